@@ -0,0 +1,155 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+/**
+ * @brief Maximum number of seats at a table (matches Game's 6 player limit)
+ */
+constexpr std::size_t MAX_SEATS = 6;
+
+/**
+ * @brief Seat index used when an event has no actor or target
+ */
+constexpr std::uint8_t NO_SEAT = 0xFF;
+
+/**
+ * @brief Kind of event stored in the action history
+ */
+enum class ActionType : std::uint8_t {
+    Gather,
+    Tax,
+    Bribe,
+    Arrest,
+    Sanction,
+    Coup,
+    Invest,
+    Investigate,
+    BlockArrest,
+    EndTurn,
+    Block,      ///< actor blocked target's action (stored in detail)
+    TurnStart,
+    GameOver,
+    GameStart   ///< game began with detail players seated
+};
+
+/**
+ * @brief Gets the display name of an action type
+ * @param type The action type
+ * @return Static string matching the GUI button label ("Block Arrest", "End Turn", ...)
+ */
+const char* actionTypeName(ActionType type);
+
+/**
+ * @brief Looks up an action type by its display name
+ * @param name Name as returned by actionTypeName (e.g. "Tax", "Block Arrest")
+ * @param out Receives the matching type
+ * @return true if the name is known
+ */
+bool parseActionType(const std::string& name, ActionType& out);
+
+/**
+ * @brief Compact, fixed-size record of a single game event
+ * @details Players are referenced by seat index instead of name and the
+ * resulting coin counts are stored alongside, so a record is self-contained
+ * and only turned into text when it is actually displayed.
+ */
+struct ActionRecord {
+    std::uint32_t seq = 0;                   ///< Sequence number assigned by ActionHistory
+    ActionType type = ActionType::Gather;    ///< What happened
+    std::uint8_t actor = NO_SEAT;            ///< Seat of the acting player
+    std::uint8_t target = NO_SEAT;           ///< Seat of the target player (NO_SEAT if none)
+    std::uint8_t detail = 0;                 ///< Blocked ActionType for Block records
+    std::uint8_t actorCoins = 0;             ///< Actor's coins after the event
+    std::uint8_t targetCoins = 0;            ///< Target's coins after the event
+    std::int16_t treasury = 0;               ///< Treasury after the event
+};
+
+/**
+ * @brief Fixed-capacity ring buffer of ActionRecords with optional disk spill
+ * @details Memory use is bounded by the capacity chosen at construction: once
+ * full, the oldest record is overwritten. When a spill path is given, every
+ * record is also appended to that file as a formatted line, so the complete
+ * history of a session survives on disk while only the tail is kept in memory.
+ */
+class ActionHistory {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 256; ///< Records kept in memory by default
+
+    /**
+     * @brief Constructs an empty history
+     * @param capacity Maximum number of records kept in memory (at least 1)
+     * @param spillPath File that receives every record as text (empty disables spilling)
+     */
+    explicit ActionHistory(std::size_t capacity = DEFAULT_CAPACITY, const std::string& spillPath = "");
+
+    /**
+     * @brief Registers the display name for a seat
+     * @param seat Seat index (ignored if out of range)
+     * @param name Name shown when formatting records for this seat
+     */
+    void setSeatName(std::uint8_t seat, const std::string& name);
+
+    /**
+     * @brief Appends a record, overwriting the oldest one when full
+     * @param record Event to store; its seq field is assigned here
+     */
+    void push(ActionRecord record);
+
+    /**
+     * @brief Drops all records held in memory (spill file is kept)
+     */
+    void clear();
+
+    /**
+     * @brief Gets the number of records currently held in memory
+     */
+    std::size_t size() const { return count; }
+
+    /**
+     * @brief Gets the maximum number of records held in memory
+     */
+    std::size_t capacity() const { return ring.size(); }
+
+    /**
+     * @brief Gets the total number of records pushed since construction
+     */
+    std::uint32_t totalRecorded() const { return nextSeq; }
+
+    /**
+     * @brief Gets a record counting back from the newest one
+     * @param index 0 for the newest record, size()-1 for the oldest retained
+     * @return Reference to the record
+     */
+    const ActionRecord& fromNewest(std::size_t index) const;
+
+    /**
+     * @brief Formats a record as a single human-readable line
+     * @param record Record to format
+     * @return Text such as "#12 Alice arrested Bob"
+     */
+    std::string format(const ActionRecord& record) const;
+
+private:
+    std::vector<ActionRecord> ring; ///< Preallocated record storage
+    std::size_t head; ///< Index where the next record is written
+    std::size_t count; ///< Number of valid records in ring
+    std::uint32_t nextSeq; ///< Sequence number for the next record
+    std::array<std::string, MAX_SEATS> seatNames; ///< Names used by format()
+    std::ofstream spill; ///< Full history on disk (closed if spilling is disabled)
+
+    /**
+     * @brief Gets the display name of a seat
+     */
+    const std::string& seatName(std::uint8_t seat) const;
+};
+
+} // namespace coup
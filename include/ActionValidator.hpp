@@ -1,14 +1,45 @@
 //meirshuker159@gmail.com
 
 #pragma once
+#include <cstdint>
 #include <string>
 #include <memory>
+#include "ActionHistory.hpp"
 
 namespace coup {
 
 class Player;
 class Game;
 
+/**
+ * @brief Why an action failed validation
+ * @details The checks report one of these instead of a message, so checking
+ * an action never allocates; the message is only built for callers that ask
+ * for a ValidationResult or an exception.
+ */
+enum class ValidationFailure : std::uint8_t {
+    None,           ///< The action is valid
+    NoActor,        ///< No player was given
+    MustCoup,       ///< 10 or more coins and the action is not Coup or End Turn
+    PlayerInactive, ///< The actor was eliminated
+    GameGone,       ///< The actor's game no longer exists
+    NotYourTurn,    ///< It is another player's turn
+    InvalidGame,    ///< The game is not in a playable state (e.g. not started)
+    NotEnoughCoins, ///< The actor cannot pay for the action
+    Sanctioned,     ///< Gather or Tax while under sanctions
+    ArrestBlocked,  ///< Arrest while blocked by a Spy
+    WrongRole,      ///< A role ability used by another role
+    TargetRequired, ///< A targeted action without a target
+    TargetInactive, ///< The target was eliminated
+    SelfTarget,     ///< The actor targeted itself
+    RepeatArrest    ///< The same player arrested twice in a row
+};
+
+/**
+ * @brief Gets a snake_case name of a failure reason, e.g. "not_enough_coins"
+ */
+const char* validationFailureName(ValidationFailure failure);
+
 /**
  * @brief Structure to hold validation results with success status and error message
  * @details Used internally by ActionValidator to return validation results
@@ -17,6 +48,7 @@ class Game;
 struct ValidationResult {
     bool isValid; ///< Whether the validation passed
     std::string errorMessage; ///< Error message if validation failed
+    ValidationFailure reason = ValidationFailure::None; ///< Why validation failed
     
     /**
      * @brief Constructs a ValidationResult
@@ -110,46 +142,59 @@ public:
      */
     static ValidationResult getValidationResult(const std::string& action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target = nullptr);
 
-private:
     /**
-     * @brief Validates coin requirements for an action
-     * @param action Name of the action
-     * @param player Player performing the action
-     * @return ValidationResult indicating if player has sufficient coins
+     * @brief Checks an action without building a message or touching the heap
+     * @param action Action to check
+     * @param actor Player performing the action
+     * @param target Target player for actions that require one (default: nullptr)
+     * @return ValidationFailure::None if the action is valid, otherwise the first rule it breaks
+     * @details Same rules, in the same order, as getValidationResult(). The
+     * game controller enumerates and validates moves through this overload.
      */
-    static ValidationResult validateCoins(const std::string& action, std::shared_ptr<Player> player);
-    
+    static ValidationFailure check(ActionType action, const Player* actor, const Player* target = nullptr);
+
     /**
-     * @brief Validates player state (active, etc.)
-     * @param player Player to validate
-     * @return ValidationResult indicating if player can perform actions
+     * @brief Gets the validation result of an action given by type
+     * @return ValidationResult whose message is only built if the action is invalid
      */
-    static ValidationResult validatePlayerState(std::shared_ptr<Player> player);
-    
+    static ValidationResult getValidationResult(ActionType action, const Player* actor, const Player* target = nullptr);
+
     /**
-     * @brief Validates target player for targeted actions
-     * @param action Name of the action
-     * @param actor Player performing the action
-     * @param target Target player to validate
-     * @return ValidationResult indicating if target is valid
+     * @brief Validates an action given by type, throwing like the by-name overload
+     * @details Allocates nothing unless the action is invalid.
      */
-    static ValidationResult validateTarget(const std::string& action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target);
-    
+    static void validateActionExecution(ActionType action, const Player* actor, const Player* target = nullptr);
+
     /**
-     * @brief Validates game state and turn management
-     * @param player Player attempting action
-     * @return ValidationResult indicating if game state allows action
+     * @brief Checks button availability of an action given by type
      */
-    static ValidationResult validateGameState(std::shared_ptr<Player> player);
-    
+    static bool isActionAvailableForButton(ActionType action, const Player* player);
+
     /**
-     * @brief Validates role-specific requirements and restrictions
-     * @param action Name of the action
-     * @param player Player performing the action
-     * @return ValidationResult indicating if role allows this action
-     * @details Checks sanctions, arrest blocks, role abilities, etc.
+     * @brief Gets the coin cost of an action given by type
+     */
+    static int getActionCost(ActionType action);
+
+    /**
+     * @brief Checks if an action given by type requires a target player
+     */
+    static bool requiresTarget(ActionType action);
+
+private:
+    /**
+     * @brief Checks everything but the target: actor, mandatory coup, turn, game, coins and role
+     */
+    static ValidationFailure checkRules(ActionType action, const Player& actor);
+
+    /**
+     * @brief Checks the target of a targeted action
+     */
+    static ValidationFailure checkTarget(ActionType action, const Player& actor, const Player* target);
+
+    /**
+     * @brief Builds the result of a failed check, with its error message
      */
-    static ValidationResult validateRoleSpecificRequirements(const std::string& action, std::shared_ptr<Player> player);
+    static ValidationResult describe(ValidationFailure failure, ActionType action, const Player* actor);
 };
 
 } // namespace coup 
\ No newline at end of file
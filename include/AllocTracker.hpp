@@ -0,0 +1,108 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace coup {
+
+/**
+ * @brief Heap traffic counted by the allocation hook
+ */
+struct AllocationCounts {
+    std::uint64_t allocations = 0; ///< operator new calls
+    std::uint64_t deallocations = 0; ///< operator delete calls on non-null pointers
+    std::uint64_t bytes = 0; ///< Bytes requested from operator new
+};
+
+/**
+ * @brief Checks whether a binary installed the allocation hook
+ * @details Without COUP_INSTALL_ALLOCATION_HOOK() the standard operator new
+ * runs untouched and every counter stays at 0, so tests of an allocation
+ * contract should check this first.
+ */
+bool allocationHookInstalled();
+
+/**
+ * @brief Gets the heap traffic of all threads since the program started
+ */
+AllocationCounts allocationTotals();
+
+/**
+ * @brief Counts the heap traffic of the calling thread while it is alive
+ * @details Scopes nest: an allocation counts in every open scope of the
+ * thread, innermost to outermost, so a test can wrap a whole game and still
+ * look at one phase of it. Other threads' allocations are never counted.
+ * Scopes must be closed in the reverse order they were opened, which
+ * holding them as locals guarantees.
+ *
+ *     AllocationScope scope;
+ *     playTurn();
+ *     CHECK(scope.counts().allocations == 0);
+ */
+class AllocationScope {
+public:
+    AllocationScope();
+    ~AllocationScope();
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    /**
+     * @brief Gets the heap traffic counted so far
+     */
+    const AllocationCounts& counts() const { return counted; }
+
+private:
+    friend void* trackedAllocate(std::size_t size);
+    friend void trackedFree(void* block) noexcept;
+
+    AllocationCounts counted; ///< Traffic of this scope
+    AllocationScope* outer; ///< Enclosing scope of the thread, or nullptr
+};
+
+/**
+ * @brief Allocates through malloc and counts the allocation (hook only)
+ * @throws std::bad_alloc if malloc fails
+ */
+void* trackedAllocate(std::size_t size);
+
+/**
+ * @brief Frees a block from trackedAllocate() and counts it (hook only)
+ */
+void trackedFree(void* block) noexcept;
+
+/**
+ * @brief Marks the hook as installed (hook only)
+ */
+bool markAllocationHookInstalled() noexcept;
+
+} // namespace coup
+
+/**
+ * @brief Replaces the global operator new and delete with counting ones
+ * @details Opt-in: expand exactly once, at namespace scope of one source file
+ * of a binary that wants allocations counted (the tests and coup-bench do;
+ * the game does not). The aligned overloads are left to the library.
+ */
+#define COUP_INSTALL_ALLOCATION_HOOK()                                                           \
+    void* operator new(std::size_t size) { return coup::trackedAllocate(size); }                 \
+    void* operator new[](std::size_t size) { return coup::trackedAllocate(size); }               \
+    void* operator new(std::size_t size, const std::nothrow_t&) noexcept {                      \
+        try {                                                                                    \
+            return coup::trackedAllocate(size);                                                  \
+        } catch (...) {                                                                          \
+            return nullptr;                                                                      \
+        }                                                                                        \
+    }                                                                                            \
+    void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {                \
+        return operator new(size, tag);                                                          \
+    }                                                                                            \
+    void operator delete(void* block) noexcept { coup::trackedFree(block); }                     \
+    void operator delete[](void* block) noexcept { coup::trackedFree(block); }                   \
+    void operator delete(void* block, std::size_t) noexcept { coup::trackedFree(block); }        \
+    void operator delete[](void* block, std::size_t) noexcept { coup::trackedFree(block); }      \
+    void operator delete(void* block, const std::nothrow_t&) noexcept { coup::trackedFree(block); } \
+    void operator delete[](void* block, const std::nothrow_t&) noexcept { coup::trackedFree(block); } \
+    static const bool coupAllocationHookInstalled = coup::markAllocationHookInstalled()
@@ -0,0 +1,38 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace coup {
+
+/**
+ * @brief A file from assets/ compiled into the binary
+ */
+struct EmbeddedAsset {
+    const char* name; ///< File name inside assets/, e.g. "DejaVuSans.ttf"
+    const unsigned char* data; ///< File contents (static storage, never freed)
+    std::size_t size; ///< Size of data in bytes
+};
+
+/**
+ * @brief All embedded assets, generated at build time by tools/embed_assets
+ */
+extern const EmbeddedAsset EMBEDDED_ASSETS[];
+
+/**
+ * @brief Number of entries in EMBEDDED_ASSETS
+ */
+extern const std::size_t EMBEDDED_ASSET_COUNT;
+
+/**
+ * @brief Looks up an embedded asset by file name
+ * @param name File name inside assets/
+ * @return The asset, or nullptr if it was not embedded
+ * @details Data can be handed straight to SFML's loadFromMemory functions;
+ * nothing is read from the filesystem at runtime.
+ */
+const EmbeddedAsset* findAsset(const std::string& name);
+
+} // namespace coup
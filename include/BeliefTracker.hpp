@@ -0,0 +1,104 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include "ActionHistory.hpp"
+#include "Game.hpp"
+#include "SimStats.hpp"
+
+namespace coup {
+
+/**
+ * @brief Probability of each role for every seat, kept up to date from game events
+ * @details Roles are dealt independently and uniformly, so each seat's
+ * distribution can be updated on its own. observe() applies the evidence a
+ * record carries as a likelihood and renormalises, in O(ROLE_COUNT):
+ *
+ * - Invest is only open to a Baron; Investigate and Block Arrest to a Spy
+ * - Tax pays governorTax to a Governor and taxAmount to everyone else, so
+ *   the actor's coin gain tells them apart (when the rules differ)
+ * - A Block record names the blocker of Tax (Governor), Bribe (Judge) or
+ *   Coup (General)
+ *
+ * Queries read the stored distribution and cost O(1). Feed it every record of
+ * a game in order, for example from GameController::setEventSink(); a
+ * GameStart record resets it.
+ */
+class BeliefTracker {
+public:
+    using Distribution = std::array<float, ROLE_COUNT>; ///< Probability per role index
+
+    /**
+     * @param players Seats at the table
+     * @param rules Rules of the game (tax amounts)
+     */
+    explicit BeliefTracker(std::size_t players = MAX_SEATS, const RuleSet& rules = RuleSet());
+
+    /**
+     * @brief Forgets all evidence
+     * @param players Seats at the table
+     */
+    void reset(std::size_t players);
+
+    /**
+     * @brief Applies the evidence of one record
+     */
+    void observe(const ActionRecord& record);
+
+    /**
+     * @brief Fixes a seat's role, e.g. the observer's own
+     * @param seat Seat to fix
+     * @param role Role index (see roleIndex)
+     */
+    void reveal(std::uint8_t seat, std::size_t role);
+
+    /**
+     * @brief Gets the probability that a seat holds a role
+     */
+    float probability(std::uint8_t seat, std::size_t role) const { return beliefs[seat][role]; }
+
+    /**
+     * @brief Gets a seat's distribution over the roles
+     */
+    const Distribution& distribution(std::uint8_t seat) const { return beliefs[seat]; }
+
+    /**
+     * @brief Gets a seat's role if the evidence leaves only one
+     * @return Role index, or ROLE_COUNT if more than one role is possible
+     */
+    std::size_t knownRole(std::uint8_t seat) const { return known[seat]; }
+
+    /**
+     * @brief Draws a role for every seat from the beliefs
+     * @param rng Random generator
+     * @param roles Receives a role index per seat
+     * @details Seats are independent, so this samples a determinization of
+     * the hidden roles consistent with everything observed.
+     */
+    void sample(std::mt19937& rng, std::array<std::size_t, MAX_SEATS>& roles) const;
+
+    /**
+     * @brief Gets the number of seats tracked
+     */
+    std::size_t players() const { return seats; }
+
+private:
+    /**
+     * @brief Multiplies a seat's distribution by a likelihood and renormalises
+     * @details Evidence that contradicts everything believed so far (a
+     * likelihood of zero for every role still possible) is ignored.
+     */
+    void apply(std::uint8_t seat, const Distribution& likelihood);
+
+    RuleSet rules; ///< Tax amounts
+    std::size_t seats; ///< Seats at the table
+    std::array<Distribution, MAX_SEATS> beliefs; ///< Per seat, per role
+    std::array<std::size_t, MAX_SEATS> known; ///< Per seat: the only possible role, or ROLE_COUNT
+    std::array<std::uint8_t, MAX_SEATS> coins; ///< Last coin count seen per seat
+};
+
+} // namespace coup
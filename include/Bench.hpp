@@ -0,0 +1,148 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+/**
+ * @brief Hardware instruction counter of the calling thread
+ * @details Uses perf_event_open (user-space instructions only). Where the
+ * syscall is missing or not permitted (other systems, containers,
+ * perf_event_paranoid) the counter is simply unavailable and reads 0.
+ */
+class InstructionCounter {
+public:
+    InstructionCounter();
+    ~InstructionCounter();
+    InstructionCounter(const InstructionCounter&) = delete;
+    InstructionCounter& operator=(const InstructionCounter&) = delete;
+
+    /**
+     * @brief Checks whether the counter could be opened
+     */
+    bool available() const { return fd >= 0; }
+
+    /**
+     * @brief Gets the instructions retired since the counter was opened
+     */
+    std::uint64_t read() const;
+
+private:
+    int fd; ///< perf event file, -1 if unavailable
+};
+
+/**
+ * @brief One microbenchmark
+ * @details op is timed in a loop, each call preceded by reset (if set),
+ * which puts the state back where op expects it. reset is timed in a loop
+ * of its own and subtracted, so results are what op alone costs. Operations
+ * that leave the state alone can instead set it up once, untimed.
+ */
+struct BenchCase {
+    std::string name; ///< e.g. "Player::gather"
+    std::function<void()> reset; ///< Restores the state op starts from, or empty
+    std::function<void()> op; ///< The operation measured
+    std::function<void()> setup; ///< Runs once before the case is timed, or empty
+};
+
+/**
+ * @brief Parameters of a benchmark run
+ */
+struct BenchConfig {
+    double minSeconds = 0.1; ///< Iterations double until a timed loop takes this long
+    double warmupSeconds = 0.0; ///< Untimed calls before calibrating, to settle caches and clocks
+    unsigned repetitions = 1; ///< Timed measurements per case, for the confidence interval
+    std::string filter; ///< Only cases whose name contains this
+    std::function<std::uint64_t()> allocations; ///< Allocations made so far, or empty if not counted
+};
+
+/**
+ * @brief Cost of one operation
+ */
+struct BenchResult {
+    std::string name; ///< Case name
+    std::uint64_t iterations = 0; ///< Calls of op in each timed loop
+    unsigned repetitions = 0; ///< Timed measurements
+    double nsPerOp = 0.0; ///< Wall time per call, mean over the repetitions
+    double nsLow = 0.0; ///< Lower bound of the 95% confidence interval of nsPerOp
+    double nsHigh = 0.0; ///< Upper bound of the 95% confidence interval of nsPerOp
+    double allocsPerOp = -1.0; ///< Heap allocations per call, -1 if not counted
+    double instructionsPerOp = -1.0; ///< Instructions retired per call, -1 if unavailable
+};
+
+/**
+ * @brief Runs benchmarks one after another on the calling thread
+ * @return One result per case that passed the filter, in order
+ * @details A case first runs untimed for config.warmupSeconds. Its
+ * iteration count is then calibrated, doubling until the loop of op and
+ * reset runs for config.minSeconds, and both loops are timed with that count
+ * config.repetitions times. The interval is Student's t over the
+ * repetitions (a single repetition gives a zero-width one). Exceptions
+ * thrown by a case propagate.
+ */
+std::vector<BenchResult> runBenchmarks(const std::vector<BenchCase>& cases, const BenchConfig& config);
+
+/**
+ * @brief Writes results as a table, one case per line
+ */
+void writeBenchTable(std::ostream& out, const std::vector<BenchResult>& results);
+
+/**
+ * @brief Writes results as JSON
+ * @details {"unit":"per_op","benchmarks":[{"name":...,"iterations":...,
+ * "repetitions":...,"ns":...,"ns_ci":[low,high],"allocs":...,
+ * "instructions":...}]}; allocs and instructions are null when they were
+ * not measured.
+ */
+void writeBenchJson(std::ostream& out, const std::vector<BenchResult>& results);
+
+/**
+ * @brief Reads results written by writeBenchJson()
+ * @details Files without ns_ci or repetitions (a single measurement) read as
+ * a zero-width interval around ns.
+ * @throws GameException if the input is not such a file
+ */
+std::vector<BenchResult> readBenchJson(std::istream& in);
+
+/**
+ * @brief Outcome of comparing one case with its baseline
+ */
+struct BenchVerdict {
+    std::string name; ///< Case name
+    const BenchResult* baseline = nullptr; ///< Baseline result, nullptr for a new case
+    const BenchResult* current = nullptr; ///< Result compared
+    double change = 0.0; ///< Relative change of the mean time (0.1 for 10% slower)
+    bool regressed = false; ///< Whether the case fails the check
+    std::string reason; ///< Why it failed, empty if it did not
+};
+
+/**
+ * @brief Compares results with a baseline, flagging regressions beyond the noise
+ * @param baseline Stored results
+ * @param current New results; cases absent from the baseline are new, never regressions
+ * @param tolerance Slowdown of the mean allowed, as a fraction
+ * @return One verdict per current result, in order
+ * @details A case regresses in time if its mean is more than tolerance
+ * slower than the baseline's and the confidence intervals do not overlap
+ * (current.nsLow > baseline.nsHigh); the intervals only keep noise from
+ * failing the check, they do not widen the tolerance. Instructions, when
+ * both sides counted them, are nearly deterministic and regress beyond
+ * tolerance alone; allocations regress on any increase of more than half
+ * an allocation per call.
+ */
+std::vector<BenchVerdict> compareBenchmarks(const std::vector<BenchResult>& baseline,
+                                            const std::vector<BenchResult>& current, double tolerance);
+
+/**
+ * @brief Writes verdicts as a table, one case per line
+ */
+void writeBenchVerdicts(std::ostream& out, const std::vector<BenchVerdict>& verdicts);
+
+} // namespace coup
@@ -0,0 +1,206 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "GameController.hpp"
+#include "GameRecord.hpp"
+
+namespace coup {
+
+class EvalQueue;
+class PolicyTable;
+class PolicyValueNet;
+
+/**
+ * @brief Self-contained copy of a position, as one seat sees it, handed to a bot
+ * @details Bots run on worker threads, so they never see the live game: they
+ * get the seating and a saved controller state and build a private, silent
+ * controller from it. Only the deciding seat's role is kept; the others are
+ * hidden and dealt afresh from the beliefs in state for every controller
+ * built, so a search averages over the roles the game so far allows.
+ */
+struct BotPosition {
+    std::vector<SeatRecord> seats; ///< Seating of the game; role is empty for every seat but seat
+    RuleSet rules; ///< Rules of the game, so searches play the same variant
+    ControllerState state; ///< Complete state to decide in, with seat's role revealed in its beliefs
+    std::uint8_t seat = NO_SEAT; ///< Seat the bot decides for
+    const std::atomic<bool>* cancel = nullptr; ///< Set when the answer is no longer wanted
+
+    /**
+     * @brief Captures a controller's current position as seen from one seat
+     * @param controller Controller to copy (read on the calling thread)
+     * @param seat Seat that has to decide
+     */
+    static BotPosition capture(const GameController& controller, std::uint8_t seat);
+
+    /**
+     * @brief Builds a silent controller in this position with the hidden roles dealt
+     * @param rng Random generator for the deal (BeliefTracker::sample)
+     * @return Controller owning its own game; no event sink is set and it records
+     * no metrics and does not update its beliefs
+     */
+    std::unique_ptr<GameController> instantiate(std::mt19937& rng) const;
+
+    /**
+     * @brief Checks whether the caller asked the bot to stop
+     */
+    bool cancelled() const { return cancel && cancel->load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Computer player
+ * @details decide() is called on a thread pool worker. A bot may keep state
+ * between calls (random generator, statistics); calls for the same bot never
+ * overlap, but different bots run in parallel.
+ *
+ * In the Playing phase the answer must be a Kind::Action move for the current
+ * player. In the BlockPending phase the bot is one of the possible blockers
+ * and answers Kind::Block (its own seat) or Kind::Pass.
+ */
+class Bot {
+public:
+    using Clock = std::chrono::steady_clock; ///< Clock for decision deadlines
+
+    virtual ~Bot() = default;
+
+    /**
+     * @brief Gets the bot type, as accepted by createBot()
+     */
+    virtual std::string name() const = 0;
+
+    /**
+     * @brief Chooses a move
+     * @param position Position to decide in; position.seat is the bot's seat
+     * @param deadline Time by which the answer should be returned
+     * @return A move that is legal in position
+     */
+    virtual RecordedMove decide(const BotPosition& position, Clock::time_point deadline) = 0;
+};
+
+/**
+ * @brief Plays randomMove(), passing or blocking with equal chance
+ */
+class RandomBot : public Bot {
+public:
+    /**
+     * @param seed Seed for the move choices
+     */
+    explicit RandomBot(std::uint32_t seed);
+
+    std::string name() const override { return "random"; }
+    RecordedMove decide(const BotPosition& position, Clock::time_point deadline) override;
+
+private:
+    std::mt19937 rng; ///< Move choices
+};
+
+/**
+ * @brief Flat Monte Carlo search with UCB1 over the candidate moves
+ * @details Until the deadline (or maxRollouts), the most promising candidate
+ * under UCB1 is applied to a restored copy of the position and the game is
+ * played out with random moves. A playout scores 1 if the bot's seat wins;
+ * playouts cut off after ROLLOUT_LIMIT moves score a share of the pot among
+ * the survivors. The candidate with the best average score is returned.
+ * The Spy's free actions are not considered. Every playout starts from a
+ * new deal of the opponents' hidden roles (see BotPosition), so only moves
+ * legal in every deal the beliefs allow are candidates.
+ *
+ * With a policy/value network the search becomes PUCT: the network's policy
+ * over the candidates is the prior that steers the playouts, and a playout
+ * stops after NET_ROLLOUT_DEPTH random moves and is scored by the network's
+ * value of the bot's seat instead of being played to the end. Those leaves
+ * are evaluated in batches through the network's shared EvalQueue.
+ *
+ * With a rollout policy the playouts draw their moves from a PolicyTable
+ * instead of uniformly at random, so they look more like real games.
+ */
+class MonteCarloBot : public Bot {
+public:
+    static constexpr std::uint32_t ROLLOUT_LIMIT = 400; ///< Moves before a playout is cut off
+    static constexpr std::uint32_t NET_ROLLOUT_DEPTH = 8; ///< Random moves before the network scores a playout
+    static constexpr double PUCT_WEIGHT = 1.5; ///< Weight of the prior against the mean score
+    static constexpr std::size_t NET_WAVE = 32; ///< Leaves in flight to the evaluator at once
+
+    /**
+     * @param seed Seed for the playouts
+     * @param maxRollouts Upper bound on playouts per decision (0 = only the deadline)
+     * @param net Network to evaluate positions with, or nullptr for plain playouts
+     * @param rolloutPolicy Table the playouts draw their moves from, or nullptr for random moves
+     * @throws GameException if net does not take encodeFeatures() input and
+     * give MOVE_SLOTS policy logits
+     */
+    explicit MonteCarloBot(std::uint32_t seed, std::uint32_t maxRollouts = 0,
+                           std::shared_ptr<const PolicyValueNet> net = nullptr,
+                           std::shared_ptr<const PolicyTable> rolloutPolicy = nullptr);
+
+    std::string name() const override { return net ? "netmc" : rolloutPolicy ? "tablemc" : "montecarlo"; }
+    RecordedMove decide(const BotPosition& position, Clock::time_point deadline) override;
+
+    /**
+     * @brief Gets the number of playouts made by the last decide()
+     */
+    std::uint32_t lastRollouts() const { return rollouts; }
+
+private:
+    std::mt19937 rng; ///< Playout choices
+    std::uint32_t maxRollouts; ///< Playout cap, 0 for none
+    std::uint32_t rollouts; ///< Playouts of the last decision
+    std::shared_ptr<const PolicyValueNet> net; ///< Evaluator, or nullptr
+    std::shared_ptr<EvalQueue> queue; ///< Batches the leaf evaluations for net
+    std::shared_ptr<const PolicyTable> rolloutPolicy; ///< Playout moves, or nullptr for random ones
+};
+
+/**
+ * @brief Plays the moves of a PolicyTable without any search
+ * @details A decision is one table lookup and a weighted draw, so the bot is
+ * about as fast as RandomBot while playing a recognisable strategy.
+ */
+class TableBot : public Bot {
+public:
+    /**
+     * @param seed Seed for the draws
+     * @param table Table to play, shared between bots
+     */
+    TableBot(std::uint32_t seed, std::shared_ptr<const PolicyTable> table);
+
+    std::string name() const override { return "table"; }
+    RecordedMove decide(const BotPosition& position, Clock::time_point deadline) override;
+
+private:
+    std::mt19937 rng; ///< Draws
+    std::shared_ptr<const PolicyTable> table; ///< Policy played
+};
+
+/**
+ * @brief Chooses a random legal move for whoever has to decide
+ * @param controller Controller in the Playing or BlockPending phase
+ * @param rng Random generator
+ * @return An action of the current player, or for a block decision a pass
+ * half of the time and otherwise a block by a random blocker
+ * @details End Turn and the Spy's free actions (Investigate, Block Arrest) are
+ * only chosen when nothing else is legal, so random games keep moving
+ * towards a coup instead of repeating moves that keep the turn.
+ */
+RecordedMove randomMove(const GameController& controller, std::mt19937& rng);
+
+/**
+ * @brief Creates a bot by type name
+ * @param type "random", "montecarlo", or "montecarlo:N" for a Monte Carlo bot
+ * capped at N playouts per decision (reproducible on any machine, as used by
+ * tournaments), or "netmc:N:PATH" for one evaluating with the network in the
+ * weight file PATH; "table" plays the built-in policy table and "table:PATH"
+ * the table file PATH, "tablemc:N" and "tablemc:N:PATH" are capped Monte
+ * Carlo bots whose playouts follow that table
+ * @param seed Seed for the bot's random choices
+ * @throws GameException if the type is unknown or the network or table cannot be loaded
+ */
+std::unique_ptr<Bot> createBot(const std::string& type, std::uint32_t seed);
+
+} // namespace coup
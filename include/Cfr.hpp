@@ -0,0 +1,161 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SmallGame.hpp"
+
+namespace coup {
+
+/**
+ * @brief A strategy over the abstract information sets of a small game
+ * @details Maps SmallGame::abstractKey() to a probability per action; keys
+ * it does not know are played uniformly. File format (little-endian):
+ *
+ *     char     magic[8]      "COUPCFR1"
+ *     uint8    players, horizon, startCoins, bucketCoins
+ *     int32    taxAmount, governorTax, merchantThreshold, merchantBonus
+ *     uint64   entries
+ *     entries x { uint64 key; float32 probabilities[SMALL_ACTIONS] }
+ */
+class CfrStrategy : public SmallPolicy {
+public:
+    /**
+     * @param config Game the strategy was solved for
+     * @param keys Abstract keys, sorted ascending
+     * @param table Probabilities per key
+     */
+    CfrStrategy(const SmallConfig& config, std::vector<std::uint64_t> keys,
+                std::vector<std::array<float, SMALL_ACTIONS>> table);
+
+    /**
+     * @brief Loads a strategy file
+     * @throws GameException if the file is missing, truncated or not a strategy
+     */
+    static CfrStrategy load(const std::string& path);
+
+    /**
+     * @brief Writes the strategy in the file format above
+     * @throws GameException if the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    void probabilities(const SmallGame& game, const SmallState& state, SmallActionMask legal,
+                       std::array<float, SMALL_ACTIONS>& out) const override;
+
+    /**
+     * @brief Gets the game the strategy was solved for
+     */
+    const SmallConfig& config() const { return settings; }
+
+    /**
+     * @brief Gets the number of information sets with a stored strategy
+     */
+    std::size_t size() const { return keys.size(); }
+
+private:
+    SmallConfig settings; ///< Game solved
+    std::vector<std::uint64_t> keys; ///< Sorted abstract keys
+    std::vector<std::array<float, SMALL_ACTIONS>> table; ///< Probabilities per key
+};
+
+/**
+ * @brief CFR+ solver for small games
+ * @details Counterfactual regret minimisation over the whole game tree of
+ * every deal, with the CFR+ refinements: regret matching on regrets floored
+ * at zero after every pass, alternating updates (one pass per seat per
+ * iteration) and an average strategy weighted by iteration. The average
+ * strategy approaches a Nash equilibrium in two-player games; with three
+ * players it is still a strong, hard to exploit strategy.
+ *
+ * Information sets are SmallGame::abstractKey(), so histories that look the
+ * same after bucketing share one set of regrets (imperfect recall). The
+ * constructor walks the tree once to number the keys densely (in key
+ * order), so the tables are flat arrays indexed by a binary search, with a
+ * cache-line-aligned row of 16 floats per information set.
+ *
+ * A pass reads the regrets but does not write them: the deals are striped
+ * across threads, each adding into its own delta rows, and the deltas are
+ * merged in thread order after the pass. The result depends on the thread
+ * count only through float rounding.
+ */
+class CfrSolver {
+public:
+    /**
+     * @param game Game to solve; must outlive the solver
+     * @param threads Worker threads, 0 for one per hardware thread
+     * @throws GameException if two states of one information set differ in
+     * their legal actions (a key that does not capture enough)
+     */
+    explicit CfrSolver(const SmallGame& game, unsigned threads = 0);
+
+    /**
+     * @brief Runs more iterations
+     */
+    void iterate(std::size_t count);
+
+    /**
+     * @brief Gets the iterations run so far
+     */
+    std::size_t iterations() const { return iteration; }
+
+    /**
+     * @brief Gets the number of abstract information sets
+     */
+    std::size_t infoSets() const { return keys.size(); }
+
+    /**
+     * @brief Gets the average strategy, the solver's answer
+     */
+    CfrStrategy averageStrategy() const;
+
+private:
+    /**
+     * @brief Sixteen floats per information set, one cache line
+     */
+    struct alignas(64) Row {
+        std::array<float, 16> values{};
+    };
+
+    /**
+     * @brief Per-thread additions of one pass
+     */
+    struct Deltas {
+        std::vector<Row> regrets;
+        std::vector<Row> strategy;
+    };
+
+    /**
+     * @brief Gets the row of an abstract key
+     */
+    std::size_t indexOf(std::uint64_t key) const;
+
+    /**
+     * @brief Gets the current strategy of a row by regret matching
+     */
+    void currentStrategy(std::size_t index, std::array<float, SMALL_ACTIONS>& out) const;
+
+    /**
+     * @brief Walks a subtree, updating the traverser's regrets and average strategy
+     * @param traverser Seat whose regrets are updated
+     * @param reachSelf Probability that the traverser plays to this state
+     * @param reachOthers Probability that chance and the others do
+     * @return The traverser's expected score at this state
+     */
+    float traverse(const SmallState& state, std::uint8_t traverser, float reachSelf, float reachOthers,
+                   Deltas& deltas) const;
+
+    const SmallGame& game; ///< Game being solved
+    unsigned threads; ///< Worker threads
+    std::size_t iteration = 0; ///< Iterations run
+    std::vector<std::uint64_t> keys; ///< Sorted abstract keys
+    std::vector<SmallActionMask> masks; ///< Legal actions per key
+    std::vector<Row> regrets; ///< Cumulative regrets per key, never negative
+    std::vector<Row> strategySums; ///< Iteration-weighted strategy per key
+};
+
+} // namespace coup
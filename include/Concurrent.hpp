@@ -0,0 +1,131 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace coup {
+
+/**
+ * @brief Assumed cache line size used to keep independently written data apart
+ */
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Bounded lock-free single-producer single-consumer queue
+ * @tparam T Element type (copied in and out)
+ * @tparam Capacity Number of slots, must be a power of two
+ * @details Exactly one thread may call tryPush and exactly one other thread
+ * may call tryPop. Head and tail live on separate cache lines so the two
+ * sides never contend on the same line except when the queue is near empty
+ * or full. All storage is inline; pushing and popping never allocate.
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0), buffer() {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Appends an element (producer thread only)
+     * @param value Element to copy into the queue
+     * @return false if the queue is full
+     */
+    bool tryPush(const T& value) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        buffer[t & (Capacity - 1)] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest element (consumer thread only)
+     * @param out Receives the element
+     * @return false if the queue is empty
+     */
+    bool tryPop(T& out) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = buffer[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Checks whether the queue currently holds no elements
+     * @details Exact for the consumer, a hint for anyone else
+     */
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head; ///< Next slot to read (consumer owned)
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail; ///< Next slot to write (producer owned)
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> buffer; ///< Element storage
+};
+
+/**
+ * @brief Lock-free triple buffer for handing whole values from one writer to one reader
+ * @tparam T Value type; should be trivially copyable so publishing never allocates
+ * @details The writer fills writeBuffer() and calls publish(); the reader calls
+ * read() and gets the most recently published value. Neither side ever waits:
+ * the third slot guarantees the writer always has a free buffer while the
+ * reader holds on to the one it is displaying. Intermediate values may be
+ * skipped if the writer publishes faster than the reader reads.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : slots(), shared(1), back(0), front(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * @brief Gets the slot the writer may fill (writer thread only)
+     * @details The slot holds stale data; the writer must overwrite it completely.
+     */
+    T& writeBuffer() { return slots[back]; }
+
+    /**
+     * @brief Makes the write buffer visible to the reader (writer thread only)
+     */
+    void publish() {
+        back = shared.exchange(static_cast<std::uint8_t>(back | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /**
+     * @brief Gets the latest published value (reader thread only)
+     * @return Reference that stays valid until the next call to read()
+     */
+    const T& read() {
+        if (shared.load(std::memory_order_relaxed) & FRESH) {
+            front = shared.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+        return slots[front];
+    }
+
+private:
+    static constexpr std::uint8_t FRESH = 0x4; ///< Set while the shared slot holds an unread value
+    static constexpr std::uint8_t INDEX_MASK = 0x3; ///< Bits holding a slot index
+
+    std::array<T, 3> slots; ///< The three buffers
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint8_t> shared; ///< Index of the slot in transit (+ FRESH bit)
+    alignas(CACHE_LINE_SIZE) std::uint8_t back; ///< Writer's slot
+    alignas(CACHE_LINE_SIZE) std::uint8_t front; ///< Reader's slot
+};
+
+} // namespace coup
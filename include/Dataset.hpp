@@ -0,0 +1,117 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Features.hpp"
+
+namespace coup {
+
+/**
+ * @brief Writes one array as a NumPy .npy file (format 1.0)
+ * @param path Destination file
+ * @param descr NumPy type string, e.g. "<f4" or "|u1"
+ * @param shape Array shape; the product times the item size must equal bytes
+ * @param data Raw little-endian values in C order
+ * @param bytes Size of data
+ * @throws GameException if the file cannot be written
+ * @details The header is padded to a multiple of 64 bytes, so the data can
+ * be memory-mapped (numpy.load(path, mmap_mode="r")) and read without any
+ * parsing.
+ */
+void writeNpy(const std::string& path, const std::string& descr, const std::vector<std::size_t>& shape,
+              const void* data, std::size_t bytes);
+
+/**
+ * @brief One decision point of a self-play game
+ */
+struct TrainingRow {
+    std::array<float, FEATURE_COUNT> features; ///< encodeFeatures() of the position
+    std::array<std::uint8_t, MOVE_SLOTS> legal; ///< legalMask() of the position
+    std::uint8_t action = 0; ///< Slot of the move taken
+    std::uint8_t seat = 0; ///< Deciding seat
+    std::uint8_t players = 0; ///< Seats at the table
+    std::uint32_t game = 0; ///< Game number
+};
+
+/**
+ * @brief Buffers rows column by column and writes them as chunk files
+ * @details Each column of a chunk is its own .npy file,
+ * DIR/chunk-NNNNNN.COLUMN.npy:
+ *
+ *     features float32 [rows, FEATURE_COUNT]   legal  uint8 [rows, MOVE_SLOTS]
+ *     action   uint8   [rows]                  outcome int8 [rows] (+1 won, 0 cut off, -1 lost)
+ *     place    uint8   [rows] (0 for first)    seat, players uint8 [rows]
+ *     game     uint32  [rows]
+ *
+ * Rows of a game are only complete once its outcome is known, so a chunk is
+ * written at the first game boundary after chunkRows rows: no game is split
+ * across chunks. One writer per thread; chunk numbers come from a counter
+ * shared by all writers of a dataset.
+ */
+class ChunkWriter {
+public:
+    /**
+     * @param directory Existing output directory
+     * @param chunkRows Rows after which a chunk is written
+     * @param nextChunk Counter handing out chunk numbers
+     */
+    ChunkWriter(const std::string& directory, std::size_t chunkRows, std::atomic<std::uint32_t>& nextChunk);
+
+    /**
+     * @brief Appends a decision of the game in progress
+     */
+    void add(const TrainingRow& row);
+
+    /**
+     * @brief Fills in the outcome of the game in progress and may write a chunk
+     * @param outcomes Outcome per seat (+1, 0 or -1)
+     * @param places Finishing place per seat
+     */
+    void finishGame(const std::vector<std::int8_t>& outcomes, const std::vector<std::uint32_t>& places);
+
+    /**
+     * @brief Writes the buffered finished games as a chunk, if there are any
+     */
+    void flush();
+
+    /**
+     * @brief Gets the (chunk number, rows) of every chunk written
+     */
+    const std::vector<std::pair<std::uint32_t, std::size_t>>& chunks() const { return written; }
+
+private:
+    std::string directory; ///< Output directory
+    std::size_t chunkRows; ///< Chunk size target
+    std::atomic<std::uint32_t>& nextChunk; ///< Shared chunk counter
+    std::size_t gameStart; ///< First buffered row of the game in progress
+    std::vector<std::pair<std::uint32_t, std::size_t>> written; ///< Chunks written so far
+
+    std::vector<float> features; ///< features column
+    std::vector<std::uint8_t> legal; ///< legal column
+    std::vector<std::uint8_t> action; ///< action column
+    std::vector<std::int8_t> outcome; ///< outcome column
+    std::vector<std::uint8_t> place; ///< place column
+    std::vector<std::uint8_t> seat; ///< seat column
+    std::vector<std::uint8_t> players; ///< players column
+    std::vector<std::uint32_t> game; ///< game column
+};
+
+/**
+ * @brief Writes DIR/manifest.json describing a dataset
+ * @param directory Dataset directory
+ * @param chunks (chunk number, rows) of every chunk, in any order
+ * @param games Games played
+ * @throws GameException if the file cannot be written
+ * @details Lists the columns with their types and widths, the feature and
+ * move slot names, and the chunks in number order.
+ */
+void writeManifest(const std::string& directory, std::vector<std::pair<std::uint32_t, std::size_t>> chunks,
+                   std::uint64_t games);
+
+} // namespace coup
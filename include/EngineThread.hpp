@@ -0,0 +1,267 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ActionHistory.hpp"
+#include "Bot.hpp"
+#include "Concurrent.hpp"
+#include "GameController.hpp"
+#include "GameRecord.hpp"
+#include "GameSnapshot.hpp"
+#include "QuantileSketch.hpp"
+#include "ThreadPool.hpp"
+
+namespace coup {
+
+/**
+ * @brief Command sent from a frontend to the engine thread
+ */
+struct EngineCommand {
+    /**
+     * @brief What the command asks the engine to do
+     */
+    enum class Kind : std::uint8_t {
+        AddPlayer, ///< Add a player named name
+        AddBot,    ///< Add a player named name, played by a bot of type botType
+        StartGame, ///< Start the game
+        Action,    ///< Current player performs action (targeting seat)
+        Block,     ///< Player at seat blocks the pending action
+        Pass       ///< Nobody blocks the pending action
+    };
+
+    Kind kind = Kind::StartGame; ///< Command type
+    ActionType action = ActionType::Gather; ///< Action for Kind::Action
+    std::uint8_t seat = NO_SEAT; ///< Target (Action) or blocker (Block) seat
+    char name[32] = {}; ///< Player name for Kind::AddPlayer and Kind::AddBot
+    char botType[16] = {}; ///< Bot type for Kind::AddBot (see createBot)
+};
+
+/**
+ * @brief Runs a GameController on a dedicated thread
+ * @details The frontend and the engine share no locks on the hot path:
+ * - commands travel frontend -> engine through a lock-free SPSC queue
+ * - every processed command publishes a full GameSnapshot through a
+ *   TripleBuffer, which the frontend reads without waiting
+ * - ActionRecords travel engine -> frontend through a second SPSC queue
+ *
+ * The engine sleeps on a condition variable while idle; the only lock is
+ * taken briefly by send() to wake it, never by snapshot() or pollEvent().
+ * All public methods except the constructor and destructor must be called
+ * from a single frontend thread.
+ *
+ * Every accepted move is also added to a GameRecord, which is written to
+ * recordPath when the game ends (or when the engine stops mid-game) so the
+ * game can be opened in the replay viewer.
+ *
+ * The time spent on each command is published in the snapshot
+ * (engineCommandMicros) so frontends can show engine latency.
+ *
+ * Seats added with addBot() are played by a Bot. Whenever a bot has to
+ * decide (its turn, or a block decision it may make), the engine hands a
+ * copy of the position to a ThreadPool and keeps serving commands and
+ * snapshots; the answer comes back as an ordinary command, so bot moves are
+ * validated and recorded exactly like clicks. Several bots that may block
+ * the same action search in parallel. Frontend commands for bot seats are
+ * rejected, and a human pass waits until the bots have answered.
+ */
+class EngineThread {
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_BOT_BUDGET{300}; ///< Default thinking time per decision
+
+    /**
+     * @brief Creates the engine thread for a game
+     * @param game Game to run; must not be touched by other threads afterwards
+     * @param recordPath File the game record is saved to; empty disables saving
+     * @param botBudget Thinking time each bot gets per decision
+     */
+    explicit EngineThread(std::shared_ptr<Game> game, const std::string& recordPath = "",
+                          std::chrono::milliseconds botBudget = DEFAULT_BOT_BUDGET);
+
+    /**
+     * @brief Stops and joins the engine thread
+     */
+    ~EngineThread();
+
+    EngineThread(const EngineThread&) = delete;
+    EngineThread& operator=(const EngineThread&) = delete;
+
+    /**
+     * @brief Queues a command for the engine
+     * @param command Command to send
+     * @return false if the command queue is full
+     */
+    bool send(const EngineCommand& command);
+
+    /**
+     * @brief Queues an AddPlayer command
+     */
+    bool addPlayer(const std::string& name);
+
+    /**
+     * @brief Queues an AddBot command
+     * @param name Player name
+     * @param type Bot type, "montecarlo" or "random"
+     */
+    bool addBot(const std::string& name, const std::string& type = "montecarlo");
+
+    /**
+     * @brief Queues a StartGame command
+     */
+    bool startGame();
+
+    /**
+     * @brief Queues an action for the current player
+     * @param action Action to perform
+     * @param targetSeat Target seat for targeted actions
+     */
+    bool action(ActionType action, std::uint8_t targetSeat = NO_SEAT);
+
+    /**
+     * @brief Queues a block of the pending action
+     * @param blockerSeat Seat of the blocking player
+     */
+    bool block(std::uint8_t blockerSeat);
+
+    /**
+     * @brief Queues a pass on the pending action
+     */
+    bool pass();
+
+    /**
+     * @brief Gets the most recently published state without locking
+     * @return Snapshot that stays valid until the next call to snapshot()
+     */
+    const GameSnapshot& snapshot() { return snapshots.read(); }
+
+    /**
+     * @brief Takes the next event emitted by the engine
+     * @param record Receives the event
+     * @return false if no event is waiting
+     */
+    bool pollEvent(ActionRecord& record) { return events.tryPop(record); }
+
+private:
+    GameController controller; ///< Engine state, owned by the worker thread
+    SpscQueue<EngineCommand, 256> commands; ///< Frontend -> engine
+    SpscQueue<ActionRecord, 4096> events; ///< Engine -> frontend
+    TripleBuffer<GameSnapshot> snapshots; ///< Latest state for the frontend
+    std::atomic<bool> running; ///< Cleared to stop the worker
+    std::mutex wakeMutex; ///< Only used to sleep/wake the worker
+    std::condition_variable wake; ///< Signalled when commands arrive
+    std::thread worker; ///< The engine thread
+
+    // Recording (worker thread only, then the destructor after join)
+    GameRecord recording; ///< Seats and accepted moves of this game
+    std::string recordPath; ///< Where recording is saved, empty for never
+    bool recordSaved; ///< Whether the finished game was already saved
+
+    // Latency of the last command, published with the next snapshot
+    std::uint32_t commandCount; ///< Commands processed so far
+    std::uint32_t lastCommandMicros; ///< Time spent in process() for the last command
+
+    // Bots (worker thread only, except the answer hand-off)
+
+    /**
+     * @brief A decision returned by a bot job
+     */
+    struct BotAnswer {
+        std::uint64_t epoch; ///< Decision point the bot was asked about
+        std::uint8_t seat; ///< Seat of the bot
+        RecordedMove move; ///< Chosen move
+        std::uint32_t micros; ///< Search time
+    };
+
+    /**
+     * @brief What a bot said about the pending block in the current epoch
+     */
+    enum class BlockAnswer : std::uint8_t { None, Pass, Block };
+
+    std::array<std::unique_ptr<Bot>, MAX_SEATS> bots; ///< Bot per seat, null for humans
+    std::chrono::milliseconds botBudget; ///< Thinking time per decision
+    std::uint32_t botSeed; ///< Seed for the next bot created
+    std::uint64_t botEpoch; ///< State version bot requests were made for
+    std::array<bool, MAX_SEATS> botRequested; ///< Seat was asked in this epoch
+    std::array<bool, MAX_SEATS> botBusy; ///< A job for the seat is running (any epoch)
+    std::array<BlockAnswer, MAX_SEATS> blockAnswers; ///< Bot block decisions in this epoch
+    bool deferredPass; ///< A human passed while bots were still deciding
+    std::uint32_t botDecisionCount; ///< Answers received
+    std::uint32_t lastBotMicros; ///< Search time of the last answer
+    QuantileSketch botLatency; ///< Search times of all answers this game, in microseconds
+    std::mutex answerMutex; ///< Guards answers
+    std::vector<BotAnswer> answers; ///< Answers from the pool, not yet applied
+    std::atomic<bool> answersWaiting; ///< Set when answers is non-empty
+    std::atomic<bool> cancelBots; ///< Tells running searches to stop
+    std::unique_ptr<ThreadPool> pool; ///< Created with the first bot
+
+    /**
+     * @brief Worker loop: process commands, publish snapshots, sleep when idle
+     */
+    void run();
+
+    /**
+     * @brief Applies a command and records its latency
+     */
+    void execute(const EngineCommand& command, bool fromBot);
+
+    /**
+     * @brief Starts bot searches for every bot that has to decide now
+     */
+    void scheduleBots();
+
+    /**
+     * @brief Hands the current position to the pool for the bot at seat
+     * @details Skipped for humans, for seats already asked in this epoch and
+     * while the seat's previous search is still running.
+     */
+    void requestBot(std::uint8_t seat);
+
+    /**
+     * @brief Applies the answers returned by bot jobs
+     * @return true if any answer was taken
+     */
+    bool collectBotAnswers();
+
+    /**
+     * @brief Passes the pending action once no bot blocks and no human must still decide
+     */
+    void resolveBlockPhase();
+
+    /**
+     * @brief Checks whether a block decision of a bot is still outstanding
+     */
+    bool botBlockersPending() const;
+
+    /**
+     * @brief Checks whether any blocker of the pending action is a human
+     */
+    bool hasHumanBlockers() const;
+
+    /**
+     * @brief Applies a single command to the controller
+     * @param command Command to apply
+     * @param fromBot Whether a bot sent it; frontend commands for bot seats are refused
+     */
+    void process(const EngineCommand& command, bool fromBot);
+
+    /**
+     * @brief Copies the controller state into the triple buffer and publishes it
+     */
+    void publishSnapshot();
+
+    /**
+     * @brief Writes the recording to recordPath, reporting failures as a message
+     */
+    void saveRecording();
+};
+
+} // namespace coup
@@ -0,0 +1,121 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Network.hpp"
+
+namespace coup {
+
+/**
+ * @brief Collects leaf evaluations from search threads and runs them in batches
+ * @details Searches submit feature vectors and carry on; one evaluator
+ * thread takes everything queued and evaluates it with a single batched
+ * PolicyValueNet::evaluate() call of up to maxBatch rows. The evaluator waits
+ * at most maxDelay after the first request for a batch to fill, and not at
+ * all once a search is blocked in wait(), so a lone search never stalls on
+ * requests that will not come.
+ *
+ * Results land in a Slot owned by the submitter, published with a release
+ * store on Slot::ready: ready() is a lock-free check. A slot must stay alive
+ * and untouched until it is ready.
+ */
+class EvalQueue {
+public:
+    /**
+     * @brief Where one evaluation's result is delivered
+     */
+    struct Slot {
+        float value = 0.0f; ///< Value head output, valid once ready
+        std::atomic<bool> ready{false}; ///< Set by the evaluator
+
+        /**
+         * @brief Checks whether the value has arrived
+         */
+        bool isReady() const { return ready.load(std::memory_order_acquire); }
+    };
+
+    static constexpr std::size_t DEFAULT_MAX_BATCH = 256; ///< Rows per evaluate() call at most
+
+    /**
+     * @param net Network to evaluate with
+     * @param maxBatch Rows per batch at most
+     * @param maxDelay Longest wait for a batch to fill
+     */
+    explicit EvalQueue(std::shared_ptr<const PolicyValueNet> net, std::size_t maxBatch = DEFAULT_MAX_BATCH,
+                       std::chrono::microseconds maxDelay = std::chrono::microseconds(200));
+
+    /**
+     * @brief Stops the evaluator after the queued requests are done
+     */
+    ~EvalQueue();
+
+    EvalQueue(const EvalQueue&) = delete;
+    EvalQueue& operator=(const EvalQueue&) = delete;
+
+    /**
+     * @brief Gets the queue of a network, shared by every search that uses it
+     * @details One queue per network means bots deciding in parallel (blockers,
+     * tournament and league games) fill each other's batches.
+     */
+    static std::shared_ptr<EvalQueue> shared(const std::shared_ptr<const PolicyValueNet>& net);
+
+    /**
+     * @brief Queues an evaluation
+     * @param features net.inputs() values, copied before returning
+     * @param slot Receives the value; its ready flag is cleared here
+     */
+    void submit(const float* features, Slot& slot);
+
+    /**
+     * @brief Blocks until a slot is ready, asking for the queued batch to run now
+     */
+    void wait(Slot& slot);
+
+    /**
+     * @brief Gets the network evaluated with
+     */
+    const PolicyValueNet& network() const { return *net; }
+
+    /**
+     * @brief Gets the number of rows evaluated so far
+     */
+    std::uint64_t evaluations() const { return evaluated.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Gets the number of evaluate() calls so far
+     */
+    std::uint64_t batches() const { return batchCount.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Evaluator thread: takes queued requests and evaluates them in batches
+     */
+    void run();
+
+    std::shared_ptr<const PolicyValueNet> net; ///< Network evaluated with
+    std::size_t maxBatch; ///< Batch size cap
+    std::chrono::microseconds maxDelay; ///< Longest wait for a batch to fill
+
+    std::mutex mutex; ///< Guards the fields below
+    std::condition_variable work; ///< Wakes the evaluator
+    std::condition_variable done; ///< Wakes searches blocked in wait()
+    std::vector<float> inputs; ///< Queued feature rows
+    std::vector<Slot*> slots; ///< Slot of each queued row
+    bool flushRequested = false; ///< A search is waiting: do not wait for more
+    bool stopping = false; ///< Destructor called
+
+    std::atomic<std::uint64_t> evaluated{0}; ///< Rows evaluated
+    std::atomic<std::uint64_t> batchCount{0}; ///< evaluate() calls
+    std::thread evaluator; ///< Runs run(); started last
+};
+
+} // namespace coup
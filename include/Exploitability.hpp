@@ -0,0 +1,94 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "SmallGame.hpp"
+
+namespace coup {
+
+/**
+ * @brief The best reply of one seat to fixed policies of the others
+ * @details Plays the best action at every information set of its seat
+ * (SmallGame::infoKey(), so it remembers the whole public history) and
+ * uniformly anywhere else, e.g. as another seat or off the solved tree.
+ */
+class BestResponsePolicy : public SmallPolicy {
+public:
+    /**
+     * @param seat Seat the reply was computed for
+     * @param actions Best action per information set of the seat
+     */
+    BestResponsePolicy(std::uint8_t seat, std::unordered_map<SmallKey, SmallAction, SmallKeyHash> actions);
+
+    void probabilities(const SmallGame& game, const SmallState& state, SmallActionMask legal,
+                       std::array<float, SMALL_ACTIONS>& out) const override;
+
+    /**
+     * @brief Gets the seat the reply was computed for
+     */
+    std::uint8_t seat() const { return replySeat; }
+
+    /**
+     * @brief Gets the number of information sets with a chosen action
+     */
+    std::size_t size() const { return actions.size(); }
+
+private:
+    std::uint8_t replySeat; ///< Seat replying
+    std::unordered_map<SmallKey, SmallAction, SmallKeyHash> actions; ///< Best action per information set
+};
+
+/**
+ * @brief A best response and its expected score
+ */
+struct BestResponse {
+    BestResponsePolicy policy; ///< The reply
+    double value = 0.0; ///< Its expected score against the fixed policies
+};
+
+/**
+ * @brief Computes a seat's best response to fixed policies of the others
+ * @param game The game
+ * @param seats Policy of every seat; the replying seat's own entry is ignored
+ * @param seat Seat replying
+ * @param threads Worker threads, 0 for one per hardware thread
+ * @details Everything but the roles is public, so the tree is walked once per
+ * role of the replying seat with the set of states it cannot tell apart
+ * (each with its chance and opponent reach), split whenever the public
+ * history diverges. Values are backed up from the leaves, taking the best
+ * action at the replying seat's information sets. The six roles are
+ * independent subtrees and are solved on separate threads. The policies
+ * must be safe to call from several threads at once.
+ * @throws GameException if there is not one policy per seat or seat is out of range
+ */
+BestResponse bestResponse(const SmallGame& game, const std::vector<const SmallPolicy*>& seats, std::uint8_t seat,
+                          unsigned threads = 0);
+
+/**
+ * @brief How much a profile of fixed policies can be exploited
+ */
+struct ExploitabilityReport {
+    std::vector<double> policyValues; ///< Expected score of each seat playing its policy
+    std::vector<double> bestResponseValues; ///< Expected score of each seat's best response
+    std::size_t infoSets = 0; ///< Information sets solved over all seats
+    double nashConv = 0.0; ///< Sum over seats of what a best response gains
+    double exploitability = 0.0; ///< nashConv per seat; 0 at a Nash equilibrium
+    double seconds = 0.0; ///< Wall time
+};
+
+/**
+ * @brief Computes every seat's best response and the exploitability of a profile
+ * @param game The game
+ * @param seats Policy of every seat, e.g. the same strategy everywhere
+ * @param threads Worker threads, 0 for one per hardware thread
+ * @throws GameException if there is not one policy per seat
+ */
+ExploitabilityReport exploitability(const SmallGame& game, const std::vector<const SmallPolicy*>& seats,
+                                    unsigned threads = 0);
+
+} // namespace coup
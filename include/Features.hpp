@@ -0,0 +1,95 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "GameController.hpp"
+#include "GameRecord.hpp"
+#include "SimStats.hpp"
+
+namespace coup {
+
+/**
+ * @brief Per-seat features: present, active, coins/10, must coup, sanctioned,
+ * arrest blocked, to move, last arrested, then the role: a one-hot for the
+ * decider's own seat, the BeliefTracker probabilities for the others
+ */
+constexpr std::size_t SEAT_FEATURES = 8 + ROLE_COUNT;
+
+/**
+ * @brief Features that do not belong to a seat: playing, block pending,
+ * treasury/50, actions left, players/6, pending action one-hot, pending actor
+ * one-hot (relative), pending target is self
+ */
+constexpr std::size_t GLOBAL_FEATURES = 5 + MOVE_TYPES + MAX_SEATS + 1;
+
+/**
+ * @brief Width of a feature vector
+ */
+constexpr std::size_t FEATURE_COUNT = GLOBAL_FEATURES + MAX_SEATS * SEAT_FEATURES;
+
+/**
+ * @brief Number of move slots: every action with no target or a relative
+ * target seat, then block and pass
+ * @details Slot action * (MAX_SEATS + 1) is the untargeted action; slot
+ * action * (MAX_SEATS + 1) + r targets the seat r places after the decider.
+ */
+constexpr std::size_t MOVE_SLOTS = MOVE_TYPES * (MAX_SEATS + 1) + 2;
+
+/**
+ * @brief Slot of a block decision
+ */
+constexpr std::size_t BLOCK_SLOT = MOVE_SLOTS - 2;
+
+/**
+ * @brief Slot of a pass decision
+ */
+constexpr std::size_t PASS_SLOT = MOVE_SLOTS - 1;
+
+/**
+ * @brief Maps a move to its slot, seen from the deciding seat
+ * @param move Move to map
+ * @param seat Deciding seat
+ * @param players Seats at the table
+ * @return Slot index below MOVE_SLOTS
+ */
+std::size_t moveSlot(const RecordedMove& move, std::uint8_t seat, std::size_t players);
+
+/**
+ * @brief Maps a slot back to a move
+ * @param slot Slot index below MOVE_SLOTS
+ * @param seat Deciding seat
+ * @param players Seats at the table
+ * @return The move; targets beyond the table give NO_SEAT
+ */
+RecordedMove slotMove(std::size_t slot, std::uint8_t seat, std::size_t players);
+
+/**
+ * @brief Encodes a decision point as a fixed-width vector
+ * @param controller Game in the Playing or BlockPending phase
+ * @param seat Seat that has to decide
+ * @param out Receives FEATURE_COUNT values
+ * @details Seats are listed relative to the decider (its own seat first), so
+ * the same situation encodes the same way wherever the decider sits. Only
+ * information the decider has is used: its own role, and for the other
+ * seats controller.beliefs() rather than their hidden roles.
+ */
+void encodeFeatures(const GameController& controller, std::uint8_t seat, float* out);
+
+/**
+ * @brief Marks the legal move slots of a decision point
+ * @param controller Game in the Playing or BlockPending phase
+ * @param seat Seat that has to decide
+ * @param out Receives MOVE_SLOTS values, 1 for legal slots and 0 otherwise
+ * @return Number of legal slots
+ */
+std::size_t legalMask(const GameController& controller, std::uint8_t seat, std::uint8_t* out);
+
+/**
+ * @brief Gets the name of a feature column, such as "seat2.coins"
+ */
+std::string featureName(std::size_t index);
+
+} // namespace coup
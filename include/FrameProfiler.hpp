@@ -0,0 +1,161 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace coup {
+
+/**
+ * @brief What a profiler sample measures
+ */
+enum class ProfileChannel : std::uint8_t {
+    Frame,   ///< Whole frame, from one frame start to the next
+    Events,  ///< handleEvents()
+    Update,  ///< update()
+    Render,  ///< render(), including display()
+    Engine,  ///< Engine time for one command (measured on the engine thread)
+    Bot,     ///< Search time of one bot decision (measured on a pool thread)
+    Count    ///< Number of channels, not a channel
+};
+
+/**
+ * @brief Number of profiler channels
+ */
+constexpr std::size_t PROFILE_CHANNELS = static_cast<std::size_t>(ProfileChannel::Count);
+
+/**
+ * @brief Gets the display name of a profiler channel
+ * @param channel The channel
+ * @return Static string such as "frame" or "engine"
+ */
+const char* profileChannelName(ProfileChannel channel);
+
+/**
+ * @brief Fixed-size rolling window of timing samples in milliseconds
+ * @details Storage is preallocated, so adding a sample is a store and two
+ * index updates. Percentiles are computed on demand with nth_element over a
+ * preallocated scratch copy; nothing allocates after construction.
+ */
+class SampleWindow {
+public:
+    static constexpr std::size_t CAPACITY = 240; ///< Samples kept (4 seconds at 60 FPS)
+
+    SampleWindow();
+
+    /**
+     * @brief Adds a sample, dropping the oldest one when full
+     * @param millis Sample value in milliseconds
+     */
+    void add(float millis);
+
+    /**
+     * @brief Drops all samples
+     */
+    void clear();
+
+    /**
+     * @brief Gets the number of samples held
+     */
+    std::size_t size() const { return count; }
+
+    /**
+     * @brief Gets a sample counting from the oldest one
+     * @param index 0 for the oldest sample, size()-1 for the newest
+     */
+    float at(std::size_t index) const;
+
+    /**
+     * @brief Gets the newest sample (0 if empty)
+     */
+    float latest() const { return count ? at(count - 1) : 0.0f; }
+
+    /**
+     * @brief Gets the largest sample in the window (0 if empty)
+     */
+    float max() const;
+
+    /**
+     * @brief Gets a percentile of the samples in the window
+     * @param p Percentile between 0 and 100 (nearest-rank)
+     * @return The sample at that rank, or 0 if the window is empty
+     */
+    float percentile(double p) const;
+
+private:
+    std::array<float, CAPACITY> samples; ///< Ring storage
+    mutable std::array<float, CAPACITY> scratch; ///< Reordered by percentile()
+    std::size_t head; ///< Index where the next sample is written
+    std::size_t count; ///< Number of valid samples
+};
+
+/**
+ * @brief In-process sampler for frame phases and engine latency
+ * @details Meant to stay on in release builds: a sample costs two
+ * steady_clock reads and a ring buffer store. Frontends wrap each phase of
+ * their loop in a Scope and draw the windows when the overlay is visible.
+ * Not thread-safe; samples from other threads (such as engine latency) are
+ * handed over through the snapshot and recorded by the frontend.
+ */
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock; ///< Clock used for all samples
+
+    /**
+     * @brief Records the duration of a scope on destruction
+     */
+    class Scope {
+    public:
+        Scope(FrameProfiler& profiler, ProfileChannel channel)
+            : profiler(profiler), channel(channel), start(Clock::now()) {}
+        ~Scope() { profiler.record(channel, start, Clock::now()); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameProfiler& profiler; ///< Receives the sample
+        ProfileChannel channel; ///< Channel the sample belongs to
+        Clock::time_point start; ///< When the scope began
+    };
+
+    FrameProfiler();
+
+    /**
+     * @brief Records a sample in milliseconds
+     */
+    void record(ProfileChannel channel, float millis);
+
+    /**
+     * @brief Records the time between two clock readings
+     */
+    void record(ProfileChannel channel, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * @brief Marks the start of a frame and records the previous frame's length
+     * @details Call once per loop iteration; the first call records nothing.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Gets the samples of a channel
+     */
+    const SampleWindow& samples(ProfileChannel channel) const {
+        return windows[static_cast<std::size_t>(channel)];
+    }
+
+    /**
+     * @brief Drops the samples of every channel
+     */
+    void reset();
+
+private:
+    std::array<SampleWindow, PROFILE_CHANNELS> windows; ///< One window per channel
+    Clock::time_point frameStart; ///< Start of the current frame
+    bool frameStarted; ///< Whether beginFrame() has been called before
+};
+
+} // namespace coup
@@ -7,8 +7,12 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "ActionHistory.hpp"
+#include "EngineThread.hpp"
 #include "Exceptions.hpp"
+#include "FrameProfiler.hpp"
 #include "Game.hpp"
+#include "GameSnapshot.hpp"
 #include "Player.hpp"
 
 namespace coup {
@@ -25,15 +29,31 @@ namespace coup {
      * - Winner/elimination popups
      * - Action history logging
      * - Treasury and game state tracking
+     *
+     * The game itself runs on an EngineThread. The GUI only turns input into
+     * engine commands and draws the latest GameSnapshot, so engine work never
+     * stalls the render loop.
+     *
+     * F3 toggles a profiler overlay with rolling graphs of frame time, the
+     * handleEvents/update/render phases and engine command latency.
+     * F4 starts a trace; pressing it again writes the spans of every thread
+     * to TRACE_PATH as Chrome trace JSON.
      */
     class GUI {
     private:
         static const int WINDOW_WIDTH = 1200; ///< Main window width in pixels
         static const int WINDOW_HEIGHT = 800; ///< Main window height in pixels
-        
+        static const int HISTORY_X = 850; ///< Left edge of the history panel
+        static const int HISTORY_Y = 60; ///< Top edge of the history panel
+        static constexpr const char* TRACE_PATH = "coup_trace.json"; ///< Where F4 writes the trace
+        static const int HISTORY_WIDTH = 340; ///< History panel width in pixels
+        static const int HISTORY_LINE_HEIGHT = 20; ///< Height of one history line
+        static const int HISTORY_VISIBLE_LINES = 24; ///< Lines drawn by the history panel
+
         sf::RenderWindow window; ///< SFML window for rendering
-        std::shared_ptr<Game> game; ///< Reference to the game instance
-        
+        EngineThread engine; ///< Game engine running on its own thread
+        const GameSnapshot* view; ///< Snapshot drawn this frame (owned by engine)
+
         // GUI elements
         sf::Font font; ///< Font for text rendering
         std::vector<sf::Text> playerTexts; ///< Text objects for player information
@@ -43,31 +63,27 @@ namespace coup {
         sf::Text inputText; ///< Text for user input display
         sf::Text promptText; ///< Text for prompts and instructions
         sf::Text historyTitle; ///< Title for action history section
-        std::vector<sf::Text> historyTexts; ///< Text objects for action history
+        std::vector<sf::Text> historyTexts; ///< Fixed pool of HISTORY_VISIBLE_LINES text lines
         std::vector<sf::RectangleShape> actionButtons; ///< Button shapes for actions
         std::vector<std::string> actionNames; ///< Names of available actions
 
-        // Game state
-        bool isSetupPhase; ///< Whether in initial setup phase
+        // Local UI state
         bool isSelectingTarget; ///< Whether waiting for target selection
         std::string currentInput; ///< Current user input string
-        std::string pendingAction; ///< Action waiting for target selection
+        ActionType pendingAction; ///< Action waiting for target selection
         std::string errorMessage; ///< Current error message to display
         sf::Clock errorMessageTimer; ///< Timer for error message display
-        
-        // Action history for CLI logging
-        std::vector<std::string> actionHistory; ///< Log of all game actions
-        
-        // Bribe state - tracks remaining actions after bribe
-        int remainingBribeActions; ///< Extra actions remaining from bribe
-        std::string bribePlayerName; ///< Player currently in bribe mode
-        
-        // Block phase state
-        std::vector<std::shared_ptr<Player>> blockers; ///< Players who can block current action
-        std::shared_ptr<Player> blockingActor; ///< Player performing blockable action
-        std::shared_ptr<Player> blockingTarget; ///< Target of blockable action
-        bool isBlockPhase; ///< Whether in blocking phase
-        std::string blockingAction; ///< Action that can be blocked
+
+        // Action history (bounded in memory, full log spilled to disk)
+        ActionHistory actionHistory; ///< Recent game events as compact records
+        std::size_t historyScroll; ///< Lines scrolled back from the newest record
+        bool historyDirty; ///< Whether the visible history lines must be reformatted
+        std::uint8_t namedSeats; ///< Seats whose names were given to actionHistory
+
+        // Change tracking against the engine snapshot
+        std::uint64_t lastVersion; ///< Snapshot version the widgets were built from
+        std::uint32_t lastMessageCount; ///< Last engine message shown
+        std::uint32_t lastEliminationCount; ///< Last elimination shown
 
         // Winner and elimination popups
         bool showWinnerPopup; ///< Whether to show winner popup
@@ -76,181 +92,118 @@ namespace coup {
         std::string eliminatedPlayerName; ///< Name of eliminated player
         sf::Clock popupTimer; ///< Timer for popup display duration
 
+        // Profiler overlay
+        static const int PROFILER_X = 10; ///< Left edge of the profiler overlay
+        static const int PROFILER_Y = 300; ///< Top edge of the profiler overlay
+        static const int PROFILER_WIDTH = 480; ///< Profiler overlay width in pixels
+        static const int PROFILER_ROW_HEIGHT = 64; ///< Height of one channel row
+        FrameProfiler profiler; ///< Always-on sampler for the loop phases
+        bool showProfiler; ///< Whether the overlay is drawn (F3)
+        std::uint32_t lastEngineCommandCount; ///< Engine commands already sampled
+        std::uint32_t lastBotDecisionCount; ///< Bot decisions already sampled
+        sf::VertexArray profilerGraph; ///< Line segments of all channel graphs
+        std::vector<sf::Text> profilerTexts; ///< One label per channel
+        sf::Clock profilerTextTimer; ///< Limits how often the labels are reformatted
+
         /**
          * @brief Initializes the SFML window with proper settings
          */
         void initializeWindow();
-        
+
         /**
          * @brief Loads fonts and other assets required for GUI
          * @return true if all assets loaded successfully
          */
         bool loadAssets();
-        
+
         /**
          * @brief Creates action buttons with proper layout
          */
         void createButtons();
-        
+
         /**
          * @brief Updates player information display
          */
         void updatePlayerInfo();
-        
+
         /**
          * @brief Handles mouse clicks on buttons and UI elements
          * @param mousePos Mouse position when clicked
          */
         void handleClick(const sf::Vector2i& mousePos);
-        
+
         /**
          * @brief Processes SFML events (input, window events)
          */
         void handleEvents();
-        
-        /**
-         * @brief Logs an action to the history display
-         * @param action Description of the action to log
-         */
-        void logAction(const std::string& action);
 
-        // Action handling
-        
         /**
-         * @brief Initiates blocking phase for blockable actions
-         * @param action Name of the action that can be blocked
-         * @param actor Player performing the action
-         * @param target Target of the action (if applicable)
+         * @brief Moves events published by the engine into the action history
          */
-        void startBlockPhase(const std::string& action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target);
-        
-        /**
-         * @brief Handles when a player chooses to block an action
-         * @param blocker Player who is blocking
-         */
-        void onBlockClicked(std::shared_ptr<Player> blocker);
-        
-        /**
-         * @brief Handles when players choose not to block
-         */
-        void onNoBlockClicked();
-        
-        /**
-         * @brief Executes a game action with proper validation
-         * @param action Name of the action to perform
-         * @param actor Player performing the action
-         * @param target Target player (if action requires one)
-         */
-        void performAction(const std::string& action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target);
-        
-        /**
-         * @brief Logs current coin counts for all players
-         */
-        void logAllPlayersCoins();
+        void drainEngineEvents();
 
         /**
-         * @brief Checks if game is over and shows winner popup
+         * @brief Scrolls the history panel
+         * @param lines Positive to scroll back in time, negative towards newest
          */
-        void checkForWinner();
+        void scrollHistory(int lines);
 
-        // Enhanced logging methods
-        
-        /**
-         * @brief Logs the start of a player's turn
-         * @param playerName Name of the player
-         * @param role Role of the player
-         * @param coins Current coin count
-         */
-        void logTurnStart(const std::string& playerName, const std::string& role, int coins);
-        
-        /**
-         * @brief Logs status effect changes (sanctions, blocks)
-         * @param playerName Name of affected player
-         * @param effect Type of status effect
-         * @param applied Whether effect was applied or removed
-         */
-        void logStatusEffect(const std::string& playerName, const std::string& effect, bool applied);
-        
-        /**
-         * @brief Logs changes to treasury amount
-         * @param oldAmount Previous treasury amount
-         * @param newAmount New treasury amount
-         * @param reason Reason for the change
-         */
-        void logTreasuryChange(int oldAmount, int newAmount, const std::string& reason);
-        
-        /**
-         * @brief Logs usage of role-specific abilities
-         * @param playerName Name of player using ability
-         * @param role Role of the player
-         * @param ability Name of the ability used
-         */
-        void logRoleAbility(const std::string& playerName, const std::string& role, const std::string& ability);
-        
-        /**
-         * @brief Logs spy investigation results
-         * @param spy Name of investigating spy
-         * @param target Name of investigated player
-         * @param targetCoins Target's coin count
-         */
-        void logInvestigation(const std::string& spy, const std::string& target, int targetCoins);
-        
-        /**
-         * @brief Logs mandatory coup warning
-         * @param playerName Name of player who must coup
-         */
-        void logMandatoryCoup(const std::string& playerName);
-        
         /**
-         * @brief Logs blocking attempts
-         * @param blocker Name of blocking player
-         * @param action Action being blocked
-         * @param actor Name of player whose action is blocked
+         * @brief Checks whether the current snapshot is in the setup phase
          */
-        void logBlockAttempt(const std::string& blocker, const std::string& action, const std::string& actor);
-        
-        /**
-         * @brief Logs automatic win conditions
-         * @param playerName Name of winning player
-         */
-        void logAutoWin(const std::string& playerName);
+        bool isSetupPhase() const { return view->phase == GamePhase::Setup; }
 
     public:
         /**
          * @brief Constructs GUI with game instance
-         * @param game Shared pointer to the game to display
+         * @param game Shared pointer to the game to display; handed over to
+         * the engine thread and must not be used by the caller afterwards
          */
         GUI(std::shared_ptr<Game> game);
-        
+
         /**
          * @brief Main GUI loop - runs until window closed
          * @details Handles events, updates game state, and renders display
          */
         void run();
-        
+
         /**
-         * @brief Updates GUI state and game logic
+         * @brief Pulls the latest engine snapshot and events into the GUI
          */
         void update();
-        
+
         /**
          * @brief Renders the main game interface
          */
         void render();
-        
+
         /**
          * @brief Renders the action history panel
+         * @details Virtualized: only the visible lines are formatted, and only
+         * when the history or scroll position changed since the last frame.
          */
         void renderHistory();
-        
+
         /**
          * @brief Renders treasury information
          */
         void renderTreasury();
-        
+
         /**
          * @brief Renders winner/elimination popups
          */
         void renderPopups();
+
+        /**
+         * @brief Renders the profiler overlay
+         * @details All graphs go out in one draw call; the p50/p99 labels are
+         * refreshed a few times per second rather than every frame.
+         */
+        void renderProfiler();
+
+        /**
+         * @brief Starts tracing, or stops it and writes the trace (F4)
+         */
+        void toggleTrace();
     };
 }
@@ -4,6 +4,7 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <random>
 #include <string>
 #include <unordered_set>
 #include "Player.hpp"
@@ -11,6 +12,39 @@
 
 namespace coup {
 
+/**
+ * @brief Tunable rule constants, so rule variants can be compared
+ * @details The defaults are the standard rules. A game's rules are fixed
+ * before it starts and never change during play.
+ */
+struct RuleSet {
+    int taxAmount = 2; ///< Coins a tax takes for every role but the Governor
+    int governorTax = 3; ///< Coins a Governor's tax takes
+    int merchantThreshold = 3; ///< Coins a Merchant needs at turn start for the bonus
+    int merchantBonus = 1; ///< Coins of the Merchant's turn start bonus
+
+    bool operator==(const RuleSet& other) const {
+        return taxAmount == other.taxAmount && governorTax == other.governorTax &&
+               merchantThreshold == other.merchantThreshold && merchantBonus == other.merchantBonus;
+    }
+    bool operator!=(const RuleSet& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Mutable state of a game, used for keyframes
+ * @details Holds everything that changes during play. The seated players
+ * (names and roles) are not part of it, so a state can only be restored
+ * into the game it was captured from or one seated identically.
+ */
+struct GameState {
+    std::vector<PlayerState> players; ///< Per-seat player state
+    size_t current_turn = 0; ///< Index of current player's turn
+    bool game_started = false; ///< Whether the game has been started
+    int treasury = 50; ///< Coins in the treasury
+    std::string last_arrested_player; ///< Global arrest restriction tracking
+    int actions_remaining = 1; ///< Actions left for the current player
+};
+
 /**
  * @brief Main game controller class for the Coup card game
  * @details Manages players, turns, treasury, and game state. Supports 2-6 players
@@ -26,6 +60,8 @@ private:
     
     // Simple action counter for bribe system
     int actions_remaining; ///< Number of actions remaining for current player
+    bool verbose; ///< Whether actions are logged to the console
+    RuleSet rules; ///< Rule constants of this game
 
 public:
     /**
@@ -85,9 +121,9 @@ public:
     
     /**
      * @brief Gets all players including inactive ones for GUI display
-     * @return Vector of shared pointers to all players
+     * @return The seated players, without a copy; valid until players are added or removed
      */
-    std::vector<std::shared_ptr<Player>> all_players() const;
+    const std::vector<std::shared_ptr<Player>>& all_players() const;
     
     /**
      * @brief Gets the winner of the game
@@ -104,6 +140,33 @@ public:
      */
     bool is_active() const { return game_started; }
     
+    /**
+     * @brief Enables or disables console logging of actions
+     * @param enabled false silences all [ACTION]/[TURN]/[GAME] output
+     * @details Headless games (spectator tables, simulations) run many games
+     * at once and turn logging off; it is on by default.
+     */
+    void set_verbose(bool enabled) { verbose = enabled; }
+    
+    /**
+     * @brief Checks whether actions are logged to the console
+     * @return true if logging is enabled
+     */
+    bool is_verbose() const { return verbose; }
+    
+    /**
+     * @brief Replaces the rule constants
+     * @param newRules Rules to play by
+     * @throws GameException if the game has started or a constant is negative
+     */
+    void set_rules(const RuleSet& newRules);
+    
+    /**
+     * @brief Gets the rule constants
+     * @return Rules this game is played by
+     */
+    const RuleSet& get_rules() const { return rules; }
+    
     /**
      * @brief Gets the total number of players (active and inactive)
      * @return Number of players in the game
@@ -159,7 +222,7 @@ public:
      * @brief Gets the name of the last arrested player
      * @return Name of last arrested player (for preventing consecutive arrests)
      */
-    std::string get_last_arrested_player() const { return last_arrested_player; }
+    const std::string& get_last_arrested_player() const { return last_arrested_player; }
     
     /**
      * @brief Sets the name of the last arrested player
@@ -212,6 +275,39 @@ public:
      */
     std::shared_ptr<Player> create_random_player(const std::string& name);
     
+    /**
+     * @brief Creates a random player from a caller-owned generator
+     * @param name Name for the new player
+     * @param rng Generator to draw the role from
+     * @return Shared pointer to newly created random player
+     * @details With the same seed the same roles are dealt, so paired
+     * simulations of two rule variants seat identical tables. Unlike the
+     * overload above it shares no state between games or threads.
+     */
+    std::shared_ptr<Player> create_random_player(const std::string& name, std::mt19937& rng);
+    
+    /**
+     * @brief Creates a player with a specific role
+     * @param name Name for the new player
+     * @param role Role name as returned by Player::role()
+     * @return Shared pointer to the new player (not yet added to the game)
+     * @throws GameException if the role is unknown
+     */
+    std::shared_ptr<Player> create_player(const std::string& name, const std::string& role);
+    
+    /**
+     * @brief Copies all mutable game and player state
+     * @return State that restore_state() can bring back later
+     */
+    GameState capture_state() const;
+    
+    /**
+     * @brief Restores state captured from this game (or an identically seated one)
+     * @param state Previously captured state
+     * @throws GameException if the number of seats differs
+     */
+    void restore_state(const GameState& state);
+    
     /**
      * @brief Forces cleanup of inactive players (for GUI after elimination display)
      * @details Public method to remove eliminated players from the list
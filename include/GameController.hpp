@@ -0,0 +1,315 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "ActionHistory.hpp"
+#include "BeliefTracker.hpp"
+#include "Game.hpp"
+#include "GameSnapshot.hpp"
+
+namespace coup {
+
+/**
+ * @brief One legal action for the current player
+ */
+struct Move {
+    ActionType action = ActionType::Gather; ///< Action to request
+    std::uint8_t target = NO_SEAT; ///< Target seat, NO_SEAT for untargeted actions
+};
+
+/**
+ * @brief Upper bound on legal moves: 5 untargeted actions plus 5 targeted
+ * actions against each of the other 5 seats
+ */
+constexpr std::size_t MAX_MOVES = 30;
+
+/**
+ * @brief Complete state of a GameController and its game, used for keyframes
+ */
+struct ControllerState {
+    GameState game; ///< Game and player state
+    GamePhase phase = GamePhase::Setup; ///< Controller phase
+    ActionType pendingAction = ActionType::Gather; ///< Action waiting for block decisions
+    std::uint8_t pendingActor = NO_SEAT; ///< Seat performing it
+    std::uint8_t pendingTarget = NO_SEAT; ///< Its target seat
+    std::array<std::uint8_t, MAX_SEATS> blockerSeats{}; ///< Seats able to block it
+    std::uint8_t blockerCount = 0; ///< Valid entries in blockerSeats
+    std::uint8_t lastTurnSeat = NO_SEAT; ///< Seat that last got a TurnStart record
+    std::uint8_t winnerSeat = NO_SEAT; ///< Winner once the game is over
+    std::uint8_t eliminatedSeat = NO_SEAT; ///< Most recently eliminated seat
+    std::uint32_t eliminationCount = 0; ///< Eliminations so far
+    std::string message; ///< Latest user message
+    std::uint32_t messageCount = 0; ///< Message counter
+    BeliefTracker beliefs; ///< Role evidence every seat has seen so far
+};
+
+/**
+ * @brief Drives a Game through setup, turns and blocking decisions
+ * @details Holds the game flow that sits on top of the Player actions:
+ * adding players, validating requested actions, the block/pass phase for
+ * blockable actions and their penalties, and winner detection. Every state
+ * change is reported as an ActionRecord through the event sink, and the
+ * current state can be copied into a GameSnapshot for display.
+ *
+ * Not thread-safe: all calls must come from the thread that owns the game
+ * (see EngineThread).
+ */
+class GameController {
+public:
+    using EventSink = std::function<void(const ActionRecord&)>; ///< Receives every emitted record
+
+    /**
+     * @brief Constructs a controller for a game
+     * @param game Game to drive (may already contain players)
+     */
+    explicit GameController(std::shared_ptr<Game> game);
+
+    /**
+     * @brief Sets the callback that receives emitted records
+     * @param sink Callback invoked on the controller's thread
+     */
+    void setEventSink(EventSink sink) { this->sink = std::move(sink); }
+
+    /**
+     * @brief Turns recording into the engine metrics on or off (on by default)
+     * @details Positions that only exist inside a bot's search are played far
+     * more often than real games; they are kept out of the metrics so the
+     * counts and turn times describe the games actually played.
+     */
+    void setMetered(bool enabled) { metered = enabled; }
+
+    /**
+     * @brief Turns updating beliefs() from the emitted records on or off (on by default)
+     * @details Bot searches turn it off: their positions are guesses, and
+     * the beliefs they start from were copied from the real game.
+     */
+    void setTracksBeliefs(bool enabled) { tracksBeliefs = enabled; }
+
+    // Setup
+
+    /**
+     * @brief Adds a player with a random role
+     * @param name Player name (must be unique and non-empty)
+     * @throws GameException if the name is invalid or the game already started
+     * @details Starts the game automatically when the sixth player joins
+     */
+    void addPlayer(const std::string& name);
+
+    /**
+     * @brief Starts the game
+     * @throws GameException if fewer than 2 players joined
+     */
+    void startGame();
+
+    // Turn flow
+
+    /**
+     * @brief Requests an action for the current player
+     * @param action Action to perform
+     * @param targetSeat Seat of the target for targeted actions
+     * @throws GameException (or a subclass) if the action is not allowed
+     * @details Blockable actions (Tax, Bribe, Arrest, Sanction, Coup) enter the
+     * BlockPending phase if any other player can block them; everything else
+     * is executed immediately.
+     */
+    void requestAction(ActionType action, std::uint8_t targetSeat = NO_SEAT);
+
+    /**
+     * @brief Blocks the pending action
+     * @param blockerSeat Seat of a player listed as a blocker
+     * @throws GameException if no action is pending or the seat cannot block
+     * @details Applies the block penalties and ends the actor's turn
+     */
+    void block(std::uint8_t blockerSeat);
+
+    /**
+     * @brief Lets the pending action go through unblocked
+     * @throws GameException if no action is pending
+     */
+    void pass();
+
+    /**
+     * @brief Shows an error to the user through the snapshot message
+     * @param message Error text
+     */
+    void reportError(const std::string& message);
+
+    /**
+     * @brief Lists every action the current player may request right now
+     * @param moves Receives the moves; no allocation is made
+     * @return Number of valid entries, 0 outside the Playing phase
+     * @details Uses the same ActionValidator checks as requestAction(), so
+     * every listed move passes validation.
+     */
+    std::size_t legalMoves(std::array<Move, MAX_MOVES>& moves) const;
+
+    // State access
+
+    /**
+     * @brief Gets the current phase
+     */
+    GamePhase phase() const { return currentPhase; }
+
+    /**
+     * @brief Gets the winner's seat
+     * @return Seat index once the game is over, NO_SEAT before
+     */
+    std::uint8_t winner() const { return winnerSeat; }
+
+    /**
+     * @brief Gets the state version (changes on every state change)
+     * @details Lets asynchronous work detect that the position it was given
+     * is no longer current.
+     */
+    std::uint64_t stateVersion() const { return version; }
+
+    /**
+     * @brief Gets the controlled game
+     */
+    std::shared_ptr<Game> get_game() const { return game; }
+
+    /**
+     * @brief Gets the player sitting at a seat
+     * @param seat Seat index
+     * @return Player, or nullptr if the seat is empty
+     */
+    std::shared_ptr<Player> playerAt(std::uint8_t seat) const;
+
+    /**
+     * @brief Gets the seat of a player
+     * @param player Player to look up
+     * @return Seat index, or NO_SEAT if the player is not in this game
+     */
+    std::uint8_t seatOf(const Player* player) const;
+
+    /**
+     * @brief Gets how many players may block the pending action
+     * @return Blocker count, 0 outside the BlockPending phase
+     */
+    std::uint8_t pendingBlockerCount() const {
+        return currentPhase == GamePhase::BlockPending ? blockerCount : 0;
+    }
+
+    /**
+     * @brief Gets the seat of a player who may block the pending action
+     * @param index Index below pendingBlockerCount()
+     */
+    std::uint8_t pendingBlocker(std::size_t index) const { return blockerSeats[index]; }
+
+    /**
+     * @brief Gets the action waiting for block decisions
+     * @return Meaningful only in the BlockPending phase
+     */
+    ActionType pendingActionType() const { return pendingAction; }
+
+    /**
+     * @brief Gets the seats involved in the action waiting for block decisions
+     * @param actor Receives the acting seat, NO_SEAT outside the BlockPending phase
+     * @param target Receives the target seat, NO_SEAT if untargeted
+     */
+    void pendingSeats(std::uint8_t& actor, std::uint8_t& target) const;
+
+    /**
+     * @brief Gets what the game so far has shown about every seat's role
+     * @details Public evidence only: no seat's own role is revealed in it.
+     */
+    const BeliefTracker& beliefs() const { return tracker; }
+
+    /**
+     * @brief Copies the complete current state into a snapshot
+     * @param snapshot Destination, fully overwritten
+     */
+    void fillSnapshot(GameSnapshot& snapshot) const;
+
+    /**
+     * @brief Captures the complete controller and game state
+     */
+    ControllerState saveState() const;
+
+    /**
+     * @brief Restores a state captured from this controller
+     * @param state Previously saved state
+     * @throws GameException if the state belongs to a differently seated game
+     * @details No records are emitted; the snapshot version still changes.
+     */
+    void restoreState(const ControllerState& state);
+
+private:
+    std::shared_ptr<Game> game; ///< Game being driven
+    GamePhase currentPhase; ///< Current phase
+    EventSink sink; ///< Receiver of emitted records
+
+    // Pending blockable action
+    ActionType pendingAction; ///< Action waiting for block decisions
+    std::shared_ptr<Player> pendingActor; ///< Player performing it
+    std::shared_ptr<Player> pendingTarget; ///< Its target (nullptr if none)
+    std::array<std::uint8_t, MAX_SEATS> blockerSeats; ///< Seats able to block it
+    std::uint8_t blockerCount; ///< Valid entries in blockerSeats
+
+    // Turn and outcome tracking
+    std::uint8_t lastTurnSeat; ///< Seat that last got a TurnStart record
+    std::uint8_t winnerSeat; ///< Winner once the game is over
+    std::uint8_t eliminatedSeat; ///< Most recently eliminated seat
+    std::uint32_t eliminationCount; ///< Eliminations so far
+
+    // Feedback for the user
+    std::string message; ///< Latest message
+    std::uint32_t messageCount; ///< Changes whenever message is set
+    std::uint64_t version; ///< Changes on every state change
+
+    // Instrumentation (see Metrics.hpp)
+    bool metered; ///< Whether this controller records metrics
+    std::uint64_t turnStartedNanos; ///< Clock reading when the current turn started, 0 if not timed
+    bool treasuryEmpty; ///< Whether the treasury was empty after the last state change
+
+    // Role evidence
+    bool tracksBeliefs; ///< Whether emitted records update tracker
+    BeliefTracker tracker; ///< Role evidence from the emitted records
+
+    /**
+     * @brief Collects blockers and either enters BlockPending or performs the action
+     */
+    void startBlockPhase(ActionType action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target);
+
+    /**
+     * @brief Executes an action through the Player methods and records it
+     */
+    void perform(ActionType action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target);
+
+    /**
+     * @brief Emits an ActionRecord describing the current state to the sink
+     */
+    void emit(ActionType type, const Player* actor, const Player* target, std::uint8_t detail = 0);
+
+    /**
+     * @brief Emits TurnStart/GameOver records after the state changed
+     */
+    void afterStateChange();
+
+    /**
+     * @brief Records the duration of the turn that just ended, if metered
+     * @param nextTurnStarts Whether to start timing the next turn
+     */
+    void endTurnTiming(bool nextTurnStarts);
+
+    /**
+     * @brief Replaces the user message with the concatenated parts
+     * @details Appends into the message's reserved buffer, so messages that
+     * fit the snapshot cost no allocation.
+     */
+    void setMessage(std::initializer_list<std::string_view> parts);
+
+    /**
+     * @brief Logs everyone's coins to the console
+     */
+    void logAllPlayersCoins() const;
+};
+
+} // namespace coup
@@ -0,0 +1,99 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ActionHistory.hpp"
+#include "Game.hpp"
+
+namespace coup {
+
+class GameController;
+
+/**
+ * @brief One accepted player decision, enough to replay it through the engine
+ */
+struct RecordedMove {
+    /**
+     * @brief Which GameController call the move was
+     */
+    enum class Kind : std::uint8_t {
+        Action, ///< requestAction(action, seat)
+        Block,  ///< block(seat)
+        Pass    ///< pass()
+    };
+
+    Kind kind = Kind::Action; ///< Move type
+    ActionType action = ActionType::Gather; ///< Action for Kind::Action
+    std::uint8_t seat = NO_SEAT; ///< Target (Action) or blocker (Block) seat
+};
+
+/**
+ * @brief Name and role of a seated player
+ */
+struct SeatRecord {
+    std::string name; ///< Player name
+    std::string role; ///< Role name as returned by Player::role()
+};
+
+/**
+ * @brief A complete recorded game: who sat where, and every move made
+ * @details The engine is deterministic once roles are dealt, so the seats
+ * plus the move list reproduce the game exactly. Records are stored as a
+ * small line-based text file:
+ * @code
+ * COUP-RECORD 1
+ * seats 2
+ * Governor Alice
+ * Spy Bob
+ * rules 2 3 3 1
+ * moves 2
+ * A 0 255
+ * P
+ * @endcode
+ */
+struct GameRecord {
+    std::vector<SeatRecord> seats; ///< Seated players in seat order
+    RuleSet rules; ///< Rules the game was played by (the line is only written if not the defaults)
+    std::vector<RecordedMove> moves; ///< Accepted moves in order
+
+    /**
+     * @brief Stores the names and roles of a game's players and its rules
+     * @param game Game whose seating to record
+     */
+    void captureSeats(const Game& game);
+
+    /**
+     * @brief Creates a game seated exactly as recorded, with the recorded rules (not yet started)
+     * @throws GameException if a role is unknown
+     */
+    std::shared_ptr<Game> createGame() const;
+
+    /**
+     * @brief Replays one move through a controller
+     * @param controller Controller to apply the move to
+     * @param move Move to apply
+     * @throws GameException (or a subclass) if the move is not legal
+     */
+    static void play(GameController& controller, const RecordedMove& move);
+
+    /**
+     * @brief Writes the record to a file
+     * @param path Destination file
+     * @throws GameException if the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Reads a record from a file
+     * @param path Source file
+     * @return The loaded record
+     * @throws GameException if the file is missing or malformed
+     */
+    static GameRecord load(const std::string& path);
+};
+
+} // namespace coup
@@ -0,0 +1,102 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "ActionHistory.hpp"
+
+namespace coup {
+
+/**
+ * @brief High-level phase of a game driven by GameController
+ */
+enum class GamePhase : std::uint8_t {
+    Setup,        ///< Players are being added
+    Playing,      ///< Waiting for the current player's action
+    BlockPending, ///< A blockable action waits for a block/pass decision
+    GameOver      ///< One player left
+};
+
+/**
+ * @brief Copies a string into a fixed-size character array, truncating if needed
+ * @param dest Destination array (always null-terminated)
+ * @param src Source string
+ */
+template <std::size_t N>
+void copyFixedString(char (&dest)[N], const std::string& src) {
+    std::size_t len = src.size() < N - 1 ? src.size() : N - 1;
+    std::memcpy(dest, src.data(), len);
+    dest[len] = '\0';
+}
+
+/**
+ * @brief Read-only view of one seat in a GameSnapshot
+ */
+struct PlayerView {
+    char name[32] = {}; ///< Player name (truncated to 31 characters)
+    char role[16] = {}; ///< Role name
+    std::uint8_t coins = 0; ///< Current coins
+    bool active = false; ///< Not eliminated
+    bool sanctioned = false; ///< Under sanctions
+    bool arrestBlocked = false; ///< Arrest ability blocked this turn
+};
+
+/**
+ * @brief Immutable, self-contained copy of everything a frontend draws
+ * @details Fixed-size and trivially copyable so it can be published through a
+ * TripleBuffer without locks or allocations. Counters (version, messageCount,
+ * eliminationCount) let a reader detect changes without comparing contents.
+ */
+struct GameSnapshot {
+    std::uint64_t version = 0; ///< Increments on every state change
+    GamePhase phase = GamePhase::Setup; ///< Current phase
+    std::uint8_t playerCount = 0; ///< Number of valid entries in players
+    std::uint8_t currentSeat = NO_SEAT; ///< Seat whose turn it is
+    std::int16_t treasury = 0; ///< Coins in the treasury
+    std::int16_t actionsRemaining = 0; ///< Actions left this turn (bribe adds more)
+    std::uint16_t availableActions = 0; ///< Bit i set if ActionType(i) is available to the current player
+    std::array<PlayerView, MAX_SEATS> players = {}; ///< All seats, including eliminated players
+
+    ActionType pendingAction = ActionType::Gather; ///< Action waiting in BlockPending
+    std::uint8_t pendingActor = NO_SEAT; ///< Seat of the player whose action may be blocked
+    std::uint8_t blockerCount = 0; ///< Number of valid entries in blockers
+    std::array<std::uint8_t, MAX_SEATS> blockers = {}; ///< Seats that may block the pending action
+
+    std::uint8_t winnerSeat = NO_SEAT; ///< Winner once phase is GameOver
+    std::uint8_t eliminatedSeat = NO_SEAT; ///< Most recently eliminated seat
+    std::uint32_t eliminationCount = 0; ///< Number of eliminations so far
+    std::uint32_t messageCount = 0; ///< Increments whenever message changes
+    char message[128] = {}; ///< Latest feedback or error text for the user
+
+    std::uint32_t engineCommandCount = 0; ///< Commands processed by the engine thread so far
+    std::uint32_t engineCommandMicros = 0; ///< Engine time spent on the most recent command
+
+    std::uint8_t botSeats = 0; ///< Bit i set if seat i is played by a bot
+    bool botThinking = false; ///< A bot is still deciding in the position shown
+    std::uint32_t botDecisionCount = 0; ///< Bot decisions returned so far
+    std::uint32_t botDecisionMicros = 0; ///< Search time of the most recent bot decision
+    std::uint32_t botDecisionP50Micros = 0; ///< Median bot search time over the whole game
+    std::uint32_t botDecisionP99Micros = 0; ///< 99th percentile bot search time over the whole game
+
+    /**
+     * @brief Checks whether a seat is played by a bot
+     */
+    bool isBot(std::uint8_t seat) const {
+        return seat < MAX_SEATS && ((botSeats >> seat) & 1u);
+    }
+
+    /**
+     * @brief Checks whether an action button should be enabled
+     * @param action Action to check
+     * @return true if the current player may choose it (targets not checked)
+     */
+    bool isAvailable(ActionType action) const {
+        return (availableActions >> static_cast<unsigned>(action)) & 1u;
+    }
+};
+
+} // namespace coup
@@ -0,0 +1,66 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Game.hpp"
+#include "Rating.hpp"
+
+namespace coup {
+
+/**
+ * @brief How a league pairs its entrants
+ */
+enum class LeagueFormat : std::uint8_t {
+    RoundRobin, ///< Every group of tableSize entrants meets, once per round
+    Swiss       ///< Each round seats entrants of similar rating together
+};
+
+/**
+ * @brief Parameters of a rated bot league
+ */
+struct LeagueConfig {
+    std::vector<std::string> bots; ///< Entrants by createBot type (capped, see checkMatchBot)
+    LeagueFormat format = LeagueFormat::RoundRobin; ///< Pairing scheme
+    std::uint8_t tableSize = 4; ///< Players per game, 2 to MAX_SEATS
+    std::uint32_t rounds = 1; ///< Round robin: cycles over all groups; Swiss: rounds
+    std::uint32_t seed = 1; ///< Base seed; game i always plays the same way
+    std::size_t threads = 0; ///< Worker threads, 0 for the ThreadPool default
+    std::uint32_t stepLimit = 2000; ///< Moves after which a game is cut off
+    RuleSet rules; ///< Rules every game is played by
+};
+
+/**
+ * @brief Outcome of a league
+ */
+struct LeagueResult {
+    RatingTable ratings; ///< Final ratings, one entry per configured bot (repeats named type#2, ...)
+    std::uint64_t games = 0; ///< Games played and rated
+    std::uint64_t truncated = 0; ///< Games cut off at the step limit
+    std::size_t threads = 0; ///< Worker threads that played
+    double seconds = 0.0; ///< Wall time
+};
+
+/**
+ * @brief Plays a league and rates every game
+ * @param config Entrants, format and limits
+ * @return Ratings and counts
+ * @throws GameException if a bot type is invalid, there are fewer entrants
+ * than seats at a table, or a game fails
+ * @details Games run on a ThreadPool; each table is one job that plays the
+ * game and hands back the finishing order. The calling thread rates the
+ * results as they arrive while the workers go on playing, always in game
+ * order, so the ratings are the same however the games were spread over the
+ * threads. A round robin queues every table up front. A Swiss round needs
+ * the ratings of the round before, so rounds are queued one at a time, each
+ * with about bots / tableSize tables to keep the workers busy.
+ *
+ * A free-for-all game ranks the winner first and the others by when they
+ * were couped out; players still in when a game is cut off share a place.
+ */
+LeagueResult runLeague(const LeagueConfig& config);
+
+} // namespace coup
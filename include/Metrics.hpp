@@ -0,0 +1,239 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include "ActionHistory.hpp"
+#include "ActionValidator.hpp"
+
+namespace coup {
+
+/**
+ * @brief Whether the recording functions below were compiled in (-DCOUP_METRICS)
+ * @details Without it they are empty inline functions and every call site
+ * compiles to nothing; the export side still works and reports zeros.
+ */
+#ifdef COUP_METRICS
+constexpr bool METRICS_ENABLED = true;
+#else
+constexpr bool METRICS_ENABLED = false;
+#endif
+
+/**
+ * @brief Bucket layout of an HDR-style (log-linear) histogram of integers
+ * @details Values below SUB_BUCKETS get a bucket each; above that, every
+ * power of two is split into SUB_BUCKETS equal buckets, so a bucket is never
+ * wider than 1/16 of its smallest value (6%) at any magnitude. Values of
+ * 2^MAX_BITS and more share the last bucket; for nanoseconds that is about
+ * 18 minutes. Finding a bucket is a bit scan and a shift, with no search and
+ * no floating point.
+ */
+struct HdrBuckets {
+    static constexpr unsigned SUB_BITS = 4; ///< log2 of the buckets per power of two
+    static constexpr std::size_t SUB_BUCKETS = std::size_t{1} << SUB_BITS; ///< Buckets per power of two
+    static constexpr unsigned MAX_BITS = 40; ///< Values from 2^MAX_BITS on are clamped
+    static constexpr std::size_t COUNT = SUB_BUCKETS + (MAX_BITS - SUB_BITS) * SUB_BUCKETS; ///< Buckets
+
+    /**
+     * @brief Gets the bucket of a value
+     */
+    static std::size_t index(std::uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<std::size_t>(value);
+        }
+        unsigned top = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        if (top >= MAX_BITS) {
+            return COUNT - 1;
+        }
+        unsigned shift = top - SUB_BITS;
+        return SUB_BUCKETS + shift * SUB_BUCKETS + static_cast<std::size_t>((value >> shift) - SUB_BUCKETS);
+    }
+
+    /**
+     * @brief Gets the smallest value of a bucket
+     */
+    static std::uint64_t lowerBound(std::size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        std::size_t shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        std::size_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        return static_cast<std::uint64_t>(SUB_BUCKETS + sub) << shift;
+    }
+
+    /**
+     * @brief Gets the first value past a bucket
+     */
+    static std::uint64_t upperBound(std::size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index + 1;
+        }
+        return lowerBound(index) + (std::uint64_t{1} << ((index - SUB_BUCKETS) / SUB_BUCKETS));
+    }
+};
+
+/**
+ * @brief Number of event types counted (every ActionType)
+ */
+constexpr std::size_t METRIC_EVENT_TYPES = static_cast<std::size_t>(ActionType::GameStart) + 1;
+
+/**
+ * @brief Number of validation failure reasons counted (ValidationFailure::None included, never counted)
+ */
+constexpr std::size_t METRIC_FAILURE_REASONS = static_cast<std::size_t>(ValidationFailure::RepeatArrest) + 1;
+
+/**
+ * @brief Totals of the engine instrumentation, summed over all threads
+ */
+struct MetricsSnapshot {
+    std::array<std::uint64_t, METRIC_EVENT_TYPES> events = {}; ///< Records emitted by controllers, by type
+    std::array<std::uint64_t, METRIC_FAILURE_REASONS> validationFailures = {}; ///< Rejected requests, by reason
+    std::array<std::uint64_t, METRIC_EVENT_TYPES> blocks = {}; ///< Blocks, by the action blocked
+    std::uint64_t forcedCoups = 0; ///< Coups by players holding 10 or more coins
+    std::uint64_t eliminations = 0; ///< Players eliminated
+    std::uint64_t treasuryExhausted = 0; ///< Times the treasury ran dry
+    std::array<std::uint64_t, HdrBuckets::COUNT> turnNanos = {}; ///< Turn durations, per HdrBuckets bucket
+    std::uint64_t turns = 0; ///< Turns measured
+    std::uint64_t turnNanosSum = 0; ///< Sum of the measured turn durations
+
+    /**
+     * @brief Estimates a quantile of the turn durations
+     * @param q Quantile in [0, 1]
+     * @return Seconds (the middle of the bucket holding the quantile), 0 if no turn was measured
+     */
+    double turnQuantile(double q) const;
+
+    /**
+     * @brief Writes the metrics in the Prometheus text exposition format (version 0.0.4)
+     * @details Counters coup_events_total{type}, coup_validation_failures_total{reason},
+     * coup_blocks_total{action}, coup_forced_coups_total, coup_eliminations_total and
+     * coup_treasury_exhausted_total; the histogram coup_turn_duration_seconds, whose
+     * decimal le buckets are sums of the HDR buckets that end at or below them;
+     * and the HDR quantile estimates as the gauge coup_turn_duration_quantile_seconds.
+     */
+    void writePrometheus(std::ostream& out) const;
+};
+
+/**
+ * @brief Sums the counters of every thread, live and exited
+ */
+MetricsSnapshot collectMetrics();
+
+/**
+ * @brief Writes collectMetrics() to a Prometheus text file
+ * @details Writes a temporary file next to it and renames it over the old
+ * one, so a collector (e.g. node_exporter's textfile collector) never sees a
+ * half-written file.
+ * @throws GameException if the file cannot be written
+ */
+void writeMetricsFile(const std::string& path);
+
+/**
+ * @brief Serves the metrics over HTTP on the loopback interface
+ * @details A background thread answers GET /metrics (and GET /) with
+ * collectMetrics() in Prometheus text format, one request per connection;
+ * other paths get 404. It only listens on 127.0.0.1: put a proxy or the
+ * Prometheus agent on the same host to reach it.
+ */
+class MetricsServer {
+public:
+    /**
+     * @brief Starts listening
+     * @param port TCP port, or 0 to let the system pick one (see port())
+     * @throws GameException if the port cannot be bound
+     */
+    explicit MetricsServer(std::uint16_t port);
+
+    /**
+     * @brief Stops the server and waits for its thread
+     */
+    ~MetricsServer();
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Gets the port listened on
+     */
+    std::uint16_t port() const { return boundPort; }
+
+private:
+    int listener; ///< Listening socket
+    std::uint16_t boundPort; ///< Port actually bound
+    std::atomic<bool> stopping; ///< Set to end the serving thread
+    std::thread worker; ///< Accepts and answers connections
+
+    void serve();
+};
+
+/**
+ * @brief Recording functions called from the engine's hot paths
+ * @details Each thread adds into counters of its own (one cache-line aligned
+ * slot per thread, handed back when the thread exits), so recording is a
+ * thread-local lookup and an uncontended add, never a lock or an allocation.
+ */
+namespace metrics {
+
+#ifdef COUP_METRICS
+
+/**
+ * @brief Counts a record emitted by a controller
+ */
+void countEvent(ActionType type);
+
+/**
+ * @brief Counts a request rejected by validation
+ */
+void countValidationFailure(ValidationFailure reason);
+
+/**
+ * @brief Counts a block of an action
+ */
+void countBlock(ActionType blocked);
+
+/**
+ * @brief Counts a coup by a player forced to coup
+ */
+void countForcedCoup();
+
+/**
+ * @brief Counts an eliminated player
+ */
+void countElimination();
+
+/**
+ * @brief Counts the treasury running dry
+ */
+void countTreasuryExhausted();
+
+/**
+ * @brief Records the duration of a turn
+ */
+void recordTurn(std::uint64_t nanoseconds);
+
+/**
+ * @brief Reads the monotonic clock for recordTurn()
+ */
+std::uint64_t clockNanos();
+
+#else
+
+inline void countEvent(ActionType) {}
+inline void countValidationFailure(ValidationFailure) {}
+inline void countBlock(ActionType) {}
+inline void countForcedCoup() {}
+inline void countElimination() {}
+inline void countTreasuryExhausted() {}
+inline void recordTurn(std::uint64_t) {}
+inline std::uint64_t clockNanos() { return 0; }
+
+#endif
+
+} // namespace metrics
+
+} // namespace coup
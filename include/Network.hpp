@@ -0,0 +1,129 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+/**
+ * @brief Multi-layer perceptron with a policy head and a value head
+ * @details Dense layers with ReLU between them. The last layer's outputs are
+ * the policy logits followed by one value output, which evaluate() squashes
+ * with tanh into [-1, 1] (the outcome of the encoded seat: +1 win, -1 loss).
+ * For bots the input is encodeFeatures() (FEATURE_COUNT values) and the
+ * policy has MOVE_SLOTS logits, matching the self-play dataset columns.
+ *
+ * Weight file (little-endian, no padding):
+ *
+ *     char     magic[8]           "COUPMLP1"
+ *     uint32   layers             L >= 1
+ *     uint32   sizes[L + 1]       inputs, hidden sizes..., policy outputs + 1
+ *     for each layer l:
+ *       float32 weights[sizes[l + 1]][sizes[l]]   row per output (PyTorch Linear.weight)
+ *       float32 bias[sizes[l + 1]]
+ *
+ * Rows are stored padded to a multiple of 8 floats, so the AVX2 kernel needs
+ * no tail loop; it is picked at run time when the CPU has AVX2 and FMA, and
+ * the scalar kernel gives the same results (up to float rounding) elsewhere.
+ * A loaded network is immutable: evaluate() is const and may run on many
+ * threads at once.
+ */
+class PolicyValueNet {
+public:
+    /**
+     * @brief Creates a network with random (He-uniform) weights and zero biases
+     * @param sizes Layer sizes: inputs, hidden..., policy outputs + 1
+     * @param seed Seed for the weights
+     * @throws GameException if there are fewer than two sizes or a size is 0
+     */
+    PolicyValueNet(const std::vector<std::size_t>& sizes, std::uint32_t seed);
+
+    /**
+     * @brief Loads a weight file
+     * @throws GameException if the file is missing, truncated or not a weight file
+     */
+    static PolicyValueNet load(const std::string& path);
+
+    /**
+     * @brief Loads a weight file once per path and shares it
+     * @details Bots are created per game; this keeps one copy of each network
+     * however many bots use it.
+     * @throws GameException as load()
+     */
+    static std::shared_ptr<const PolicyValueNet> shared(const std::string& path);
+
+    /**
+     * @brief Writes the weights in the file format above
+     * @throws GameException if the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Evaluates a batch of inputs
+     * @param inputs batch rows of inputs() values
+     * @param batch Number of rows
+     * @param policy Receives batch rows of policyOutputs() logits, or nullptr
+     * @param value Receives batch values in [-1, 1], or nullptr
+     */
+    void evaluate(const float* inputs, std::size_t batch, float* policy, float* value) const;
+
+    /**
+     * @brief Gets the input width
+     */
+    std::size_t inputs() const { return sizes.front(); }
+
+    /**
+     * @brief Gets the number of policy logits
+     */
+    std::size_t policyOutputs() const { return sizes.back() - 1; }
+
+    /**
+     * @brief Gets the layer sizes, inputs first
+     */
+    const std::vector<std::size_t>& layerSizes() const { return sizes; }
+
+    /**
+     * @brief Chooses between the AVX2 and scalar kernels
+     * @param enabled False forces the scalar kernel; true uses AVX2 if the CPU has it
+     */
+    void setSimd(bool enabled);
+
+    /**
+     * @brief Checks whether evaluate() uses the AVX2 kernel
+     */
+    bool simdEnabled() const { return simd; }
+
+    /**
+     * @brief Checks whether this CPU can run the AVX2 kernel
+     */
+    static bool simdSupported();
+
+private:
+    PolicyValueNet() = default;
+
+    /**
+     * @brief Allocates zeroed, padded weights for the current sizes
+     */
+    void allocate();
+
+    std::vector<std::size_t> sizes; ///< Layer sizes, inputs first
+    std::vector<std::vector<float>> weights; ///< Per layer: outputs rows of padded inputs
+    std::vector<std::vector<float>> biases; ///< Per layer: one bias per output
+    bool simd = false; ///< Use the AVX2 kernel
+};
+
+/**
+ * @brief Turns logits into probabilities over the legal slots only
+ * @param logits Policy logits
+ * @param legal 1 for legal slots, 0 otherwise (as from legalMask())
+ * @param count Number of slots
+ * @param out Receives the probabilities; illegal slots get 0
+ */
+void maskedSoftmax(const float* logits, const std::uint8_t* legal, std::size_t count, float* out);
+
+} // namespace coup
@@ -9,6 +9,17 @@ namespace coup {
 
 class Game;  // Forward declaration
 
+/**
+ * @brief Mutable state of a player, used for game keyframes
+ */
+struct PlayerState {
+    int coins = 0; ///< Coin count
+    bool active = true; ///< Whether the player is still in the game
+    bool sanctioned = false; ///< Sanction status
+    bool arrest_blocked = false; ///< Arrest block status
+    std::string last_arrested_player; ///< Last player this player arrested
+};
+
 /**
  * @brief Abstract base class for all player types in the Coup game
  * @details Provides common functionality for all roles including basic actions,
@@ -130,7 +141,7 @@ public:
      * @brief Gets the player's name
      * @return Player's display name
      */
-    std::string get_name() const { return name; }
+    const std::string& get_name() const { return name; }
     
     /**
      * @brief Gets the player's current coin count
@@ -154,7 +165,7 @@ public:
      * @brief Gets the name of the last player this player arrested
      * @return Name of last arrested player (for preventing consecutive arrests)
      */
-    std::string get_last_arrested_player() const { return last_arrested_player; }
+    const std::string& get_last_arrested_player() const { return last_arrested_player; }
     
     /**
      * @brief Gets weak reference to the game instance
@@ -193,6 +204,18 @@ public:
      * @details Sets active status to false, player can no longer take actions
      */
     void deactivate() { active = false; }
+    
+    /**
+     * @brief Copies the player's mutable state
+     * @return State that restore_state() can bring back later
+     */
+    PlayerState capture_state() const;
+    
+    /**
+     * @brief Restores state captured earlier from this player
+     * @param state Previously captured state
+     */
+    void restore_state(const PlayerState& state);
 
     // Utility methods
     
@@ -233,6 +256,12 @@ protected:
      * @throws NotEnoughCoinsException if player has insufficient coins
      */
     void validate_coins(int required) const;
+    
+    /**
+     * @brief Checks whether actions should be logged to the console
+     * @return true if the game still exists and is verbose
+     */
+    bool log_enabled() const;
 };
 
 } // namespace coup 
\ No newline at end of file
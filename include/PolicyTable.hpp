@@ -0,0 +1,207 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include "GameController.hpp"
+#include "GameRecord.hpp"
+#include "SimStats.hpp"
+
+namespace coup {
+
+/**
+ * @brief A rollout policy compiled into a lookup table
+ * @details Decisions are looked up by a quantized key instead of being
+ * searched or evaluated:
+ *
+ * - Action rows, keyed by own coins (0 to 10, 10 meaning 10 or more), own
+ *   role, the richest and the poorest opponent's coin bucket (0-2, 3-4,
+ *   5-6, 7-9, 10+) and the treasury bucket (0-9, 10-24, 25-39, 40+). A row
+ *   holds a weight (0-255) for each of Gather, Tax, Bribe, Arrest,
+ *   Sanction, Coup and Invest, padded to 8 bytes.
+ * - Block entries, keyed by own coins, own role and the pending action
+ *   (Tax, Bribe or Coup): the chance in 255ths of blocking it.
+ *
+ * A move is drawn in proportion to the weights of the legal action classes;
+ * targeted actions go to the richest opponent they may hit. The whole table
+ * is about 52 KB, so a lookup stays in cache and costs a few nanoseconds;
+ * rollouts spend their time in the engine, not in the policy.
+ *
+ * A table is a view of bytes it does not copy: the heuristic table built
+ * into the binary at compile time (builtin()), a Data compiled in from a
+ * header written by writeHeader(), or a file written by save() and mapped
+ * into memory read-only by map(). Blob format:
+ *
+ *     char     magic[8]       "COUPLUT1"
+ *     uint32   actionKeys     ACTION_KEYS
+ *     uint32   blockKeys      BLOCK_KEYS
+ *     uint8    actions[ACTION_KEYS][ROW]
+ *     uint8    blocks[BLOCK_KEYS]
+ */
+class PolicyTable {
+public:
+    static constexpr std::size_t COIN_LEVELS = 11; ///< Own coins 0 to 10+
+    static constexpr std::size_t COIN_BUCKETS = 5; ///< Opponent coin buckets
+    static constexpr std::size_t TREASURY_BUCKETS = 4; ///< Treasury buckets
+    static constexpr std::size_t CLASSES = 7; ///< Action classes with a weight
+    static constexpr std::size_t ROW = 8; ///< Bytes per action row
+    static constexpr std::size_t BLOCKABLE = 3; ///< Pending actions with a block entry
+    static constexpr std::size_t ACTION_KEYS =
+        COIN_LEVELS * ROLE_COUNT * COIN_BUCKETS * COIN_BUCKETS * TREASURY_BUCKETS; ///< Action rows
+    static constexpr std::size_t BLOCK_KEYS = COIN_LEVELS * ROLE_COUNT * BLOCKABLE; ///< Block entries
+
+    /**
+     * @brief The raw table, as compiled in or stored in a blob
+     */
+    struct Data {
+        std::array<std::uint8_t, ACTION_KEYS * ROW> actions; ///< Weights per action row
+        std::array<std::uint8_t, BLOCK_KEYS> blocks; ///< Block chance per block entry
+    };
+
+    /**
+     * @brief Views a table that outlives this object, e.g. a compiled-in constexpr Data
+     */
+    explicit PolicyTable(const Data& data);
+
+    ~PolicyTable();
+    PolicyTable(const PolicyTable&) = delete;
+    PolicyTable& operator=(const PolicyTable&) = delete;
+
+    /**
+     * @brief Gets the hand-written heuristic table, computed at compile time
+     */
+    static std::shared_ptr<const PolicyTable> builtin();
+
+    /**
+     * @brief Maps a blob into memory, once per path
+     * @throws GameException if the file is missing or not a table of this layout
+     */
+    static std::shared_ptr<const PolicyTable> map(const std::string& path);
+
+    /**
+     * @brief Copies a table into a new one that owns its bytes
+     */
+    static std::shared_ptr<const PolicyTable> copy(const Data& data);
+
+    /**
+     * @brief Gets the action-class index of an action type
+     * @return 0 to CLASSES - 1, or CLASSES for actions without a weight
+     */
+    static std::size_t actionClass(ActionType action);
+
+    /**
+     * @brief Gets the action type of an action class
+     */
+    static ActionType classAction(std::size_t actionClass);
+
+    /**
+     * @brief Gets the action row of a seat's position
+     * @param controller Game to look at
+     * @param seat Seat to decide for
+     */
+    static std::size_t actionKey(const GameController& controller, std::uint8_t seat);
+
+    /**
+     * @brief Gets the block entry of a seat asked to block the pending action
+     * @return Entry, or BLOCK_KEYS if the pending action has no entry
+     */
+    static std::size_t blockKey(const GameController& controller, std::uint8_t seat);
+
+    /**
+     * @brief Gets the weights of an action row
+     */
+    const std::uint8_t* row(std::size_t key) const { return data->actions.data() + key * ROW; }
+
+    /**
+     * @brief Gets a block entry's chance of blocking, in 255ths
+     */
+    std::uint8_t blockChance(std::size_t key) const { return data->blocks[key]; }
+
+    /**
+     * @brief Gets the table bytes
+     */
+    const Data& bytes() const { return *data; }
+
+    /**
+     * @brief Draws a move for whoever has to decide, like randomMove()
+     * @param controller Controller in the Playing or BlockPending phase
+     * @param rng Random generator
+     * @return An action of the current player, or a block by the first asked
+     * seat that draws one, or a pass
+     */
+    RecordedMove move(const GameController& controller, std::mt19937& rng) const;
+
+    /**
+     * @brief Draws a seat's answer to a block request
+     * @return Block (by seat) or Pass
+     */
+    RecordedMove blockMove(const GameController& controller, std::uint8_t seat, std::mt19937& rng) const;
+
+    /**
+     * @brief Writes the blob format above
+     * @throws GameException if the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Writes a C++ header defining the table as an inline constexpr Data
+     * @param path Header to write
+     * @param name Name of the variable
+     * @throws GameException if the file cannot be written
+     */
+    void writeHeader(const std::string& path, const std::string& name) const;
+
+private:
+    PolicyTable() = default;
+
+    const Data* data = nullptr; ///< Table bytes
+    std::unique_ptr<Data> owned; ///< Bytes owned by a copy
+    void* mapping = nullptr; ///< Mapped file, if any
+    std::size_t mappedSize = 0; ///< Bytes mapped
+};
+
+/**
+ * @brief Parameters of a distillation run
+ */
+struct DistillConfig {
+    std::string teacher = "montecarlo:32"; ///< Bot type whose decisions are counted (capped)
+    std::uint64_t games = 200; ///< Games the teacher plays against itself
+    unsigned threads = 0; ///< Worker threads, 0 for one per hardware thread
+    std::uint32_t seed = 1; ///< Base seed; game i always plays the same way
+    std::uint8_t minPlayers = 2; ///< Smallest table (at least 2)
+    std::uint8_t maxPlayers = 6; ///< Largest table (at most MAX_SEATS)
+    std::uint32_t stepLimit = 2000; ///< Moves after which a game is cut off
+    double prior = 4.0; ///< Weight of the built-in heuristic, in decisions
+    RuleSet rules; ///< Rules every game is played by
+};
+
+/**
+ * @brief Outcome of a distillation run
+ */
+struct DistillResult {
+    std::shared_ptr<const PolicyTable> table; ///< The distilled table
+    std::uint64_t decisions = 0; ///< Teacher decisions counted
+    std::size_t actionRows = 0; ///< Action rows seen at least once
+    std::size_t blockEntries = 0; ///< Block entries seen at least once
+    unsigned threads = 0; ///< Worker threads that played
+    double seconds = 0.0; ///< Wall time
+};
+
+/**
+ * @brief Distills a bot into a policy table
+ * @details The teacher plays itself; every decision is counted under its
+ * table key, in per-thread counters merged at the end (game i plays the same
+ * way on any number of threads). A row's weights are the teacher's choice
+ * frequencies, blended with the built-in heuristic as if it had made
+ * 'prior' more decisions there, so rare keys lean on the heuristic and
+ * unseen ones keep it. The Spy's free actions and End Turn are not counted.
+ * @throws GameException if the table sizes or teacher are invalid or a game fails
+ */
+DistillResult distillPolicy(const DistillConfig& config);
+
+} // namespace coup
@@ -0,0 +1,103 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+
+namespace coup {
+
+/**
+ * @brief Mergeable streaming quantile estimate (merging t-digest)
+ * @details Samples are summarised as weighted centroids whose size is bounded
+ * by the arcsine scale function, so they are small near the tails and large
+ * in the middle: p99 stays accurate while the storage never grows. New
+ * samples go into a buffer that is sorted and folded into the centroids when
+ * it fills; merging another sketch folds its centroids in the same way.
+ *
+ * All storage is a fixed member array (about 9 KB), so a sketch can live in
+ * per-thread counters and be copied or merged without allocating, no matter
+ * how many samples it has seen. Not thread-safe, not even the const queries,
+ * which fold the buffer in first.
+ */
+class QuantileSketch {
+public:
+    static constexpr std::size_t COMPRESSION = 100; ///< Scale parameter (about COMPRESSION/2 centroids)
+    static constexpr std::size_t CAPACITY = 2 * COMPRESSION; ///< Centroids kept after a compression
+    static constexpr std::size_t BUFFER = 3 * COMPRESSION; ///< Samples or centroids waiting to be folded in
+
+    QuantileSketch();
+
+    /**
+     * @brief Adds a sample
+     * @param value Sample value (NaN is ignored)
+     * @param weight How many identical samples it stands for (must be positive)
+     */
+    void add(double value, double weight = 1.0);
+
+    /**
+     * @brief Adds everything another sketch has seen
+     */
+    void merge(const QuantileSketch& other);
+
+    /**
+     * @brief Drops all samples
+     */
+    void clear();
+
+    /**
+     * @brief Estimates a quantile
+     * @param q Quantile between 0 and 1 (0.5 for the median)
+     * @return Interpolated value, exact at q = 0 and q = 1; 0 if empty
+     */
+    double quantile(double q) const;
+
+    /**
+     * @brief Gets the total weight of all samples
+     */
+    double count() const { return totalWeight + bufferWeight; }
+
+    /**
+     * @brief Gets the smallest sample (0 if empty)
+     */
+    double min() const { return count() > 0.0 ? minimum : 0.0; }
+
+    /**
+     * @brief Gets the largest sample (0 if empty)
+     */
+    double max() const { return count() > 0.0 ? maximum : 0.0; }
+
+    /**
+     * @brief Gets the number of centroids after folding in the buffer
+     */
+    std::size_t centroidCount() const;
+
+private:
+    /**
+     * @brief A group of neighbouring samples
+     */
+    struct Centroid {
+        double mean; ///< Mean of the samples
+        double weight; ///< Number of samples
+    };
+
+    mutable std::array<Centroid, CAPACITY + BUFFER> centroids; ///< Merged centroids, then the buffer
+    mutable std::size_t merged; ///< Merged centroids at the front of centroids
+    mutable std::size_t buffered; ///< Buffered entries after them
+    mutable double totalWeight; ///< Weight of the merged centroids
+    mutable double bufferWeight; ///< Weight of the buffered entries
+    double minimum; ///< Smallest sample
+    double maximum; ///< Largest sample
+
+    /**
+     * @brief Appends one entry to the buffer, folding it in first if full
+     */
+    void push(double mean, double weight) const;
+
+    /**
+     * @brief Sorts the buffer into the centroids and re-bounds their sizes
+     */
+    void compress() const;
+};
+
+} // namespace coup
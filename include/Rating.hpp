@@ -0,0 +1,103 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+/**
+ * @brief Skill estimate of one entrant
+ * @details Two ratings are kept side by side. mu/sigma is a Bayesian
+ * estimate in the TrueSkill family (Weng-Lin with the Plackett-Luce model),
+ * which handles free-for-all finishing orders directly and knows how sure it
+ * is. elo is the familiar number, updated by splitting each game into all
+ * its head-to-head pairs.
+ */
+struct Rating {
+    double mu = 25.0; ///< Estimated skill
+    double sigma = 25.0 / 3.0; ///< Uncertainty of mu
+    double elo = 1500.0; ///< Multiplayer Elo
+    std::uint64_t games = 0; ///< Games rated
+    std::uint64_t wins = 0; ///< Games finished first (alone)
+
+    /**
+     * @brief Skill the entrant has with high confidence (mu - 3 sigma), used for ranking
+     */
+    double conservative() const { return mu - 3.0 * sigma; }
+};
+
+/**
+ * @brief Ratings of a population, updated one game at a time
+ * @details Not thread-safe: one thread applies results, in a fixed order, so
+ * the final ratings do not depend on which game finished first.
+ */
+class RatingTable {
+public:
+    static constexpr double ELO_K = 32.0; ///< Elo step per game
+
+    /**
+     * @brief Adds an entrant with the default rating
+     * @param name Display name
+     * @return Index of the entrant
+     */
+    std::size_t add(const std::string& name);
+
+    /**
+     * @brief Rates one game
+     * @param players Entrant index of each participant (2 or more, all different)
+     * @param ranks Finishing place of each participant, 0 for first; equal
+     * places are ties (players still in when a game is cut off)
+     * @throws GameException if the sizes differ, an index is unknown or a
+     * player appears twice
+     * @details All updates use the ratings from before the game.
+     */
+    void update(const std::vector<std::size_t>& players, const std::vector<std::uint32_t>& ranks);
+
+    /**
+     * @brief Gets the number of entrants
+     */
+    std::size_t size() const { return entries.size(); }
+
+    /**
+     * @brief Gets an entrant's name
+     */
+    const std::string& name(std::size_t index) const { return entries[index].name; }
+
+    /**
+     * @brief Gets an entrant's rating
+     */
+    const Rating& rating(std::size_t index) const { return entries[index].rating; }
+
+    /**
+     * @brief Lists entrant indexes from best to worst conservative rating
+     */
+    std::vector<std::size_t> standings() const;
+
+    /**
+     * @brief Writes the standings as a table
+     */
+    void writeStandings(std::ostream& out) const;
+
+    /**
+     * @brief Writes the standings as CSV: rank,name,mu,sigma,conservative,elo,games,wins
+     */
+    void writeCsv(std::ostream& out) const;
+
+private:
+    /**
+     * @brief A named rating
+     */
+    struct Entry {
+        std::string name; ///< Display name
+        Rating rating; ///< Current rating
+    };
+
+    std::vector<Entry> entries; ///< Entrants in the order added
+};
+
+} // namespace coup
@@ -0,0 +1,107 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "ActionHistory.hpp"
+#include "GameController.hpp"
+#include "GameRecord.hpp"
+
+namespace coup {
+
+/**
+ * @brief Seekable replay of a recorded game
+ * @details Loading plays the record once from the start and keeps:
+ * - a full ControllerState keyframe every keyframeInterval moves
+ * - every ActionRecord emitted, with the event count after each move
+ *
+ * seek() restores the nearest keyframe at or before the target and replays
+ * at most keyframeInterval - 1 moves through the real engine; short forward
+ * seeks simply continue from the current position. Seeking therefore costs
+ * O(keyframeInterval) no matter how long the game is, and the event list up
+ * to any position is available without replaying at all.
+ */
+class Replay {
+public:
+    static constexpr std::size_t DEFAULT_KEYFRAME_INTERVAL = 16; ///< Moves between keyframes
+
+    /**
+     * @brief Loads a record and builds its keyframes
+     * @param record Recorded game
+     * @param keyframeInterval Moves between two keyframes (at least 1)
+     * @throws GameException if the record cannot be replayed
+     * @details The replay starts positioned at the end of the game.
+     */
+    explicit Replay(const GameRecord& record, std::size_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    Replay(const Replay&) = delete;
+    Replay& operator=(const Replay&) = delete;
+
+    /**
+     * @brief Gets the number of recorded moves
+     */
+    std::size_t length() const { return record.moves.size(); }
+
+    /**
+     * @brief Gets the number of moves applied to the current state
+     */
+    std::size_t position() const { return current; }
+
+    /**
+     * @brief Moves the replay to the state after position moves
+     * @param position Target position, clamped to length()
+     */
+    void seek(std::size_t position);
+
+    /**
+     * @brief Gets how many moves the last seek() replayed through the engine
+     */
+    std::size_t lastSeekCost() const { return seekCost; }
+
+    /**
+     * @brief Gets the controller holding the state at position()
+     */
+    const GameController& controller() const { return replayController; }
+
+    /**
+     * @brief Gets the number of events emitted up to position()
+     */
+    std::size_t eventCount() const { return eventEnd[current]; }
+
+    /**
+     * @brief Gets an emitted event; seq is its index in the whole game
+     * @param index Index below the total number of events
+     */
+    const ActionRecord& event(std::size_t index) const { return events[index]; }
+
+    /**
+     * @brief Gets the number of stored keyframes
+     */
+    std::size_t keyframeCount() const { return keyframes.size(); }
+
+    /**
+     * @brief Gets the moves between keyframes
+     */
+    std::size_t keyframeInterval() const { return interval; }
+
+    /**
+     * @brief Gets the recorded seats
+     */
+    const std::vector<SeatRecord>& seats() const { return record.seats; }
+
+private:
+    GameRecord record; ///< Record being replayed
+    std::shared_ptr<Game> game; ///< Game rebuilt from the record
+    GameController replayController; ///< Engine used to apply moves
+    std::size_t interval; ///< Moves between keyframes
+    std::vector<ControllerState> keyframes; ///< keyframes[k]: state after k * interval moves
+    std::vector<ActionRecord> events; ///< All events of the game
+    std::vector<std::size_t> eventEnd; ///< eventEnd[p]: events emitted by the first p moves
+    std::size_t current; ///< Moves applied to the current state
+    std::size_t seekCost; ///< Moves replayed by the last seek
+    bool capturing; ///< Whether emitted events are being collected (first pass only)
+};
+
+} // namespace coup
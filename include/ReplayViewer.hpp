@@ -0,0 +1,103 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include "ActionHistory.hpp"
+#include "GameSnapshot.hpp"
+#include "Replay.hpp"
+
+namespace coup {
+
+    /**
+     * @brief Window for reviewing a recorded game with a seekable timeline
+     * @details Shows the table (all roles revealed), the events up to the
+     * current move, and a timeline with a tick per keyframe. Clicking or
+     * dragging on the timeline jumps straight to that move; Left/Right step
+     * one move, PageUp/PageDown ten, Home/End jump to the ends.
+     *
+     * Seeking goes through Replay, so a jump only replays the moves since the
+     * nearest keyframe. Texts are rebuilt only when the position changes.
+     */
+    class ReplayViewer {
+    private:
+        static const int WINDOW_WIDTH = 1200; ///< Viewer window width in pixels
+        static const int WINDOW_HEIGHT = 800; ///< Viewer window height in pixels
+        static const int HISTORY_X = 650; ///< Left edge of the event list
+        static const int HISTORY_Y = 60; ///< Top edge of the event list
+        static const int HISTORY_LINE_HEIGHT = 20; ///< Height of one event line
+        static const int HISTORY_VISIBLE_LINES = 28; ///< Event lines shown
+        static const int TIMELINE_X = 50; ///< Left edge of the timeline
+        static const int TIMELINE_Y = 720; ///< Top edge of the timeline
+        static const int TIMELINE_WIDTH = 1100; ///< Timeline width in pixels
+        static const int TIMELINE_HEIGHT = 24; ///< Timeline height in pixels
+
+        sf::RenderWindow window; ///< SFML window for rendering
+        Replay& replay; ///< Game being reviewed
+        sf::Font font; ///< Font for text rendering
+        ActionHistory formatter; ///< Formats events with the recorded seat names
+        GameSnapshot snapshot; ///< State at the current position
+
+        sf::Text titleText; ///< Move counter
+        sf::Text treasuryText; ///< Treasury amount
+        sf::Text messageText; ///< Engine message at this position
+        std::vector<sf::Text> playerTexts; ///< One line per seat
+        std::vector<sf::Text> historyTexts; ///< Fixed pool of event lines
+        sf::VertexArray keyframeTicks; ///< Keyframe marks on the timeline
+        bool dirty; ///< Whether texts must be rebuilt
+        bool dragging; ///< Whether the timeline handle is being dragged
+
+        /**
+         * @brief Loads the font and sets up the fixed texts
+         * @return true if a font was found
+         */
+        bool loadAssets();
+
+        /**
+         * @brief Processes SFML events (keys, timeline clicks and drags)
+         */
+        void handleEvents();
+
+        /**
+         * @brief Seeks to the move under an x coordinate of the timeline
+         */
+        void seekToTimeline(int x);
+
+        /**
+         * @brief Seeks and marks the view for rebuilding
+         */
+        void seek(std::size_t position);
+
+        /**
+         * @brief Rebuilds all texts from the replay at its current position
+         */
+        void refresh();
+
+        /**
+         * @brief Draws the timeline and its handle
+         */
+        void renderTimeline();
+
+    public:
+        /**
+         * @brief Opens the viewer at the start of the game
+         * @param replay Replay to show; must outlive the viewer
+         * @param title Window title, usually the record file name
+         * @throws std::runtime_error if no font can be loaded
+         */
+        ReplayViewer(Replay& replay, const std::string& title);
+
+        /**
+         * @brief Main loop - runs until the window is closed
+         */
+        void run();
+
+        /**
+         * @brief Renders the current position
+         */
+        void render();
+    };
+}
@@ -0,0 +1,60 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Game.hpp"
+
+namespace coup {
+
+/**
+ * @brief Parameters of a self-play dataset run
+ */
+struct SelfPlayConfig {
+    std::string directory = "selfplay"; ///< Output directory, created if missing
+    std::uint64_t games = 1000; ///< Games to play
+    unsigned threads = 0; ///< Worker threads, 0 for one per hardware thread
+    std::uint32_t seed = 1; ///< Base seed; game i always plays the same way
+    std::uint8_t minPlayers = 2; ///< Smallest table (at least 2)
+    std::uint8_t maxPlayers = 6; ///< Largest table (at most MAX_SEATS)
+    std::string bot = "random"; ///< Bot type in every seat (capped, see checkMatchBot)
+    std::uint32_t stepLimit = 2000; ///< Moves after which a game is cut off
+    std::size_t chunkRows = 65536; ///< Rows per chunk file, rounded up to whole games
+    RuleSet rules; ///< Rules every game is played by
+};
+
+/**
+ * @brief Outcome of a self-play run
+ */
+struct SelfPlayResult {
+    std::uint64_t games = 0; ///< Games played
+    std::uint64_t rows = 0; ///< Decisions recorded
+    std::size_t chunks = 0; ///< Chunks written
+    std::uint64_t truncated = 0; ///< Games cut off at the step limit
+    unsigned threads = 0; ///< Worker threads that played
+    double seconds = 0.0; ///< Wall time
+};
+
+/**
+ * @brief Plays bots against themselves and records every decision
+ * @param config What to play and where to write it
+ * @return Counts and timing
+ * @throws GameException if the table sizes or bot type are invalid, the
+ * directory cannot be written or a game fails
+ * @details Each decision becomes a row: the seat-relative features of the
+ * position, its legal move mask, the move chosen and, once the game is over,
+ * the decider's outcome and place (see ChunkWriter for the columns). Threads
+ * claim games from an atomic counter and buffer rows in their own
+ * ChunkWriter, which writes a chunk of .npy files whenever it holds enough
+ * whole games; nothing is shared but the game and chunk counters. A
+ * manifest.json listing the chunks is written last.
+ *
+ * Every game is seeded from its index, so game i records the same rows on
+ * any number of threads; only which chunk holds it varies. The game column
+ * identifies it.
+ */
+SelfPlayResult runSelfPlay(const SelfPlayConfig& config);
+
+} // namespace coup
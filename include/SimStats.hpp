@@ -0,0 +1,333 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ActionHistory.hpp"
+#include "QuantileSketch.hpp"
+
+namespace coup {
+
+/**
+ * @brief Number of roles a player can be dealt
+ */
+constexpr std::size_t ROLE_COUNT = 6;
+
+/**
+ * @brief Number of action types a player can choose (Gather through End Turn)
+ */
+constexpr std::size_t MOVE_TYPES = static_cast<std::size_t>(ActionType::EndTurn) + 1;
+
+/**
+ * @brief Gets a role name by index
+ * @param index 0..ROLE_COUNT-1, in the order Governor, Spy, Baron, General, Judge, Merchant
+ * @return Static string as returned by Player::role(), "?" if out of range
+ */
+const char* roleName(std::size_t index);
+
+/**
+ * @brief Looks up the index of a role name
+ * @return Index for roleName(), or ROLE_COUNT if the name is unknown
+ */
+std::size_t roleIndex(const std::string& role);
+
+/**
+ * @brief Raw tallies of a batch of simulated games
+ * @details Each simulation thread owns one instance and is the only writer,
+ * so counting is plain integer increments. The type is aligned to a cache
+ * line, which keeps the instances of different threads in an array from
+ * sharing lines; the totals are formed with merge() once the threads are done.
+ *
+ * Per-seat and per-role tallies are kept per player count, indexed
+ * [players][seat] and [players][role]; the totals over all player counts are
+ * sums of those rows. Distributions are kept as QuantileSketches, so the
+ * size stays fixed however many games are counted.
+ */
+struct alignas(64) SimCounters {
+    using SeatTable = std::array<std::array<std::uint64_t, MAX_SEATS>, MAX_SEATS + 1>; ///< [players][seat]
+    using RoleTable = std::array<std::array<std::uint64_t, ROLE_COUNT>, MAX_SEATS + 1>; ///< [players][role]
+
+    std::uint64_t games = 0; ///< Games played
+    std::uint64_t truncated = 0; ///< Games stopped at the step limit without a winner
+    std::array<std::uint64_t, MAX_SEATS + 1> gamesByPlayers = {}; ///< Games per player count
+
+    SeatTable seatGames = {}; ///< Games per player count and seat
+    SeatTable seatWins = {}; ///< Wins per player count and seat
+    RoleTable roleGames = {}; ///< Players dealt a role, per player count
+    RoleTable roleWins = {}; ///< Wins per player count and role of the winner
+
+    std::uint64_t turnsSum = 0; ///< Sum of game lengths in turns (finished games)
+    std::uint64_t turnsSumSquares = 0; ///< Sum of squared game lengths
+    std::uint64_t turnsMin = 0; ///< Shortest finished game (0 if none)
+    std::uint64_t turnsMax = 0; ///< Longest finished game
+    QuantileSketch turnQuantiles; ///< Distribution of finished game lengths
+    QuantileSketch eliminationCoins; ///< Coins a player held when couped out
+
+    std::array<std::uint64_t, MOVE_TYPES> actions = {}; ///< Performed actions per type
+    std::array<std::uint64_t, MOVE_TYPES> blocks = {}; ///< Blocked actions per type
+    std::uint64_t coups = 0; ///< Coups performed
+    std::uint64_t forcedCoups = 0; ///< Coups made with 10 or more coins, when coup is mandatory
+
+    /**
+     * @brief Counts one event of a game in progress
+     */
+    void recordEvent(const ActionRecord& record);
+
+    /**
+     * @brief Counts a finished or truncated game
+     * @param roles Role index of each seat (see roleIndex)
+     * @param winner Winning seat, NO_SEAT if the game was truncated
+     * @param turns Number of turns played
+     */
+    void recordGame(const std::vector<std::size_t>& roles, std::uint8_t winner, std::uint64_t turns);
+
+    /**
+     * @brief Adds another instance's tallies to this one
+     */
+    void merge(const SimCounters& other);
+};
+
+/**
+ * @brief Tallies of two rule variants played on the same seeds
+ * @details Game i of both variants deals the same roles and draws its moves
+ * from the same random stream, so every game gives a paired difference
+ * between the variants. Role results are kept per game: a role is counted
+ * once for each game it is dealt in, and wins when the winner holds it. Like
+ * SimCounters, each thread owns one instance and merge() forms the totals.
+ */
+struct alignas(64) PairedCounters {
+    using RoleRow = std::array<std::uint64_t, ROLE_COUNT>; ///< One count per role
+
+    std::uint64_t games = 0; ///< Game pairs played
+    std::array<std::uint64_t, 2> truncated = {}; ///< Games without a winner, per variant
+    RoleRow roleGames = {}; ///< Pairs in which the role was dealt
+    std::array<RoleRow, 2> roleWins = {}; ///< Games won by the role, per variant
+    RoleRow roleSplits = {}; ///< Pairs the role won under one variant only
+
+    std::uint64_t finishedPairs = 0; ///< Pairs in which both games finished
+    std::array<std::uint64_t, 2> turnsSum = {}; ///< Sum of game lengths over finished pairs, per variant
+    std::array<std::uint64_t, 2> turnsSumSquares = {}; ///< Sum of squared game lengths, per variant
+    std::uint64_t turnsDiffSquares = 0; ///< Sum of squared length differences
+
+    /**
+     * @brief Counts one pair of games
+     * @param roles Role index of each seat, the same in both games
+     * @param winners Winning seat per variant, NO_SEAT if truncated
+     * @param turns Game length per variant
+     */
+    void recordPair(const std::vector<std::size_t>& roles, const std::array<std::uint8_t, 2>& winners,
+                    const std::array<std::uint64_t, 2>& turns);
+
+    /**
+     * @brief Adds another instance's tallies to this one
+     */
+    void merge(const PairedCounters& other);
+};
+
+/**
+ * @brief Point estimate with a confidence interval
+ */
+struct Interval {
+    double estimate = 0.0; ///< Observed value
+    double low = 0.0; ///< Lower bound
+    double high = 0.0; ///< Upper bound
+};
+
+/**
+ * @brief Wilson score interval for a proportion
+ * @param successes Observed successes
+ * @param trials Number of trials (an empty sample gives [0, 1])
+ * @param z Normal quantile of the confidence level (1.96 for 95%)
+ * @details Unlike the normal approximation it stays inside [0, 1] and
+ * behaves for rates near 0 or 1, such as rare roles at large tables.
+ */
+Interval wilsonInterval(std::uint64_t successes, std::uint64_t trials, double z = 1.96);
+
+/**
+ * @brief Normal-approximation interval for a mean
+ * @param sum Sum of the samples
+ * @param sumSquares Sum of the squared samples
+ * @param count Number of samples
+ * @param z Normal quantile of the confidence level (1.96 for 95%)
+ */
+Interval meanInterval(double sum, double sumSquares, std::uint64_t count, double z = 1.96);
+
+/**
+ * @brief Difference between two variants, with paired and unpaired intervals
+ * @details paired is what the common seeds give; unpaired is the interval
+ * the same number of independently seeded games would have given. Their
+ * width ratio squared is how many times more games an unpaired run needs.
+ */
+struct PairedDelta {
+    Interval paired; ///< Mean difference (variant minus baseline), paired interval
+    Interval unpaired; ///< Same estimate, independent-samples interval
+};
+
+/**
+ * @brief Merged results of a simulation with derived rates and exports
+ */
+class SimStats {
+public:
+    /**
+     * @param counters Merged tallies
+     * @param threads Threads that played the games
+     * @param seconds Wall time of the run
+     */
+    SimStats(const SimCounters& counters, unsigned threads, double seconds);
+
+    /**
+     * @brief Gets the raw tallies
+     */
+    const SimCounters& counters() const { return totals; }
+
+    /**
+     * @brief Gets the number of threads that played
+     */
+    unsigned threads() const { return threadCount; }
+
+    /**
+     * @brief Gets the wall time of the run in seconds
+     */
+    double seconds() const { return elapsed; }
+
+    /**
+     * @brief Win rate of a role
+     * @param role Role index
+     * @param players Player count, 0 for all counts together
+     */
+    Interval roleWinRate(std::size_t role, std::size_t players = 0) const;
+
+    /**
+     * @brief Win rate of a seat
+     * @param seat Seat index (0 moves first)
+     * @param players Player count, 0 for all counts together
+     */
+    Interval seatWinRate(std::size_t seat, std::size_t players = 0) const;
+
+    /**
+     * @brief Mean game length in turns over finished games
+     */
+    Interval gameLength() const;
+
+    /**
+     * @brief Share of attempts of an action type that were blocked
+     */
+    Interval blockRate(ActionType action) const;
+
+    /**
+     * @brief Share of coups that were forced by the 10 coin rule
+     */
+    Interval forcedCoupRate() const;
+
+    /**
+     * @brief Estimated quantile of the game length in turns
+     * @param q Quantile between 0 and 1
+     */
+    double gameLengthQuantile(double q) const { return totals.turnQuantiles.quantile(q); }
+
+    /**
+     * @brief Estimated quantile of the coins held by couped players
+     * @param q Quantile between 0 and 1
+     */
+    double eliminationCoinsQuantile(double q) const { return totals.eliminationCoins.quantile(q); }
+
+    /**
+     * @brief Writes one row per rate: metric,key,players,count,total,value,ci_low,ci_high
+     * @details Rows with players "all" sum over player counts; count/total is
+     * the proportion behind value, except for game_length where value is the
+     * mean and count the number of finished games, and the *_quantile rows
+     * where key names the quantile, count is the number of samples and the
+     * interval columns are empty.
+     */
+    void writeCsv(std::ostream& out) const;
+
+    /**
+     * @brief Writes the same figures as one JSON object
+     */
+    void writeJson(std::ostream& out) const;
+
+    /**
+     * @brief Writes a human-readable summary
+     */
+    void writeSummary(std::ostream& out) const;
+
+private:
+    /**
+     * @brief Wins out of games for one role or seat
+     */
+    struct Tally {
+        std::uint64_t wins = 0; ///< Games won
+        std::uint64_t games = 0; ///< Games played
+    };
+
+    SimCounters totals; ///< Merged tallies
+    unsigned threadCount; ///< Threads used
+    double elapsed; ///< Wall time in seconds
+
+    /**
+     * @brief Sums a role's games and wins over one or all player counts
+     */
+    Tally roleTally(std::size_t role, std::size_t players) const;
+
+    /**
+     * @brief Sums a seat's games and wins over one or all player counts
+     */
+    Tally seatTally(std::size_t seat, std::size_t players) const;
+};
+
+/**
+ * @brief Merged results of a paired rule comparison
+ */
+class RuleComparison {
+public:
+    /**
+     * @param counters Merged paired tallies
+     * @param threads Threads that played the games
+     * @param seconds Wall time of the run
+     */
+    RuleComparison(const PairedCounters& counters, unsigned threads, double seconds);
+
+    /**
+     * @brief Gets the raw tallies
+     */
+    const PairedCounters& counters() const { return totals; }
+
+    /**
+     * @brief Win rate of a role under one variant, over the games it was dealt in
+     * @param variant 0 for the baseline, 1 for the variant
+     * @param role Role index
+     */
+    Interval roleWinRate(std::size_t variant, std::size_t role) const;
+
+    /**
+     * @brief Change of a role's win rate (variant minus baseline)
+     */
+    PairedDelta roleWinDelta(std::size_t role) const;
+
+    /**
+     * @brief Change of the mean game length in turns, over pairs where both games finished
+     */
+    PairedDelta gameLengthDelta() const;
+
+    /**
+     * @brief Writes one row per difference: metric,key,count,baseline,variant,delta,paired_low,paired_high,unpaired_low,unpaired_high
+     */
+    void writeCsv(std::ostream& out) const;
+
+    /**
+     * @brief Writes a human-readable summary
+     */
+    void writeSummary(std::ostream& out) const;
+
+private:
+    PairedCounters totals; ///< Merged tallies
+    unsigned threadCount; ///< Threads used
+    double elapsed; ///< Wall time in seconds
+};
+
+} // namespace coup
@@ -0,0 +1,74 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Game.hpp"
+#include "SimStats.hpp"
+
+namespace coup {
+
+/**
+ * @brief Parameters of a batch simulation
+ */
+struct SimConfig {
+    std::uint64_t games = 10000; ///< Games to play
+    unsigned threads = 0; ///< Worker threads, 0 for one per hardware thread
+    std::uint32_t seed = 1; ///< Base seed; game i always plays the same way
+    std::uint8_t minPlayers = 2; ///< Smallest table (at least 2)
+    std::uint8_t maxPlayers = 6; ///< Largest table (at most MAX_SEATS)
+    std::uint32_t stepLimit = 2000; ///< Moves after which a game counts as truncated
+    RuleSet rules; ///< Rules to play by (the baseline of a comparison)
+};
+
+/**
+ * @brief Plays one game with random moves and counts it
+ * @param config Table sizes, seed and step limit
+ * @param index Game number; with the seed it fixes the deal and every move
+ * @param counters Receives the game's events and result
+ * @details Roles are dealt by Game::create_random_player from the game's own
+ * generator, which then draws every move, so games on different threads
+ * share no state.
+ */
+void simulateGame(const SimConfig& config, std::uint64_t index, SimCounters& counters);
+
+/**
+ * @brief Plays a batch of games on several threads
+ * @param config What to play
+ * @return Merged tallies with timing
+ * @throws GameException if the table sizes are out of range
+ * @details Threads claim games in small chunks from an atomic counter and
+ * count into their own cache-line aligned SimCounters; nothing is shared
+ * while games run, and the per-thread tallies are merged after the threads
+ * are joined. Every game is seeded from its index, so the totals do not
+ * depend on the number of threads.
+ */
+SimStats runSimulation(const SimConfig& config);
+
+/**
+ * @brief Plays every game under the configured rules and under a variant
+ * @param config What to play; config.rules is the baseline
+ * @param variant Rules to compare with the baseline
+ * @return Paired differences with their intervals
+ * @throws GameException if the table sizes are out of range
+ * @details Both games of pair i come from the same seed, so they seat the
+ * same roles and draw moves from the same random stream until the rule
+ * change makes them diverge (common random numbers). The noise of the deal
+ * and of the early moves cancels in the difference, which typically needs
+ * several times fewer games than two independent runs for the same
+ * interval; the summary reports the factor. Threads work as in runSimulation.
+ */
+RuleComparison compareRules(const SimConfig& config, const RuleSet& variant);
+
+/**
+ * @brief Applies a rule change written as key=value pairs
+ * @param spec Comma-separated changes, e.g. "governor-tax=2,merchant-threshold=4";
+ * keys are tax, governor-tax, merchant-threshold and merchant-bonus
+ * @param rules Rules to start from
+ * @return The changed rules
+ * @throws GameException if a key is unknown or a value is not a small non-negative number
+ */
+RuleSet parseRules(const std::string& spec, RuleSet rules);
+
+} // namespace coup
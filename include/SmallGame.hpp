@@ -0,0 +1,279 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ActionHistory.hpp"
+#include "Game.hpp"
+#include "SimStats.hpp"
+
+namespace coup {
+
+/**
+ * @brief Most players of a small game
+ */
+constexpr std::size_t SMALL_MAX_PLAYERS = 3;
+
+/**
+ * @brief Most turns of a small game (the public log must fit its key)
+ */
+constexpr std::size_t SMALL_MAX_HORIZON = 14;
+
+/**
+ * @brief Decisions of a small game; targets are counted in seats after the actor
+ */
+enum class SmallAction : std::uint8_t {
+    Gather,
+    Tax,
+    Invest,
+    Arrest1,
+    Arrest2,
+    Sanction1,
+    Sanction2,
+    Coup1,
+    Coup2,
+    Skip,   ///< Only when nothing else is legal
+    Block,  ///< Block the pending action
+    Pass    ///< Let the pending action through
+};
+
+/**
+ * @brief Number of SmallAction values
+ */
+constexpr std::size_t SMALL_ACTIONS = 12;
+
+/**
+ * @brief Bit set of legal SmallActions, bit a for action a
+ */
+using SmallActionMask = std::uint16_t;
+
+/**
+ * @brief Gets the display name of a small-game action, e.g. "Arrest+1"
+ */
+const char* smallActionName(SmallAction action);
+
+/**
+ * @brief Parameters of a small game
+ */
+struct SmallConfig {
+    std::uint8_t players = 2; ///< 2 or 3
+    std::uint8_t horizon = 6; ///< Turns before the game is scored, 1 to SMALL_MAX_HORIZON
+    std::uint8_t startCoins = 3; ///< Coins every player starts with
+    bool bucketCoins = true; ///< Abstract info sets see coin buckets instead of counts
+    RuleSet rules; ///< Tax amounts and the Merchant bonus
+};
+
+/**
+ * @brief Complete state of a small game, small enough to copy at every node
+ */
+struct SmallState {
+    std::uint8_t players = 0; ///< Seats
+    std::uint8_t turn = 0; ///< Turns completed
+    std::uint8_t current = 0; ///< Seat whose turn it is
+    std::uint8_t alive = 0; ///< Bit per seat still in
+    std::uint8_t sanctioned = 0; ///< Bit per seat that may not gather or tax this turn
+    std::uint8_t lastArrested = NO_SEAT; ///< May not be arrested again right away
+    std::uint8_t pending = 0xFF; ///< SmallAction awaiting blocks, 0xFF outside a block phase
+    std::uint8_t blocker = NO_SEAT; ///< Seat deciding whether to block
+    std::uint8_t asked = 0; ///< Bit per seat asked to block this turn
+    std::array<std::uint8_t, SMALL_MAX_PLAYERS> coins{}; ///< Coins per seat
+    std::array<std::uint8_t, SMALL_MAX_PLAYERS> roles{}; ///< Role index per seat (hidden)
+    std::array<std::uint64_t, 2> log{}; ///< 8 bits per turn: action, blocker seat + 1 (0 if none), seats asked
+    std::uint64_t outcomes = 0; ///< 3 bits per turn of what the coins revealed, see SmallGame
+};
+
+/**
+ * @brief Exact key of a state or information set, for memo tables
+ */
+struct SmallKey {
+    std::uint64_t low = 0; ///< Public log, first bits
+    std::uint64_t high = 0; ///< Rest of the log
+    std::uint64_t rest = 0; ///< Outcomes, turn, pending action, blocker, seats asked and roles
+
+    bool operator==(const SmallKey& other) const {
+        return low == other.low && high == other.high && rest == other.rest;
+    }
+};
+
+/**
+ * @brief Hash of a SmallKey for unordered containers
+ */
+struct SmallKeyHash {
+    std::size_t operator()(const SmallKey& key) const {
+        std::uint64_t mixed = key.low * 0x9E3779B97F4A7C15ULL ^ (key.high + 0x632BE59BD9B4E019ULL + (key.low >> 29)) ^
+                              key.rest * 0xC2B2AE3D27D4EB4FULL;
+        return static_cast<std::size_t>(mixed ^ (mixed >> 31));
+    }
+};
+
+/**
+ * @brief A finite two- or three-player abstraction of Coup for solvers
+ * @details Roles are dealt uniformly and independently and stay hidden;
+ * every action, coin count and block is public. The rules follow the
+ * engine's where they can be kept small:
+ *
+ * - Gather +1, Tax +taxAmount (a Governor +governorTax), neither while sanctioned
+ * - Invest (Baron, 3 coins): pay 3, gain 6
+ * - Arrest takes a coin from the target; a General keeps it, a Merchant pays
+ *   up to 2 to the treasury instead. Nobody may be arrested twice in a row
+ * - Sanction costs 3 and stops the target gathering or taxing on its next
+ *   turn; a sanctioned Baron gets 1 coin back
+ * - Coup costs 7; at 10 coins a coup is forced
+ * - Governors may block Tax, and Generals with 5 coins may block a Coup
+ *   (paying 5, the coup's cost is lost); they are asked in seat order, in
+ *   the open
+ * - A Merchant starting a turn with merchantThreshold coins gains merchantBonus
+ *
+ * There is no Bribe (so Judges only differ in blocking nothing) and no Spy
+ * action, and sanctioning a Judge costs no extra. The game ends when one
+ * player is left, who scores 1, or after horizon turns, when the players
+ * still in share 1 in proportion to coins + 1. Scores always sum to 1.
+ *
+ * Coins are public, so they give some roles away. Each turn's outcome
+ * keeps what they showed: whether a tax paid the Governor's amount, whether
+ * an arrest took nothing (General) or cost the target without paying the
+ * actor (Merchant), whether a sanctioned target got a refund (Baron), and
+ * whether the next player got the Merchant bonus. With the public log this
+ * makes infoKey() exactly what a seat has seen.
+ */
+class SmallGame {
+public:
+    /**
+     * @throws GameException if players or horizon are out of range
+     */
+    explicit SmallGame(const SmallConfig& config);
+
+    /**
+     * @brief Gets the parameters
+     */
+    const SmallConfig& config() const { return settings; }
+
+    /**
+     * @brief Gets the number of equally likely role deals (6^players)
+     */
+    std::size_t dealCount() const;
+
+    /**
+     * @brief Gets the starting state of a deal
+     * @param index 0 to dealCount() - 1; seat s gets role (index / 6^s) % 6
+     */
+    SmallState deal(std::size_t index) const;
+
+    /**
+     * @brief Checks whether the game is over
+     */
+    bool isTerminal(const SmallState& state) const;
+
+    /**
+     * @brief Gets each seat's score of a finished game
+     * @param out Receives one score per seat
+     */
+    void utilities(const SmallState& state, float* out) const;
+
+    /**
+     * @brief Gets the seat that decides next
+     */
+    std::uint8_t actingSeat(const SmallState& state) const;
+
+    /**
+     * @brief Gets the legal actions of the acting seat
+     * @details Depends only on what the acting seat knows, so it is the same
+     * for every state of an information set.
+     */
+    SmallActionMask legalActions(const SmallState& state) const;
+
+    /**
+     * @brief Plays an action of the acting seat
+     * @return The next state; the argument is not changed
+     */
+    SmallState apply(const SmallState& state, SmallAction action) const;
+
+    /**
+     * @brief Packs what a seat sees into the abstract information-set key of CFR
+     * @details Own seat and role, the coins of every seat (in buckets 0,
+     * 1-2, 3-4, 5-6, 7-9, 10+ unless bucketCoins is off), who is in or
+     * sanctioned, who was arrested last, turns left and the pending action.
+     * The history is forgotten, so different histories can share a key.
+     */
+    std::uint64_t abstractKey(const SmallState& state, std::uint8_t seat) const;
+
+    /**
+     * @brief Gets the exact (perfect recall) information-set key of a seat
+     * @details Own seat and role plus the whole public log and its outcomes.
+     */
+    SmallKey infoKey(const SmallState& state, std::uint8_t seat) const;
+
+    /**
+     * @brief Gets the exact key of a state: every role plus the public log
+     */
+    SmallKey historyKey(const SmallState& state) const;
+
+private:
+    /**
+     * @brief Moves to the next living seat's turn and starts it
+     */
+    void endTurn(SmallState& state, SmallAction action, std::uint8_t blockedBy, std::uint8_t observed) const;
+
+    /**
+     * @brief Carries out an action that was not blocked
+     * @return What the coins revealed, the turn's outcome bits
+     */
+    std::uint8_t perform(SmallState& state, SmallAction action) const;
+
+    /**
+     * @brief Gets the next seat after 'after' that may block the pending action
+     * @return Seat, or NO_SEAT if nobody else may
+     */
+    std::uint8_t nextBlocker(const SmallState& state, std::uint8_t after) const;
+
+    SmallConfig settings; ///< Parameters
+};
+
+/**
+ * @brief A fixed strategy for small games
+ */
+class SmallPolicy {
+public:
+    virtual ~SmallPolicy() = default;
+
+    /**
+     * @brief Gets the probability of each action of the acting seat
+     * @param game The game being played
+     * @param state Current state; only what the acting seat sees may be used
+     * @param legal Legal actions
+     * @param out Receives probabilities summing to 1 over the legal actions
+     */
+    virtual void probabilities(const SmallGame& game, const SmallState& state, SmallActionMask legal,
+                               std::array<float, SMALL_ACTIONS>& out) const = 0;
+};
+
+/**
+ * @brief Plays every legal action with the same probability
+ */
+class UniformPolicy : public SmallPolicy {
+public:
+    void probabilities(const SmallGame& game, const SmallState& state, SmallActionMask legal,
+                       std::array<float, SMALL_ACTIONS>& out) const override;
+};
+
+/**
+ * @brief Coups when it can, otherwise takes the most coins it can; never blocks
+ */
+class GreedyPolicy : public SmallPolicy {
+public:
+    void probabilities(const SmallGame& game, const SmallState& state, SmallActionMask legal,
+                       std::array<float, SMALL_ACTIONS>& out) const override;
+};
+
+/**
+ * @brief Computes the exact expected score of every seat
+ * @param game The game
+ * @param seats Policy of each seat
+ * @return One expected score per seat, averaged over all deals
+ */
+std::vector<double> expectedUtilities(const SmallGame& game, const std::vector<const SmallPolicy*>& seats);
+
+} // namespace coup
@@ -0,0 +1,113 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+#include "TableFeed.hpp"
+
+namespace coup {
+
+    /**
+     * @brief Window showing many games at once as a grid of compact tiles
+     * @details Each tile shows a table's treasury, the coins of every seat and
+     * the last action. Tiles are built only from the TableFeed event streams.
+     *
+     * Rendering is batched and incremental:
+     * - tiles live in an off-screen atlas texture that persists across frames
+     * - only tiles whose TableState is dirty are redrawn into the atlas, with
+     *   the quads of all dirty tiles submitted in a single draw call
+     * - each frame presents the whole wall with one sprite draw
+     *
+     * An idle wall therefore costs one textured quad per frame no matter how
+     * many tables it shows.
+     */
+    class SpectatorWall {
+    private:
+        static const int WINDOW_WIDTH = 1600; ///< Wall window width in pixels
+        static const int WINDOW_HEIGHT = 900; ///< Wall window height in pixels
+        static const int TILE_PADDING = 4; ///< Gap between neighbouring tiles
+
+        /**
+         * @brief Cached text objects of one tile
+         */
+        struct TileTexts {
+            sf::Text header; ///< Table number and treasury
+            sf::Text seats; ///< Coins per seat
+            sf::Text lastAction; ///< Latest action or the winner
+        };
+
+        sf::RenderWindow window; ///< SFML window for rendering
+        TableFeed& feed; ///< Event source for every table
+        sf::Font font; ///< Font for text rendering
+
+        std::vector<TableState> states; ///< Display state per table
+        std::vector<TileTexts> texts; ///< Text objects per table
+        std::size_t columns; ///< Tiles per row
+        float tileWidth; ///< Tile width in pixels
+        float tileHeight; ///< Tile height in pixels
+
+        sf::RenderTexture atlas; ///< Persistent image of the whole wall
+        sf::Sprite atlasSprite; ///< Presents the atlas in one draw
+        sf::VertexArray geometry; ///< Batched quads of the tiles being redrawn
+        std::vector<std::size_t> redrawList; ///< Dirty tiles collected this frame
+
+        /**
+         * @brief Loads the font used by the tiles
+         * @return true if a font was found
+         */
+        bool loadAssets();
+
+        /**
+         * @brief Processes SFML events (window close, Escape)
+         */
+        void handleEvents();
+
+        /**
+         * @brief Applies every waiting event to the table states
+         */
+        void drainFeed();
+
+        /**
+         * @brief Redraws the dirty tiles into the atlas
+         */
+        void redrawDirtyTiles();
+
+        /**
+         * @brief Appends the quads of one tile to geometry
+         * @param tile Table index
+         */
+        void appendTileGeometry(std::size_t tile);
+
+        /**
+         * @brief Refreshes the cached strings of one tile
+         * @param tile Table index
+         */
+        void updateTileTexts(std::size_t tile);
+
+        /**
+         * @brief Appends one axis-aligned rectangle to geometry
+         */
+        void appendQuad(float x, float y, float width, float height, const sf::Color& color);
+
+    public:
+        /**
+         * @brief Opens the wall for a feed
+         * @param feed Tables to show; must outlive the wall
+         * @throws std::runtime_error if no font can be loaded
+         */
+        explicit SpectatorWall(TableFeed& feed);
+
+        /**
+         * @brief Main loop - runs until the window is closed
+         */
+        void run();
+
+        /**
+         * @brief Presents the atlas after bringing dirty tiles up to date
+         */
+        void render();
+    };
+}
@@ -0,0 +1,211 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ActionHistory.hpp"
+#include "Concurrent.hpp"
+#include "GameController.hpp"
+#include "GameRecord.hpp"
+
+namespace coup {
+
+/**
+ * @brief Source of event streams for several tables at once
+ * @details Frontends that watch many games (the spectator wall) read each
+ * table only through its ActionRecord stream, never through a Game, so the
+ * same view works for live games (LiveTables) and replays (ReplayTables).
+ */
+class TableFeed {
+public:
+    virtual ~TableFeed() = default;
+
+    /**
+     * @brief Gets the number of tables in the feed
+     */
+    virtual std::size_t tableCount() const = 0;
+
+    /**
+     * @brief Gets the display name of a seat at a table
+     * @param table Table index
+     * @param seat Seat index
+     */
+    virtual std::string seatName(std::size_t table, std::uint8_t seat) const = 0;
+
+    /**
+     * @brief Takes the next event of a table
+     * @param table Table index
+     * @param record Receives the event
+     * @return false if the table has no event waiting
+     */
+    virtual bool poll(std::size_t table, ActionRecord& record) = 0;
+};
+
+/**
+ * @brief Compact state of one table, rebuilt purely from its events
+ * @details Every record carries the coins of its actor and target and the
+ * treasury after the event, which is all a tile needs to display.
+ */
+struct TableState {
+    std::uint8_t playerCount = 0; ///< Seated players (0 before the first GameStart)
+    std::array<std::uint8_t, MAX_SEATS> coins{}; ///< Coins per seat
+    std::array<bool, MAX_SEATS> active{}; ///< Whether each seat is still in the game
+    std::int16_t treasury = 0; ///< Treasury after the latest event
+    std::uint8_t currentSeat = NO_SEAT; ///< Seat whose turn it is
+    std::uint8_t winnerSeat = NO_SEAT; ///< Winner of the finished game
+    ActionRecord lastAction{}; ///< Latest player action (TurnStart is not an action)
+    bool hasLastAction = false; ///< Whether lastAction is valid
+    std::uint32_t gamesPlayed = 0; ///< Games started at this table
+    bool dirty = true; ///< Set by apply(); cleared by the renderer
+
+    /**
+     * @brief Updates the state with one event and marks it dirty
+     * @param record Event from the table's stream
+     */
+    void apply(const ActionRecord& record);
+};
+
+/**
+ * @brief Plays many headless games at once and streams their events
+ * @details All tables run on one background thread that picks random legal
+ * moves (and random block/pass decisions), one step per table every
+ * stepInterval on average. Finished games restart after restartDelay.
+ * Each table publishes its records through its own SPSC queue; when a queue
+ * is full the table simply pauses, so no event is ever dropped.
+ *
+ * poll() must be called from a single consumer thread.
+ */
+class LiveTables : public TableFeed {
+public:
+    /**
+     * @brief Starts the tables
+     * @param tables Number of tables
+     * @param stepInterval Average time between two moves at one table
+     * @param seed Seed for the move choices (table sizes and roles use it too)
+     */
+    LiveTables(std::size_t tables, std::chrono::milliseconds stepInterval, std::uint32_t seed = 1);
+
+    /**
+     * @brief Stops and joins the worker thread
+     */
+    ~LiveTables() override;
+
+    LiveTables(const LiveTables&) = delete;
+    LiveTables& operator=(const LiveTables&) = delete;
+
+    std::size_t tableCount() const override { return tables.size(); }
+    std::string seatName(std::size_t table, std::uint8_t seat) const override;
+    bool poll(std::size_t table, ActionRecord& record) override;
+
+    /**
+     * @brief Maximum moves before an undecided game is abandoned and restarted
+     */
+    static constexpr std::uint32_t MAX_GAME_STEPS = 2000;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief One table: its game, its outgoing events and its schedule
+     */
+    struct Table {
+        std::unique_ptr<GameController> controller; ///< Current game
+        SpscQueue<ActionRecord, 1024> events; ///< Worker -> consumer
+        std::vector<ActionRecord> pending; ///< Records not yet pushed to events
+        Clock::time_point nextStep; ///< When the table moves next
+        std::uint32_t steps = 0; ///< Moves made in the current game
+    };
+
+    std::vector<std::unique_ptr<Table>> tables; ///< All tables
+    std::chrono::milliseconds stepInterval; ///< Average delay between moves
+    std::chrono::milliseconds restartDelay; ///< Pause after a game ends
+    std::mt19937 rng; ///< Move choices, used only by the worker
+    std::atomic<bool> running; ///< Cleared to stop the worker
+    std::mutex wakeMutex; ///< Only used to sleep/wake the worker
+    std::condition_variable wake; ///< Signalled on shutdown
+    std::thread worker; ///< Thread playing all tables
+
+    /**
+     * @brief Worker loop: step every table that is due, then sleep
+     */
+    void run();
+
+    /**
+     * @brief Seats a fresh random game at a table
+     */
+    void newGame(Table& table);
+
+    /**
+     * @brief Makes one random decision at a table
+     */
+    void step(Table& table);
+
+    /**
+     * @brief Moves a table's pending records into its queue
+     * @return true if everything was pushed
+     */
+    bool flush(Table& table);
+
+    /**
+     * @brief Gets a randomized delay around interval so tables do not tick in lockstep
+     */
+    Clock::duration jitter(std::chrono::milliseconds interval);
+};
+
+/**
+ * @brief Plays recorded games back as event streams, one table per record
+ * @details Every record is replayed once when the feed is built, keeping its
+ * events and where each move's events end. poll() then releases one move's
+ * events at a time, every stepInterval on average, so no thread is needed.
+ * A finished record starts over after restartDelay.
+ *
+ * poll() must be called from a single consumer thread.
+ */
+class ReplayTables : public TableFeed {
+public:
+    /**
+     * @brief Replays the records
+     * @param records One recorded game per table
+     * @param stepInterval Average time between two moves at one table
+     * @param seed Seed for the delays between moves
+     * @throws GameException if a record cannot be replayed
+     */
+    ReplayTables(const std::vector<GameRecord>& records, std::chrono::milliseconds stepInterval,
+                 std::uint32_t seed = 1);
+
+    std::size_t tableCount() const override { return tables.size(); }
+    std::string seatName(std::size_t table, std::uint8_t seat) const override;
+    bool poll(std::size_t table, ActionRecord& record) override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief One replayed game and how far it has been played back
+     */
+    struct Table {
+        std::vector<SeatRecord> seats; ///< Recorded seats, for the names
+        std::vector<ActionRecord> events; ///< Every event of the game
+        std::vector<std::size_t> moveEnd; ///< moveEnd[p]: events emitted by the first p moves
+        std::size_t moves = 0; ///< Moves released so far
+        std::size_t next = 0; ///< Next event handed out by poll()
+        Clock::time_point nextStep; ///< When the next move is released
+    };
+
+    std::vector<Table> tables; ///< All tables
+    std::chrono::milliseconds stepInterval; ///< Average delay between moves
+    std::chrono::milliseconds restartDelay; ///< Pause before a finished game starts over
+    std::mt19937 rng; ///< Delays between moves
+};
+
+} // namespace coup
@@ -0,0 +1,146 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+/**
+ * @brief Text attributes of a terminal cell, mirroring the GUI colours
+ */
+enum class CellStyle : std::uint8_t {
+    Normal,    ///< Default colours
+    Bold,      ///< Bold default colour (current turn, titles)
+    Dim,       ///< Faint (disabled actions, eliminated players)
+    Highlight, ///< Bold yellow (treasury, current player)
+    Title,     ///< Bold cyan (panel titles)
+    Error,     ///< Bold red (error messages)
+    Good,      ///< Green (continue, winner)
+    Inverse    ///< Reversed colours (popups, input line)
+};
+
+/**
+ * @brief Double-buffered character grid that emits only what changed
+ * @details Frontends draw a complete frame into the back buffer with clear()
+ * and put(); flush() then compares it with what the terminal is known to show
+ * and returns the ANSI escape sequences for the changed span of each row.
+ * An unchanged frame produces no output at all, so redrawing on every input
+ * costs almost nothing over a slow SSH link.
+ */
+class TerminalScreen {
+public:
+    /**
+     * @brief Creates a screen of the given size
+     * @param rows Number of rows (at least 1)
+     * @param cols Number of columns (at least 1)
+     */
+    TerminalScreen(int rows, int cols);
+
+    /**
+     * @brief Changes the size; the next flush() repaints everything
+     */
+    void resize(int rows, int cols);
+
+    /**
+     * @brief Gets the number of rows
+     */
+    int rows() const { return rowCount; }
+
+    /**
+     * @brief Gets the number of columns
+     */
+    int cols() const { return colCount; }
+
+    /**
+     * @brief Blanks the back buffer
+     */
+    void clear();
+
+    /**
+     * @brief Writes text into the back buffer
+     * @param row Row (0 is the top); rows outside the screen are ignored
+     * @param col Column where the text starts; text beyond the edge is clipped
+     * @param text ASCII text; other bytes are shown as '?'
+     * @param style Attributes for every written cell
+     */
+    void put(int row, int col, const std::string& text, CellStyle style = CellStyle::Normal);
+
+    /**
+     * @brief Fills a rectangle of the back buffer with spaces of one style
+     */
+    void fill(int row, int col, int height, int width, CellStyle style);
+
+    /**
+     * @brief Gets the character in the back buffer at a cell (' ' outside)
+     */
+    char at(int row, int col) const;
+
+    /**
+     * @brief Forgets what the terminal shows; the next flush() repaints everything
+     */
+    void invalidate() { fullRedraw = true; }
+
+    /**
+     * @brief Produces the output that updates the terminal to the back buffer
+     * @return Escape sequences and text to write to the terminal, empty if
+     * nothing changed since the previous flush
+     */
+    std::string flush();
+
+private:
+    /**
+     * @brief One character cell
+     */
+    struct Cell {
+        char ch = ' '; ///< Printable ASCII character
+        CellStyle style = CellStyle::Normal; ///< Attributes
+
+        bool operator==(const Cell& other) const { return ch == other.ch && style == other.style; }
+        bool operator!=(const Cell& other) const { return !(*this == other); }
+    };
+
+    int rowCount; ///< Height in cells
+    int colCount; ///< Width in cells
+    std::vector<Cell> front; ///< What the terminal currently shows
+    std::vector<Cell> back; ///< Frame being drawn
+    bool fullRedraw; ///< Whether front is unknown
+};
+
+/**
+ * @brief A key press decoded from terminal input
+ */
+struct TerminalKey {
+    /**
+     * @brief Key category
+     */
+    enum class Kind : std::uint8_t {
+        Char,      ///< Printable character in ch
+        Enter,
+        Backspace,
+        Tab,
+        Escape,
+        Up,
+        Down,
+        PageUp,
+        PageDown,
+        Interrupt  ///< Ctrl-C or Ctrl-D
+    };
+
+    Kind kind = Kind::Char; ///< What was pressed
+    char ch = 0; ///< Character for Kind::Char
+};
+
+/**
+ * @brief Decodes raw terminal input into key presses
+ * @param bytes Bytes read from a terminal in raw mode
+ * @param keys Receives the decoded keys (appended)
+ * @details Understands the VT100/xterm sequences for the arrow and page keys;
+ * other escape sequences are skipped. An ESC that ends the input is a lone
+ * Escape key press.
+ */
+void decodeTerminalKeys(const std::string& bytes, std::vector<TerminalKey>& keys);
+
+} // namespace coup
@@ -0,0 +1,199 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ActionHistory.hpp"
+#include "EngineThread.hpp"
+#include "Game.hpp"
+#include "GameSnapshot.hpp"
+#include "TerminalScreen.hpp"
+
+namespace coup {
+
+/**
+ * @brief Text frontend for the Coup card game running in an ANSI terminal
+ * @details Mirrors the GUI: player list, treasury, current turn, action
+ * history, the role's action menu, target selection, block decisions and the
+ * elimination/winner popups. Like the GUI it only turns key presses into
+ * EngineThread commands and draws the latest GameSnapshot.
+ *
+ * Nothing is loaded at startup (no window, font or GL context), so it starts
+ * instantly and works over SSH. Each frame is drawn into a TerminalScreen
+ * whose flush() sends only the cells that changed; frames are only built when
+ * input, the snapshot, the terminal size or a timer changed something.
+ *
+ * Keys: digits choose an action, then a target; in a block phase, digits
+ * block for a listed player and 'c' continues. Tab adds a bot during setup.
+ * PgUp/PgDn (or the arrow keys) scroll the history, Esc cancels target
+ * selection, and 'q' or Ctrl-C quits.
+ */
+class TerminalUI {
+public:
+    static const int MIN_ROWS = 24; ///< Smallest usable terminal height
+    static const int MIN_COLS = 80; ///< Smallest usable terminal width
+
+    /**
+     * @brief Constructs the frontend with a game instance
+     * @param game Game to play; handed over to the engine thread and made
+     * silent, since console logging would scroll the screen
+     */
+    explicit TerminalUI(std::shared_ptr<Game> game);
+
+    /**
+     * @brief Runs until the user quits
+     * @throws GameException if standard input or output is not a terminal
+     * @details Switches the terminal to raw mode and the alternate screen and
+     * restores it on return, including when an exception escapes.
+     */
+    void run();
+
+    /**
+     * @brief Pulls the latest engine snapshot and events into the frontend
+     * @return true if something visible changed
+     */
+    bool update();
+
+    /**
+     * @brief Handles one key press
+     */
+    void handleKey(const TerminalKey& key);
+
+    /**
+     * @brief Draws the current state into the screen's back buffer
+     */
+    void render();
+
+    /**
+     * @brief Gets the screen frames are drawn into
+     */
+    TerminalScreen& getScreen() { return screen; }
+
+    /**
+     * @brief Checks whether the user asked to quit
+     */
+    bool quitRequested() const { return quit; }
+
+private:
+    using Clock = std::chrono::steady_clock; ///< Clock for message and popup timers
+
+    static const int MESSAGE_SECONDS = 3; ///< How long messages and popups stay up
+
+    EngineThread engine; ///< Game engine running on its own thread
+    const GameSnapshot* view; ///< Snapshot drawn this frame (owned by engine)
+    TerminalScreen screen; ///< Frame buffer with diffed output
+    bool quit; ///< Set by 'q' or Ctrl-C
+
+    // Local UI state
+    std::vector<std::string> actionNames; ///< Menu of the current player's role
+    std::string currentInput; ///< Name being typed during setup
+    bool isSelectingTarget; ///< Whether waiting for a target
+    ActionType pendingAction; ///< Action waiting for a target
+    std::string message; ///< Latest engine or local message
+    Clock::time_point messageTime; ///< When message was set
+
+    // Action history
+    ActionHistory actionHistory; ///< Recent game events as compact records
+    std::size_t historyScroll; ///< Lines scrolled back from the newest record
+    std::uint8_t namedSeats; ///< Seats whose names were given to actionHistory
+
+    // Change tracking against the engine snapshot
+    std::uint64_t lastVersion; ///< Snapshot version the menu was built from
+    std::uint32_t lastMessageCount; ///< Last engine message shown
+    std::uint32_t lastEliminationCount; ///< Last elimination shown
+    bool lastBotThinking; ///< Bot activity shown in the last frame
+
+    // Popups
+    std::string eliminatedPlayerName; ///< Name in the elimination popup
+    Clock::time_point eliminationTime; ///< When the elimination popup opened
+    bool showEliminationPopup; ///< Whether the elimination popup is up
+    std::string winnerName; ///< Winner once the game is over
+
+    /**
+     * @brief Rebuilds the action menu for the current player's role
+     */
+    void createMenu();
+
+    /**
+     * @brief Moves events published by the engine into the action history
+     * @return true if any event arrived
+     */
+    bool drainEngineEvents();
+
+    /**
+     * @brief Shows a message for MESSAGE_SECONDS
+     */
+    void showMessage(const std::string& text);
+
+    /**
+     * @brief Drops the message and elimination popup once they expired
+     * @return true if something was hidden
+     */
+    bool expireTimers();
+
+    /**
+     * @brief Handles keys during player setup
+     */
+    void handleSetupKey(const TerminalKey& key);
+
+    /**
+     * @brief Handles a digit during play (action, target or blocker)
+     */
+    void handleChoice(int choice);
+
+    /**
+     * @brief Scrolls the history panel
+     * @param lines Positive to scroll back in time, negative towards newest
+     */
+    void scrollHistory(int lines);
+
+    /**
+     * @brief Number of history lines that fit on the screen
+     */
+    std::size_t historyLines() const;
+
+    /**
+     * @brief Draws the setup prompt and the seated players
+     */
+    void renderSetup();
+
+    /**
+     * @brief Draws the player list
+     */
+    void renderPlayers();
+
+    /**
+     * @brief Draws the block decision for the pending action
+     * @param row First row to use
+     */
+    void renderBlockPhase(int row);
+
+    /**
+     * @brief Draws the action history panel
+     * @details Only the visible records are formatted.
+     */
+    void renderHistory();
+
+    /**
+     * @brief Draws the action menu and key help at the bottom
+     */
+    void renderMenu();
+
+    /**
+     * @brief Draws the winner/elimination popups
+     */
+    void renderPopups();
+
+    /**
+     * @brief Gets the human blockers of the pending action in display order
+     */
+    std::vector<std::uint8_t> humanBlockers() const;
+
+    bool isSetupPhase() const { return view->phase == GamePhase::Setup; }
+};
+
+} // namespace coup
@@ -0,0 +1,86 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace coup {
+
+/**
+ * @brief Fixed set of worker threads running submitted jobs
+ * @details Used for work that is too slow for the engine or render threads,
+ * such as bot searches. Jobs are taken in submission order by whichever
+ * worker is free, so independent jobs run in parallel. The queue is guarded
+ * by a mutex; jobs are expected to be coarse (milliseconds), so the lock is
+ * never the bottleneck.
+ */
+class ThreadPool {
+public:
+    using Job = std::function<void()>; ///< Unit of work
+
+    /**
+     * @brief Starts the workers
+     * @param threads Number of workers; 0 picks one less than the hardware
+     * thread count (at least 1) so the frontend keeps a core
+     */
+    explicit ThreadPool(std::size_t threads = 0);
+
+    /**
+     * @brief Discards jobs that have not started and joins the workers
+     * @details Jobs already running are allowed to finish.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queues a job
+     * @param job Work to run on a worker thread; exceptions it throws are dropped
+     */
+    void submit(Job job);
+
+    /**
+     * @brief Gets the number of worker threads
+     */
+    std::size_t size() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers; ///< Worker threads
+    std::deque<Job> jobs; ///< Jobs waiting for a worker
+    std::mutex mutex; ///< Guards jobs and stopping
+    std::condition_variable available; ///< Signalled when a job is queued or on shutdown
+    bool stopping; ///< Set by the destructor
+
+    /**
+     * @brief Worker loop: take jobs until stopping
+     */
+    void run();
+};
+
+/**
+ * @brief Gets how many threads a batch run should use
+ * @param requested Threads asked for; 0 means one per hardware thread
+ * @param work Independent pieces of work; more threads than that would idle
+ * @return Between 1 and max(work, 1)
+ */
+unsigned workerCount(unsigned requested, std::uint64_t work);
+
+/**
+ * @brief Runs body(slot) for every slot from 0 to threads - 1 and waits for all of them
+ * @details Slot 0 runs on the calling thread and the others on threads of
+ * their own, started for this call only. Batch runs (simulation, matches,
+ * self-play, CFR, best responses, distillation) hand each slot its own
+ * counters and merge them afterwards. If a slot throws, the others still
+ * run to completion and the first exception is rethrown here.
+ */
+void runOnThreads(unsigned threads, const std::function<void(unsigned)>& body);
+
+} // namespace coup
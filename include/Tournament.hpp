@@ -0,0 +1,194 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Bot.hpp"
+
+namespace coup {
+
+/**
+ * @brief Outcome of a sequential probability ratio test
+ */
+enum class SprtDecision : std::uint8_t {
+    Continue,  ///< Not decided yet; keep playing
+    AcceptH0,  ///< The difference is at most elo0
+    AcceptH1   ///< The difference is at least elo1
+};
+
+/**
+ * @brief Gets the display name of an SPRT decision ("continue", "H0", "H1")
+ */
+const char* sprtDecisionName(SprtDecision decision);
+
+/**
+ * @brief Sequential probability ratio test on win/draw/loss counts
+ * @details Tests H0: the candidate is elo0 stronger against H1: it is elo1
+ * stronger. Each game is a Bernoulli trial on the candidate's score, with a
+ * draw (a game cut off without a winner) counting as half a win and half a
+ * loss:
+ *
+ *     LLR = (W + D/2) log(s1 / s0) + (L + D/2) log((1 - s1) / (1 - s0))
+ *
+ * where s0 and s1 are the expected scores of the two hypotheses. The test
+ * stops once LLR leaves [log(beta / (1 - alpha)), log((1 - beta) / alpha)].
+ * Results can be added at any time, so a caller checks after every batch.
+ */
+class SprtTest {
+public:
+    /**
+     * @param elo0 Elo difference of H0
+     * @param elo1 Elo difference of H1 (must differ from elo0)
+     * @param alpha Probability of accepting H1 when H0 holds
+     * @param beta Probability of accepting H0 when H1 holds
+     * @throws GameException if the parameters are out of range
+     */
+    SprtTest(double elo0 = 0.0, double elo1 = 50.0, double alpha = 0.05, double beta = 0.05);
+
+    /**
+     * @brief Adds game results from the candidate's point of view
+     */
+    void add(std::uint64_t wins, std::uint64_t draws, std::uint64_t losses);
+
+    /**
+     * @brief Gets the current log-likelihood ratio (0 before any decisive game)
+     */
+    double llr() const;
+
+    /**
+     * @brief Gets the lower stopping bound (accept H0 at or below it)
+     */
+    double lowerBound() const { return lower; }
+
+    /**
+     * @brief Gets the upper stopping bound (accept H1 at or above it)
+     */
+    double upperBound() const { return upper; }
+
+    /**
+     * @brief Checks the ratio against the bounds
+     */
+    SprtDecision decision() const;
+
+    std::uint64_t wins() const { return winCount; }
+    std::uint64_t draws() const { return drawCount; }
+    std::uint64_t losses() const { return lossCount; }
+    std::uint64_t games() const { return winCount + drawCount + lossCount; }
+
+    /**
+     * @brief Estimates the Elo difference from the score so far
+     * @param low Receives the lower end of the 95% interval
+     * @param high Receives the upper end of the 95% interval
+     * @return Estimated difference; scores of 0 or 1 are clamped to +-1000
+     */
+    double eloEstimate(double& low, double& high) const;
+
+private:
+    double score0; ///< Expected score under H0
+    double score1; ///< Expected score under H1
+    double lower; ///< log(beta / (1 - alpha))
+    double upper; ///< log((1 - beta) / alpha)
+    std::uint64_t winCount; ///< Candidate wins
+    std::uint64_t drawCount; ///< Games without a winner
+    std::uint64_t lossCount; ///< Candidate losses
+};
+
+/**
+ * @brief Parameters of a bot-vs-bot match
+ */
+struct TournamentConfig {
+    std::string candidate = "montecarlo:32"; ///< Bot type under test (see createBot)
+    std::string baseline = "random"; ///< Bot type it is compared with
+    std::uint32_t seed = 1; ///< Base seed; pair i always plays the same way
+    unsigned threads = 0; ///< Worker threads, 0 for one per hardware thread
+    std::uint32_t batchPairs = 32; ///< Game pairs between SPRT checks
+    std::uint64_t maxGames = 20000; ///< Give up undecided after this many games
+    std::uint32_t stepLimit = 2000; ///< Moves after which a game is a draw
+    double elo0 = 0.0; ///< SPRT H0
+    double elo1 = 50.0; ///< SPRT H1
+    double alpha = 0.05; ///< SPRT false positive rate
+    double beta = 0.05; ///< SPRT false negative rate
+    RuleSet rules; ///< Rules both games of every pair are played by
+};
+
+/**
+ * @brief Result of a match
+ */
+struct TournamentResult {
+    SprtTest sprt; ///< Final counts and ratio
+    SprtDecision decision = SprtDecision::Continue; ///< Continue means maxGames ran out
+    std::uint32_t batches = 0; ///< SPRT checks made
+    double seconds = 0.0; ///< Wall time
+};
+
+/**
+ * @brief Called for every bot decision, before the move is applied
+ * @details Receives the position, the deciding seat and its answer. Each
+ * blocker asked in a block phase is a decision of its own. Actions the
+ * engine is going to reject are not reported.
+ */
+using DecisionHook = std::function<void(const GameController&, std::uint8_t seat, const RecordedMove& move)>;
+
+/**
+ * @brief Plays one game between bots, one per seat
+ * @param deal Seating and rules of the game
+ * @param players Bot deciding for each seat (same order as deal.seats)
+ * @param stepLimit Moves after which the game is cut off
+ * @param eliminations If given, receives for each seat when it was couped
+ * out (1 for the first player out, 2 for the next, ...) or 0 if it was still
+ * in at the end
+ * @param onDecision If set, sees every legal decision as it is made
+ * @return Winning seat, or NO_SEAT if the step limit was reached
+ * @details Bots decide on the calling thread with no time limit. Blockers are
+ * asked in seat order and the first to block decides.
+ */
+std::uint8_t playBotGame(const GameRecord& deal, const std::vector<Bot*>& players, std::uint32_t stepLimit,
+                         std::vector<std::uint32_t>* eliminations = nullptr,
+                         const DecisionHook& onDecision = DecisionHook());
+
+/**
+ * @brief Turns elimination order into finishing places
+ * @param eliminations As filled by playBotGame()
+ * @return Place of each seat, 0 for first; seats still in share a place
+ */
+std::vector<std::uint32_t> finishingPlaces(const std::vector<std::uint32_t>& eliminations);
+
+/**
+ * @brief Checks that a bot type can play without a time limit
+ * @throws GameException if the type is unknown, or a Monte Carlo bot has no
+ * playout cap (it would never return)
+ */
+void checkMatchBot(const std::string& type);
+
+/**
+ * @brief Plays one pair of heads-up games with the seats swapped
+ * @param config Bots, seed and step limit
+ * @param index Pair number; with the seed it fixes the deal and the bots' seeds
+ * @param wins Incremented for each game the candidate wins
+ * @param draws Incremented for each game that hits the step limit
+ * @param losses Incremented for each game the baseline wins
+ * @details Both games deal the same roles to the same seats, so neither bot
+ * profits from a lucky deal; only the seating changes. Bots decide on the
+ * calling thread with no time limit, so capped bots play identically on
+ * any machine.
+ */
+void playMatchPair(const TournamentConfig& config, std::uint64_t index,
+                   std::uint64_t& wins, std::uint64_t& draws, std::uint64_t& losses);
+
+/**
+ * @brief Plays pairs in parallel batches until the SPRT decides
+ * @param config Bots, hypotheses and limits
+ * @return Counts, final ratio and decision
+ * @throws GameException if a bot type or SPRT parameter is invalid, or a
+ * Monte Carlo bot has no playout cap
+ * @details After every batch the per-thread counts are merged and the test is
+ * checked, so a clear difference stops after a few batches instead of a game
+ * count fixed up front. The result depends only on the configuration, not on
+ * the number of threads.
+ */
+TournamentResult runTournament(const TournamentConfig& config);
+
+} // namespace coup
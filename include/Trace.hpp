@@ -0,0 +1,164 @@
+//meirshuker159@gmail.com
+
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace coup {
+
+/**
+ * @brief Whether trace spans were compiled in (-DCOUP_TRACE)
+ * @details Without it TraceSpan and TraceQuiet are empty and every span
+ * compiles to nothing; starting a trace still works and dumps no spans.
+ */
+#ifdef COUP_TRACE
+constexpr bool TRACE_ENABLED = true;
+#else
+constexpr bool TRACE_ENABLED = false;
+#endif
+
+/**
+ * @brief Spans kept per thread; older ones are overwritten
+ */
+constexpr std::size_t TRACE_SPANS_PER_THREAD = std::size_t{1} << 15;
+
+/**
+ * @brief Starts recording spans, dropping the ones recorded before
+ */
+void startTracing();
+
+/**
+ * @brief Stops recording spans; the recorded ones stay until the next startTracing()
+ */
+void stopTracing();
+
+/**
+ * @brief Writes the spans of every thread, live and exited, as Chrome trace JSON
+ * @details The trace-event format read by chrome://tracing and ui.perfetto.dev:
+ * one complete ("X") event per span, with microsecond timestamps counted
+ * from startTracing() and thread_name metadata for each thread. Can be
+ * called while threads keep recording; a span being written at that moment
+ * is skipped instead of waited for.
+ * @return Number of spans written
+ */
+std::size_t writeTraceJson(std::ostream& out);
+
+/**
+ * @brief Writes writeTraceJson() to a file
+ * @return Number of spans written
+ * @throws GameException if the file cannot be written
+ */
+std::size_t writeTraceFile(const std::string& path);
+
+/**
+ * @brief Recording functions behind TraceSpan
+ * @details Each thread writes into a ring buffer of its own, allocated the
+ * first time it records while tracing is on and handed to a later thread
+ * when it exits. A slot carries a sequence number that is odd while the
+ * slot is being written, so the writer never waits and a dump just skips
+ * slots that change under it. With tracing off, a span is one relaxed load.
+ */
+namespace trace {
+
+/**
+ * @brief Set while spans are recorded (use active())
+ */
+extern std::atomic<bool> recording;
+
+/**
+ * @brief Checks whether spans are being recorded
+ */
+inline bool active() {
+    return recording.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Names the calling thread in traces (e.g. "engine")
+ * @details Keeps the first 31 characters. Threads that never call it are
+ * named "thread N".
+ */
+void setThreadName(const char* name);
+
+/**
+ * @brief Reads the clock spans are timed with, in nanoseconds
+ */
+std::uint64_t clockNanos();
+
+/**
+ * @brief Records a finished span of the calling thread
+ * @param name Span name; must outlive the trace (a string literal)
+ * @param category Span category; must outlive the trace (a string literal)
+ */
+void record(const char* name, const char* category, std::uint64_t startNanos, std::uint64_t endNanos);
+
+/**
+ * @brief Number of TraceQuiet scopes open on the calling thread
+ */
+extern thread_local unsigned quietDepth;
+
+} // namespace trace
+
+#ifdef COUP_TRACE
+
+/**
+ * @brief Records the time between its construction and destruction as a span
+ * @details Does nothing, not even read the clock, unless tracing was on when
+ * it was constructed and no TraceQuiet is open on the thread.
+ *
+ *     TraceSpan span("Game::next_turn", "engine");
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category)
+        : name(name), category(category),
+          start(trace::active() && trace::quietDepth == 0 ? trace::clockNanos() : 0) {}
+    ~TraceSpan() {
+        if (start != 0) {
+            trace::record(name, category, start, trace::clockNanos());
+        }
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name; ///< Span name
+    const char* category; ///< Span category
+    std::uint64_t start; ///< Clock reading at construction, 0 if not recording
+};
+
+/**
+ * @brief Drops the spans the calling thread opens while it is alive
+ * @details Bot searches hold one so the thousands of simulated moves inside
+ * a search do not flood the trace; the search itself is still one span.
+ */
+class TraceQuiet {
+public:
+    TraceQuiet() { ++trace::quietDepth; }
+    ~TraceQuiet() { --trace::quietDepth; }
+    TraceQuiet(const TraceQuiet&) = delete;
+    TraceQuiet& operator=(const TraceQuiet&) = delete;
+};
+
+#else
+
+class TraceSpan {
+public:
+    TraceSpan(const char*, const char*) {}
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+class TraceQuiet {
+public:
+    TraceQuiet() {}
+    TraceQuiet(const TraceQuiet&) = delete;
+    TraceQuiet& operator=(const TraceQuiet&) = delete;
+};
+
+#endif
+
+} // namespace coup
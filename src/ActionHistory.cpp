@@ -0,0 +1,147 @@
+//meirshuker159@gmail.com
+
+#include "ActionHistory.hpp"
+#include <algorithm>
+
+namespace coup {
+
+const char* actionTypeName(ActionType type) {
+    switch (type) {
+        case ActionType::Gather:      return "Gather";
+        case ActionType::Tax:         return "Tax";
+        case ActionType::Bribe:       return "Bribe";
+        case ActionType::Arrest:      return "Arrest";
+        case ActionType::Sanction:    return "Sanction";
+        case ActionType::Coup:        return "Coup";
+        case ActionType::Invest:      return "Invest";
+        case ActionType::Investigate: return "Investigate";
+        case ActionType::BlockArrest: return "Block Arrest";
+        case ActionType::EndTurn:     return "End Turn";
+        case ActionType::Block:       return "Block";
+        case ActionType::TurnStart:   return "Turn Start";
+        case ActionType::GameOver:    return "Game Over";
+        case ActionType::GameStart:   return "Game Start";
+    }
+    return "Unknown";
+}
+
+bool parseActionType(const std::string& name, ActionType& out) {
+    for (std::uint8_t i = 0; i <= static_cast<std::uint8_t>(ActionType::GameStart); ++i) {
+        if (name == actionTypeName(static_cast<ActionType>(i))) {
+            out = static_cast<ActionType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Constructs the history with all record storage allocated up front
+ * @details The ring never grows after construction. The spill file is opened
+ * in truncate mode so each session starts a fresh log.
+ */
+ActionHistory::ActionHistory(std::size_t capacity, const std::string& spillPath)
+    : ring(std::max<std::size_t>(capacity, 1)), head(0), count(0), nextSeq(0), seatNames(), spill() {
+    if (!spillPath.empty()) {
+        spill.open(spillPath, std::ios::out | std::ios::trunc);
+    }
+}
+
+void ActionHistory::setSeatName(std::uint8_t seat, const std::string& name) {
+    if (seat < MAX_SEATS) {
+        seatNames[seat] = name;
+    }
+}
+
+/**
+ * @brief Stores a record in the ring and appends it to the spill file
+ * @details O(1): writes into the slot after the newest record, overwriting
+ * the oldest one once the ring is full.
+ */
+void ActionHistory::push(ActionRecord record) {
+    record.seq = nextSeq++;
+    ring[head] = record;
+    head = (head + 1) % ring.size();
+    if (count < ring.size()) {
+        count++;
+    }
+    if (spill.is_open()) {
+        spill << format(record) << '\n';
+    }
+}
+
+void ActionHistory::clear() {
+    head = 0;
+    count = 0;
+}
+
+const ActionRecord& ActionHistory::fromNewest(std::size_t index) const {
+    return ring[(head + ring.size() - 1 - (index % ring.size())) % ring.size()];
+}
+
+const std::string& ActionHistory::seatName(std::uint8_t seat) const {
+    static const std::string unknown = "?";
+    if (seat >= MAX_SEATS || seatNames[seat].empty()) {
+        return unknown;
+    }
+    return seatNames[seat];
+}
+
+/**
+ * @brief Builds the display text for a record
+ * @details Called only for records that are about to be shown (or spilled),
+ * so the cost of string formatting is independent of the history length.
+ */
+std::string ActionHistory::format(const ActionRecord& record) const {
+    std::string line = "#" + std::to_string(record.seq) + " ";
+    const std::string& actor = seatName(record.actor);
+    switch (record.type) {
+        case ActionType::Gather:
+            line += actor + " gathered (" + std::to_string(record.actorCoins) + " coins)";
+            break;
+        case ActionType::Tax:
+            line += actor + " collected tax (" + std::to_string(record.actorCoins) + " coins)";
+            break;
+        case ActionType::Bribe:
+            line += actor + " bribed for extra actions";
+            break;
+        case ActionType::Arrest:
+            line += actor + " arrested " + seatName(record.target);
+            break;
+        case ActionType::Sanction:
+            line += actor + " sanctioned " + seatName(record.target);
+            break;
+        case ActionType::Coup:
+            line += actor + " couped " + seatName(record.target);
+            break;
+        case ActionType::Invest:
+            line += actor + " invested (" + std::to_string(record.actorCoins) + " coins)";
+            break;
+        case ActionType::Investigate:
+            line += actor + " investigated " + seatName(record.target);
+            break;
+        case ActionType::BlockArrest:
+            line += actor + " blocked " + seatName(record.target) + "'s arrest";
+            break;
+        case ActionType::EndTurn:
+            line += actor + " ended turn";
+            break;
+        case ActionType::Block:
+            line += actor + " blocked " + actionTypeName(static_cast<ActionType>(record.detail)) +
+                    " by " + seatName(record.target);
+            break;
+        case ActionType::TurnStart:
+            line += "--- " + actor + "'s turn ---";
+            break;
+        case ActionType::GameOver:
+            line += actor + " wins the game";
+            break;
+        case ActionType::GameStart:
+            line += "Game started with " + std::to_string(record.detail) + " players";
+            break;
+    }
+    line += " [T:" + std::to_string(record.treasury) + "]";
+    return line;
+}
+
+} // namespace coup
@@ -5,22 +5,54 @@
 #include "Game.hpp"
 #include "Roles.hpp"
 #include "Exceptions.hpp"
-#include <algorithm>
-#include <unordered_map>
-#include <unordered_set>
+#include "Trace.hpp"
 
 namespace coup {
 
+namespace {
+
+/**
+ * @brief Gets the action type of an action name
+ * @details Names that are not actions get Block, which no rule mentions, so
+ * they are checked like before: only the rules that apply to every action.
+ */
+ActionType actionOf(const std::string& name) {
+    ActionType type;
+    return parseActionType(name, type) ? type : ActionType::Block;
+}
+
+} // namespace
+
+const char* validationFailureName(ValidationFailure failure) {
+    switch (failure) {
+        case ValidationFailure::None:           return "none";
+        case ValidationFailure::NoActor:        return "no_actor";
+        case ValidationFailure::MustCoup:       return "must_coup";
+        case ValidationFailure::PlayerInactive: return "player_inactive";
+        case ValidationFailure::GameGone:       return "game_gone";
+        case ValidationFailure::NotYourTurn:    return "not_your_turn";
+        case ValidationFailure::InvalidGame:    return "invalid_game";
+        case ValidationFailure::NotEnoughCoins: return "not_enough_coins";
+        case ValidationFailure::Sanctioned:     return "sanctioned";
+        case ValidationFailure::ArrestBlocked:  return "arrest_blocked";
+        case ValidationFailure::WrongRole:      return "wrong_role";
+        case ValidationFailure::TargetRequired: return "target_required";
+        case ValidationFailure::TargetInactive: return "target_inactive";
+        case ValidationFailure::SelfTarget:     return "self_target";
+        case ValidationFailure::RepeatArrest:   return "repeat_arrest";
+    }
+    return "unknown";
+}
+
 /**
  * @brief Determines if an action is available for a player (simplified check)
- * @details Uses getValidationResult internally to check basic availability
- * without requiring target specification. Used for quick availability checks.
+ * @details Uses the same checks as getValidationResult internally to check basic
+ * availability without requiring target specification. Used for quick availability checks.
  */
 bool ActionValidator::isActionAvailable(const std::string& action, std::shared_ptr<Player> player) {
     if (!player) return false;
     
-    ValidationResult result = getValidationResult(action, player);
-    return result.isValid;
+    return check(actionOf(action), player.get()) == ValidationFailure::None;
 }
 
 /**
@@ -30,36 +62,14 @@ bool ActionValidator::isActionAvailable(const std::string& action, std::shared_p
  * Includes mandatory coup rule enforcement and role-specific restrictions.
  */
 bool ActionValidator::isActionAvailableForButton(const std::string& action, std::shared_ptr<Player> player) {
+    return isActionAvailableForButton(actionOf(action), player.get());
+}
+
+bool ActionValidator::isActionAvailableForButton(ActionType action, const Player* player) {
     if (!player) return false;
     
-    // For button states, we don't check targets - just basic availability
-    if (!player) {
-        return false;
-    }
-    
-    // Check mandatory coup rule first
-    if (player->get_coins() >= 10 && action != "Coup" && action != "End Turn") {
-        return false;
-    }
-    
-    // Check player state
-    ValidationResult playerState = validatePlayerState(player);
-    if (!playerState.isValid) return false;
-    
-    // Check game state
-    ValidationResult gameState = validateGameState(player);
-    if (!gameState.isValid) return false;
-    
-    // Check coin requirements
-    ValidationResult coinCheck = validateCoins(action, player);
-    if (!coinCheck.isValid) return false;
-    
-    // Check role-specific requirements
-    ValidationResult roleCheck = validateRoleSpecificRequirements(action, player);
-    if (!roleCheck.isValid) return false;
-    
     // Don't check target requirements for button availability
-    return true;
+    return checkRules(action, *player) == ValidationFailure::None;
 }
 
 /**
@@ -69,58 +79,74 @@ bool ActionValidator::isActionAvailableForButton(const std::string& action, std:
  * handling for different validation failure scenarios.
  */
 void ActionValidator::validateActionExecution(const std::string& action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target) {
-    ValidationResult result = getValidationResult(action, actor, target);
-    if (!result.isValid) {
-        // Determine the appropriate exception type based on the error message
-        if (result.errorMessage.find("coins") != std::string::npos) {
-            throw NotEnoughCoinsException(result.errorMessage);
-        } else if (result.errorMessage.find("turn") != std::string::npos) {
-            throw NotYourTurnException(result.errorMessage);
-        } else if (result.errorMessage.find("target") != std::string::npos || result.errorMessage.find("Target") != std::string::npos) {
-            throw IllegalTargetException(result.errorMessage);
-        } else if (result.errorMessage.find("game") != std::string::npos || result.errorMessage.find("Game") != std::string::npos) {
-            throw GameException(result.errorMessage);
-        } else {
-            throw IllegalMoveException(result.errorMessage);
-        }
+    validateActionExecution(actionOf(action), actor.get(), target.get());
+}
+
+void ActionValidator::validateActionExecution(ActionType action, const Player* actor, const Player* target) {
+    TraceSpan span("ActionValidator::validateActionExecution", "validation");
+    ValidationFailure failure = check(action, actor, target);
+    if (failure == ValidationFailure::None) {
+        return;
+    }
+    const std::string message = describe(failure, action, actor).errorMessage;
+    // The exception type follows the reason, as the matching Player checks throw it
+    switch (failure) {
+        case ValidationFailure::NotEnoughCoins:
+            throw NotEnoughCoinsException(message);
+        case ValidationFailure::NotYourTurn:
+            throw NotYourTurnException(message);
+        case ValidationFailure::TargetRequired:
+        case ValidationFailure::TargetInactive:
+        case ValidationFailure::SelfTarget:
+            throw IllegalTargetException(message);
+        case ValidationFailure::GameGone:
+        case ValidationFailure::InvalidGame:
+            throw GameException(message);
+        case ValidationFailure::None:
+        case ValidationFailure::NoActor:
+        case ValidationFailure::MustCoup:
+        case ValidationFailure::PlayerInactive:
+        case ValidationFailure::Sanctioned:
+        case ValidationFailure::ArrestBlocked:
+        case ValidationFailure::WrongRole:
+        case ValidationFailure::RepeatArrest:
+            break;
     }
+    throw IllegalMoveException(message);
 }
 
 /**
- * @brief Returns coin cost for specified action using static lookup table
- * @details Uses unordered_map for O(1) lookup performance. Handles base costs,
- * with special cases (like Judge sanction costing 4) handled in validation logic.
- * Returns 0 for unknown actions or free actions.
+ * @brief Returns coin cost for specified action
+ * @details Handles base costs, with special cases (like Judge sanction
+ * costing 4) handled in validation logic. Returns 0 for unknown actions or
+ * free actions.
  */
 int ActionValidator::getActionCost(const std::string& action, [[maybe_unused]] std::shared_ptr<Player> player) {
-    // Use a static map for better performance and organization
-    static const std::unordered_map<std::string, int> actionCosts = {
-        {"Gather", 0},
-        {"Tax", 0},
-        {"Bribe", 4},
-        {"Arrest", 0},
-        {"Coup", 7},
-        {"Investigate", 0},
-        {"Block Arrest", 0},
-        {"End Turn", 0},
-        {"Sanction", 3},  // Default cost, actual validation handles Judge case
-        {"Invest", 3}     // Baron ability
-    };
-    
-    auto it = actionCosts.find(action);
-    return (it != actionCosts.end()) ? it->second : 0;
+    return getActionCost(actionOf(action));
+}
+
+int ActionValidator::getActionCost(ActionType action) {
+    switch (action) {
+        case ActionType::Bribe:    return 4;
+        case ActionType::Coup:     return 7;
+        case ActionType::Sanction: return 3;  // Default cost, actual validation handles Judge case
+        case ActionType::Invest:   return 3;  // Baron ability
+        default:                   return 0;
+    }
 }
 
 /**
- * @brief Determines if an action requires a target player using static set lookup
- * @details Uses unordered_set for fast O(1) lookup. Actions like arrest, sanction,
- * coup, investigate, and block arrest all require valid target players.
+ * @brief Determines if an action requires a target player
+ * @details Actions like arrest, sanction, coup, investigate, and block
+ * arrest all require valid target players.
  */
 bool ActionValidator::requiresTarget(const std::string& action) {
-    static const std::unordered_set<std::string> targetRequiredActions = {
-        "Arrest", "Sanction", "Coup", "Investigate", "Block Arrest"
-    };
-    return targetRequiredActions.find(action) != targetRequiredActions.end();
+    return requiresTarget(actionOf(action));
+}
+
+bool ActionValidator::requiresTarget(ActionType action) {
+    return action == ActionType::Arrest || action == ActionType::Sanction || action == ActionType::Coup ||
+           action == ActionType::Investigate || action == ActionType::BlockArrest;
 }
 
 /**
@@ -136,73 +162,82 @@ bool ActionValidator::requiresTarget(const std::string& action) {
  * Early returns on first validation failure for efficiency.
  */
 ValidationResult ActionValidator::getValidationResult(const std::string& action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target) {
+    return getValidationResult(actionOf(action), actor.get(), target.get());
+}
+
+ValidationResult ActionValidator::getValidationResult(ActionType action, const Player* actor, const Player* target) {
+    ValidationFailure failure = check(action, actor, target);
+    if (failure == ValidationFailure::None) {
+        return ValidationResult::valid();
+    }
+    return describe(failure, action, actor);
+}
+
+ValidationFailure ActionValidator::check(ActionType action, const Player* actor, const Player* target) {
     if (!actor) {
-        return ValidationResult::invalid("No actor specified");
+        return ValidationFailure::NoActor;
     }
-    
+    ValidationFailure failure = checkRules(action, *actor);
+    if (failure == ValidationFailure::None && requiresTarget(action)) {
+        failure = checkTarget(action, *actor, target);
+    }
+    return failure;
+}
+
+/**
+ * @brief Checks the rules that do not involve a target
+ * @details In order: mandatory coup, player state (eliminated players cannot
+ * act), game state and turn ownership, coin requirements (Sanction needs at
+ * least 3 here; a Judge target's 4 is checked with the target), then
+ * sanctions, arrest blocks and role abilities.
+ */
+ValidationFailure ActionValidator::checkRules(ActionType action, const Player& player) {
     // Check mandatory coup rule first
-    if (actor->get_coins() >= 10 && action != "Coup" && action != "End Turn") {
-        return ValidationResult::invalid("Must perform coup when having 10 or more coins");
+    if (player.get_coins() >= 10 && action != ActionType::Coup && action != ActionType::EndTurn) {
+        return ValidationFailure::MustCoup;
     }
     
-    // Check player state
-    ValidationResult playerState = validatePlayerState(actor);
-    if (!playerState.isValid) return playerState;
-    
-    // Check game state
-    ValidationResult gameState = validateGameState(actor);
-    if (!gameState.isValid) return gameState;
-    
-    // Check coin requirements
-    ValidationResult coinCheck = validateCoins(action, actor);
-    if (!coinCheck.isValid) return coinCheck;
+    if (!player.is_active()) {
+        return ValidationFailure::PlayerInactive;
+    }
     
-    // Check role-specific requirements
-    ValidationResult roleCheck = validateRoleSpecificRequirements(action, actor);
-    if (!roleCheck.isValid) return roleCheck;
+    auto game_ptr = player.get_game().lock();
+    if (!game_ptr) {
+        return ValidationFailure::GameGone;
+    }
+    if (!game_ptr->is_player_turn(&player)) {
+        return ValidationFailure::NotYourTurn;
+    }
+    try {
+        game_ptr->validate_game_state();
+    } catch (const std::exception&) {
+        return ValidationFailure::InvalidGame;
+    }
     
-    // Check target requirements
-    if (requiresTarget(action)) {
-        ValidationResult targetCheck = validateTarget(action, actor, target);
-        if (!targetCheck.isValid) return targetCheck;
+    int requiredCoins = getActionCost(action);
+    if (requiredCoins > 0 && player.get_coins() < requiredCoins) {
+        return ValidationFailure::NotEnoughCoins;
     }
     
-    return ValidationResult::valid();
-}
-
-/**
- * @brief Validates coin requirements with special case handling
- * @details Checks basic coin requirements using getActionCost, with special
- * handling for Sanction action where Judge targets cost 4 instead of 3.
- * For button availability, uses base cost of 3 for sanction.
- */
-ValidationResult ActionValidator::validateCoins(const std::string& action, std::shared_ptr<Player> player) {
-    int requiredCoins = getActionCost(action, player);
+    // Sanction restrictions
+    if ((action == ActionType::Gather || action == ActionType::Tax) && player.is_sanctioned()) {
+        return ValidationFailure::Sanctioned;
+    }
     
-    // Special case for Sanction: Judge costs 4, others cost 3
-    if (action == "Sanction" && requiredCoins == 3) {
-        // We need the target to determine the exact cost, but for button availability we use base cost
-        if (player->get_coins() < 3) {
-            return ValidationResult::invalid("Need at least 3 coins for sanction");
-        }
-    } else if (requiredCoins > 0 && player->get_coins() < requiredCoins) {
-        return ValidationResult::invalid("Need " + std::to_string(requiredCoins) + " coins for " + action);
+    // Arrest block restrictions
+    if (action == ActionType::Arrest && player.is_arrest_blocked()) {
+        return ValidationFailure::ArrestBlocked;
     }
     
-    return ValidationResult::valid();
-}
-
-/**
- * @brief Validates player state (active status)
- * @details Simple check to ensure player is still active in the game.
- * Eliminated players cannot perform any actions.
- */
-ValidationResult ActionValidator::validatePlayerState(std::shared_ptr<Player> player) {
-    if (!player->is_active()) {
-        return ValidationResult::invalid("Player is not active");
+    // Role-specific action availability
+    if (action == ActionType::Invest && !dynamic_cast<const Baron*>(&player)) {
+        return ValidationFailure::WrongRole;
+    }
+    if ((action == ActionType::Investigate || action == ActionType::BlockArrest) && !dynamic_cast<const Spy*>(&player)) {
+        return ValidationFailure::WrongRole;
     }
     
-    return ValidationResult::valid();
+    return ValidationFailure::None;
 }
 
 /**
@@ -211,79 +246,109 @@ ValidationResult ActionValidator::validatePlayerState(std::shared_ptr<Player> pl
  * self-targeting prohibition. All actions in Coup that require targets
  * prevent players from targeting themselves.
  */
-ValidationResult ActionValidator::validateTarget(const std::string& action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target) {
+ValidationFailure ActionValidator::checkTarget(ActionType action, const Player& actor, const Player* target) {
     if (!target) {
-        return ValidationResult::invalid("Target required for " + action);
+        return ValidationFailure::TargetRequired;
     }
     
     if (!target->is_active()) {
-        return ValidationResult::invalid("Target player is not active");
+        return ValidationFailure::TargetInactive;
     }
     
     // Self-targeting rules - no action can target self
-    if (actor == target) {
-        return ValidationResult::invalid("Cannot target yourself with " + action);
+    if (&actor == target) {
+        return ValidationFailure::SelfTarget;
     }
     
-    return ValidationResult::valid();
-}
-
-/**
- * @brief Validates game state and turn management
- * @details Checks game instance validity, turn ownership, and overall
- * game state through the game's validate_game_state method. Uses
- * exception handling to convert game validation exceptions to ValidationResult.
- */
-ValidationResult ActionValidator::validateGameState(std::shared_ptr<Player> player) {
-    auto game_ptr = player->get_game().lock();
-    if (!game_ptr) {
-        return ValidationResult::invalid("Game no longer exists");
-    }
-    
-    if (!game_ptr->is_player_turn(player.get())) {
-        return ValidationResult::invalid("Not your turn");
+    // Sanctioning a Judge costs 4 coins instead of 3
+    if (action == ActionType::Sanction && dynamic_cast<const Judge*>(target) && actor.get_coins() < 4) {
+        return ValidationFailure::NotEnoughCoins;
     }
     
-    try {
-        game_ptr->validate_game_state();
-    } catch (const std::exception& e) {
-        return ValidationResult::invalid(e.what());
+    // Arrest restriction - the same player cannot be arrested twice in a row
+    if (action == ActionType::Arrest) {
+        auto game_ptr = actor.get_game().lock();
+        if (game_ptr && game_ptr->get_last_arrested_player() == target->get_name()) {
+            return ValidationFailure::RepeatArrest;
+        }
     }
     
-    return ValidationResult::valid();
+    return ValidationFailure::None;
 }
 
 /**
- * @brief Validates role-specific restrictions and status effects
- * @details Handles sanctions (blocking gather/tax), arrest blocks,
- * role abilities, and other special restrictions. This is where
- * most game rule enforcement happens at the role level.
+ * @brief Builds the user-facing message of a failed check
+ * @details Only runs once an action is known to be invalid, so the valid
+ * path never formats strings.
  */
-ValidationResult ActionValidator::validateRoleSpecificRequirements(const std::string& action, std::shared_ptr<Player> player) {
-    // Sanction restrictions
-    if ((action == "Gather" || action == "Tax") && player->is_sanctioned()) {
-        return ValidationResult::invalid("You are under sanctions and cannot gather or tax");
+ValidationResult ActionValidator::describe(ValidationFailure failure, ActionType action, const Player* actor) {
+    const std::string name = actionTypeName(action);
+    ValidationResult result = ValidationResult::invalid("");
+    result.reason = failure;
+    switch (failure) {
+        case ValidationFailure::None:
+            return ValidationResult::valid();
+        case ValidationFailure::NoActor:
+            result.errorMessage = "No actor specified";
+            break;
+        case ValidationFailure::MustCoup:
+            result.errorMessage = "Must perform coup when having 10 or more coins";
+            break;
+        case ValidationFailure::PlayerInactive:
+            result.errorMessage = "Player is not active";
+            break;
+        case ValidationFailure::GameGone:
+            result.errorMessage = "Game no longer exists";
+            break;
+        case ValidationFailure::NotYourTurn:
+            result.errorMessage = "Not your turn";
+            break;
+        case ValidationFailure::InvalidGame:
+            try {
+                actor->get_game().lock()->validate_game_state();
+                result.errorMessage = "Game is not playable";
+            } catch (const std::exception& e) {
+                result.errorMessage = e.what();
+            }
+            break;
+        case ValidationFailure::NotEnoughCoins:
+            if (action == ActionType::Sanction && actor->get_coins() >= 3) {
+                result.errorMessage = "Need 4 coins to sanction a Judge";
+            } else if (action == ActionType::Sanction) {
+                result.errorMessage = "Need at least 3 coins for sanction";
+            } else {
+                result.errorMessage = "Need " + std::to_string(getActionCost(action)) + " coins for " + name;
+            }
+            break;
+        case ValidationFailure::Sanctioned:
+            result.errorMessage = "You are under sanctions and cannot gather or tax";
+            break;
+        case ValidationFailure::ArrestBlocked:
+            result.errorMessage = "Your arrest ability is blocked this turn";
+            break;
+        case ValidationFailure::WrongRole:
+            if (action == ActionType::Invest) {
+                result.errorMessage = "Only Baron can invest";
+            } else if (action == ActionType::Investigate) {
+                result.errorMessage = "Only Spy can investigate";
+            } else {
+                result.errorMessage = "Only Spy can block arrest abilities";
+            }
+            break;
+        case ValidationFailure::TargetRequired:
+            result.errorMessage = "Target required for " + name;
+            break;
+        case ValidationFailure::TargetInactive:
+            result.errorMessage = "Target player is not active";
+            break;
+        case ValidationFailure::SelfTarget:
+            result.errorMessage = "Cannot target yourself with " + name;
+            break;
+        case ValidationFailure::RepeatArrest:
+            result.errorMessage = "Cannot arrest the same player twice in a row";
+            break;
     }
-    
-    // Arrest block restrictions
-    if (action == "Arrest" && player->is_arrest_blocked()) {
-        return ValidationResult::invalid("Your arrest ability is blocked this turn");
-    }
-    
-    // Role-specific action availability
-    if (action == "Invest" && player->role() != "Baron") {
-        return ValidationResult::invalid("Only Baron can invest");
-    }
-    
-    if (action == "Investigate" && player->role() != "Spy") {
-        return ValidationResult::invalid("Only Spy can investigate");
-    }
-    
-    if (action == "Block Arrest" && player->role() != "Spy") {
-        return ValidationResult::invalid("Only Spy can block arrest abilities");
-    }
-    
-    return ValidationResult::valid();
+    return result;
 }
 
-} // namespace coup 
\ No newline at end of file
+} // namespace coup
@@ -0,0 +1,70 @@
+//meirshuker159@gmail.com
+
+#include "AllocTracker.hpp"
+#include <atomic>
+#include <cstdlib>
+
+namespace coup {
+
+namespace {
+
+std::atomic<bool> hookInstalled{false};
+std::atomic<std::uint64_t> totalAllocations{0};
+std::atomic<std::uint64_t> totalDeallocations{0};
+std::atomic<std::uint64_t> totalBytes{0};
+
+// Innermost open scope of the thread; a plain pointer, so reading it never allocates
+thread_local AllocationScope* innermost = nullptr;
+
+} // namespace
+
+bool allocationHookInstalled() {
+    return hookInstalled.load(std::memory_order_relaxed);
+}
+
+AllocationCounts allocationTotals() {
+    AllocationCounts totals;
+    totals.allocations = totalAllocations.load(std::memory_order_relaxed);
+    totals.deallocations = totalDeallocations.load(std::memory_order_relaxed);
+    totals.bytes = totalBytes.load(std::memory_order_relaxed);
+    return totals;
+}
+
+AllocationScope::AllocationScope() : counted(), outer(innermost) {
+    innermost = this;
+}
+
+AllocationScope::~AllocationScope() {
+    innermost = outer;
+}
+
+void* trackedAllocate(std::size_t size) {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(size, std::memory_order_relaxed);
+    for (AllocationScope* scope = innermost; scope; scope = scope->outer) {
+        scope->counted.allocations++;
+        scope->counted.bytes += size;
+    }
+    if (void* block = std::malloc(size ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void trackedFree(void* block) noexcept {
+    if (!block) {
+        return;
+    }
+    totalDeallocations.fetch_add(1, std::memory_order_relaxed);
+    for (AllocationScope* scope = innermost; scope; scope = scope->outer) {
+        scope->counted.deallocations++;
+    }
+    std::free(block);
+}
+
+bool markAllocationHookInstalled() noexcept {
+    hookInstalled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace coup
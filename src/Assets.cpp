@@ -0,0 +1,16 @@
+//meirshuker159@gmail.com
+
+#include "Assets.hpp"
+
+namespace coup {
+
+const EmbeddedAsset* findAsset(const std::string& name) {
+    for (std::size_t i = 0; i < EMBEDDED_ASSET_COUNT; ++i) {
+        if (name == EMBEDDED_ASSETS[i].name) {
+            return &EMBEDDED_ASSETS[i];
+        }
+    }
+    return nullptr;
+}
+
+} // namespace coup
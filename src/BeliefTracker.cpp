@@ -0,0 +1,145 @@
+//meirshuker159@gmail.com
+
+#include "BeliefTracker.hpp"
+#include <algorithm>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief Likelihood that is 1 for one role and 0 for the others
+ */
+BeliefTracker::Distribution only(const char* role) {
+    BeliefTracker::Distribution likelihood{};
+    likelihood[roleIndex(role)] = 1.0f;
+    return likelihood;
+}
+
+/**
+ * @brief Role able to block an action, as in the roles' can_block()
+ * @return Role name, or nullptr if nobody blocks it
+ */
+const char* blockerOf(ActionType action) {
+    switch (action) {
+        case ActionType::Tax: return "Governor";
+        case ActionType::Bribe: return "Judge";
+        case ActionType::Coup: return "General";
+        default: return nullptr;
+    }
+}
+
+} // namespace
+
+BeliefTracker::BeliefTracker(std::size_t players, const RuleSet& rules) : rules(rules) {
+    reset(players);
+}
+
+void BeliefTracker::reset(std::size_t players) {
+    seats = std::min(players, MAX_SEATS);
+    for (auto& belief : beliefs) {
+        belief.fill(1.0f / static_cast<float>(ROLE_COUNT));
+    }
+    known.fill(ROLE_COUNT);
+    coins.fill(0);
+}
+
+void BeliefTracker::observe(const ActionRecord& record) {
+    if (record.type == ActionType::GameStart) {
+        reset(record.detail);
+        return;
+    }
+    std::uint8_t actor = record.actor;
+    if (actor >= seats) {
+        return;
+    }
+    std::uint8_t before = coins[actor];
+    coins[actor] = record.actorCoins;
+    if (record.target < seats) {
+        coins[record.target] = record.targetCoins;
+    }
+
+    switch (record.type) {
+        case ActionType::Invest:
+            apply(actor, only("Baron"));
+            break;
+        case ActionType::Investigate:
+        case ActionType::BlockArrest:
+            apply(actor, only("Spy"));
+            break;
+        case ActionType::Tax: {
+            if (rules.governorTax == rules.taxAmount) {
+                break;  // Every role collects the same
+            }
+            int gained = static_cast<int>(record.actorCoins) - static_cast<int>(before);
+            Distribution likelihood{};
+            likelihood.fill(gained == rules.taxAmount ? 1.0f : 0.0f);
+            likelihood[roleIndex("Governor")] = gained == rules.governorTax ? 1.0f : 0.0f;
+            apply(actor, likelihood);
+            break;
+        }
+        case ActionType::Block: {
+            const char* blocker = blockerOf(static_cast<ActionType>(record.detail));
+            if (blocker) {
+                apply(actor, only(blocker));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void BeliefTracker::reveal(std::uint8_t seat, std::size_t role) {
+    if (seat < seats && role < ROLE_COUNT) {
+        beliefs[seat].fill(0.0f);
+        beliefs[seat][role] = 1.0f;
+        known[seat] = role;
+    }
+}
+
+void BeliefTracker::sample(std::mt19937& rng, std::array<std::size_t, MAX_SEATS>& roles) const {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (std::size_t seat = 0; seat < seats; ++seat) {
+        if (known[seat] < ROLE_COUNT) {
+            roles[seat] = known[seat];
+            continue;
+        }
+        float draw = unit(rng);
+        std::size_t role = 0;
+        while (role + 1 < ROLE_COUNT && (draw -= beliefs[seat][role]) >= 0.0f) {
+            ++role;
+        }
+        // Rounding may run past the last possible role; step back onto one
+        while (role > 0 && beliefs[seat][role] == 0.0f) {
+            --role;
+        }
+        roles[seat] = role;
+    }
+}
+
+void BeliefTracker::apply(std::uint8_t seat, const Distribution& likelihood) {
+    Distribution updated;
+    float total = 0.0f;
+    for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+        updated[role] = beliefs[seat][role] * likelihood[role];
+        total += updated[role];
+    }
+    if (total <= 0.0f) {
+        return;
+    }
+    std::size_t possible = 0;
+    for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+        updated[role] /= total;
+        if (updated[role] > 0.0f) {
+            possible++;
+            known[seat] = role;
+        }
+    }
+    if (possible != 1) {
+        known[seat] = ROLE_COUNT;
+    }
+    beliefs[seat] = updated;
+}
+
+} // namespace coup
@@ -0,0 +1,430 @@
+//meirshuker159@gmail.com
+
+#include "Bench.hpp"
+#include "Exceptions.hpp"
+#include "SimStats.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace coup {
+
+InstructionCounter::InstructionCounter() : fd(-1) {
+#ifdef __linux__
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+}
+
+InstructionCounter::~InstructionCounter() {
+#ifdef __linux__
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+}
+
+std::uint64_t InstructionCounter::read() const {
+    std::uint64_t count = 0;
+#ifdef __linux__
+    if (fd >= 0 && ::read(fd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+        count = 0;
+    }
+#endif
+    return count;
+}
+
+namespace {
+
+/**
+ * @brief Totals of one timed loop
+ */
+struct Sample {
+    double seconds = 0.0;
+    std::uint64_t allocations = 0;
+    std::uint64_t instructions = 0;
+};
+
+/**
+ * @brief Runs reset (and op) count times
+ */
+Sample timeLoop(const BenchCase& bench, std::uint64_t count, bool withOp, const InstructionCounter& counter,
+                const BenchConfig& config) {
+    std::uint64_t allocations = config.allocations ? config.allocations() : 0;
+    std::uint64_t instructions = counter.read();
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (bench.reset) {
+            bench.reset();
+        }
+        if (withOp) {
+            bench.op();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    Sample sample;
+    sample.instructions = counter.read() - instructions;
+    sample.allocations = config.allocations ? config.allocations() - allocations : 0;
+    sample.seconds = std::chrono::duration<double>(end - start).count();
+    return sample;
+}
+
+/**
+ * @brief Two-sided 95% quantile of Student's t distribution
+ * @param degrees Degrees of freedom (at least 1)
+ */
+double tQuantile(unsigned degrees) {
+    static constexpr double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                       2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086};
+    constexpr unsigned entries = sizeof(table) / sizeof(table[0]);
+    return degrees == 0 ? 0.0 : degrees <= entries ? table[degrees - 1] : degrees <= 60 ? 2.0 : 1.96;
+}
+
+/**
+ * @brief Formats a number for JSON, null if it was not measured
+ */
+std::string jsonNumber(double value) {
+    if (value < 0.0) {
+        return "null";
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+}
+
+} // namespace
+
+std::vector<BenchResult> runBenchmarks(const std::vector<BenchCase>& cases, const BenchConfig& config) {
+    InstructionCounter counter;
+    std::vector<const BenchCase*> selected;
+    std::vector<BenchResult> results;
+    for (const BenchCase& bench : cases) {
+        if (bench.name.find(config.filter) == std::string::npos) continue;
+        if (bench.setup) {
+            bench.setup();
+        }
+        auto warmupEnd = std::chrono::steady_clock::now() + std::chrono::duration<double>(config.warmupSeconds);
+        while (std::chrono::steady_clock::now() < warmupEnd) {
+            timeLoop(bench, 64, true, counter, config);
+        }
+        std::uint64_t count = 1;
+        while (timeLoop(bench, count, true, counter, config).seconds < config.minSeconds && count < (1ull << 40)) {
+            count *= 2;
+        }
+        selected.push_back(&bench);
+        BenchResult result;
+        result.name = bench.name;
+        result.iterations = count;
+        result.repetitions = std::max(1u, config.repetitions);
+        results.push_back(result);
+    }
+
+    // Repetitions go round the cases, so a slow spell of the machine spreads over all of
+    // them and widens their intervals instead of shifting one case's mean
+    std::vector<Sample> totals(selected.size());
+    std::vector<double> sums(selected.size(), 0.0);
+    std::vector<double> squares(selected.size(), 0.0);
+    for (unsigned r = 0; r < std::max(1u, config.repetitions); ++r) {
+        for (std::size_t i = 0; i < selected.size(); ++i) {
+            const BenchCase& bench = *selected[i];
+            if (bench.setup) {
+                bench.setup();
+            }
+            std::uint64_t count = results[i].iterations;
+            Sample full = timeLoop(bench, count, true, counter, config);
+            Sample base = timeLoop(bench, count, false, counter, config);
+            // Noise can make the difference slightly negative for very cheap operations
+            double ns = std::max(0.0, (full.seconds - base.seconds) * 1e9 / static_cast<double>(count));
+            sums[i] += ns;
+            squares[i] += ns * ns;
+            totals[i].allocations += full.allocations - std::min(full.allocations, base.allocations);
+            totals[i].instructions += full.instructions - std::min(full.instructions, base.instructions);
+        }
+    }
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        BenchResult& result = results[i];
+        Interval ns = meanInterval(sums[i], squares[i], result.repetitions, tQuantile(result.repetitions - 1));
+        result.nsPerOp = ns.estimate;
+        result.nsLow = std::max(0.0, ns.low);
+        result.nsHigh = ns.high;
+        double calls = static_cast<double>(result.iterations) * result.repetitions;
+        if (config.allocations) {
+            result.allocsPerOp = static_cast<double>(totals[i].allocations) / calls;
+        }
+        if (counter.available()) {
+            result.instructionsPerOp = static_cast<double>(totals[i].instructions) / calls;
+        }
+    }
+    return results;
+}
+
+void writeBenchTable(std::ostream& out, const std::vector<BenchResult>& results) {
+    std::ios format(nullptr);
+    format.copyfmt(out);
+    std::size_t width = 9;
+    for (const BenchResult& result : results) {
+        width = std::max(width, result.name.size());
+    }
+    out << std::left << std::setw(static_cast<int>(width)) << "benchmark" << std::right << std::setw(12) << "ns/op"
+        << std::setw(10) << "+/-" << std::setw(12) << "allocs/op" << std::setw(14) << "instr/op" << std::setw(14) << "iterations" << '\n';
+    out << std::fixed;
+    for (const BenchResult& result : results) {
+        out << std::left << std::setw(static_cast<int>(width)) << result.name << std::right << std::setprecision(1)
+            << std::setw(12) << result.nsPerOp << std::setw(10) << (result.nsHigh - result.nsLow) / 2.0
+            << std::setprecision(2) << std::setw(12);
+        if (result.allocsPerOp < 0.0) {
+            out << '-';
+        } else {
+            out << result.allocsPerOp;
+        }
+        out << std::setprecision(0) << std::setw(14);
+        if (result.instructionsPerOp < 0.0) {
+            out << '-';
+        } else {
+            out << result.instructionsPerOp;
+        }
+        out << std::setw(14) << result.iterations << '\n';
+    }
+    out.copyfmt(format);
+}
+
+void writeBenchJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "{\"unit\":\"per_op\",\"benchmarks\":[";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& result = results[i];
+        out << (i ? "," : "") << "\n  {\"name\":\"" << result.name << "\",\"iterations\":" << result.iterations
+            << ",\"repetitions\":" << result.repetitions << ",\"ns\":" << jsonNumber(result.nsPerOp) << ",\"ns_ci\":["
+            << jsonNumber(result.nsLow) << ',' << jsonNumber(result.nsHigh) << "],\"allocs\":" << jsonNumber(result.allocsPerOp)
+            << ",\"instructions\":" << jsonNumber(result.instructionsPerOp) << '}';
+    }
+    out << "\n]}\n";
+}
+
+namespace {
+
+/**
+ * @brief Reads the flat JSON of writeBenchJson(): strings, numbers, null and number pairs
+ */
+class JsonReader {
+public:
+    explicit JsonReader(std::string text) : text(std::move(text)) {}
+
+    /**
+     * @brief Skips whitespace and checks the next character
+     */
+    bool peek(char c) {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        }
+        return pos < text.size() && text[pos] == c;
+    }
+
+    void expect(char c) {
+        if (!peek(c)) {
+            throw GameException("Not a benchmark file: expected '" + std::string(1, c) + "' at offset " +
+                                std::to_string(pos));
+        }
+        pos++;
+    }
+
+    std::string string() {
+        expect('"');
+        std::size_t end = text.find('"', pos);
+        if (end == std::string::npos) {
+            throw GameException("Not a benchmark file: unterminated string");
+        }
+        std::string value = text.substr(pos, end - pos);
+        pos = end + 1;
+        return value;
+    }
+
+    /**
+     * @return The number, or -1 for null
+     */
+    double number() {
+        peek(' ');
+        if (text.compare(pos, 4, "null") == 0) {
+            pos += 4;
+            return -1.0;
+        }
+        const char* start = text.c_str() + pos;
+        char* end = nullptr;
+        double value = std::strtod(start, &end);
+        if (end == start) {
+            throw GameException("Not a benchmark file: expected a number at offset " + std::to_string(pos));
+        }
+        pos += static_cast<std::size_t>(end - start);
+        return value;
+    }
+
+    /**
+     * @brief Skips a string or number value
+     */
+    void skipValue() {
+        if (peek('"')) {
+            string();
+        } else if (peek('[')) {
+            expect('[');
+            while (!peek(']')) {
+                number();
+                if (peek(',')) expect(',');
+            }
+            expect(']');
+        } else {
+            number();
+        }
+    }
+
+private:
+    std::string text;
+    std::size_t pos = 0;
+};
+
+} // namespace
+
+std::vector<BenchResult> readBenchJson(std::istream& in) {
+    JsonReader json(std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>()));
+    std::vector<BenchResult> results;
+    json.expect('{');
+    while (!json.peek('}')) {
+        std::string key = json.string();
+        json.expect(':');
+        if (key != "benchmarks") {
+            json.skipValue();
+        } else {
+            json.expect('[');
+            while (!json.peek(']')) {
+                BenchResult result;
+                bool interval = false;
+                json.expect('{');
+                while (!json.peek('}')) {
+                    std::string field = json.string();
+                    json.expect(':');
+                    if (field == "name") {
+                        result.name = json.string();
+                    } else if (field == "iterations") {
+                        result.iterations = static_cast<std::uint64_t>(std::max(0.0, json.number()));
+                    } else if (field == "repetitions") {
+                        result.repetitions = static_cast<unsigned>(std::max(0.0, json.number()));
+                    } else if (field == "ns") {
+                        result.nsPerOp = json.number();
+                    } else if (field == "ns_ci") {
+                        json.expect('[');
+                        result.nsLow = json.number();
+                        json.expect(',');
+                        result.nsHigh = json.number();
+                        json.expect(']');
+                        interval = true;
+                    } else if (field == "allocs") {
+                        result.allocsPerOp = json.number();
+                    } else if (field == "instructions") {
+                        result.instructionsPerOp = json.number();
+                    } else {
+                        json.skipValue();
+                    }
+                    if (json.peek(',')) json.expect(',');
+                }
+                json.expect('}');
+                if (result.name.empty() || result.nsPerOp < 0.0) {
+                    throw GameException("Not a benchmark file: a result without a name or time");
+                }
+                if (!interval) {
+                    result.nsLow = result.nsHigh = result.nsPerOp;
+                }
+                results.push_back(result);
+                if (json.peek(',')) json.expect(',');
+            }
+            json.expect(']');
+        }
+        if (json.peek(',')) json.expect(',');
+    }
+    json.expect('}');
+    return results;
+}
+
+std::vector<BenchVerdict> compareBenchmarks(const std::vector<BenchResult>& baseline,
+                                            const std::vector<BenchResult>& current, double tolerance) {
+    std::vector<BenchVerdict> verdicts;
+    for (const BenchResult& result : current) {
+        BenchVerdict verdict;
+        verdict.name = result.name;
+        verdict.current = &result;
+        auto found = std::find_if(baseline.begin(), baseline.end(),
+                                  [&result](const BenchResult& old) { return old.name == result.name; });
+        if (found != baseline.end()) {
+            const BenchResult& old = *found;
+            verdict.baseline = &old;
+            verdict.change = old.nsPerOp > 0.0 ? result.nsPerOp / old.nsPerOp - 1.0 : 0.0;
+            // Overlapping intervals are noise, however far apart the means
+            if (result.nsPerOp > old.nsPerOp * (1.0 + tolerance) && result.nsLow > old.nsHigh) {
+                verdict.regressed = true;
+                verdict.reason = "time";
+            }
+            if (old.instructionsPerOp >= 0.0 && result.instructionsPerOp >= 0.0 &&
+                result.instructionsPerOp > old.instructionsPerOp * (1.0 + tolerance)) {
+                verdict.regressed = true;
+                verdict.reason += verdict.reason.empty() ? "instructions" : ", instructions";
+            }
+            if (old.allocsPerOp >= 0.0 && result.allocsPerOp >= 0.0 && result.allocsPerOp > old.allocsPerOp + 0.5) {
+                verdict.regressed = true;
+                verdict.reason += verdict.reason.empty() ? "allocations" : ", allocations";
+            }
+        }
+        verdicts.push_back(verdict);
+    }
+    return verdicts;
+}
+
+void writeBenchVerdicts(std::ostream& out, const std::vector<BenchVerdict>& verdicts) {
+    std::ios format(nullptr);
+    format.copyfmt(out);
+    std::size_t width = 9;
+    for (const BenchVerdict& verdict : verdicts) {
+        width = std::max(width, verdict.name.size());
+    }
+    out << std::left << std::setw(static_cast<int>(width)) << "benchmark" << std::right << std::setw(24)
+        << "baseline ns/op" << std::setw(24) << "current ns/op" << std::setw(10) << "change" << "  verdict\n";
+    out << std::fixed << std::setprecision(1);
+    auto interval = [&out](const BenchResult& result) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1) << result.nsPerOp << " [" << result.nsLow << ", "
+             << result.nsHigh << "]";
+        out << std::setw(24) << text.str();
+    };
+    for (const BenchVerdict& verdict : verdicts) {
+        out << std::left << std::setw(static_cast<int>(width)) << verdict.name << std::right;
+        if (!verdict.baseline) {
+            out << std::setw(24) << "-";
+            interval(*verdict.current);
+            out << std::setw(10) << "-" << "  new\n";
+            continue;
+        }
+        interval(*verdict.baseline);
+        interval(*verdict.current);
+        out << std::setw(9) << verdict.change * 100.0 << '%' << "  "
+            << (verdict.regressed ? "REGRESSED (" + verdict.reason + ")" : std::string("ok")) << '\n';
+    }
+    out.copyfmt(format);
+}
+
+} // namespace coup
@@ -0,0 +1,420 @@
+//meirshuker159@gmail.com
+
+#include "Bot.hpp"
+#include "EvalQueue.hpp"
+#include "Exceptions.hpp"
+#include "Features.hpp"
+#include "Network.hpp"
+#include "Player.hpp"
+#include "PolicyTable.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <exception>
+
+namespace coup {
+
+BotPosition BotPosition::capture(const GameController& controller, std::uint8_t seat) {
+    GameRecord record;
+    record.captureSeats(*controller.get_game());
+    BotPosition position;
+    position.seats = std::move(record.seats);
+    position.rules = record.rules;
+    position.state = controller.saveState();
+    position.seat = seat;
+    for (std::size_t other = 0; other < position.seats.size(); ++other) {
+        if (other == seat) {
+            position.state.beliefs.reveal(seat, roleIndex(position.seats[other].role));
+        } else {
+            position.seats[other].role.clear();
+        }
+    }
+    return position;
+}
+
+std::unique_ptr<GameController> BotPosition::instantiate(std::mt19937& rng) const {
+    GameRecord record;
+    record.seats = seats;
+    record.rules = rules;
+    std::array<std::size_t, MAX_SEATS> roles{};
+    state.beliefs.sample(rng, roles);
+    for (std::size_t other = 0; other < record.seats.size(); ++other) {
+        if (record.seats[other].role.empty()) {
+            record.seats[other].role = roleName(roles[other]);
+        }
+    }
+    auto game = record.createGame();
+    game->set_verbose(false);
+    auto controller = std::make_unique<GameController>(game);
+    controller->setMetered(false);
+    controller->setTracksBeliefs(false);
+    controller->restoreState(state);
+    return controller;
+}
+
+namespace {
+
+/**
+ * @brief Checks for the Spy's free actions, which leave the turn with the Spy
+ * @details Random or search-driven play could repeat them forever without the
+ * game moving on.
+ */
+bool keepsTurn(ActionType action) {
+    return action == ActionType::Investigate || action == ActionType::BlockArrest;
+}
+
+/**
+ * @brief Checks whether a move legal in one deal is legal in every deal the beliefs allow
+ * @details The only rule that reads a hidden role is the Judge's: sanctioning
+ * one costs 4 coins instead of 3. With 3 coins, a sanction is only certain to
+ * be accepted if the target is known not to be a Judge.
+ */
+bool legalInEveryDeal(const BotPosition& position, const GameController& controller, const Move& move) {
+    if (move.action != ActionType::Sanction || move.target >= position.seats.size() ||
+        position.state.beliefs.probability(move.target, roleIndex("Judge")) == 0.0f) {
+        return true;
+    }
+    return controller.get_game()->all_players()[position.seat]->get_coins() >= 4;
+}
+
+} // namespace
+
+RecordedMove randomMove(const GameController& controller, std::mt19937& rng) {
+    if (controller.phase() == GamePhase::BlockPending) {
+        std::uint8_t blockers = controller.pendingBlockerCount();
+        std::uniform_int_distribution<int> choice(0, 2 * blockers - 1);
+        int pick = choice(rng);
+        if (pick < blockers) {
+            return RecordedMove{RecordedMove::Kind::Block, ActionType::Gather,
+                                controller.pendingBlocker(static_cast<std::size_t>(pick))};
+        }
+        return RecordedMove{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT};
+    }
+    std::array<Move, MAX_MOVES> moves;
+    std::size_t count = controller.legalMoves(moves);
+    auto end = std::remove_if(moves.begin(), moves.begin() + count,
+                              [](const Move& move) {
+                                  return move.action == ActionType::EndTurn || keepsTurn(move.action);
+                              });
+    std::size_t choices = static_cast<std::size_t>(end - moves.begin());
+    if (choices == 0) {
+        return RecordedMove{RecordedMove::Kind::Action, ActionType::EndTurn, NO_SEAT};
+    }
+    std::uniform_int_distribution<std::size_t> choice(0, choices - 1);
+    const Move& move = moves[choice(rng)];
+    return RecordedMove{RecordedMove::Kind::Action, move.action, move.target};
+}
+
+RandomBot::RandomBot(std::uint32_t seed) : rng(seed) {}
+
+RecordedMove RandomBot::decide(const BotPosition& position, Clock::time_point) {
+    TraceSpan span("RandomBot::decide", "bot");
+    TraceQuiet quiet;
+    auto controller = position.instantiate(rng);
+    if (controller->phase() == GamePhase::BlockPending) {
+        std::bernoulli_distribution block(0.5);
+        return block(rng) ? RecordedMove{RecordedMove::Kind::Block, ActionType::Gather, position.seat}
+                          : RecordedMove{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT};
+    }
+    return randomMove(*controller, rng);
+}
+
+MonteCarloBot::MonteCarloBot(std::uint32_t seed, std::uint32_t maxRollouts, std::shared_ptr<const PolicyValueNet> net,
+                             std::shared_ptr<const PolicyTable> rolloutPolicy)
+    : rng(seed), maxRollouts(maxRollouts), rollouts(0), net(std::move(net)), rolloutPolicy(std::move(rolloutPolicy)) {
+    if (this->net && (this->net->inputs() != FEATURE_COUNT || this->net->policyOutputs() != MOVE_SLOTS)) {
+        throw GameException("Bot networks take " + std::to_string(FEATURE_COUNT) + " features and give " +
+                            std::to_string(MOVE_SLOTS) + " policy logits");
+    }
+    if (this->net) {
+        queue = EvalQueue::shared(this->net);
+    }
+}
+
+namespace {
+
+/**
+ * @brief Plays random or table moves until the game ends or the limit is reached
+ * @param policy Table to draw moves from, or nullptr for randomMove()
+ * @return 1 for a win of seat, 0 for a loss, 1/survivors if cut off with seat alive
+ */
+double playout(GameController& controller, std::uint8_t seat, std::mt19937& rng, std::uint32_t limit,
+               const PolicyTable* policy) {
+    try {
+        for (std::uint32_t step = 0; step < limit && controller.phase() != GamePhase::GameOver; ++step) {
+            GameRecord::play(controller, policy ? policy->move(controller, rng) : randomMove(controller, rng));
+        }
+    } catch (const std::exception&) {
+        // A rejected move ends the playout early; score what was reached
+    }
+    if (controller.phase() == GamePhase::GameOver) {
+        return controller.winner() == seat ? 1.0 : 0.0;
+    }
+    auto self = controller.playerAt(seat);
+    if (!self || !self->is_active()) {
+        return 0.0;
+    }
+    int survivors = 0;
+    for (const auto& player : controller.get_game()->all_players()) {
+        survivors += player->is_active() ? 1 : 0;
+    }
+    return 1.0 / std::max(survivors, 1);
+}
+
+/**
+ * @brief Plays a few random moves and encodes the position reached for the network
+ * @param features Receives encodeFeatures() of seat if the network has to score it
+ * @param score Receives the exact score if the game is decided for seat
+ * @return True if features were filled and the network has to score the position
+ */
+bool networkPlayout(GameController& controller, std::uint8_t seat, std::mt19937& rng, float* features,
+                    double& score) {
+    try {
+        for (std::uint32_t step = 0; step < MonteCarloBot::NET_ROLLOUT_DEPTH &&
+                                     controller.phase() != GamePhase::GameOver; ++step) {
+            GameRecord::play(controller, randomMove(controller, rng));
+        }
+    } catch (const std::exception&) {
+        // Score what was reached
+    }
+    if (controller.phase() == GamePhase::GameOver) {
+        score = controller.winner() == seat ? 1.0 : 0.0;
+        return false;
+    }
+    auto self = controller.playerAt(seat);
+    if (!self || !self->is_active()) {
+        score = 0.0;
+        return false;
+    }
+    encodeFeatures(controller, seat, features);
+    return true;
+}
+
+/**
+ * @brief Gets the network's prior for each candidate, normalised over the candidates
+ * @param rootValue Receives the network's value of the position
+ */
+std::vector<double> networkPriors(const PolicyValueNet& net, const GameController& controller, std::uint8_t seat,
+                                  const std::vector<RecordedMove>& candidates, double& rootValue) {
+    std::array<float, FEATURE_COUNT> features;
+    std::array<float, MOVE_SLOTS> logits;
+    std::array<std::uint8_t, MOVE_SLOTS> legal{};
+    std::array<float, MOVE_SLOTS> probabilities;
+    encodeFeatures(controller, seat, features.data());
+    float value = 0.0f;
+    net.evaluate(features.data(), 1, logits.data(), &value);
+    rootValue = (static_cast<double>(value) + 1.0) / 2.0;
+
+    std::size_t players = controller.get_game()->player_count();
+    for (const RecordedMove& candidate : candidates) {
+        legal[moveSlot(candidate, seat, players)] = 1;
+    }
+    maskedSoftmax(logits.data(), legal.data(), MOVE_SLOTS, probabilities.data());
+    std::vector<double> priors;
+    for (const RecordedMove& candidate : candidates) {
+        priors.push_back(probabilities[moveSlot(candidate, seat, players)]);
+    }
+    return priors;
+}
+
+} // namespace
+
+/**
+ * @brief Spreads playouts over the candidates with UCB1 until time runs out
+ * @details Candidates are first tried once each in order; the deadline is
+ * honoured even before all of them were tried, in which case only the tried
+ * ones compete. At least one playout is made unless the search is cancelled.
+ * With a network, selection is PUCT instead: an untried candidate counts as
+ * the root's value, so a strong prior is tried first and a weak one may
+ * never be. Leaves go to the network's EvalQueue in waves of NET_WAVE: each
+ * queued leaf counts at once as a visit scoring 0 (virtual loss), which
+ * steers the next selections elsewhere while it waits, and the wave's values
+ * are added when it is complete. Waves keep the search independent of how
+ * the evaluator happened to batch the requests.
+ */
+RecordedMove MonteCarloBot::decide(const BotPosition& position, Clock::time_point deadline) {
+    TraceSpan span("MonteCarloBot::decide", "bot");
+    TraceQuiet quiet;
+    auto controller = position.instantiate(rng);
+    rollouts = 0;
+
+    std::vector<RecordedMove> candidates;
+    if (controller->phase() == GamePhase::BlockPending) {
+        candidates.push_back(RecordedMove{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT});
+        candidates.push_back(RecordedMove{RecordedMove::Kind::Block, ActionType::Gather, position.seat});
+    } else {
+        std::array<Move, MAX_MOVES> moves;
+        std::size_t count = controller->legalMoves(moves);
+        for (std::size_t i = 0; i < count; ++i) {
+            // The bot sees every coin count anyway; free actions would only let it stall
+            if (!keepsTurn(moves[i].action) && legalInEveryDeal(position, *controller, moves[i])) {
+                candidates.push_back(RecordedMove{RecordedMove::Kind::Action, moves[i].action, moves[i].target});
+            }
+        }
+    }
+    if (candidates.empty()) {
+        return RecordedMove{RecordedMove::Kind::Action, ActionType::EndTurn, NO_SEAT};
+    }
+    if (candidates.size() == 1) {
+        return candidates.front();
+    }
+
+    std::vector<double> priors;
+    double rootValue = 0.5;
+    if (net) {
+        priors = networkPriors(*net, *controller, position.seat, candidates, rootValue);
+    }
+
+    std::vector<double> totals(candidates.size(), 0.0);
+    std::vector<std::uint32_t> visits(candidates.size(), 0);
+    std::array<float, FEATURE_COUNT> features;
+    std::vector<EvalQueue::Slot> slots(queue ? NET_WAVE : 0);
+    std::vector<std::size_t> slotCandidates(slots.size());
+    std::size_t queued = 0;
+    // Replaces the virtual losses of the wave with the network's values
+    auto completeWave = [&]() {
+        for (std::size_t i = 0; i < queued; ++i) {
+            queue->wait(slots[i]);
+            totals[slotCandidates[i]] += (static_cast<double>(slots[i].value) + 1.0) / 2.0;
+        }
+        queued = 0;
+    };
+    while (!position.cancelled()) {
+        if (maxRollouts > 0 && rollouts >= maxRollouts) break;
+        if (rollouts > 0 && Clock::now() >= deadline) break;
+
+        std::size_t pick = 0;
+        if (net) {
+            double best = -1.0;
+            double exploration = PUCT_WEIGHT * std::sqrt(static_cast<double>(rollouts) + 1.0);
+            for (std::size_t i = 0; i < candidates.size(); ++i) {
+                double mean = visits[i] ? totals[i] / visits[i] : rootValue;
+                double value = mean + exploration * priors[i] / (1.0 + visits[i]);
+                if (value > best) {
+                    best = value;
+                    pick = i;
+                }
+            }
+        } else if (rollouts < candidates.size()) {
+            pick = rollouts;
+        } else {
+            double best = -1.0;
+            double logTotal = std::log(static_cast<double>(rollouts));
+            for (std::size_t i = 0; i < candidates.size(); ++i) {
+                if (visits[i] == 0) continue;  // Rejected in its first deal
+                double value = totals[i] / visits[i] + std::sqrt(2.0 * logTotal / visits[i]);
+                if (value > best) {
+                    best = value;
+                    pick = i;
+                }
+            }
+        }
+
+        controller = position.instantiate(rng);  // A new deal of the hidden roles
+        double score = 0.0;
+        bool evaluate = false;
+        try {
+            GameRecord::play(*controller, candidates[pick]);
+        } catch (const std::exception&) {
+            // Rejected under this deal only; the playout is spent and the next one redeals
+            rollouts++;
+            continue;
+        }
+        if (queue) {
+            evaluate = networkPlayout(*controller, position.seat, rng, features.data(), score);
+        } else {
+            score = playout(*controller, position.seat, rng, ROLLOUT_LIMIT, rolloutPolicy.get());
+        }
+        if (evaluate) {
+            queue->submit(features.data(), slots[queued]);
+            slotCandidates[queued++] = pick;
+        } else {
+            totals[pick] += score;
+        }
+        visits[pick]++;
+        rollouts++;
+        if (queued == slots.size() && queued > 0) {
+            completeWave();
+        }
+    }
+    if (queued > 0) {
+        completeWave();
+    }
+
+    std::size_t best = 0;  // Cancelled before the first playout: any legal move will do
+    double bestMean = -1.0;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (visits[i] == 0) continue;
+        double mean = totals[i] / visits[i];
+        if (mean > bestMean || (mean == bestMean && visits[i] > visits[best])) {
+            bestMean = mean;
+            best = i;
+        }
+    }
+    return candidates[best];
+}
+
+TableBot::TableBot(std::uint32_t seed, std::shared_ptr<const PolicyTable> table) : rng(seed), table(std::move(table)) {}
+
+RecordedMove TableBot::decide(const BotPosition& position, Clock::time_point) {
+    TraceSpan span("TableBot::decide", "bot");
+    TraceQuiet quiet;
+    auto controller = position.instantiate(rng);
+    if (controller->phase() == GamePhase::BlockPending) {
+        return table->blockMove(*controller, position.seat, rng);
+    }
+    return table->move(*controller, rng);
+}
+
+std::unique_ptr<Bot> createBot(const std::string& type, std::uint32_t seed) {
+    if (type == "random") {
+        return std::make_unique<RandomBot>(seed);
+    }
+    if (type == "montecarlo") {
+        return std::make_unique<MonteCarloBot>(seed);
+    }
+    const std::string prefix = "montecarlo:";
+    if (type.compare(0, prefix.size(), prefix) == 0 && type.size() > prefix.size() &&
+        type.size() <= prefix.size() + 7 && type.find_first_not_of("0123456789", prefix.size()) == std::string::npos) {
+        unsigned long rollouts = std::stoul(type.substr(prefix.size()));
+        if (rollouts > 0 && rollouts <= 1000000) {
+            return std::make_unique<MonteCarloBot>(seed, static_cast<std::uint32_t>(rollouts));
+        }
+    }
+    if (type == "table") {
+        return std::make_unique<TableBot>(seed, PolicyTable::builtin());
+    }
+    const std::string tablePrefix = "table:";
+    if (type.compare(0, tablePrefix.size(), tablePrefix) == 0 && type.size() > tablePrefix.size()) {
+        return std::make_unique<TableBot>(seed, PolicyTable::map(type.substr(tablePrefix.size())));
+    }
+    const std::string tableMcPrefix = "tablemc:";
+    if (type.compare(0, tableMcPrefix.size(), tableMcPrefix) == 0) {
+        std::size_t colon = std::min(type.find(':', tableMcPrefix.size()), type.size());
+        std::string digits = type.substr(tableMcPrefix.size(), colon - tableMcPrefix.size());
+        if (!digits.empty() && digits.size() <= 7 && digits.find_first_not_of("0123456789") == std::string::npos &&
+            colon + 1 != type.size()) {
+            unsigned long rollouts = std::stoul(digits);
+            if (rollouts > 0 && rollouts <= 1000000) {
+                auto table = colon == type.size() ? PolicyTable::builtin() : PolicyTable::map(type.substr(colon + 1));
+                return std::make_unique<MonteCarloBot>(seed, static_cast<std::uint32_t>(rollouts), nullptr,
+                                                       std::move(table));
+            }
+        }
+    }
+    const std::string netPrefix = "netmc:";
+    std::size_t colon = type.find(':', netPrefix.size());
+    if (type.compare(0, netPrefix.size(), netPrefix) == 0 && colon != std::string::npos && colon > netPrefix.size() &&
+        colon <= netPrefix.size() + 7 && colon + 1 < type.size() &&
+        type.find_first_not_of("0123456789", netPrefix.size()) == colon) {
+        unsigned long rollouts = std::stoul(type.substr(netPrefix.size(), colon - netPrefix.size()));
+        if (rollouts > 0 && rollouts <= 1000000) {
+            return std::make_unique<MonteCarloBot>(seed, static_cast<std::uint32_t>(rollouts),
+                                                   PolicyValueNet::shared(type.substr(colon + 1)));
+        }
+    }
+    throw GameException("Unknown bot type: " + type);
+}
+
+} // namespace coup
@@ -0,0 +1,289 @@
+//meirshuker159@gmail.com
+
+#include "Cfr.hpp"
+#include "Exceptions.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace coup {
+
+namespace {
+
+constexpr char MAGIC[8] = {'C', 'O', 'U', 'P', 'C', 'F', 'R', '1'};
+
+template <typename T>
+void readValue(std::istream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void writeValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief Records the legal actions of every information set below a state
+ * @throws GameException if one key is seen with two different masks
+ */
+void collectKeys(const SmallGame& game, const SmallState& state,
+                 std::unordered_map<std::uint64_t, SmallActionMask>& found) {
+    if (game.isTerminal(state)) {
+        return;
+    }
+    SmallActionMask legal = game.legalActions(state);
+    auto inserted = found.emplace(game.abstractKey(state, game.actingSeat(state)), legal);
+    if (inserted.first->second != legal) {
+        throw GameException("Abstract information set with differing legal actions");
+    }
+    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+        if ((legal >> a) & 1u) {
+            collectKeys(game, game.apply(state, static_cast<SmallAction>(a)), found);
+        }
+    }
+}
+
+/**
+ * @brief Spreads probability evenly over the legal actions
+ */
+void uniform(SmallActionMask legal, std::array<float, SMALL_ACTIONS>& out) {
+    float share = 1.0f / static_cast<float>(__builtin_popcount(legal));
+    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+        out[a] = (legal >> a) & 1u ? share : 0.0f;
+    }
+}
+
+} // namespace
+
+CfrStrategy::CfrStrategy(const SmallConfig& config, std::vector<std::uint64_t> keys,
+                         std::vector<std::array<float, SMALL_ACTIONS>> table)
+    : settings(config), keys(std::move(keys)), table(std::move(table)) {
+    if (this->keys.size() != this->table.size()) {
+        throw GameException("A strategy needs one row per key");
+    }
+}
+
+CfrStrategy CfrStrategy::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw GameException("Cannot open strategy " + path);
+    }
+    char magic[8] = {};
+    in.read(magic, sizeof(magic));
+    SmallConfig config;
+    std::uint8_t bucket = 1;
+    readValue(in, config.players);
+    readValue(in, config.horizon);
+    readValue(in, config.startCoins);
+    readValue(in, bucket);
+    config.bucketCoins = bucket != 0;
+    std::int32_t rules[4] = {};
+    in.read(reinterpret_cast<char*>(rules), sizeof(rules));
+    config.rules.taxAmount = rules[0];
+    config.rules.governorTax = rules[1];
+    config.rules.merchantThreshold = rules[2];
+    config.rules.merchantBonus = rules[3];
+    std::uint64_t entries = 0;
+    readValue(in, entries);
+    if (!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || entries > (1ull << 32)) {
+        throw GameException("Not a strategy file: " + path);
+    }
+    std::vector<std::uint64_t> keys(entries);
+    std::vector<std::array<float, SMALL_ACTIONS>> table(entries);
+    for (std::uint64_t i = 0; i < entries && in; ++i) {
+        readValue(in, keys[i]);
+        in.read(reinterpret_cast<char*>(table[i].data()), sizeof(float) * SMALL_ACTIONS);
+    }
+    if (!in || in.peek() != std::char_traits<char>::eof()) {
+        throw GameException("Strategy file has the wrong size: " + path);
+    }
+    if (!std::is_sorted(keys.begin(), keys.end())) {
+        throw GameException("Strategy keys out of order in " + path);
+    }
+    return CfrStrategy(config, std::move(keys), std::move(table));
+}
+
+void CfrStrategy::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(MAGIC, sizeof(MAGIC));
+    writeValue(out, settings.players);
+    writeValue(out, settings.horizon);
+    writeValue(out, settings.startCoins);
+    writeValue(out, static_cast<std::uint8_t>(settings.bucketCoins ? 1 : 0));
+    std::int32_t rules[4] = {settings.rules.taxAmount, settings.rules.governorTax, settings.rules.merchantThreshold,
+                             settings.rules.merchantBonus};
+    out.write(reinterpret_cast<const char*>(rules), sizeof(rules));
+    writeValue(out, static_cast<std::uint64_t>(keys.size()));
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        writeValue(out, keys[i]);
+        out.write(reinterpret_cast<const char*>(table[i].data()), sizeof(float) * SMALL_ACTIONS);
+    }
+    if (!out) {
+        throw GameException("Cannot write strategy " + path);
+    }
+}
+
+void CfrStrategy::probabilities(const SmallGame& game, const SmallState& state, SmallActionMask legal,
+                                std::array<float, SMALL_ACTIONS>& out) const {
+    std::uint64_t key = game.abstractKey(state, game.actingSeat(state));
+    auto found = std::lower_bound(keys.begin(), keys.end(), key);
+    if (found == keys.end() || *found != key) {
+        uniform(legal, out);
+        return;
+    }
+    const auto& row = table[static_cast<std::size_t>(found - keys.begin())];
+    float total = 0.0f;
+    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+        out[a] = (legal >> a) & 1u ? row[a] : 0.0f;
+        total += out[a];
+    }
+    if (total <= 0.0f) {
+        uniform(legal, out);
+        return;
+    }
+    for (float& p : out) {
+        p /= total;
+    }
+}
+
+CfrSolver::CfrSolver(const SmallGame& game, unsigned threads) : game(game) {
+    this->threads = workerCount(threads, game.dealCount());
+
+    std::unordered_map<std::uint64_t, SmallActionMask> found;
+    for (std::size_t deal = 0; deal < game.dealCount(); ++deal) {
+        collectKeys(game, game.deal(deal), found);
+    }
+    keys.reserve(found.size());
+    for (const auto& entry : found) {
+        keys.push_back(entry.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    masks.reserve(keys.size());
+    for (std::uint64_t key : keys) {
+        masks.push_back(found[key]);
+    }
+    regrets.resize(keys.size());
+    strategySums.resize(keys.size());
+}
+
+std::size_t CfrSolver::indexOf(std::uint64_t key) const {
+    return static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+}
+
+void CfrSolver::currentStrategy(std::size_t index, std::array<float, SMALL_ACTIONS>& out) const {
+    const auto& row = regrets[index].values;
+    SmallActionMask legal = masks[index];
+    float total = 0.0f;
+    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+        out[a] = (legal >> a) & 1u ? row[a] : 0.0f;
+        total += out[a];
+    }
+    if (total <= 0.0f) {
+        uniform(legal, out);
+        return;
+    }
+    for (float& p : out) {
+        p /= total;
+    }
+}
+
+float CfrSolver::traverse(const SmallState& state, std::uint8_t traverser, float reachSelf, float reachOthers,
+                          Deltas& deltas) const {
+    if (game.isTerminal(state)) {
+        std::array<float, SMALL_MAX_PLAYERS> scores;
+        game.utilities(state, scores.data());
+        return scores[traverser];
+    }
+    std::uint8_t seat = game.actingSeat(state);
+    std::size_t index = indexOf(game.abstractKey(state, seat));
+    SmallActionMask legal = masks[index];
+    std::array<float, SMALL_ACTIONS> strategy;
+    currentStrategy(index, strategy);
+
+    if (seat != traverser) {
+        float value = 0.0f;
+        for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+            if ((legal >> a) & 1u) {
+                value += strategy[a] * traverse(game.apply(state, static_cast<SmallAction>(a)), traverser, reachSelf,
+                                                reachOthers * strategy[a], deltas);
+            }
+        }
+        return value;
+    }
+
+    std::array<float, SMALL_ACTIONS> values{};
+    float value = 0.0f;
+    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+        if ((legal >> a) & 1u) {
+            values[a] = traverse(game.apply(state, static_cast<SmallAction>(a)), traverser,
+                                 reachSelf * strategy[a], reachOthers, deltas);
+            value += strategy[a] * values[a];
+        }
+    }
+    float weight = static_cast<float>(iteration + 1) * reachSelf;
+    auto& regretRow = deltas.regrets[index].values;
+    auto& strategyRow = deltas.strategy[index].values;
+    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+        if ((legal >> a) & 1u) {
+            regretRow[a] += reachOthers * (values[a] - value);
+            strategyRow[a] += weight * strategy[a];
+        }
+    }
+    return value;
+}
+
+void CfrSolver::iterate(std::size_t count) {
+    std::vector<Deltas> deltas(threads);
+    float chance = 1.0f / static_cast<float>(game.dealCount());
+    for (std::size_t step = 0; step < count; ++step) {
+        for (std::uint8_t traverser = 0; traverser < game.config().players; ++traverser) {
+            auto worker = [&](unsigned slot) {
+                Deltas& mine = deltas[slot];
+                mine.regrets.assign(keys.size(), Row());
+                mine.strategy.assign(keys.size(), Row());
+                for (std::size_t deal = slot; deal < game.dealCount(); deal += threads) {
+                    traverse(game.deal(deal), traverser, 1.0f, chance, mine);
+                }
+            };
+            runOnThreads(threads, worker);
+
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                auto& regret = regrets[i].values;
+                auto& sum = strategySums[i].values;
+                for (const Deltas& mine : deltas) {
+                    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+                        regret[a] += mine.regrets[i].values[a];
+                        sum[a] += mine.strategy[i].values[a];
+                    }
+                }
+                // CFR+: negative regret is forgotten, so actions that turn good recover quickly
+                for (float& r : regret) {
+                    r = std::max(r, 0.0f);
+                }
+            }
+        }
+        iteration++;
+    }
+}
+
+CfrStrategy CfrSolver::averageStrategy() const {
+    std::vector<std::array<float, SMALL_ACTIONS>> table(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        float total = 0.0f;
+        for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+            total += strategySums[i].values[a];
+        }
+        if (total <= 0.0f) {
+            uniform(masks[i], table[i]);
+            continue;
+        }
+        for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+            table[i][a] = strategySums[i].values[a] / total;
+        }
+    }
+    return CfrStrategy(game.config(), keys, std::move(table));
+}
+
+} // namespace coup
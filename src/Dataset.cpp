@@ -0,0 +1,147 @@
+//meirshuker159@gmail.com
+
+#include "Dataset.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief Formats a chunk file name
+ */
+std::string chunkPath(const std::string& directory, std::uint32_t chunk, const char* column) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "/chunk-%06u.%s.npy", chunk, column);
+    return directory + name;
+}
+
+/**
+ * @brief Names a move slot: "Tax", "Coup+2" (two seats after the decider), "block", "pass"
+ */
+std::string slotName(std::size_t slot) {
+    if (slot == BLOCK_SLOT) return "block";
+    if (slot == PASS_SLOT) return "pass";
+    std::string name = actionTypeName(static_cast<ActionType>(slot / (MAX_SEATS + 1)));
+    std::size_t relative = slot % (MAX_SEATS + 1);
+    return relative == 0 ? name : name + "+" + std::to_string(relative);
+}
+
+} // namespace
+
+void writeNpy(const std::string& path, const std::string& descr, const std::vector<std::size_t>& shape,
+              const void* data, std::size_t bytes) {
+    std::string dims;
+    for (std::size_t dim : shape) {
+        dims += std::to_string(dim) + ",";
+    }
+    if (shape.size() > 1) {
+        dims.pop_back();  // (n,) needs its comma; (n, m) does not
+    }
+    std::string header = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (" + dims + "), }";
+    // Magic (6) + version (2) + length (2) + header + '\n', padded to 64 bytes
+    std::size_t total = 10 + header.size() + 1;
+    header.append((64 - total % 64) % 64, ' ');
+    header += '\n';
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write("\x93NUMPY\x01\x00", 8);
+    char length[2] = {static_cast<char>(header.size() & 0xFF), static_cast<char>(header.size() >> 8)};
+    out.write(length, 2);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    if (!out) {
+        throw GameException("Cannot write " + path);
+    }
+}
+
+ChunkWriter::ChunkWriter(const std::string& directory, std::size_t chunkRows, std::atomic<std::uint32_t>& nextChunk)
+    : directory(directory), chunkRows(std::max<std::size_t>(1, chunkRows)), nextChunk(nextChunk), gameStart(0) {}
+
+void ChunkWriter::add(const TrainingRow& row) {
+    features.insert(features.end(), row.features.begin(), row.features.end());
+    legal.insert(legal.end(), row.legal.begin(), row.legal.end());
+    action.push_back(row.action);
+    outcome.push_back(0);
+    place.push_back(0);
+    seat.push_back(row.seat);
+    players.push_back(row.players);
+    game.push_back(row.game);
+}
+
+void ChunkWriter::finishGame(const std::vector<std::int8_t>& outcomes, const std::vector<std::uint32_t>& places) {
+    for (std::size_t row = gameStart; row < action.size(); ++row) {
+        if (seat[row] < outcomes.size()) {
+            outcome[row] = outcomes[seat[row]];
+            place[row] = static_cast<std::uint8_t>(places[seat[row]]);
+        }
+    }
+    gameStart = action.size();
+    if (gameStart >= chunkRows) {
+        flush();
+    }
+}
+
+void ChunkWriter::flush() {
+    std::size_t rows = gameStart;  // Rows of an unfinished game stay buffered
+    if (rows == 0) {
+        return;
+    }
+    std::uint32_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+    writeNpy(chunkPath(directory, chunk, "features"), "<f4", {rows, FEATURE_COUNT}, features.data(),
+             rows * FEATURE_COUNT * sizeof(float));
+    writeNpy(chunkPath(directory, chunk, "legal"), "|u1", {rows, MOVE_SLOTS}, legal.data(), rows * MOVE_SLOTS);
+    writeNpy(chunkPath(directory, chunk, "action"), "|u1", {rows}, action.data(), rows);
+    writeNpy(chunkPath(directory, chunk, "outcome"), "|i1", {rows}, outcome.data(), rows);
+    writeNpy(chunkPath(directory, chunk, "place"), "|u1", {rows}, place.data(), rows);
+    writeNpy(chunkPath(directory, chunk, "seat"), "|u1", {rows}, seat.data(), rows);
+    writeNpy(chunkPath(directory, chunk, "players"), "|u1", {rows}, players.data(), rows);
+    writeNpy(chunkPath(directory, chunk, "game"), "<u4", {rows}, game.data(), rows * sizeof(std::uint32_t));
+    written.emplace_back(chunk, rows);
+
+    features.erase(features.begin(), features.begin() + static_cast<std::ptrdiff_t>(rows * FEATURE_COUNT));
+    legal.erase(legal.begin(), legal.begin() + static_cast<std::ptrdiff_t>(rows * MOVE_SLOTS));
+    for (auto* column : {&action, &place, &seat, &players}) {
+        column->erase(column->begin(), column->begin() + static_cast<std::ptrdiff_t>(rows));
+    }
+    outcome.erase(outcome.begin(), outcome.begin() + static_cast<std::ptrdiff_t>(rows));
+    game.erase(game.begin(), game.begin() + static_cast<std::ptrdiff_t>(rows));
+    gameStart = 0;
+}
+
+void writeManifest(const std::string& directory, std::vector<std::pair<std::uint32_t, std::size_t>> chunks,
+                   std::uint64_t games) {
+    std::sort(chunks.begin(), chunks.end());
+    std::size_t rows = 0;
+    for (const auto& chunk : chunks) {
+        rows += chunk.second;
+    }
+    std::string path = directory + "/manifest.json";
+    std::ofstream out(path, std::ios::trunc);
+    out << "{\n  \"format\": \"coup-selfplay 1\",\n  \"games\": " << games << ",\n  \"rows\": " << rows << ",\n"
+        << "  \"columns\": {\"features\": [\"<f4\", " << FEATURE_COUNT << "], \"legal\": [\"|u1\", " << MOVE_SLOTS
+        << "], \"action\": [\"|u1\", 1], \"outcome\": [\"|i1\", 1], \"place\": [\"|u1\", 1], "
+        << "\"seat\": [\"|u1\", 1], \"players\": [\"|u1\", 1], \"game\": [\"<u4\", 1]},\n  \"feature_names\": [";
+    for (std::size_t i = 0; i < FEATURE_COUNT; ++i) {
+        out << (i ? ", " : "") << '"' << featureName(i) << '"';
+    }
+    out << "],\n  \"move_slots\": [";
+    for (std::size_t i = 0; i < MOVE_SLOTS; ++i) {
+        out << (i ? ", " : "") << '"' << slotName(i) << '"';
+    }
+    out << "],\n  \"chunks\": [";
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "chunk-%06u", chunks[i].first);
+        out << (i ? ", " : "") << "{\"name\": \"" << name << "\", \"rows\": " << chunks[i].second << "}";
+    }
+    out << "]\n}\n";
+    if (!out) {
+        throw GameException("Cannot write " + path);
+    }
+}
+
+} // namespace coup
@@ -0,0 +1,376 @@
+//meirshuker159@gmail.com
+
+#include "EngineThread.hpp"
+#include "Exceptions.hpp"
+#include "Trace.hpp"
+#include <chrono>
+#include <exception>
+#include <random>
+
+namespace coup {
+
+/**
+ * @brief Wires the controller to the event queue and starts the worker
+ * @details An initial snapshot is published before the thread starts so the
+ * frontend never observes an empty state.
+ */
+EngineThread::EngineThread(std::shared_ptr<Game> game, const std::string& recordPath,
+                           std::chrono::milliseconds botBudget)
+    : controller(game), commands(), events(), snapshots(), running(true), wakeMutex(), wake(), worker(),
+      recording(), recordPath(recordPath), recordSaved(false),
+      commandCount(0), lastCommandMicros(0),
+      bots(), botBudget(botBudget), botSeed(std::random_device{}()), botEpoch(0), botRequested(), botBusy(),
+      blockAnswers(), deferredPass(false), botDecisionCount(0), lastBotMicros(0), botLatency(), answerMutex(), answers(),
+      answersWaiting(false), cancelBots(false), pool() {
+    controller.setEventSink([this](const ActionRecord& record) {
+        // Back-pressure instead of dropping history if the frontend falls behind
+        while (!events.tryPush(record) && running.load(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+        }
+    });
+    publishSnapshot();
+    worker = std::thread(&EngineThread::run, this);
+}
+
+EngineThread::~EngineThread() {
+    cancelBots.store(true);
+    running.store(false);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wake.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    // Running searches see cancelBots and return; their answers are ignored
+    pool.reset();
+    // Keep unfinished games too; they can still be reviewed
+    if (!recordSaved && !recording.moves.empty()) {
+        saveRecording();
+    }
+}
+
+bool EngineThread::send(const EngineCommand& command) {
+    if (!commands.tryPush(command)) {
+        return false;
+    }
+    // Taking the mutex orders the push before the worker's predicate check,
+    // so a wakeup can never be lost between its check and its wait
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wake.notify_one();
+    return true;
+}
+
+bool EngineThread::addPlayer(const std::string& name) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::AddPlayer;
+    copyFixedString(command.name, name);
+    return send(command);
+}
+
+bool EngineThread::addBot(const std::string& name, const std::string& type) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::AddBot;
+    copyFixedString(command.name, name);
+    copyFixedString(command.botType, type);
+    return send(command);
+}
+
+bool EngineThread::startGame() {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::StartGame;
+    return send(command);
+}
+
+bool EngineThread::action(ActionType action, std::uint8_t targetSeat) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::Action;
+    command.action = action;
+    command.seat = targetSeat;
+    return send(command);
+}
+
+bool EngineThread::block(std::uint8_t blockerSeat) {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::Block;
+    command.seat = blockerSeat;
+    return send(command);
+}
+
+bool EngineThread::pass() {
+    EngineCommand command;
+    command.kind = EngineCommand::Kind::Pass;
+    return send(command);
+}
+
+void EngineThread::run() {
+    trace::setThreadName("engine");
+    while (running.load()) {
+        EngineCommand command;
+        bool processed = false;
+        while (commands.tryPop(command)) {
+            execute(command, false);
+            processed = true;
+        }
+        if (collectBotAnswers()) {
+            processed = true;
+        }
+        if (processed) {
+            scheduleBots();
+            publishSnapshot();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return !commands.empty() || answersWaiting.load() || !running.load();
+        });
+    }
+}
+
+void EngineThread::execute(const EngineCommand& command, bool fromBot) {
+    TraceSpan span("EngineThread::execute", "engine");
+    auto start = std::chrono::steady_clock::now();
+    process(command, fromBot);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    lastCommandMicros = static_cast<std::uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    commandCount++;
+}
+
+/**
+ * @brief Applies one command, turning rule violations into user messages
+ * @details Commands that succeed are recorded; rejected ones change nothing
+ * and are left out of the record. Seats played by bots only accept commands
+ * from their bot, and a human pass is held back while a bot may still block.
+ */
+void EngineThread::process(const EngineCommand& command, bool fromBot) {
+    try {
+        if (!fromBot) {
+            std::uint8_t current = controller.phase() == GamePhase::Playing
+                ? controller.seatOf(controller.get_game()->get_current_player().get()) : NO_SEAT;
+            if (command.kind == EngineCommand::Kind::Action && current < MAX_SEATS && bots[current]) {
+                throw GameException("Waiting for " + controller.playerAt(current)->get_name() + " (bot)");
+            }
+            if (command.kind == EngineCommand::Kind::Block && command.seat < MAX_SEATS && bots[command.seat]) {
+                throw GameException("Bots make their own block decisions");
+            }
+            if (command.kind == EngineCommand::Kind::Pass && controller.phase() == GamePhase::BlockPending &&
+                botBlockersPending()) {
+                deferredPass = true;
+                return;
+            }
+        }
+        switch (command.kind) {
+            case EngineCommand::Kind::AddPlayer:
+                controller.addPlayer(command.name);
+                break;
+            case EngineCommand::Kind::AddBot: {
+                auto bot = createBot(command.botType, botSeed++);
+                controller.addPlayer(command.name);
+                bots[controller.get_game()->all_players().size() - 1] = std::move(bot);
+                if (!pool) {
+                    pool = std::make_unique<ThreadPool>();
+                }
+                break;
+            }
+            case EngineCommand::Kind::StartGame:
+                controller.startGame();
+                break;
+            case EngineCommand::Kind::Action:
+                controller.requestAction(command.action, command.seat);
+                recording.moves.push_back(RecordedMove{RecordedMove::Kind::Action, command.action, command.seat});
+                break;
+            case EngineCommand::Kind::Block:
+                controller.block(command.seat);
+                recording.moves.push_back(RecordedMove{RecordedMove::Kind::Block, ActionType::Gather, command.seat});
+                break;
+            case EngineCommand::Kind::Pass:
+                controller.pass();
+                recording.moves.push_back(RecordedMove{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT});
+                break;
+        }
+    } catch (const std::exception& e) {
+        controller.reportError(e.what());
+    }
+    if (recording.seats.empty() && controller.phase() != GamePhase::Setup) {
+        recording.captureSeats(*controller.get_game());
+    }
+    if (!recordSaved && controller.phase() == GamePhase::GameOver) {
+        saveRecording();
+    }
+}
+
+void EngineThread::saveRecording() {
+    recordSaved = true;
+    if (recordPath.empty() || recording.seats.empty()) {
+        return;
+    }
+    try {
+        recording.save(recordPath);
+    } catch (const std::exception& e) {
+        controller.reportError(e.what());
+    }
+}
+
+/**
+ * @brief Asks every bot that has a decision to make in the current position
+ * @details A new epoch starts whenever the controller state changed, which
+ * forgets the block answers and held-back pass of the previous position.
+ */
+void EngineThread::scheduleBots() {
+    GamePhase phase = controller.phase();
+    if (!pool || (phase != GamePhase::Playing && phase != GamePhase::BlockPending)) {
+        return;
+    }
+    if (controller.stateVersion() != botEpoch) {
+        botEpoch = controller.stateVersion();
+        botRequested.fill(false);
+        blockAnswers.fill(BlockAnswer::None);
+        deferredPass = false;
+    }
+    if (phase == GamePhase::Playing) {
+        requestBot(controller.seatOf(controller.get_game()->get_current_player().get()));
+        return;
+    }
+    for (std::size_t i = 0; i < controller.pendingBlockerCount(); ++i) {
+        requestBot(controller.pendingBlocker(i));
+    }
+}
+
+void EngineThread::requestBot(std::uint8_t seat) {
+    if (seat >= MAX_SEATS || !bots[seat] || botRequested[seat] || botBusy[seat]) {
+        return;
+    }
+    botRequested[seat] = true;
+    botBusy[seat] = true;
+
+    BotPosition position = BotPosition::capture(controller, seat);
+    position.cancel = &cancelBots;
+    Bot* bot = bots[seat].get();
+    std::uint64_t epoch = botEpoch;
+    std::chrono::milliseconds budget = botBudget;
+    pool->submit([this, bot, epoch, seat, position, budget] {
+        auto start = Bot::Clock::now();
+        RecordedMove move{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT};
+        try {
+            move = bot->decide(position, start + budget);
+        } catch (const std::exception&) {
+            // The engine rejects the fallback and asks again with a fresh epoch
+        }
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(Bot::Clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> lock(answerMutex);
+            answers.push_back(BotAnswer{epoch, seat, move, static_cast<std::uint32_t>(micros)});
+            answersWaiting.store(true);
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wake.notify_one();
+    });
+}
+
+/**
+ * @brief Turns bot answers into commands
+ * @details Answers about a position that has since changed are dropped. The
+ * first bot to block wins; passes are collected until nobody is left to ask.
+ */
+bool EngineThread::collectBotAnswers() {
+    if (!answersWaiting.load()) {
+        return false;
+    }
+    std::vector<BotAnswer> taken;
+    {
+        std::lock_guard<std::mutex> lock(answerMutex);
+        taken.swap(answers);
+        answersWaiting.store(false);
+    }
+    for (const BotAnswer& answer : taken) {
+        botBusy[answer.seat] = false;
+        botDecisionCount++;
+        lastBotMicros = answer.micros;
+        botLatency.add(static_cast<double>(answer.micros));
+        if (answer.epoch != botEpoch || controller.stateVersion() != botEpoch) {
+            continue;
+        }
+        EngineCommand command;
+        switch (answer.move.kind) {
+            case RecordedMove::Kind::Action:
+                command.kind = EngineCommand::Kind::Action;
+                command.action = answer.move.action;
+                command.seat = answer.move.seat;
+                execute(command, true);
+                break;
+            case RecordedMove::Kind::Block:
+                blockAnswers[answer.seat] = BlockAnswer::Block;
+                command.kind = EngineCommand::Kind::Block;
+                command.seat = answer.seat;
+                execute(command, true);
+                break;
+            case RecordedMove::Kind::Pass:
+                if (controller.phase() != GamePhase::BlockPending) {
+                    controller.reportError("Bot returned no move");
+                    break;
+                }
+                blockAnswers[answer.seat] = BlockAnswer::Pass;
+                resolveBlockPhase();
+                break;
+        }
+    }
+    return !taken.empty();
+}
+
+void EngineThread::resolveBlockPhase() {
+    if (controller.phase() != GamePhase::BlockPending || botBlockersPending()) {
+        return;
+    }
+    if (deferredPass || !hasHumanBlockers()) {
+        EngineCommand command;
+        command.kind = EngineCommand::Kind::Pass;
+        execute(command, true);
+    }
+}
+
+bool EngineThread::botBlockersPending() const {
+    for (std::size_t i = 0; i < controller.pendingBlockerCount(); ++i) {
+        std::uint8_t seat = controller.pendingBlocker(i);
+        if (bots[seat] && (controller.stateVersion() != botEpoch || blockAnswers[seat] == BlockAnswer::None)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EngineThread::hasHumanBlockers() const {
+    for (std::size_t i = 0; i < controller.pendingBlockerCount(); ++i) {
+        if (!bots[controller.pendingBlocker(i)]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EngineThread::publishSnapshot() {
+    TraceSpan span("EngineThread::publishSnapshot", "engine");
+    GameSnapshot& snapshot = snapshots.writeBuffer();
+    controller.fillSnapshot(snapshot);
+    snapshot.engineCommandCount = commandCount;
+    snapshot.engineCommandMicros = lastCommandMicros;
+    snapshot.botSeats = 0;
+    snapshot.botThinking = false;
+    for (std::size_t seat = 0; seat < MAX_SEATS; ++seat) {
+        if (bots[seat]) {
+            snapshot.botSeats |= static_cast<std::uint8_t>(1u << seat);
+        }
+        snapshot.botThinking = snapshot.botThinking || botBusy[seat];
+    }
+    snapshot.botDecisionCount = botDecisionCount;
+    snapshot.botDecisionMicros = lastBotMicros;
+    snapshot.botDecisionP50Micros = static_cast<std::uint32_t>(botLatency.quantile(0.5));
+    snapshot.botDecisionP99Micros = static_cast<std::uint32_t>(botLatency.quantile(0.99));
+    snapshots.publish();
+}
+
+} // namespace coup
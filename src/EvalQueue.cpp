@@ -0,0 +1,103 @@
+//meirshuker159@gmail.com
+
+#include "EvalQueue.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <map>
+
+namespace coup {
+
+EvalQueue::EvalQueue(std::shared_ptr<const PolicyValueNet> net, std::size_t maxBatch,
+                     std::chrono::microseconds maxDelay)
+    : net(std::move(net)), maxBatch(std::max<std::size_t>(1, maxBatch)), maxDelay(maxDelay) {
+    inputs.reserve(this->maxBatch * this->net->inputs());
+    slots.reserve(this->maxBatch);
+    evaluator = std::thread(&EvalQueue::run, this);
+}
+
+EvalQueue::~EvalQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work.notify_one();
+    evaluator.join();
+}
+
+std::shared_ptr<EvalQueue> EvalQueue::shared(const std::shared_ptr<const PolicyValueNet>& net) {
+    static std::mutex cacheMutex;
+    static std::map<const PolicyValueNet*, std::shared_ptr<EvalQueue>> cache;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto& queue = cache[net.get()];
+    if (!queue) {
+        queue = std::make_shared<EvalQueue>(net);
+    }
+    return queue;
+}
+
+void EvalQueue::submit(const float* features, Slot& slot) {
+    slot.ready.store(false, std::memory_order_relaxed);
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inputs.insert(inputs.end(), features, features + net->inputs());
+        slots.push_back(&slot);
+        wake = slots.size() == 1 || slots.size() >= maxBatch;
+    }
+    if (wake) {
+        work.notify_one();
+    }
+}
+
+void EvalQueue::wait(Slot& slot) {
+    if (slot.isReady()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!slots.empty()) {
+        flushRequested = true;
+        work.notify_one();
+    }
+    done.wait(lock, [&slot]() { return slot.isReady(); });
+}
+
+void EvalQueue::run() {
+    trace::setThreadName("eval");
+    std::vector<float> batchInputs;
+    std::vector<Slot*> batchSlots;
+    std::vector<float> values;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        work.wait(lock, [this]() { return stopping || !slots.empty(); });
+        if (slots.empty()) {
+            return;  // Stopping with nothing left to do
+        }
+        // Give other searches a moment to fill the batch, unless one is already waiting
+        work.wait_for(lock, maxDelay, [this]() { return stopping || flushRequested || slots.size() >= maxBatch; });
+        flushRequested = false;
+        batchInputs.swap(inputs);
+        batchSlots.swap(slots);
+        inputs.clear();
+        slots.clear();
+        lock.unlock();
+
+        std::size_t width = net->inputs();
+        values.resize(batchSlots.size());
+        for (std::size_t first = 0; first < batchSlots.size(); first += maxBatch) {
+            std::size_t rows = std::min(maxBatch, batchSlots.size() - first);
+            TraceSpan span("EvalQueue::evaluate", "bot");
+            net->evaluate(batchInputs.data() + first * width, rows, nullptr, values.data() + first);
+            batchCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < batchSlots.size(); ++i) {
+            batchSlots[i]->value = values[i];
+            batchSlots[i]->ready.store(true, std::memory_order_release);
+        }
+        evaluated.fetch_add(batchSlots.size(), std::memory_order_relaxed);
+
+        lock.lock();
+        done.notify_all();
+    }
+}
+
+} // namespace coup
@@ -0,0 +1,262 @@
+//meirshuker159@gmail.com
+
+#include "Exploitability.hpp"
+#include "Exceptions.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief A state the replying seat cannot tell from the others of its set
+ */
+struct Weighted {
+    SmallState state;
+    double weight; ///< Chance times the other seats' reach
+};
+
+/**
+ * @brief States of one information set of the replying seat
+ */
+using StateSet = std::vector<Weighted>;
+
+/**
+ * @brief Sorts states into sets by what the replying seat sees
+ */
+class Splitter {
+public:
+    Splitter(const SmallGame& game, std::uint8_t seat) : game(game), seat(seat) {}
+
+    void add(const SmallState& state, double weight) {
+        SmallKey key = game.infoKey(state, seat);
+        for (auto& group : groups) {
+            if (group.first == key) {
+                group.second.push_back({state, weight});
+                return;
+            }
+        }
+        groups.emplace_back(key, StateSet{{state, weight}});
+    }
+
+    std::vector<std::pair<SmallKey, StateSet>> groups;
+
+private:
+    const SmallGame& game;
+    std::uint8_t seat;
+};
+
+/**
+ * @brief Best-response search of one seat holding one role
+ */
+class Responder {
+public:
+    Responder(const SmallGame& game, const std::vector<const SmallPolicy*>& seats, std::uint8_t seat)
+        : game(game), seats(seats), seat(seat) {}
+
+    /**
+     * @brief Gets the best weighted score reachable from a set
+     * @return Sum over the set of weight times the replying seat's score
+     */
+    double solve(const StateSet& set) {
+        const SmallState& first = set.front().state;
+        if (game.isTerminal(first)) {
+            double total = 0.0;
+            std::array<float, SMALL_MAX_PLAYERS> scores;
+            for (const Weighted& entry : set) {
+                game.utilities(entry.state, scores.data());
+                total += entry.weight * scores[seat];
+            }
+            return total;
+        }
+
+        if (game.actingSeat(first) == seat) {
+            // Legal actions only depend on what the seat knows, the same for the whole set
+            SmallActionMask legal = game.legalActions(first);
+            double best = -1.0;
+            SmallAction choice = SmallAction::Skip;
+            for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+                if (!((legal >> a) & 1u)) continue;
+                Splitter children(game, seat);
+                for (const Weighted& entry : set) {
+                    children.add(game.apply(entry.state, static_cast<SmallAction>(a)), entry.weight);
+                }
+                double value = 0.0;
+                for (const auto& group : children.groups) {
+                    value += solve(group.second);
+                }
+                if (value > best) {
+                    best = value;
+                    choice = static_cast<SmallAction>(a);
+                }
+            }
+            actions.emplace(game.infoKey(first, seat), choice);
+            return best;
+        }
+
+        Splitter children(game, seat);
+        std::array<float, SMALL_ACTIONS> probabilities;
+        for (const Weighted& entry : set) {
+            SmallActionMask legal = game.legalActions(entry.state);
+            seats[game.actingSeat(entry.state)]->probabilities(game, entry.state, legal, probabilities);
+            for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+                if ((legal >> a) & 1u && probabilities[a] > 0.0f) {
+                    children.add(game.apply(entry.state, static_cast<SmallAction>(a)), entry.weight * probabilities[a]);
+                }
+            }
+        }
+        double value = 0.0;
+        for (const auto& group : children.groups) {
+            value += solve(group.second);
+        }
+        return value;
+    }
+
+    /**
+     * @brief Solves every deal where the seat holds a role
+     * @return The role's share of the expected score
+     */
+    double solveRole(std::size_t role) {
+        StateSet set;
+        double weight = 1.0 / static_cast<double>(game.dealCount());
+        std::size_t stride = 1;
+        for (std::uint8_t s = 0; s < seat; ++s) {
+            stride *= ROLE_COUNT;
+        }
+        for (std::size_t deal = 0; deal < game.dealCount(); ++deal) {
+            if ((deal / stride) % ROLE_COUNT == role) {
+                set.push_back({game.deal(deal), weight});
+            }
+        }
+        // The Merchant bonus can split the opening states by a role the seat cannot see
+        Splitter start(game, seat);
+        for (const Weighted& entry : set) {
+            start.add(entry.state, entry.weight);
+        }
+        double value = 0.0;
+        for (const auto& group : start.groups) {
+            value += solve(group.second);
+        }
+        return value;
+    }
+
+    std::unordered_map<SmallKey, SmallAction, SmallKeyHash> actions; ///< Best action per information set
+
+private:
+    const SmallGame& game;
+    const std::vector<const SmallPolicy*>& seats;
+    std::uint8_t seat;
+};
+
+/**
+ * @brief Runs tasks 0 to count - 1 on a few threads
+ */
+template <typename Task>
+void runTasks(std::size_t count, unsigned threads, Task task) {
+    std::atomic<std::size_t> next{0};
+    runOnThreads(workerCount(threads, count), [&next, count, &task](unsigned) {
+        for (std::size_t index = next.fetch_add(1); index < count; index = next.fetch_add(1)) {
+            task(index);
+        }
+    });
+}
+
+/**
+ * @brief Best responses of several seats, one task per seat and role
+ */
+std::vector<BestResponse> solveSeats(const SmallGame& game, const std::vector<const SmallPolicy*>& seats,
+                                     const std::vector<std::uint8_t>& replying, unsigned threads) {
+    if (seats.size() != game.config().players) {
+        throw GameException("Need one policy per seat");
+    }
+    std::size_t tasks = replying.size() * ROLE_COUNT;
+    std::vector<std::unordered_map<SmallKey, SmallAction, SmallKeyHash>> actions(tasks);
+    std::vector<double> values(tasks, 0.0);
+    std::mutex failureMutex;
+    std::string failure;
+    runTasks(tasks, threads, [&](std::size_t index) {
+        try {
+            Responder responder(game, seats, replying[index / ROLE_COUNT]);
+            values[index] = responder.solveRole(index % ROLE_COUNT);
+            actions[index] = std::move(responder.actions);
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (failure.empty()) {
+                failure = e.what();
+            }
+        }
+    });
+    if (!failure.empty()) {
+        throw GameException("Best response failed: " + failure);
+    }
+
+    std::vector<BestResponse> responses;
+    for (std::size_t r = 0; r < replying.size(); ++r) {
+        std::unordered_map<SmallKey, SmallAction, SmallKeyHash> merged;
+        double value = 0.0;
+        for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+            auto& part = actions[r * ROLE_COUNT + role];
+            merged.insert(part.begin(), part.end());
+            value += values[r * ROLE_COUNT + role];
+        }
+        responses.push_back({BestResponsePolicy(replying[r], std::move(merged)), value});
+    }
+    return responses;
+}
+
+} // namespace
+
+BestResponsePolicy::BestResponsePolicy(std::uint8_t seat, std::unordered_map<SmallKey, SmallAction, SmallKeyHash> actions)
+    : replySeat(seat), actions(std::move(actions)) {}
+
+void BestResponsePolicy::probabilities(const SmallGame& game, const SmallState& state, SmallActionMask legal,
+                                       std::array<float, SMALL_ACTIONS>& out) const {
+    auto found = game.actingSeat(state) == replySeat ? actions.find(game.infoKey(state, replySeat)) : actions.end();
+    if (found != actions.end() && (legal >> static_cast<unsigned>(found->second)) & 1u) {
+        out.fill(0.0f);
+        out[static_cast<std::size_t>(found->second)] = 1.0f;
+        return;
+    }
+    float share = 1.0f / static_cast<float>(__builtin_popcount(legal));
+    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+        out[a] = (legal >> a) & 1u ? share : 0.0f;
+    }
+}
+
+BestResponse bestResponse(const SmallGame& game, const std::vector<const SmallPolicy*>& seats, std::uint8_t seat,
+                          unsigned threads) {
+    if (seat >= game.config().players) {
+        throw GameException("No seat " + std::to_string(seat) + " in a " +
+                            std::to_string(game.config().players) + "-player game");
+    }
+    return std::move(solveSeats(game, seats, {seat}, threads).front());
+}
+
+ExploitabilityReport exploitability(const SmallGame& game, const std::vector<const SmallPolicy*>& seats,
+                                    unsigned threads) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::uint8_t> replying;
+    for (std::uint8_t seat = 0; seat < game.config().players; ++seat) {
+        replying.push_back(seat);
+    }
+    std::vector<BestResponse> responses = solveSeats(game, seats, replying, threads);
+
+    ExploitabilityReport report;
+    report.policyValues = expectedUtilities(game, seats);
+    for (std::size_t seat = 0; seat < responses.size(); ++seat) {
+        report.bestResponseValues.push_back(responses[seat].value);
+        report.infoSets += responses[seat].policy.size();
+        // A policy can never beat the best reply to the others; clamp rounding
+        report.nashConv += std::max(0.0, responses[seat].value - report.policyValues[seat]);
+    }
+    report.exploitability = report.nashConv / static_cast<double>(responses.size());
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+} // namespace coup
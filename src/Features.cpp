@@ -0,0 +1,142 @@
+//meirshuker159@gmail.com
+
+#include "Features.hpp"
+#include "Game.hpp"
+#include <algorithm>
+
+namespace coup {
+
+namespace {
+
+const char* const SEAT_FEATURE_NAMES[8] = {"present", "active", "coins", "must_coup",
+                                           "sanctioned", "arrest_blocked", "to_move", "last_arrested"};
+
+/**
+ * @brief Seat r places after the decider, wrapping around the table
+ */
+std::uint8_t absoluteSeat(std::size_t relative, std::uint8_t seat, std::size_t players) {
+    return static_cast<std::uint8_t>((seat + relative) % players);
+}
+
+} // namespace
+
+std::size_t moveSlot(const RecordedMove& move, std::uint8_t seat, std::size_t players) {
+    switch (move.kind) {
+        case RecordedMove::Kind::Block: return BLOCK_SLOT;
+        case RecordedMove::Kind::Pass: return PASS_SLOT;
+        case RecordedMove::Kind::Action: break;
+    }
+    std::size_t base = static_cast<std::size_t>(move.action) * (MAX_SEATS + 1);
+    if (move.seat == NO_SEAT || players == 0) {
+        return base;
+    }
+    return base + (move.seat + players - seat) % players;
+}
+
+RecordedMove slotMove(std::size_t slot, std::uint8_t seat, std::size_t players) {
+    if (slot == BLOCK_SLOT) {
+        return RecordedMove{RecordedMove::Kind::Block, ActionType::Gather, seat};
+    }
+    if (slot == PASS_SLOT) {
+        return RecordedMove{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT};
+    }
+    ActionType action = static_cast<ActionType>(slot / (MAX_SEATS + 1));
+    std::size_t relative = slot % (MAX_SEATS + 1);
+    std::uint8_t target = relative == 0 || relative >= players ? NO_SEAT : absoluteSeat(relative, seat, players);
+    return RecordedMove{RecordedMove::Kind::Action, action, target};
+}
+
+void encodeFeatures(const GameController& controller, std::uint8_t seat, float* out) {
+    std::fill(out, out + FEATURE_COUNT, 0.0f);
+    auto game = controller.get_game();
+    const auto& players = game->all_players();
+    std::size_t count = players.size();
+
+    bool blockPending = controller.phase() == GamePhase::BlockPending;
+    out[0] = controller.phase() == GamePhase::Playing ? 1.0f : 0.0f;
+    out[1] = blockPending ? 1.0f : 0.0f;
+    out[2] = static_cast<float>(game->get_treasury()) / 50.0f;
+    out[3] = static_cast<float>(game->get_actions_remaining());
+    out[4] = static_cast<float>(count) / static_cast<float>(MAX_SEATS);
+    if (blockPending) {
+        std::uint8_t actor = NO_SEAT;
+        std::uint8_t target = NO_SEAT;
+        controller.pendingSeats(actor, target);
+        out[5 + static_cast<std::size_t>(controller.pendingActionType())] = 1.0f;
+        if (actor < count) {
+            out[5 + MOVE_TYPES + (actor + count - seat) % count] = 1.0f;
+        }
+        out[5 + MOVE_TYPES + MAX_SEATS] = target == seat ? 1.0f : 0.0f;
+    }
+
+    const Player* current = game->get_current_player().get();
+    const BeliefTracker& beliefs = controller.beliefs();
+    std::string lastArrested = game->get_last_arrested_player();
+    for (std::size_t relative = 0; relative < count && relative < MAX_SEATS; ++relative) {
+        const Player& player = *players[absoluteSeat(relative, seat, count)];
+        float* row = out + GLOBAL_FEATURES + relative * SEAT_FEATURES;
+        row[0] = 1.0f;
+        row[1] = player.is_active() ? 1.0f : 0.0f;
+        row[2] = static_cast<float>(player.get_coins()) / 10.0f;
+        row[3] = player.get_coins() >= 10 ? 1.0f : 0.0f;
+        row[4] = player.is_sanctioned() ? 1.0f : 0.0f;
+        row[5] = player.is_arrest_blocked() ? 1.0f : 0.0f;
+        row[6] = &player == current ? 1.0f : 0.0f;
+        row[7] = !lastArrested.empty() && player.get_name() == lastArrested ? 1.0f : 0.0f;
+        if (relative == 0) {
+            std::size_t role = roleIndex(player.role());
+            if (role < ROLE_COUNT) {
+                row[8 + role] = 1.0f;
+            }
+            continue;
+        }
+        // Other roles are hidden; only what the game has shown of them is encoded
+        const BeliefTracker::Distribution& belief = beliefs.distribution(absoluteSeat(relative, seat, count));
+        std::copy(belief.begin(), belief.end(), row + 8);
+    }
+}
+
+std::size_t legalMask(const GameController& controller, std::uint8_t seat, std::uint8_t* out) {
+    std::fill(out, out + MOVE_SLOTS, std::uint8_t{0});
+    if (controller.phase() == GamePhase::BlockPending) {
+        out[BLOCK_SLOT] = 1;
+        out[PASS_SLOT] = 1;
+        return 2;
+    }
+    std::array<Move, MAX_MOVES> moves;
+    std::size_t count = controller.legalMoves(moves);
+    std::size_t players = controller.get_game()->player_count();
+    std::size_t legal = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t slot = moveSlot(RecordedMove{RecordedMove::Kind::Action, moves[i].action, moves[i].target}, seat,
+                                    players);
+        legal += out[slot] ? 0 : 1;
+        out[slot] = 1;
+    }
+    return legal;
+}
+
+std::string featureName(std::size_t index) {
+    if (index < 5) {
+        static const char* const NAMES[5] = {"playing", "block_pending", "treasury", "actions_left", "players"};
+        return NAMES[index];
+    }
+    if (index < 5 + MOVE_TYPES) {
+        return std::string("pending.") + actionTypeName(static_cast<ActionType>(index - 5));
+    }
+    if (index < 5 + MOVE_TYPES + MAX_SEATS) {
+        return "pending.actor" + std::to_string(index - 5 - MOVE_TYPES);
+    }
+    if (index < GLOBAL_FEATURES) {
+        return "pending.targets_self";
+    }
+    if (index < FEATURE_COUNT) {
+        std::size_t seat = (index - GLOBAL_FEATURES) / SEAT_FEATURES;
+        std::size_t field = (index - GLOBAL_FEATURES) % SEAT_FEATURES;
+        std::string name = field < 8 ? SEAT_FEATURE_NAMES[field] : std::string("role.") + roleName(field - 8);
+        return "seat" + std::to_string(seat) + "." + name;
+    }
+    return "?";
+}
+
+} // namespace coup
@@ -0,0 +1,97 @@
+//meirshuker159@gmail.com
+
+#include "FrameProfiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace coup {
+
+const char* profileChannelName(ProfileChannel channel) {
+    switch (channel) {
+        case ProfileChannel::Frame: return "frame";
+        case ProfileChannel::Events: return "events";
+        case ProfileChannel::Update: return "update";
+        case ProfileChannel::Render: return "render";
+        case ProfileChannel::Engine: return "engine";
+        case ProfileChannel::Bot: return "bot";
+        case ProfileChannel::Count: break;
+    }
+    return "?";
+}
+
+SampleWindow::SampleWindow() : samples(), scratch(), head(0), count(0) {}
+
+void SampleWindow::add(float millis) {
+    samples[head] = millis;
+    head = (head + 1) % CAPACITY;
+    if (count < CAPACITY) {
+        count++;
+    }
+}
+
+void SampleWindow::clear() {
+    head = 0;
+    count = 0;
+}
+
+float SampleWindow::at(std::size_t index) const {
+    return samples[(head + CAPACITY - count + index) % CAPACITY];
+}
+
+float SampleWindow::max() const {
+    float result = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+        result = std::max(result, at(i));
+    }
+    return result;
+}
+
+/**
+ * @brief Nearest-rank percentile over the current window
+ * @details The window is small and fixed, so a partial sort of a copy is
+ * cheaper than keeping a sorted structure up to date on every add().
+ */
+float SampleWindow::percentile(double p) const {
+    if (count == 0) {
+        return 0.0f;
+    }
+    p = std::min(std::max(p, 0.0), 100.0);
+    std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(count)));
+    std::size_t index = rank > 0 ? rank - 1 : 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        scratch[i] = at(i);
+    }
+    std::nth_element(scratch.begin(), scratch.begin() + index, scratch.begin() + count);
+    return scratch[index];
+}
+
+FrameProfiler::FrameProfiler() : windows(), frameStart(), frameStarted(false) {}
+
+void FrameProfiler::record(ProfileChannel channel, float millis) {
+    if (channel == ProfileChannel::Count) {
+        return;
+    }
+    windows[static_cast<std::size_t>(channel)].add(millis);
+}
+
+void FrameProfiler::record(ProfileChannel channel, Clock::time_point start, Clock::time_point end) {
+    record(channel, std::chrono::duration<float, std::milli>(end - start).count());
+}
+
+void FrameProfiler::beginFrame() {
+    Clock::time_point now = Clock::now();
+    if (frameStarted) {
+        record(ProfileChannel::Frame, frameStart, now);
+    }
+    frameStart = now;
+    frameStarted = true;
+}
+
+void FrameProfiler::reset() {
+    for (auto& window : windows) {
+        window.clear();
+    }
+    frameStarted = false;
+}
+
+} // namespace coup
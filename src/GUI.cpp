@@ -2,25 +2,30 @@
 
 
 #include "GUI.hpp"
+#include "Assets.hpp"
 #include "Game.hpp"
 #include "Roles.hpp"
 #include "Exceptions.hpp"
 #include "ActionValidator.hpp"
+#include "Trace.hpp"
 #include <iostream>
 #include <random>
 #include <algorithm>
+#include <cstdio>
 
 using namespace coup;
 
 /**
  * @brief Constructs GUI with comprehensive initialization
- * @details Initializes all member variables, creates SFML window, loads assets,
- * and sets up action buttons. Uses exception handling to ensure robust startup.
- * Starts in setup phase where players can be added before game begins.
+ * @details Initializes all member variables, starts the engine thread, creates
+ * the SFML window, loads assets, and sets up action buttons. Uses exception
+ * handling to ensure robust startup. Starts in setup phase where players can
+ * be added before game begins.
  */
 GUI::GUI(std::shared_ptr<Game> game) : 
     window(),
-    game(game),
+    engine(game, "coup_game.rec"),
+    view(&engine.snapshot()),
     font(),
     playerTexts(),
     buttonTexts(),
@@ -30,22 +35,30 @@ GUI::GUI(std::shared_ptr<Game> game) :
     promptText(),
     actionButtons(),
     actionNames(),
-    isSetupPhase(true),
     isSelectingTarget(false),
     currentInput(""),
-    pendingAction(""),
+    pendingAction(ActionType::Gather),
     errorMessage(""),
     errorMessageTimer(),
-    blockers(),
-    blockingActor(nullptr),
-    blockingTarget(nullptr),
-    isBlockPhase(false),
-    blockingAction(""),
+    actionHistory(ActionHistory::DEFAULT_CAPACITY, "coup_history.log"),
+    historyScroll(0),
+    historyDirty(true),
+    namedSeats(0),
+    lastVersion(0),
+    lastMessageCount(0),
+    lastEliminationCount(0),
     showWinnerPopup(false),
     showEliminationPopup(false),
     winnerName(""),
     eliminatedPlayerName(""),
-    popupTimer() {
+    popupTimer(),
+    profiler(),
+    showProfiler(false),
+    lastEngineCommandCount(0),
+    lastBotDecisionCount(0),
+    profilerGraph(sf::Lines),
+    profilerTexts(),
+    profilerTextTimer() {
     try {
         initializeWindow();
         if (!loadAssets()) {
@@ -69,34 +82,16 @@ void GUI::initializeWindow() {
 }
 
 /**
- * @brief Loads fonts and other assets with fallback system
- * @details Attempts to load fonts from multiple paths (local assets, system fonts)
- * for cross-platform compatibility. Initializes all text objects with proper
- * positioning and styling. Returns false if no fonts can be loaded.
+ * @brief Loads fonts and other assets from the embedded asset bundle
+ * @details The font is compiled into the binary (see tools/embed_assets), so
+ * startup never probes the filesystem and works the same on machines without
+ * system fonts. Initializes all text objects with proper positioning and
+ * styling. Returns false if the font data cannot be parsed.
  */
 bool GUI::loadAssets() {
-    const std::vector<std::string> fontPaths = {
-        "assets/DejaVuSans.ttf",
-        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
-        "C:/Windows/Fonts/arial.ttf",
-        "/System/Library/Fonts/Arial.ttf",
-        "/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf"
-    };
-
-    bool fontLoaded = false;
-    for (const auto& path : fontPaths) {
-        if (font.loadFromFile(path)) {
-            std::cout << "Successfully loaded font from: " << path << std::endl;
-            fontLoaded = true;
-            break;
-        }
-    }
-
-    if (!fontLoaded) {
-        std::cerr << "Failed to load any font. Tried:\n";
-        for (const auto& path : fontPaths) {
-            std::cerr << "  - " << path << "\n";
-        }
+    const EmbeddedAsset* fontAsset = findAsset("DejaVuSans.ttf");
+    if (!fontAsset || !font.loadFromMemory(fontAsset->data, fontAsset->size)) {
+        std::cerr << "Failed to load the embedded font" << std::endl;
         return false;
     }
 
@@ -116,11 +111,34 @@ bool GUI::loadAssets() {
     inputText.setPosition(WINDOW_WIDTH / 2 - 100, WINDOW_HEIGHT / 2);
 
     promptText.setFont(font);
-    promptText.setString("Enter player name (press Enter to add):");
+    promptText.setString("Enter player name (press Enter to add, Tab adds a bot):");
     promptText.setCharacterSize(24);
     promptText.setFillColor(sf::Color::White);
     promptText.setPosition(WINDOW_WIDTH / 2 - 200, WINDOW_HEIGHT / 2 - 50);
 
+    historyTitle.setFont(font);
+    historyTitle.setString("Action History");
+    historyTitle.setCharacterSize(20);
+    historyTitle.setFillColor(sf::Color::Cyan);
+    historyTitle.setPosition(HISTORY_X, HISTORY_Y - 30);
+
+    // The panel reuses a fixed set of text objects no matter how long the game runs
+    historyTexts.assign(HISTORY_VISIBLE_LINES, sf::Text());
+    for (size_t i = 0; i < historyTexts.size(); ++i) {
+        historyTexts[i].setFont(font);
+        historyTexts[i].setCharacterSize(14);
+        historyTexts[i].setFillColor(sf::Color(220, 220, 220));
+        historyTexts[i].setPosition(HISTORY_X + 5, HISTORY_Y + i * HISTORY_LINE_HEIGHT);
+    }
+
+    profilerTexts.assign(PROFILE_CHANNELS, sf::Text());
+    for (size_t i = 0; i < profilerTexts.size(); ++i) {
+        profilerTexts[i].setFont(font);
+        profilerTexts[i].setCharacterSize(13);
+        profilerTexts[i].setFillColor(sf::Color(180, 255, 180));
+        profilerTexts[i].setPosition(PROFILER_X + 6, PROFILER_Y + i * PROFILER_ROW_HEIGHT + 2);
+    }
+
     return true;
 }
 
@@ -133,10 +151,10 @@ bool GUI::loadAssets() {
  */
 void GUI::createButtons() {
     std::vector<std::string> baseActions = {"Gather", "Tax", "Bribe", "Arrest", "Sanction", "Coup", "End Turn"};
-    auto currentPlayer = game->get_current_player();
-    if (currentPlayer && currentPlayer->role() == "Spy") {
+    const PlayerView* currentPlayer = view->currentSeat < view->playerCount ? &view->players[view->currentSeat] : nullptr;
+    if (currentPlayer && std::string(currentPlayer->role) == "Spy") {
         actionNames = {"Gather", "Tax", "Bribe", "Arrest", "Sanction", "Coup", "Investigate", "Block Arrest", "End Turn"};
-    } else if (currentPlayer && currentPlayer->role() == "Baron") {
+    } else if (currentPlayer && std::string(currentPlayer->role) == "Baron") {
         actionNames = {"Gather", "Tax", "Bribe", "Arrest", "Sanction", "Coup", "Invest", "End Turn"};
     } else {
         actionNames = baseActions;
@@ -153,10 +171,10 @@ void GUI::createButtons() {
         button.setPosition(startX + i * (buttonWidth + spacing), startY);
         sf::Color buttonColor = sf::Color(100, 100, 100);
         bool isActionAvailable = true;
-        if (currentPlayer) {
-            const std::string& action = actionNames[i];
-            // Use button-specific validation logic (doesn't check targets)
-            isActionAvailable = ActionValidator::isActionAvailableForButton(action, currentPlayer);
+        ActionType type;
+        if (currentPlayer && parseActionType(actionNames[i], type)) {
+            // Availability is computed by the engine with the button validation rules
+            isActionAvailable = view->isAvailable(type) && !view->isBot(view->currentSeat);
             if (!isActionAvailable) {
                 buttonColor = sf::Color(70, 70, 70);
             }
@@ -185,16 +203,36 @@ void GUI::createButtons() {
  * @brief Main GUI loop that runs until window is closed
  * @details Continuously processes events, updates game state, and renders
  * the display at 60 FPS. This is the core game loop that keeps the interface
- * responsive and the game running smoothly.
+ * responsive and the game running smoothly. Each phase is timed for the
+ * profiler overlay whether or not it is shown, and traced while F4 tracing is on.
  */
 void GUI::run() {
+    trace::setThreadName("gui");
     while (window.isOpen()) {
-        handleEvents();
-        update();
-        render();
+        profiler.beginFrame();
+        {
+            FrameProfiler::Scope scope(profiler, ProfileChannel::Events);
+            TraceSpan span("GUI::handleEvents", "gui");
+            handleEvents();
+        }
+        {
+            FrameProfiler::Scope scope(profiler, ProfileChannel::Update);
+            TraceSpan span("GUI::update", "gui");
+            update();
+        }
+        {
+            FrameProfiler::Scope scope(profiler, ProfileChannel::Render);
+            TraceSpan span("GUI::render", "gui");
+            render();
+        }
     }
 }
 
+/**
+ * @brief Turns window input into engine commands
+ * @details Nothing here touches the game directly: setup input and clicks are
+ * queued to the engine thread, whose answers show up in later snapshots.
+ */
 void GUI::handleEvents() {
     sf::Event event;
     while (window.pollEvent(event)) {
@@ -206,59 +244,42 @@ void GUI::handleEvents() {
                 window.close();
                 return;
             }
-            else if (event.key.code == sf::Keyboard::Space && isSetupPhase) {
-                try {
-                    size_t playerCount = game->players().size();
-                    if (playerCount < 2) {
-                        throw GameException("Need at least 2 players to start the game");
-                    }
-                    isSetupPhase = false;
-                    game->start_game();
-                } catch (const std::exception& e) {
-                    errorMessage = e.what();
-                    errorMessageTimer.restart();
-                }
+            else if (event.key.code == sf::Keyboard::Space && isSetupPhase()) {
+                engine.startGame();
+            }
+            else if (event.key.code == sf::Keyboard::Tab && isSetupPhase()) {
+                engine.addBot("Bot " + std::to_string(view->playerCount + 1));
+            }
+            else if (event.key.code == sf::Keyboard::F3) {
+                showProfiler = !showProfiler;
+            }
+            else if (event.key.code == sf::Keyboard::F4) {
+                toggleTrace();
             }
         }
-        else if (event.type == sf::Event::TextEntered && isSetupPhase) {
+        else if (event.type == sf::Event::TextEntered && isSetupPhase()) {
             if (event.text.unicode < 128) {
                 if (event.text.unicode == '\b' && !currentInput.empty()) {
                     currentInput.pop_back();
                 }
                 else if (event.text.unicode == '\r' || event.text.unicode == '\n') {
-                    try {
-                        if (currentInput.empty()) {
-                            throw GameException("Player name cannot be empty");
-                        }
-                        std::vector<std::string> existingPlayers = game->players();
-                        if (std::find(existingPlayers.begin(), existingPlayers.end(), currentInput) != existingPlayers.end()) {
-                            throw GameException("Player name already exists");
-                        }
-                        auto player = game->create_random_player(currentInput);
-                        game->add_player(player);
-                        currentInput.clear();
-                        size_t playerCount = game->players().size();
-                        if (playerCount < 2) {
-                            promptText.setString("Need at least " + std::to_string(2 - playerCount) + 
-                                               " more players to start. Enter player name:");
-                        } else if (playerCount >= 6) {
-                            isSetupPhase = false;
-                            game->start_game();
-                        } else {
-                            promptText.setString("Press Space to start game or enter more names (max 6)");
-                        }
-                    } catch (const std::exception& e) {
-                        errorMessage = e.what();
-                        errorMessageTimer.restart();
-                    }
+                    // Name validation and the 6-player auto start happen in the engine
+                    engine.addPlayer(currentInput);
+                    currentInput.clear();
                 }
-                else if (event.text.unicode != '\b') {
+                else if (event.text.unicode != '\b' && event.text.unicode != '\t') {
                     currentInput += static_cast<char>(event.text.unicode);
                 }
                 inputText.setString(currentInput);
             }
         }
-        else if (event.type == sf::Event::MouseButtonPressed && !isSetupPhase && !showWinnerPopup) {
+        else if (event.type == sf::Event::MouseWheelScrolled && !isSetupPhase()) {
+            sf::FloatRect panel(HISTORY_X, HISTORY_Y, HISTORY_WIDTH, HISTORY_VISIBLE_LINES * HISTORY_LINE_HEIGHT);
+            if (panel.contains(static_cast<float>(event.mouseWheelScroll.x), static_cast<float>(event.mouseWheelScroll.y))) {
+                scrollHistory(event.mouseWheelScroll.delta > 0 ? 3 : -3);
+            }
+        }
+        else if (event.type == sf::Event::MouseButtonPressed && !isSetupPhase() && !showWinnerPopup) {
             if (event.mouseButton.button == sf::Mouse::Left) {
                 handleClick(sf::Mouse::getPosition(window));
             }
@@ -266,81 +287,134 @@ void GUI::handleEvents() {
     }
 }
 
+/**
+ * @brief Picks up the newest engine snapshot and reacts to what changed
+ * @details Widgets are rebuilt only when the snapshot version moved; messages,
+ * eliminations and the winner are detected through the snapshot counters.
+ */
 void GUI::update() {
-    updatePlayerInfo();
-    static std::string lastPlayerName = "";
-    auto currentPlayer = game->get_current_player();
-    std::string currentPlayerName = currentPlayer ? currentPlayer->get_name() : "";
-    if (currentPlayerName != lastPlayerName) {
+    view = &engine.snapshot();
+    drainEngineEvents();
+    if (view->engineCommandCount != lastEngineCommandCount) {
+        lastEngineCommandCount = view->engineCommandCount;
+        profiler.record(ProfileChannel::Engine, view->engineCommandMicros / 1000.0f);
+    }
+    if (view->botDecisionCount != lastBotDecisionCount) {
+        lastBotDecisionCount = view->botDecisionCount;
+        profiler.record(ProfileChannel::Bot, view->botDecisionMicros / 1000.0f);
+    }
+
+    if (view->version != lastVersion) {
+        lastVersion = view->version;
         createButtons();
-        lastPlayerName = currentPlayerName;
+        updatePlayerInfo();
+        if (isSetupPhase()) {
+            size_t playerCount = view->playerCount;
+            if (playerCount == 0) {
+                promptText.setString("Enter player name (press Enter to add, Tab adds a bot):");
+            } else if (playerCount < 2) {
+                promptText.setString("Need at least " + std::to_string(2 - playerCount) + 
+                                   " more players to start. Enter player name:");
+            } else {
+                promptText.setString("Press Space to start game or enter more names (max 6)");
+            }
+        }
+    }
+    if (view->messageCount != lastMessageCount) {
+        lastMessageCount = view->messageCount;
+        errorMessage = view->message;
+        errorMessageTimer.restart();
+    }
+    if (view->eliminationCount != lastEliminationCount && view->eliminatedSeat < view->playerCount) {
+        lastEliminationCount = view->eliminationCount;
+        eliminatedPlayerName = view->players[view->eliminatedSeat].name;
+        showEliminationPopup = true;
+        popupTimer.restart();
+    }
+    if (view->phase == GamePhase::GameOver && !showWinnerPopup && view->winnerSeat < view->playerCount) {
+        winnerName = view->players[view->winnerSeat].name;
+        showWinnerPopup = true;
+    }
+}
+
+void GUI::drainEngineEvents() {
+    while (namedSeats < view->playerCount) {
+        actionHistory.setSeatName(namedSeats, view->players[namedSeats].name);
+        namedSeats++;
+    }
+    ActionRecord record;
+    while (engine.pollEvent(record)) {
+        actionHistory.push(record);
+        if (historyScroll > 0) {
+            scrollHistory(1);
+        }
+        historyDirty = true;
     }
-    checkForWinner();
 }
 
 void GUI::updatePlayerInfo() {
     playerTexts.clear();
     float startY = 50.f;
     float spacing = 30.f;
-    if (!isSetupPhase) {
-        try {
-            auto allPlayers = game->all_players();
-            auto currentPlayer = game->get_current_player();
-            std::string currentPlayerName = currentPlayer ? currentPlayer->get_name() : "";
-            for (size_t i = 0; i < allPlayers.size(); ++i) {
-                auto player = allPlayers[i];
-                if (!player) continue;
-                std::string playerInfo = player->get_name();
-                if (currentPlayer && player->get_name() == currentPlayer->get_name()) {
-                    playerInfo += " [" + player->role() + "]";
-                    playerInfo += " (" + std::to_string(player->get_coins()) + " coins)";
-                } else {
-                    playerInfo += " [Hidden]";
-                }
-                if (player->is_sanctioned()) {
-                    playerInfo += " [SANCTIONED]";
-                }
-                if (player->is_arrest_blocked()) {
-                    playerInfo += " [ARREST BLOCKED]";
-                }
-                sf::Text playerText;
-                playerText.setFont(font);
-                playerText.setString(playerInfo);
-                playerText.setCharacterSize(20);
-                if (!player->is_active()) {
-                    playerText.setFillColor(sf::Color(100, 100, 100));
-                    playerText.setString(player->get_name() + " [ELIMINATED]");
-                } else if (game->turn() == player->get_name()) {
-                    playerText.setFillColor(sf::Color::Yellow);
-                } else {
-                    playerText.setFillColor(sf::Color::White);
-                }
-                playerText.setPosition(10, startY + i * spacing);
-                playerTexts.push_back(playerText);
+    if (!isSetupPhase()) {
+        const PlayerView* currentPlayer = view->currentSeat < view->playerCount ? &view->players[view->currentSeat] : nullptr;
+        for (size_t i = 0; i < view->playerCount; ++i) {
+            const PlayerView& player = view->players[i];
+            std::string playerInfo = player.name;
+            if (view->isBot(static_cast<std::uint8_t>(i))) {
+                playerInfo += " [BOT]";
+            }
+            if (i == view->currentSeat && !view->isBot(static_cast<std::uint8_t>(i))) {
+                playerInfo += " [" + std::string(player.role) + "]";
+                playerInfo += " (" + std::to_string(player.coins) + " coins)";
+            } else {
+                playerInfo += " [Hidden]";
             }
-            if (currentPlayer) {
-                turnText.setString("Current Turn: " + currentPlayer->get_name() + 
-                                 " [" + currentPlayer->role() + "]" +
-                                 " (" + std::to_string(currentPlayer->get_coins()) + " coins)");
+            if (player.sanctioned) {
+                playerInfo += " [SANCTIONED]";
             }
-        } catch (const std::exception& e) {
-            std::cerr << "Error updating player info: " << e.what() << std::endl;
+            if (player.arrestBlocked) {
+                playerInfo += " [ARREST BLOCKED]";
+            }
+            sf::Text playerText;
+            playerText.setFont(font);
+            playerText.setString(playerInfo);
+            playerText.setCharacterSize(20);
+            if (!player.active) {
+                playerText.setFillColor(sf::Color(100, 100, 100));
+                playerText.setString(std::string(player.name) + " [ELIMINATED]");
+            } else if (i == view->currentSeat) {
+                playerText.setFillColor(sf::Color::Yellow);
+            } else {
+                playerText.setFillColor(sf::Color::White);
+            }
+            playerText.setPosition(10, startY + i * spacing);
+            playerTexts.push_back(playerText);
+        }
+        if (currentPlayer && view->isBot(view->currentSeat)) {
+            // A bot's role stays hidden like every other player's
+            turnText.setString("Current Turn: " + std::string(currentPlayer->name) + " [BOT]" +
+                             (view->botThinking ? " thinking..." : ""));
+        } else if (currentPlayer) {
+            turnText.setString("Current Turn: " + std::string(currentPlayer->name) + 
+                             " [" + currentPlayer->role + "]" +
+                             " (" + std::to_string(currentPlayer->coins) + " coins)");
         }
     }
 }
 
 void GUI::render() {
     window.clear(sf::Color(50, 50, 50));
-    if (isSetupPhase) {
+    if (isSetupPhase()) {
         window.draw(promptText);
         window.draw(inputText);
         float startY = 50.f;
         float spacing = 30.f;
-        std::vector<std::string> playerNames = game->players();
-        for (size_t i = 0; i < playerNames.size(); ++i) {
+        for (size_t i = 0; i < view->playerCount; ++i) {
             sf::Text playerText;
             playerText.setFont(font);
-            playerText.setString(playerNames[i]);
+            playerText.setString(std::string(view->players[i].name) +
+                                 (view->isBot(static_cast<std::uint8_t>(i)) ? " [BOT]" : ""));
             playerText.setCharacterSize(20);
             playerText.setFillColor(sf::Color::White);
             playerText.setPosition(10, startY + i * spacing);
@@ -358,35 +432,53 @@ void GUI::render() {
         if (isSelectingTarget) {
             window.draw(promptText);
         }
-        if (isBlockPhase) {
+        if (view->phase == GamePhase::BlockPending) {
+            // Only humans get buttons; bots send their block decisions themselves
             float buttonWidth = 120.f, buttonHeight = 40.f, spacing = 10.f;
             float y = 120.f;
-            for (size_t i = 0; i < blockers.size(); ++i) {
+            size_t row = 0;
+            for (size_t i = 0; i < view->blockerCount; ++i) {
+                if (view->isBot(view->blockers[i])) {
+                    continue;
+                }
                 sf::RectangleShape blockBtn(sf::Vector2f(buttonWidth, buttonHeight));
-                blockBtn.setPosition(250, y + i * (buttonHeight + spacing));
+                blockBtn.setPosition(250, y + row * (buttonHeight + spacing));
                 blockBtn.setFillColor(sf::Color(160, 40, 40));
                 window.draw(blockBtn);
                 sf::Text btnText;
                 btnText.setFont(font);
-                btnText.setString("Block: " + blockers[i]->get_name());
+                btnText.setString("Block: " + std::string(view->players[view->blockers[i]].name));
                 btnText.setCharacterSize(18);
                 btnText.setFillColor(sf::Color::White);
-                btnText.setPosition(255, y + i * (buttonHeight + spacing) + 8);
+                btnText.setPosition(255, y + row * (buttonHeight + spacing) + 8);
                 window.draw(btnText);
+                row++;
+            }
+            if (row > 0) {
+                sf::RectangleShape continueBtn(sf::Vector2f(buttonWidth, buttonHeight));
+                continueBtn.setPosition(250, y + row * (buttonHeight + spacing) + 20);
+                continueBtn.setFillColor(sf::Color(40, 160, 40));
+                window.draw(continueBtn);
+                sf::Text contText;
+                contText.setFont(font);
+                contText.setString("Continue");
+                contText.setCharacterSize(18);
+                contText.setFillColor(sf::Color::White);
+                contText.setPosition(270, y + row * (buttonHeight + spacing) + 28);
+                window.draw(contText);
+            }
+            if (view->botThinking) {
+                sf::Text waitText;
+                waitText.setFont(font);
+                waitText.setString("Bots are deciding whether to block...");
+                waitText.setCharacterSize(18);
+                waitText.setFillColor(sf::Color(200, 200, 200));
+                waitText.setPosition(250, y + row * (buttonHeight + spacing) + (row > 0 ? 70 : 0));
+                window.draw(waitText);
             }
-            sf::RectangleShape continueBtn(sf::Vector2f(buttonWidth, buttonHeight));
-            continueBtn.setPosition(250, y + blockers.size() * (buttonHeight + spacing) + 20);
-            continueBtn.setFillColor(sf::Color(40, 160, 40));
-            window.draw(continueBtn);
-            sf::Text contText;
-            contText.setFont(font);
-            contText.setString("Continue");
-            contText.setCharacterSize(18);
-            contText.setFillColor(sf::Color::White);
-            contText.setPosition(270, y + blockers.size() * (buttonHeight + spacing) + 28);
-            window.draw(contText);
         }
         renderTreasury();
+        renderHistory();
     }
     if (!errorMessage.empty() && errorMessageTimer.getElapsedTime().asSeconds() < 3.0f) {
         sf::Text errorText;
@@ -403,14 +495,62 @@ void GUI::render() {
         errorMessage = "";
     }
     renderPopups();
+    if (showProfiler) {
+        renderProfiler();
+    }
     window.display();
 }
 
 void GUI::renderTreasury() {
-    treasuryText.setString("Treasury: " + std::to_string(game->get_treasury()) + " coins");
+    treasuryText.setString("Treasury: " + std::to_string(view->treasury) + " coins");
     window.draw(treasuryText);
 }
 
+void GUI::renderHistory() {
+    if (historyDirty) {
+        // Format only the records that fall inside the visible window
+        size_t available = actionHistory.size() > historyScroll ? actionHistory.size() - historyScroll : 0;
+        size_t shown = std::min(available, historyTexts.size());
+        for (size_t i = 0; i < historyTexts.size(); ++i) {
+            if (i < shown) {
+                // Oldest visible line at the top, newest at the bottom
+                size_t fromNewest = historyScroll + (shown - 1 - i);
+                historyTexts[i].setString(actionHistory.format(actionHistory.fromNewest(fromNewest)));
+            } else {
+                historyTexts[i].setString("");
+            }
+        }
+        std::string title = "Action History (" + std::to_string(actionHistory.totalRecorded()) + ")";
+        if (historyScroll > 0) {
+            title += " -" + std::to_string(historyScroll);
+        }
+        historyTitle.setString(title);
+        historyDirty = false;
+    }
+
+    sf::RectangleShape panel(sf::Vector2f(HISTORY_WIDTH, HISTORY_VISIBLE_LINES * HISTORY_LINE_HEIGHT));
+    panel.setPosition(HISTORY_X, HISTORY_Y);
+    panel.setFillColor(sf::Color(35, 35, 35));
+    panel.setOutlineThickness(1.f);
+    panel.setOutlineColor(sf::Color(90, 90, 90));
+    window.draw(panel);
+    window.draw(historyTitle);
+    for (const auto& text : historyTexts) {
+        window.draw(text);
+    }
+}
+
+void GUI::scrollHistory(int lines) {
+    size_t maxScroll = actionHistory.size() > historyTexts.size() ? actionHistory.size() - historyTexts.size() : 0;
+    if (lines < 0) {
+        size_t back = static_cast<size_t>(-lines);
+        historyScroll = historyScroll > back ? historyScroll - back : 0;
+    } else {
+        historyScroll = std::min(historyScroll + static_cast<size_t>(lines), maxScroll);
+    }
+    historyDirty = true;
+}
+
 void GUI::renderPopups() {
     if (showWinnerPopup) {
         sf::RectangleShape popup(sf::Vector2f(400, 200));
@@ -461,29 +601,120 @@ void GUI::renderPopups() {
     }
 }
 
+/**
+ * @brief Draws one rolling graph per profiler channel
+ * @details Each row is scaled to the larger of its worst sample and the 60 FPS
+ * frame budget, which is marked with a red line so spikes are easy to spot.
+ */
+void GUI::renderProfiler() {
+    const float budget = 1000.0f / 60.0f;
+    const float graphLeft = PROFILER_X + 200.0f;
+    const float graphWidth = PROFILER_WIDTH - 210.0f;
+    const float graphHeight = PROFILER_ROW_HEIGHT - 12.0f;
+    bool refreshTexts = profilerTextTimer.getElapsedTime().asSeconds() >= 0.25f;
+    if (refreshTexts) {
+        profilerTextTimer.restart();
+    }
+
+    sf::RectangleShape panel(sf::Vector2f(PROFILER_WIDTH, PROFILER_ROW_HEIGHT * PROFILE_CHANNELS));
+    panel.setPosition(PROFILER_X, PROFILER_Y);
+    panel.setFillColor(sf::Color(0, 0, 0, 190));
+    panel.setOutlineThickness(1.f);
+    panel.setOutlineColor(sf::Color(90, 160, 90));
+    window.draw(panel);
+
+    profilerGraph.clear();
+    for (size_t c = 0; c < PROFILE_CHANNELS; ++c) {
+        ProfileChannel channel = static_cast<ProfileChannel>(c);
+        const SampleWindow& samples = profiler.samples(channel);
+        float rowBottom = PROFILER_Y + (c + 1) * PROFILER_ROW_HEIGHT - 6.0f;
+        float scale = std::max(samples.max(), budget);
+
+        float budgetY = rowBottom - graphHeight * budget / scale;
+        profilerGraph.append(sf::Vertex(sf::Vector2f(graphLeft, budgetY), sf::Color(160, 50, 50)));
+        profilerGraph.append(sf::Vertex(sf::Vector2f(graphLeft + graphWidth, budgetY), sf::Color(160, 50, 50)));
+
+        float step = graphWidth / (SampleWindow::CAPACITY - 1);
+        for (size_t i = 1; i < samples.size(); ++i) {
+            float x0 = graphLeft + (i - 1) * step;
+            float y0 = rowBottom - graphHeight * samples.at(i - 1) / scale;
+            float y1 = rowBottom - graphHeight * samples.at(i) / scale;
+            sf::Color color = samples.at(i) > budget ? sf::Color(255, 200, 60) : sf::Color(120, 220, 120);
+            profilerGraph.append(sf::Vertex(sf::Vector2f(x0, y0), color));
+            profilerGraph.append(sf::Vertex(sf::Vector2f(x0 + step, y1), color));
+        }
+
+        if (refreshTexts) {
+            char label[128];
+            if (channel == ProfileChannel::Bot && view->botDecisionCount > 0) {
+                // The window only holds recent decisions; the engine's sketch covers the whole game
+                std::snprintf(label, sizeof(label), "%s  game p50 %.0f p99 %.0f\np50 %.2f ms\np99 %.2f ms  max %.1f",
+                              profileChannelName(channel), view->botDecisionP50Micros / 1000.0,
+                              view->botDecisionP99Micros / 1000.0, samples.percentile(50), samples.percentile(99),
+                              samples.max());
+            } else {
+                std::snprintf(label, sizeof(label), "%s\np50 %.2f ms\np99 %.2f ms  max %.1f",
+                              profileChannelName(channel), samples.percentile(50), samples.percentile(99),
+                              samples.max());
+            }
+            profilerTexts[c].setString(label);
+        }
+    }
+    window.draw(profilerGraph);
+    for (const auto& text : profilerTexts) {
+        window.draw(text);
+    }
+}
+
+/**
+ * @brief Starts a trace, or stops the running one and writes it to TRACE_PATH
+ * @details The outcome is shown where rule violations are, so it is visible
+ * without a console.
+ */
+void GUI::toggleTrace() {
+    if (!trace::active()) {
+        startTracing();
+        errorMessage = "Tracing - press F4 again to save";
+    } else {
+        stopTracing();
+        try {
+            std::size_t spans = writeTraceFile(TRACE_PATH);
+            errorMessage = "Wrote " + std::to_string(spans) + " spans to " + TRACE_PATH;
+        } catch (const GameException& e) {
+            errorMessage = e.what();
+        }
+    }
+    errorMessageTimer.restart();
+}
+
 void GUI::handleClick(const sf::Vector2i& mousePos) {
     // ==========================================
     // PRIORITY 1: BLOCK PHASE HANDLER
     // ==========================================
     // When an action is being blocked, only blocking-related clicks are processed
     // This has the highest priority to prevent other actions during blocking
-    if (isBlockPhase) {
+    if (view->phase == GamePhase::BlockPending) {
         float buttonWidth = 120.f, buttonHeight = 40.f, spacing = 10.f;
         float y = 120.f;
         
-        // Check if user clicked on any "Block" button (one for each potential blocker)
-        for (size_t i = 0; i < blockers.size(); ++i) {
-            sf::FloatRect btnRect(250, y + i * (buttonHeight + spacing), buttonWidth, buttonHeight);
+        // Check if user clicked on any "Block" button (one per human blocker, laid out as in render())
+        size_t row = 0;
+        for (size_t i = 0; i < view->blockerCount; ++i) {
+            if (view->isBot(view->blockers[i])) {
+                continue;
+            }
+            sf::FloatRect btnRect(250, y + row * (buttonHeight + spacing), buttonWidth, buttonHeight);
             if (btnRect.contains(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y))) {
-                onBlockClicked(blockers[i]); // Execute the block with this player
+                engine.block(view->blockers[i]); // Execute the block with this player
                 return; // Exit immediately - no other actions allowed
             }
+            row++;
         }
         
         // Check if user clicked "Continue" button (proceed without blocking)
-        sf::FloatRect continueRect(250, y + blockers.size() * (buttonHeight + spacing) + 20, buttonWidth, buttonHeight);
-        if (continueRect.contains(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y))) {
-            onNoBlockClicked(); // Execute the original action without blocking
+        sf::FloatRect continueRect(250, y + row * (buttonHeight + spacing) + 20, buttonWidth, buttonHeight);
+        if (row > 0 && continueRect.contains(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y))) {
+            engine.pass(); // The engine waits for any bot that may still block
             return;
         }
         return; // Block all other clicks during block phase
@@ -492,10 +723,10 @@ void GUI::handleClick(const sf::Vector2i& mousePos) {
     // ==========================================
     // GUARDS: PREVENT INVALID STATES
     // ==========================================
-    // Don't process clicks during setup phase or when no current player exists
-    if (isSetupPhase) return;
-    auto currentPlayer = game->get_current_player();
-    if (!currentPlayer) return;
+    // Don't process clicks outside of play or when no current player exists
+    if (view->phase != GamePhase::Playing) return;
+    if (view->currentSeat >= view->playerCount) return;
+    if (view->isBot(view->currentSeat)) return; // Bots play their own turns
     
     // ==========================================
     // PRIORITY 2: TARGET SELECTION HANDLER
@@ -505,60 +736,19 @@ void GUI::handleClick(const sf::Vector2i& mousePos) {
         float startY = 50.f;
         float spacing = 30.f;
         float playerHeight = 30.f;
-        std::vector<std::string> playerNames = game->players();
         
         // Check if user clicked on any player in the list
-        for (size_t i = 0; i < playerNames.size(); ++i) {
+        for (size_t i = 0; i < view->playerCount; ++i) {
             sf::FloatRect playerBounds(10.f, startY + i * spacing, 200.f, playerHeight);
             if (playerBounds.contains(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y))) {
-                try {
-                    auto targetPlayer = game->get_player_by_name(playerNames[i]);
-                    if (targetPlayer) {
-                        // === ACTIONS THAT TRIGGER BLOCKING PHASE ===
-                        // These actions can be blocked by other players, so start the blocking process
-                        if (pendingAction == "Arrest" || pendingAction == "Sanction" || pendingAction == "Coup" ||
-                         pendingAction == "Tax" || pendingAction == "Bribe") {
-                            // Validate with target before starting block phase
-                            ActionValidator::validateActionExecution(pendingAction, currentPlayer, targetPlayer);
-                            startBlockPhase(pendingAction, currentPlayer, targetPlayer);
-                            isSelectingTarget = false;
-                            pendingAction = "";
-                            return;
-                        }  
-                
-                        // === SPY-SPECIFIC ACTIONS (NO BLOCKING) ===
-                        // These are immediate actions that cannot be blocked
-                        if (pendingAction == "Investigate") {
-                            auto spy = std::dynamic_pointer_cast<Spy>(currentPlayer);
-                            spy->investigate(*targetPlayer);
-                            std::string coinsInfo = targetPlayer->get_name() + " has " + std::to_string(targetPlayer->get_coins()) + " coins";
-                            errorMessage = coinsInfo; // Display result to current player
-                            errorMessageTimer.restart();
-                            std::cout << "[ACTION LOG] " << currentPlayer->get_name() + " (" + currentPlayer->role() + ") investigated " << targetPlayer->get_name() + " and saw " << std::to_string(targetPlayer->get_coins()) << " coins" << std::endl;
-                        }
-                        else if (pendingAction == "Block Arrest") {
-                            auto spy = std::dynamic_pointer_cast<Spy>(currentPlayer);
-                            if (spy) {
-                                spy->block_arrest_ability(*targetPlayer);
-                                errorMessage = targetPlayer->get_name() + " is blocked from using arrest this turn!";
-                                errorMessageTimer.restart();
-                                std::cout << "[ACTION LOG] " << currentPlayer->get_name() + " (" + currentPlayer->role() + ") blocked " << targetPlayer->get_name() << "'s arrest ability" << std::endl;
-                            }
-                        }
-                    }
-                } catch (const std::exception& e) {
-                    errorMessage = e.what();
-                    errorMessageTimer.restart();
-                }
-                // Reset target selection state after processing
+                // The engine validates the target and starts a block phase if needed
+                engine.action(pendingAction, static_cast<std::uint8_t>(i));
                 isSelectingTarget = false;
-                pendingAction = "";
                 return;
             }
         }
         // If clicked outside player list, cancel target selection
         isSelectingTarget = false;
-        pendingAction = "";
         return;
     }
     
@@ -569,213 +759,36 @@ void GUI::handleClick(const sf::Vector2i& mousePos) {
     for (size_t i = 0; i < actionButtons.size(); ++i) {
         if (actionButtons[i].getGlobalBounds().contains(static_cast<float>(mousePos.x),
                                                         static_cast<float>(mousePos.y))) {
-            try {
-                const std::string& action = actionNames[i];
-                
-                // === VALIDATION: CONDITIONAL BASED ON ACTION TYPE ===
-                if (!ActionValidator::requiresTarget(action)) {
-                    // Full validation for actions that don't need targets
-                    ActionValidator::validateActionExecution(action, currentPlayer);
-                } else {
-                    // Basic validation only for target-requiring actions (no target validation)
-                    if (!ActionValidator::isActionAvailableForButton(action, currentPlayer)) {
-                        throw IllegalMoveException("Action not available");
-                    }
-                }
-                
-                // === IMMEDIATE ACTIONS (ROUTE THROUGH PERFORMACTION) ===
-                if (action == "Gather") {
-                    // Validation already done above - route through performAction
-                    performAction("Gather", currentPlayer, nullptr);
-                    return;
-                    
-                // === ACTIONS THAT TRIGGER BLOCKING (NO TARGET) ===
-                } else if (action == "Tax") {
-                    // Validation already done above - start blocking phase
-                    startBlockPhase("Tax", currentPlayer, nullptr);
-                    return;
-                } else if (action == "Bribe") {
-                    startBlockPhase("Bribe", currentPlayer, nullptr);
-                    return;
-                    
-                // === ACTIONS THAT REQUIRE TARGET SELECTION ===
-                } else if (action == "Arrest" || action == "Sanction" || action == "Coup") {
-                    // Switch to target selection mode
-                    isSelectingTarget = true;
-                    pendingAction = action;
-                    promptText.setString("Select a target player");
-                    return;
-                } else if (action == "Investigate") {
-                    // Spy ability: investigate another player's coins
-                    isSelectingTarget = true;
-                    pendingAction = action;
-                    promptText.setString("Select a player to investigate");
-                    return;
-                } else if (action == "Block Arrest") {
-                    // Spy ability: prevent another player from using arrest
-                    isSelectingTarget = true;
-                    pendingAction = action;
-                    promptText.setString("Select a player to block their arrest ability");
-                    return;
-                    
-                // === ROLE-SPECIFIC ACTIONS ===
-                } else if (action == "Invest") {
-                    if (currentPlayer->role() == "Baron") {
-                        // Route through performAction for consistency
-                        performAction("Invest", currentPlayer, nullptr);
-                        return;
-                    } else if (currentPlayer->role() == "Spy") {
-                        // Note: This seems like legacy code - Spy doesn't use "Invest" button
-                        isSelectingTarget = true;
-                        pendingAction = "SpyMenu";
-                        promptText.setString("Spy Abilities: Click player to Investigate OR right-click to Block Arrest");
-                        return;
-                    }
-                    
-                // === TURN MANAGEMENT ===
-                } else if (action == "End Turn") {
-                    // Force end turn regardless of remaining actions
-                    std::cout << "[ACTION LOG] " << currentPlayer->get_name() + " (" + currentPlayer->role() + ") ended turn" << std::endl;
-                    game->next_turn();
-                    return;
-                }
-            } catch (const std::exception& e) {
-                // Display any errors to the player (insufficient coins, invalid moves, etc.)
-                errorMessage = e.what();
-                errorMessageTimer.restart();
+            const std::string& action = actionNames[i];
+            ActionType type;
+            if (!parseActionType(action, type)) {
+                break;
             }
-            break; // Only process one button click per call
-        }
-    }
-}
-
-/**
- * @brief Initiates blocking phase for blockable actions
- * @details Identifies all active players who can block the current action,
- * sets up blocking state variables, and either proceeds immediately (if no
- * blockers exist) or enters blocking phase for player decisions.
- */
-void GUI::startBlockPhase(const std::string& action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target) {
-    blockers.clear();
-    isBlockPhase = true;
-    this->blockingAction = action;
-    this->blockingActor = actor;
-    this->blockingTarget = target;
-    auto allPlayers = game->all_players();
-    for (const auto& player : allPlayers) {
-        if (!player || player == actor || !player->is_active()) continue;  // Skip eliminated players
-        if (player->can_block(action)) {
-            blockers.push_back(player);
-        }
-    }
-    if (blockers.empty()) {
-        performAction(action, actor, target);
-        isBlockPhase = false;
-    }
-}
-
-void GUI::onBlockClicked(std::shared_ptr<Player> blocker) {
-    std::cout << "[ACTION LOG] " << blocker->get_name() + " (" + blocker->role() + ") blocked " << this->blockingAction + " from " << this->blockingActor->get_name() + " (" + this->blockingActor->role() + ")" << std::endl;
-    try {
-        if (this->blockingAction == "Bribe") {
-            this->blockingActor->remove_coins(4);
-            game->add_to_treasury(4);
-            std::cout << "[ACTION LOG] " << this->blockingActor->get_name() + " (" + this->blockingActor->role() + ") lost 4 coins from blocked Bribe (returned to treasury)" << std::endl;
-        } else if (this->blockingAction == "Sanction") {
-            this->blockingActor->remove_coins(3);
-            game->add_to_treasury(3);
-            std::cout << "[ACTION LOG] " << this->blockingActor->get_name() + " (" + this->blockingActor->role() + ") lost 3 coins from blocked Sanction (returned to treasury)" << std::endl;
-        } else if (this->blockingAction == "Coup") {
-            this->blockingActor->remove_coins(7);
-            game->add_to_treasury(7);
-            std::cout << "[ACTION LOG] " << this->blockingActor->get_name() + " (" + this->blockingActor->role() + ") lost 7 coins from blocked Coup (returned to treasury)" << std::endl;
-            if (blocker->role() == "General") {
-                blocker->remove_coins(5);
-                game->add_to_treasury(5);
-                std::cout << "[ACTION LOG] " << blocker->get_name() + " (" + blocker->role() + ") paid 5 coins to treasury to block coup" << std::endl;
+            
+            if (!ActionValidator::requiresTarget(action)) {
+                // === IMMEDIATE ACTIONS: the engine validates and executes or starts blocking ===
+                engine.action(type);
+                return;
             }
-        }
-    } catch (const std::exception& e) {
-         std::cerr << "ERROR in blocking: " + std::string(e.what()) << std::endl;
-    }
-    errorMessage = blocker->get_name() + " (" + blocker->role() + ") blocked " + this->blockingAction + "!";
-    errorMessageTimer.restart();
-    isBlockPhase = false;
-    
-    game->next_turn();
-    pendingAction = "";
-}
-
-void GUI::onNoBlockClicked() {
-    if (!isBlockPhase) return;
-    isBlockPhase = false;
-    performAction(this->blockingAction, this->blockingActor, this->blockingTarget);
-}
-
-/**
- * @brief Executes validated game actions by calling appropriate player methods
- * @details Routes actions to proper Player class methods, handles role-specific
- * actions (Baron's invest), manages special feedback (bribe extra actions),
- * triggers elimination popups (coup), and logs coin summaries. Uses exception
- * handling to display errors to players.
- */
-void GUI::performAction(const std::string& action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target) {
-    try {
-        // Call the actual Player methods instead of duplicating logic
-        if (action == "Gather") {
-            actor->gather();
-        } else if (action == "Tax") {
-            actor->tax();
-        } else if (action == "Bribe") {
-            actor->bribe();
-            errorMessage = actor->get_name() + " used Bribe! Choose " + std::to_string(game->get_actions_remaining()) + " more actions (or End Turn).";
-            errorMessageTimer.restart();
-        } else if (action == "Invest") {
-            // Cast to Baron and call invest method
-            auto baron = std::dynamic_pointer_cast<Baron>(actor);
-            if (baron) {
-                baron->invest();
-            } else {
-                throw IllegalMoveException("Only Baron can invest");
+            
+            // === ACTIONS THAT REQUIRE TARGET SELECTION ===
+            if (!view->isAvailable(type)) {
+                errorMessage = "Action not available";
+                errorMessageTimer.restart();
+                return;
             }
-        } else if (action == "Arrest" && target) {
-            actor->arrest(*target);
-        } else if (action == "Sanction" && target) {
-            actor->sanction(*target);
-        } else if (action == "Coup" && target) {
-            actor->coup(*target);
-            eliminatedPlayerName = target->get_name();
-            showEliminationPopup = true;
-            popupTimer.restart();
-        }
-        
-        // Print coin summary after action
-        std::string coinSummaryForCLI = "COINS: ";
-        std::vector<std::string> cliPlayerNames = game->players();
-        for (size_t k = 0; k < cliPlayerNames.size(); ++k) {
-            auto player = game->get_player_by_name(cliPlayerNames[k]);
-            if (player) {
-                coinSummaryForCLI += cliPlayerNames[k] + "(" + std::to_string(player->get_coins()) + ")";
-                if (k < cliPlayerNames.size() - 1) coinSummaryForCLI += ", ";
+            isSelectingTarget = true;
+            pendingAction = type;
+            if (type == ActionType::Investigate) {
+                // Spy ability: investigate another player's coins
+                promptText.setString("Select a player to investigate");
+            } else if (type == ActionType::BlockArrest) {
+                // Spy ability: prevent another player from using arrest
+                promptText.setString("Select a player to block their arrest ability");
+            } else {
+                promptText.setString("Select a target player");
             }
-        }
-        std::cout << "[ACTION LOG] " << coinSummaryForCLI << std::endl;
-    } catch (const std::exception& e) {
-        errorMessage = e.what();
-        errorMessageTimer.restart();
-        std::cerr << "ERROR performing action: " + std::string(e.what()) << std::endl;
-    }
-}
-
-void GUI::checkForWinner() {
-    if (!isSetupPhase && game->is_active() && game->is_game_over() && !showWinnerPopup) {
-        try {
-            winnerName = game->winner();
-            showWinnerPopup = true;
-            std::cout << "GAME OVER! Winner: " << winnerName << std::endl;
-        } catch (const std::exception&) {
+            return;
         }
     }
 }
-
-
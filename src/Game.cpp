@@ -3,6 +3,7 @@
 #include "Game.hpp"
 #include "Exceptions.hpp"
 #include "Roles.hpp"
+#include "Trace.hpp"
 #include <algorithm>
 #include <random>
 #include <iostream>
@@ -10,7 +11,18 @@
 namespace coup {
 
 Game::Game() : current_turn(0), game_started(false), treasury(50), last_arrested_player(""), 
-               actions_remaining(1) {}
+               actions_remaining(1), verbose(true), rules() {}
+
+void Game::set_rules(const RuleSet& newRules) {
+    if (game_started) {
+        throw GameException("Rules cannot change once the game has started");
+    }
+    if (newRules.taxAmount < 0 || newRules.governorTax < 0 || newRules.merchantThreshold < 0 ||
+        newRules.merchantBonus < 0) {
+        throw GameException("Rule constants cannot be negative");
+    }
+    rules = newRules;
+}
 
 void Game::add_player(std::shared_ptr<Player> player) {
     validate_player_count();
@@ -36,6 +48,7 @@ void Game::start_game() {
  * - Resetting action counter for new turn
  */
 void Game::next_turn() {
+    TraceSpan span("Game::next_turn", "engine");
     // Don't cleanup inactive players immediately - let GUI show elimination first
     // cleanup_inactive_players();
     
@@ -55,18 +68,24 @@ void Game::next_turn() {
     // Check for mandatory coup
     auto currentPlayer = get_current_player();
     if (currentPlayer && currentPlayer->get_coins() >= 10) {
-        std::cout << "[GAME] ⚠️ " << currentPlayer->get_name() << " (" << currentPlayer->role() 
-                  << ") MUST COUP (has " << currentPlayer->get_coins() << " coins)" << std::endl;
+        if (verbose) {
+            std::cout << "[GAME] ⚠️ " << currentPlayer->get_name() << " (" << currentPlayer->role() 
+                      << ") MUST COUP (has " << currentPlayer->get_coins() << " coins)" << std::endl;
+        }
     }
     
     // Clear turn-based effects for current player before moving to next
     if (currentPlayer) {
         // Log status effect cleanup
         if (currentPlayer->is_sanctioned()) {
-            std::cout << "[CLEANUP] " << currentPlayer->get_name() << " is no longer sanctioned" << std::endl;
+            if (verbose) {
+                std::cout << "[CLEANUP] " << currentPlayer->get_name() << " is no longer sanctioned" << std::endl;
+            }
         }
         if (currentPlayer->is_arrest_blocked()) {
-            std::cout << "[CLEANUP] " << currentPlayer->get_name() << " is no longer arrest blocked" << std::endl;
+            if (verbose) {
+                std::cout << "[CLEANUP] " << currentPlayer->get_name() << " is no longer arrest blocked" << std::endl;
+            }
         }
         currentPlayer->set_sanctioned(false);  // Clear sanctions at end of turn
         currentPlayer->set_arrest_blocked(false); // Clear arrest block at end of turn
@@ -82,8 +101,10 @@ void Game::next_turn() {
     // Call on_turn_start for current player and reset actions
     auto nextPlayer = get_current_player();
     if (nextPlayer && nextPlayer->is_active()) {
-        std::cout << "[TURN] === " << nextPlayer->get_name() << " (" << nextPlayer->role() 
-                  << ")'s turn begins - " << nextPlayer->get_coins() << " coins ===" << std::endl;
+        if (verbose) {
+            std::cout << "[TURN] === " << nextPlayer->get_name() << " (" << nextPlayer->role() 
+                      << ")'s turn begins - " << nextPlayer->get_coins() << " coins ===" << std::endl;
+        }
         nextPlayer->on_turn_start();
         start_turn_actions();  // Reset to 1 action for new turn
     }
@@ -116,7 +137,7 @@ std::vector<std::string> Game::players() const {
     return player_names;
 }
 
-std::vector<std::shared_ptr<Player>> Game::all_players() const {
+const std::vector<std::shared_ptr<Player>>& Game::all_players() const {
     return this->player_list;
 }
 
@@ -237,9 +258,13 @@ void Game::cleanup_inactive_players() {
 std::shared_ptr<Player> Game::create_random_player(const std::string& name) {
     static std::random_device rd;
     static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, 5);
+    return create_random_player(name, gen);
+}
+
+std::shared_ptr<Player> Game::create_random_player(const std::string& name, std::mt19937& rng) {
+    std::uniform_int_distribution<> dis(0, 5);
     
-    int role_index = dis(gen);
+    int role_index = dis(rng);
     auto game_ptr = shared_from_this();
     
     switch (role_index) {
@@ -253,6 +278,45 @@ std::shared_ptr<Player> Game::create_random_player(const std::string& name) {
     }
 }
 
+std::shared_ptr<Player> Game::create_player(const std::string& name, const std::string& role) {
+    auto game_ptr = shared_from_this();
+    if (role == "Governor") return std::make_shared<Governor>(game_ptr, name);
+    if (role == "Spy") return std::make_shared<Spy>(game_ptr, name);
+    if (role == "Baron") return std::make_shared<Baron>(game_ptr, name);
+    if (role == "General") return std::make_shared<General>(game_ptr, name);
+    if (role == "Judge") return std::make_shared<Judge>(game_ptr, name);
+    if (role == "Merchant") return std::make_shared<Merchant>(game_ptr, name);
+    throw GameException("Unknown role: " + role);
+}
+
+GameState Game::capture_state() const {
+    GameState state;
+    state.players.reserve(player_list.size());
+    for (const auto& player : player_list) {
+        state.players.push_back(player->capture_state());
+    }
+    state.current_turn = current_turn;
+    state.game_started = game_started;
+    state.treasury = treasury;
+    state.last_arrested_player = last_arrested_player;
+    state.actions_remaining = actions_remaining;
+    return state;
+}
+
+void Game::restore_state(const GameState& state) {
+    if (state.players.size() != player_list.size()) {
+        throw GameException("Saved state does not match the seated players");
+    }
+    for (size_t i = 0; i < player_list.size(); ++i) {
+        player_list[i]->restore_state(state.players[i]);
+    }
+    current_turn = state.current_turn;
+    game_started = state.game_started;
+    treasury = state.treasury;
+    last_arrested_player = state.last_arrested_player;
+    actions_remaining = state.actions_remaining;
+}
+
 void Game::force_cleanup_inactive_players() {
     cleanup_inactive_players();
 }
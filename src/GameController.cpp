@@ -0,0 +1,561 @@
+//meirshuker159@gmail.com
+
+#include "GameController.hpp"
+#include "ActionValidator.hpp"
+#include "Exceptions.hpp"
+#include "Metrics.hpp"
+#include "Roles.hpp"
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief Formats a number into a caller's buffer, for messages built without allocating
+ */
+std::string_view formatNumber(char (&buffer)[16], int value) {
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string_view(buffer, static_cast<std::size_t>(result.ptr - buffer));
+}
+
+} // namespace
+
+GameController::GameController(std::shared_ptr<Game> game)
+    : game(game), currentPhase(game->is_active() ? GamePhase::Playing : GamePhase::Setup), sink(),
+      pendingAction(ActionType::Gather), pendingActor(nullptr), pendingTarget(nullptr),
+      blockerSeats(), blockerCount(0), lastTurnSeat(NO_SEAT), winnerSeat(NO_SEAT),
+      eliminatedSeat(NO_SEAT), eliminationCount(0), message(""), messageCount(0), version(0), metered(true),
+      turnStartedNanos(0), treasuryEmpty(false), tracksBeliefs(true),
+      tracker(game->player_count(), game->get_rules()) {
+    // Room for any message the snapshot can show, so setting one never allocates
+    message.reserve(sizeof(GameSnapshot::message));
+}
+
+/**
+ * @brief Validates the name and adds a randomly assigned role to the game
+ * @details Mirrors the original GUI setup rules: names must be unique and
+ * non-empty, and a full table of six starts immediately.
+ */
+void GameController::addPlayer(const std::string& name) {
+    version++;
+    if (currentPhase != GamePhase::Setup) {
+        throw GameException("Game has already started");
+    }
+    if (name.empty()) {
+        throw GameException("Player name cannot be empty");
+    }
+    std::vector<std::string> existingPlayers = game->players();
+    if (std::find(existingPlayers.begin(), existingPlayers.end(), name) != existingPlayers.end()) {
+        throw GameException("Player name already exists");
+    }
+    game->add_player(game->create_random_player(name));
+    if (game->player_count() >= 6) {
+        startGame();
+    }
+}
+
+void GameController::startGame() {
+    version++;
+    if (currentPhase != GamePhase::Setup) {
+        throw GameException("Game has already started");
+    }
+    if (game->players().size() < 2) {
+        throw GameException("Need at least 2 players to start the game");
+    }
+    game->start_game();
+    currentPhase = GamePhase::Playing;
+    tracker = BeliefTracker(game->player_count(), game->get_rules());
+    emit(ActionType::GameStart, nullptr, nullptr, static_cast<std::uint8_t>(game->player_count()));
+    afterStateChange();
+}
+
+/**
+ * @brief Validates and dispatches an action request
+ * @details Uses ActionValidator for all rule checks, then routes the action:
+ * blockable actions go through startBlockPhase, Spy abilities and End Turn
+ * are applied directly, and Gather/Invest go straight to perform().
+ */
+void GameController::requestAction(ActionType action, std::uint8_t targetSeat) {
+    version++;
+    if (currentPhase != GamePhase::Playing) {
+        throw GameException("Cannot act right now");
+    }
+    auto actor = game->get_current_player();
+    if (!actor) {
+        throw GameException("No current player");
+    }
+
+    std::shared_ptr<Player> target = nullptr;
+    if (ActionValidator::requiresTarget(action)) {
+        target = playerAt(targetSeat);
+        if (!target) {
+            if (metered) {
+                metrics::countValidationFailure(ValidationFailure::TargetRequired);
+            }
+            throw IllegalTargetException(std::string("Target required for ") + actionTypeName(action));
+        }
+    }
+    try {
+        ActionValidator::validateActionExecution(action, actor.get(), target.get());
+    } catch (const GameException&) {
+        if (metered) {
+            metrics::countValidationFailure(ActionValidator::check(action, actor.get(), target.get()));
+        }
+        throw;
+    }
+    if (metered && action == ActionType::Coup && actor->get_coins() >= 10) {
+        metrics::countForcedCoup();
+    }
+
+    switch (action) {
+        case ActionType::Gather:
+        case ActionType::Invest:
+            perform(action, actor, target);
+            break;
+        case ActionType::Tax:
+        case ActionType::Bribe:
+        case ActionType::Arrest:
+        case ActionType::Sanction:
+        case ActionType::Coup:
+            startBlockPhase(action, actor, target);
+            break;
+        case ActionType::Investigate: {
+            auto spy = std::dynamic_pointer_cast<Spy>(actor);
+            spy->investigate(*target);
+            char coins[16];
+            setMessage({target->get_name(), " has ", formatNumber(coins, target->get_coins()), " coins"});
+            if (game->is_verbose()) {
+                std::cout << "[ACTION LOG] " << actor->get_name() + " (" + actor->role() + ") investigated " << target->get_name() + " and saw " << std::to_string(target->get_coins()) << " coins" << std::endl;
+            }
+            emit(ActionType::Investigate, actor.get(), target.get());
+            break;
+        }
+        case ActionType::BlockArrest: {
+            auto spy = std::dynamic_pointer_cast<Spy>(actor);
+            spy->block_arrest_ability(*target);
+            setMessage({target->get_name(), " is blocked from using arrest this turn!"});
+            if (game->is_verbose()) {
+                std::cout << "[ACTION LOG] " << actor->get_name() + " (" + actor->role() + ") blocked " << target->get_name() << "'s arrest ability" << std::endl;
+            }
+            emit(ActionType::BlockArrest, actor.get(), target.get());
+            break;
+        }
+        case ActionType::EndTurn:
+            // Force end turn regardless of remaining actions
+            if (game->is_verbose()) {
+                std::cout << "[ACTION LOG] " << actor->get_name() + " (" + actor->role() + ") ended turn" << std::endl;
+            }
+            game->next_turn();
+            emit(ActionType::EndTurn, actor.get(), nullptr);
+            break;
+        default:
+            throw IllegalMoveException(std::string(actionTypeName(action)) + " is not a player action");
+    }
+    afterStateChange();
+}
+
+/**
+ * @brief Identifies all active players who can block the action
+ * @details Either proceeds immediately (if no blockers exist) or enters the
+ * BlockPending phase and waits for block() or pass().
+ */
+void GameController::startBlockPhase(ActionType action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target) {
+    blockerCount = 0;
+    const std::string actionName = actionTypeName(action);  // Short enough to stay off the heap
+    const auto& allPlayers = game->all_players();
+    for (size_t i = 0; i < allPlayers.size(); ++i) {
+        const auto& player = allPlayers[i];
+        if (!player || player == actor || !player->is_active()) continue;  // Skip eliminated players
+        if (player->can_block(actionName)) {
+            blockerSeats[blockerCount++] = static_cast<std::uint8_t>(i);
+        }
+    }
+    if (blockerCount == 0) {
+        perform(action, actor, target);
+        return;
+    }
+    pendingAction = action;
+    pendingActor = actor;
+    pendingTarget = target;
+    currentPhase = GamePhase::BlockPending;
+}
+
+/**
+ * @brief Applies a block: the blocked action is cancelled and its cost is lost
+ * @details Bribe, Sanction and Coup costs are paid to the treasury anyway, and
+ * a General blocking a coup pays 5 coins. The actor's turn ends.
+ */
+void GameController::block(std::uint8_t blockerSeat) {
+    version++;
+    if (currentPhase != GamePhase::BlockPending) {
+        throw GameException("No action to block");
+    }
+    auto blockerEnd = blockerSeats.begin() + blockerCount;
+    if (std::find(blockerSeats.begin(), blockerEnd, blockerSeat) == blockerEnd) {
+        throw IllegalMoveException("That player cannot block this action");
+    }
+    auto blocker = playerAt(blockerSeat);
+    if (game->is_verbose()) {
+        std::cout << "[ACTION LOG] " << blocker->get_name() + " (" + blocker->role() + ") blocked " << actionTypeName(pendingAction) << " from " << pendingActor->get_name() + " (" + pendingActor->role() + ")" << std::endl;
+    }
+    try {
+        if (pendingAction == ActionType::Bribe) {
+            pendingActor->remove_coins(4);
+            game->add_to_treasury(4);
+            if (game->is_verbose()) {
+                std::cout << "[ACTION LOG] " << pendingActor->get_name() + " (" + pendingActor->role() + ") lost 4 coins from blocked Bribe (returned to treasury)" << std::endl;
+            }
+        } else if (pendingAction == ActionType::Sanction) {
+            pendingActor->remove_coins(3);
+            game->add_to_treasury(3);
+            if (game->is_verbose()) {
+                std::cout << "[ACTION LOG] " << pendingActor->get_name() + " (" + pendingActor->role() + ") lost 3 coins from blocked Sanction (returned to treasury)" << std::endl;
+            }
+        } else if (pendingAction == ActionType::Coup) {
+            pendingActor->remove_coins(7);
+            game->add_to_treasury(7);
+            if (game->is_verbose()) {
+                std::cout << "[ACTION LOG] " << pendingActor->get_name() + " (" + pendingActor->role() + ") lost 7 coins from blocked Coup (returned to treasury)" << std::endl;
+            }
+            if (dynamic_cast<const General*>(blocker.get())) {
+                blocker->remove_coins(5);
+                game->add_to_treasury(5);
+                if (game->is_verbose()) {
+                    std::cout << "[ACTION LOG] " << blocker->get_name() + " (" + blocker->role() + ") paid 5 coins to treasury to block coup" << std::endl;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        if (game->is_verbose()) {
+            std::cerr << "ERROR in blocking: " + std::string(e.what()) << std::endl;
+        }
+    }
+    if (metered) {
+        metrics::countBlock(pendingAction);
+    }
+    emit(ActionType::Block, blocker.get(), pendingActor.get(), static_cast<std::uint8_t>(pendingAction));
+    setMessage({blocker->get_name(), " (", blocker->role(), ") blocked ", actionTypeName(pendingAction), "!"});
+
+    currentPhase = GamePhase::Playing;
+    pendingActor = nullptr;
+    pendingTarget = nullptr;
+    blockerCount = 0;
+    game->next_turn();
+    afterStateChange();
+}
+
+void GameController::pass() {
+    version++;
+    if (currentPhase != GamePhase::BlockPending) {
+        throw GameException("No action to pass on");
+    }
+    currentPhase = GamePhase::Playing;
+    auto actor = pendingActor;
+    auto target = pendingTarget;
+    pendingActor = nullptr;
+    pendingTarget = nullptr;
+    blockerCount = 0;
+    perform(pendingAction, actor, target);
+    afterStateChange();
+}
+
+/**
+ * @brief Executes validated game actions by calling appropriate player methods
+ * @details Routes actions to proper Player class methods, handles role-specific
+ * actions (Baron's invest), sets feedback messages (bribe extra actions),
+ * tracks eliminations (coup), and logs coin summaries.
+ */
+void GameController::perform(ActionType action, std::shared_ptr<Player> actor, std::shared_ptr<Player> target) {
+    try {
+        // Call the actual Player methods instead of duplicating logic
+        if (action == ActionType::Gather) {
+            actor->gather();
+        } else if (action == ActionType::Tax) {
+            actor->tax();
+        } else if (action == ActionType::Bribe) {
+            actor->bribe();
+            char actions[16];
+            setMessage({actor->get_name(), " used Bribe! Choose ", formatNumber(actions, game->get_actions_remaining()),
+                        " more actions (or End Turn)."});
+        } else if (action == ActionType::Invest) {
+            // Cast to Baron and call invest method
+            auto baron = std::dynamic_pointer_cast<Baron>(actor);
+            if (baron) {
+                baron->invest();
+            } else {
+                throw IllegalMoveException("Only Baron can invest");
+            }
+        } else if (action == ActionType::Arrest && target) {
+            actor->arrest(*target);
+        } else if (action == ActionType::Sanction && target) {
+            actor->sanction(*target);
+        } else if (action == ActionType::Coup && target) {
+            actor->coup(*target);
+            eliminatedSeat = seatOf(target.get());
+            eliminationCount++;
+            if (metered) {
+                metrics::countElimination();
+            }
+        } else {
+            throw IllegalMoveException(std::string("Cannot perform ") + actionTypeName(action));
+        }
+        emit(action, actor.get(), target.get());
+        logAllPlayersCoins();
+    } catch (const std::exception& e) {
+        setMessage({e.what()});
+        if (game->is_verbose()) {
+            std::cerr << "ERROR performing action: " + std::string(e.what()) << std::endl;
+        }
+    }
+}
+
+void GameController::reportError(const std::string& text) {
+    version++;
+    setMessage({text});
+}
+
+/**
+ * @brief Enumerates the current player's legal moves
+ * @details Untargeted actions are checked once; targeted actions are checked
+ * against every other active seat.
+ */
+std::size_t GameController::legalMoves(std::array<Move, MAX_MOVES>& moves) const {
+    if (currentPhase != GamePhase::Playing) {
+        return 0;
+    }
+    auto actor = game->get_current_player();
+    if (!actor) {
+        return 0;
+    }
+    const auto& allPlayers = game->all_players();
+    std::size_t count = 0;
+    for (std::uint8_t a = 0; a <= static_cast<std::uint8_t>(ActionType::EndTurn); ++a) {
+        const ActionType action = static_cast<ActionType>(a);
+        if (!ActionValidator::requiresTarget(action)) {
+            if (ActionValidator::check(action, actor.get()) == ValidationFailure::None && count < MAX_MOVES) {
+                moves[count++] = Move{action, NO_SEAT};
+            }
+            continue;
+        }
+        for (size_t seat = 0; seat < allPlayers.size() && seat < MAX_SEATS; ++seat) {
+            const auto& target = allPlayers[seat];
+            if (target == actor || !target->is_active()) continue;
+            if (ActionValidator::check(action, actor.get(), target.get()) == ValidationFailure::None &&
+                count < MAX_MOVES) {
+                moves[count++] = Move{action, static_cast<std::uint8_t>(seat)};
+            }
+        }
+    }
+    return count;
+}
+
+std::shared_ptr<Player> GameController::playerAt(std::uint8_t seat) const {
+    const auto& allPlayers = game->all_players();
+    if (seat >= allPlayers.size()) {
+        return nullptr;
+    }
+    return allPlayers[seat];
+}
+
+std::uint8_t GameController::seatOf(const Player* player) const {
+    if (!player) return NO_SEAT;
+    const auto& allPlayers = game->all_players();
+    for (size_t i = 0; i < allPlayers.size(); ++i) {
+        if (allPlayers[i].get() == player) {
+            return static_cast<std::uint8_t>(i);
+        }
+    }
+    return NO_SEAT;
+}
+
+void GameController::emit(ActionType type, const Player* actor, const Player* target, std::uint8_t detail) {
+    if (metered) {
+        metrics::countEvent(type);
+    }
+    if (!sink && !tracksBeliefs) return;
+    ActionRecord record;
+    record.type = type;
+    record.actor = seatOf(actor);
+    record.target = seatOf(target);
+    record.detail = detail;
+    record.actorCoins = actor ? static_cast<std::uint8_t>(actor->get_coins()) : 0;
+    record.targetCoins = target ? static_cast<std::uint8_t>(target->get_coins()) : 0;
+    record.treasury = static_cast<std::int16_t>(game->get_treasury());
+    if (tracksBeliefs) {
+        tracker.observe(record);
+    }
+    if (sink) {
+        sink(record);
+    }
+}
+
+/**
+ * @brief Detects turn changes and the end of the game
+ * @details Emits a TurnStart record whenever the turn moved to another seat
+ * and a single GameOver record once one player is left. Metered controllers
+ * also time the turn that just ended and note the treasury running dry.
+ */
+void GameController::afterStateChange() {
+    if (currentPhase == GamePhase::Setup || currentPhase == GamePhase::GameOver) {
+        return;
+    }
+    bool empty = game->get_treasury() == 0;
+    if (metered && empty && !treasuryEmpty) {
+        metrics::countTreasuryExhausted();
+    }
+    treasuryEmpty = empty;
+    if (game->is_game_over()) {
+        currentPhase = GamePhase::GameOver;
+        endTurnTiming(false);
+        // The winner is the one active player left, found by seat rather than by name
+        const auto& allPlayers = game->all_players();
+        auto winner = std::find_if(allPlayers.begin(), allPlayers.end(),
+                                   [](const std::shared_ptr<Player>& player) { return player && player->is_active(); });
+        if (winner != allPlayers.end()) {
+            winnerSeat = static_cast<std::uint8_t>(winner - allPlayers.begin());
+            if (game->is_verbose()) {
+                std::cout << "GAME OVER! Winner: " << (*winner)->get_name() << std::endl;
+            }
+            emit(ActionType::GameOver, winner->get(), nullptr);
+        }
+        return;
+    }
+    auto current = game->get_current_player();
+    std::uint8_t seat = seatOf(current.get());
+    if (seat != lastTurnSeat) {
+        lastTurnSeat = seat;
+        endTurnTiming(true);
+        emit(ActionType::TurnStart, current.get(), nullptr);
+    }
+}
+
+void GameController::endTurnTiming(bool nextTurnStarts) {
+    if (!metered) {
+        return;
+    }
+    std::uint64_t now = metrics::clockNanos();
+    if (turnStartedNanos != 0) {
+        metrics::recordTurn(now - turnStartedNanos);
+    }
+    turnStartedNanos = nextTurnStarts ? now : 0;
+}
+
+void GameController::pendingSeats(std::uint8_t& actor, std::uint8_t& target) const {
+    bool pending = currentPhase == GamePhase::BlockPending;
+    actor = pending ? seatOf(pendingActor.get()) : NO_SEAT;
+    target = pending ? seatOf(pendingTarget.get()) : NO_SEAT;
+}
+
+ControllerState GameController::saveState() const {
+    ControllerState state;
+    state.game = game->capture_state();
+    state.phase = currentPhase;
+    state.pendingAction = pendingAction;
+    state.pendingActor = seatOf(pendingActor.get());
+    state.pendingTarget = seatOf(pendingTarget.get());
+    state.blockerSeats = blockerSeats;
+    state.blockerCount = blockerCount;
+    state.lastTurnSeat = lastTurnSeat;
+    state.winnerSeat = winnerSeat;
+    state.eliminatedSeat = eliminatedSeat;
+    state.eliminationCount = eliminationCount;
+    state.message = message;
+    state.messageCount = messageCount;
+    state.beliefs = tracker;
+    return state;
+}
+
+void GameController::restoreState(const ControllerState& state) {
+    version++;
+    game->restore_state(state.game);
+    currentPhase = state.phase;
+    pendingAction = state.pendingAction;
+    pendingActor = playerAt(state.pendingActor);
+    pendingTarget = playerAt(state.pendingTarget);
+    blockerSeats = state.blockerSeats;
+    blockerCount = state.blockerCount;
+    lastTurnSeat = state.lastTurnSeat;
+    winnerSeat = state.winnerSeat;
+    eliminatedSeat = state.eliminatedSeat;
+    eliminationCount = state.eliminationCount;
+    message = state.message;
+    messageCount = state.messageCount;
+    tracker = state.beliefs;
+    turnStartedNanos = 0;
+    treasuryEmpty = game->get_treasury() == 0;
+}
+
+void GameController::setMessage(std::initializer_list<std::string_view> parts) {
+    message.clear();
+    for (std::string_view part : parts) {
+        message.append(part.data(), part.size());
+    }
+    messageCount++;
+}
+
+void GameController::logAllPlayersCoins() const {
+    if (!game->is_verbose()) {
+        return;
+    }
+    std::string coinSummaryForCLI = "COINS: ";
+    std::vector<std::string> cliPlayerNames = game->players();
+    for (size_t k = 0; k < cliPlayerNames.size(); ++k) {
+        auto player = game->get_player_by_name(cliPlayerNames[k]);
+        if (player) {
+            coinSummaryForCLI += cliPlayerNames[k] + "(" + std::to_string(player->get_coins()) + ")";
+            if (k < cliPlayerNames.size() - 1) coinSummaryForCLI += ", ";
+        }
+    }
+    std::cout << "[ACTION LOG] " << coinSummaryForCLI << std::endl;
+}
+
+/**
+ * @brief Copies the full game state into a fixed-size snapshot
+ * @details Action availability uses the same ActionValidator checks the GUI
+ * buttons always used, evaluated once per state change instead of per frame.
+ */
+void GameController::fillSnapshot(GameSnapshot& snapshot) const {
+    snapshot.version = version;
+    snapshot.phase = currentPhase;
+    snapshot.treasury = static_cast<std::int16_t>(game->get_treasury());
+    snapshot.actionsRemaining = static_cast<std::int16_t>(game->get_actions_remaining());
+
+    const auto& allPlayers = game->all_players();
+    snapshot.playerCount = static_cast<std::uint8_t>(std::min(allPlayers.size(), MAX_SEATS));
+    for (size_t i = 0; i < snapshot.playerCount; ++i) {
+        PlayerView& view = snapshot.players[i];
+        copyFixedString(view.name, allPlayers[i]->get_name());
+        copyFixedString(view.role, allPlayers[i]->role());
+        view.coins = static_cast<std::uint8_t>(allPlayers[i]->get_coins());
+        view.active = allPlayers[i]->is_active();
+        view.sanctioned = allPlayers[i]->is_sanctioned();
+        view.arrestBlocked = allPlayers[i]->is_arrest_blocked();
+    }
+
+    auto current = currentPhase == GamePhase::Setup ? nullptr : game->get_current_player();
+    snapshot.currentSeat = seatOf(current.get());
+    snapshot.availableActions = 0;
+    if (current && currentPhase == GamePhase::Playing) {
+        for (std::uint8_t a = 0; a <= static_cast<std::uint8_t>(ActionType::EndTurn); ++a) {
+            if (ActionValidator::isActionAvailableForButton(static_cast<ActionType>(a), current.get())) {
+                snapshot.availableActions |= static_cast<std::uint16_t>(1u << a);
+            }
+        }
+    }
+
+    snapshot.pendingAction = pendingAction;
+    snapshot.pendingActor = currentPhase == GamePhase::BlockPending ? seatOf(pendingActor.get()) : NO_SEAT;
+    snapshot.blockerCount = currentPhase == GamePhase::BlockPending ? blockerCount : 0;
+    snapshot.blockers = blockerSeats;
+
+    snapshot.winnerSeat = winnerSeat;
+    snapshot.eliminatedSeat = eliminatedSeat;
+    snapshot.eliminationCount = eliminationCount;
+    snapshot.messageCount = messageCount;
+    copyFixedString(snapshot.message, message);
+}
+
+} // namespace coup
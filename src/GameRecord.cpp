@@ -0,0 +1,172 @@
+//meirshuker159@gmail.com
+
+#include "GameRecord.hpp"
+#include "Exceptions.hpp"
+#include "GameController.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace coup {
+
+namespace {
+const char* const RECORD_HEADER = "COUP-RECORD 1";
+constexpr long long RESERVED_MOVES = 4096; ///< Most moves reserved up front; a longer record grows as it is read
+}
+
+void GameRecord::captureSeats(const Game& game) {
+    seats.clear();
+    for (const auto& player : game.all_players()) {
+        seats.push_back(SeatRecord{player->get_name(), player->role()});
+    }
+    rules = game.get_rules();
+}
+
+std::shared_ptr<Game> GameRecord::createGame() const {
+    auto game = std::make_shared<Game>();
+    game->set_rules(rules);
+    for (const auto& seat : seats) {
+        game->add_player(game->create_player(seat.name, seat.role));
+    }
+    return game;
+}
+
+void GameRecord::play(GameController& controller, const RecordedMove& move) {
+    switch (move.kind) {
+        case RecordedMove::Kind::Action:
+            controller.requestAction(move.action, move.seat);
+            break;
+        case RecordedMove::Kind::Block:
+            controller.block(move.seat);
+            break;
+        case RecordedMove::Kind::Pass:
+            controller.pass();
+            break;
+    }
+}
+
+void GameRecord::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) {
+        throw GameException("Cannot write game record: " + path);
+    }
+    out << RECORD_HEADER << "\n";
+    out << "seats " << seats.size() << "\n";
+    for (const auto& seat : seats) {
+        out << seat.role << " " << seat.name << "\n";
+    }
+    if (rules != RuleSet()) {
+        out << "rules " << rules.taxAmount << " " << rules.governorTax << " " << rules.merchantThreshold << " "
+            << rules.merchantBonus << "\n";
+    }
+    out << "moves " << moves.size() << "\n";
+    for (const auto& move : moves) {
+        switch (move.kind) {
+            case RecordedMove::Kind::Action:
+                out << "A " << static_cast<int>(move.action) << " " << static_cast<int>(move.seat) << "\n";
+                break;
+            case RecordedMove::Kind::Block:
+                out << "B " << static_cast<int>(move.seat) << "\n";
+                break;
+            case RecordedMove::Kind::Pass:
+                out << "P\n";
+                break;
+        }
+    }
+    if (!out) {
+        throw GameException("Cannot write game record: " + path);
+    }
+}
+
+/**
+ * @brief Parses a record file
+ * @details Every line is checked; seat and action numbers must be in range so
+ * a damaged file fails here instead of in the middle of a replay.
+ */
+GameRecord GameRecord::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw GameException("Cannot open game record: " + path);
+    }
+    auto malformed = [&path](const std::string& what) {
+        return GameException("Malformed game record " + path + ": " + what);
+    };
+
+    std::string line;
+    if (!std::getline(in, line) || line != RECORD_HEADER) {
+        throw malformed("missing header");
+    }
+
+    GameRecord record;
+    std::string keyword;
+    std::size_t count = 0;
+    if (!std::getline(in, line) || !(std::istringstream(line) >> keyword >> count) || keyword != "seats" ||
+        count < 2 || count > MAX_SEATS) {
+        throw malformed("bad seat count");
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!std::getline(in, line)) {
+            throw malformed("missing seat");
+        }
+        std::size_t space = line.find(' ');
+        if (space == std::string::npos || space + 1 >= line.size()) {
+            throw malformed("bad seat line");
+        }
+        record.seats.push_back(SeatRecord{line.substr(space + 1), line.substr(0, space)});
+    }
+
+    if (!std::getline(in, line)) {
+        throw malformed("bad move count");
+    }
+    if (line.compare(0, 6, "rules ") == 0) {
+        // Optional: records of games played by the standard rules have no rules line
+        std::istringstream fields(line.substr(6));
+        RuleSet rules;
+        if (!(fields >> rules.taxAmount >> rules.governorTax >> rules.merchantThreshold >> rules.merchantBonus) ||
+            rules.taxAmount < 0 || rules.governorTax < 0 || rules.merchantThreshold < 0 || rules.merchantBonus < 0) {
+            throw malformed("bad rules line");
+        }
+        record.rules = rules;
+        if (!std::getline(in, line)) {
+            throw malformed("bad move count");
+        }
+    }
+    long long moves = 0;
+    if (!(std::istringstream(line) >> keyword >> moves) || keyword != "moves" || moves < 0) {
+        throw malformed("bad move count");
+    }
+    // The count is only trusted as far as the lines are there to back it
+    count = static_cast<std::size_t>(moves);
+    record.moves.reserve(static_cast<std::size_t>(std::min(moves, RESERVED_MOVES)));
+    std::size_t firstMoveLine = 4 + record.seats.size() + (record.rules != RuleSet() ? 1 : 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!std::getline(in, line)) {
+            throw malformed("missing move");
+        }
+        std::istringstream fields(line);
+        std::string kind;
+        int action = 0;
+        int seat = NO_SEAT;
+        RecordedMove move;
+        fields >> kind;
+        if (kind == "A" && fields >> action >> seat &&
+            action >= 0 && action <= static_cast<int>(ActionType::EndTurn)) {
+            move.kind = RecordedMove::Kind::Action;
+            move.action = static_cast<ActionType>(action);
+        } else if (kind == "B" && fields >> seat) {
+            move.kind = RecordedMove::Kind::Block;
+        } else if (kind == "P") {
+            move.kind = RecordedMove::Kind::Pass;
+        } else {
+            throw malformed("bad move on line " + std::to_string(firstMoveLine + i));
+        }
+        if (seat < 0 || seat > NO_SEAT) {
+            throw malformed("bad seat number");
+        }
+        move.seat = static_cast<std::uint8_t>(seat);
+        record.moves.push_back(move);
+    }
+    return record;
+}
+
+} // namespace coup
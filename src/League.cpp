@@ -0,0 +1,186 @@
+//meirshuker159@gmail.com
+
+#include "League.hpp"
+#include "Bot.hpp"
+#include "Exceptions.hpp"
+#include "GameRecord.hpp"
+#include "SimStats.hpp"
+#include "ThreadPool.hpp"
+#include "Tournament.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief Finishing order of one played table
+ */
+struct TableResult {
+    std::vector<std::size_t> entrants; ///< Entrant of each seat
+    std::vector<std::uint32_t> ranks; ///< Place of each seat, 0 for first
+    bool truncated = false; ///< Cut off at the step limit
+    std::string error; ///< Set if the game could not be played
+};
+
+/**
+ * @brief Plays one table of a league
+ * @param index Game number; with the seed it fixes the deal and the bots' seeds
+ * @param entrants Entrant of each seat
+ */
+TableResult playTable(const LeagueConfig& config, std::uint64_t index, const std::vector<std::size_t>& entrants) {
+    std::seed_seq seq{config.seed, static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32)};
+    std::mt19937 rng(seq);
+    std::uniform_int_distribution<std::size_t> deal(0, ROLE_COUNT - 1);
+    GameRecord record;
+    record.rules = config.rules;
+    std::vector<std::unique_ptr<Bot>> bots;
+    std::vector<Bot*> players;
+    for (std::size_t seat = 0; seat < entrants.size(); ++seat) {
+        record.seats.push_back(SeatRecord{"P" + std::to_string(seat + 1), roleName(deal(rng))});
+        bots.push_back(createBot(config.bots[entrants[seat]], rng()));
+        players.push_back(bots.back().get());
+    }
+
+    std::vector<std::uint32_t> eliminations;
+    TableResult result;
+    result.entrants = entrants;
+    result.truncated = playBotGame(record, players, config.stepLimit, &eliminations) == NO_SEAT;
+    result.ranks = finishingPlaces(eliminations);
+    return result;
+}
+
+/**
+ * @brief Lists every group of size entrants, in lexicographic order
+ */
+std::vector<std::vector<std::size_t>> allGroups(std::size_t entrants, std::size_t size) {
+    std::vector<std::vector<std::size_t>> groups;
+    std::vector<std::size_t> group(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        group[i] = i;
+    }
+    for (;;) {
+        groups.push_back(group);
+        std::size_t i = size;
+        while (i > 0 && group[i - 1] == entrants - size + i - 1) {
+            --i;
+        }
+        if (i == 0) {
+            return groups;
+        }
+        group[i - 1]++;
+        for (std::size_t j = i; j < size; ++j) {
+            group[j] = group[j - 1] + 1;
+        }
+    }
+}
+
+/**
+ * @brief Rotates a table's seating so every entrant gets to move first in turn
+ */
+std::vector<std::size_t> rotated(std::vector<std::size_t> table, std::uint32_t by) {
+    std::rotate(table.begin(), table.begin() + static_cast<std::ptrdiff_t>(by % table.size()), table.end());
+    return table;
+}
+
+} // namespace
+
+LeagueResult runLeague(const LeagueConfig& config) {
+    if (config.tableSize < 2 || config.tableSize > MAX_SEATS) {
+        throw GameException("League tables seat 2 to " + std::to_string(MAX_SEATS) + " players");
+    }
+    if (config.bots.size() < config.tableSize) {
+        throw GameException("A league needs at least as many bots as seats at a table");
+    }
+    LeagueResult result;
+    for (std::size_t i = 0; i < config.bots.size(); ++i) {
+        const std::string& type = config.bots[i];
+        checkMatchBot(type);
+        // Repeated types are told apart by a count: random, random#2, ...
+        std::size_t copy = std::count(config.bots.begin(), config.bots.begin() + static_cast<std::ptrdiff_t>(i), type);
+        result.ratings.add(copy == 0 ? type : type + "#" + std::to_string(copy + 1));
+    }
+
+    // Shared with the jobs; declared before the pool so they outlive its workers
+    std::mutex mutex;
+    std::condition_variable arrived;
+    std::vector<TableResult> results;
+    std::vector<bool> ready;
+    ThreadPool pool(config.threads);
+    result.threads = pool.size();
+
+    // Queues a batch of tables, then rates them in game order as they arrive
+    auto playBatch = [&](const std::vector<std::vector<std::size_t>>& tables) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.assign(tables.size(), TableResult());
+            ready.assign(tables.size(), false);
+        }
+        std::uint64_t first = result.games;
+        for (std::size_t i = 0; i < tables.size(); ++i) {
+            pool.submit([&, i, first, table = tables[i]]() {
+                TableResult played;
+                try {
+                    played = playTable(config, first + i, table);
+                } catch (const std::exception& e) {
+                    played.error = e.what();
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                results[i] = std::move(played);
+                ready[i] = true;
+                arrived.notify_one();
+            });
+        }
+        for (std::size_t i = 0; i < tables.size(); ++i) {
+            TableResult played;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                arrived.wait(lock, [&ready, i]() { return ready[i]; });
+                played = std::move(results[i]);
+            }
+            if (!played.error.empty()) {
+                // Later jobs still write into results; wait for them before unwinding
+                std::unique_lock<std::mutex> lock(mutex);
+                arrived.wait(lock, [&ready]() { return std::find(ready.begin(), ready.end(), false) == ready.end(); });
+                throw GameException("League game failed: " + played.error);
+            }
+            result.ratings.update(played.entrants, played.ranks);
+            result.games++;
+            result.truncated += played.truncated ? 1 : 0;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    if (config.format == LeagueFormat::RoundRobin) {
+        std::vector<std::vector<std::size_t>> groups = allGroups(config.bots.size(), config.tableSize);
+        std::vector<std::vector<std::size_t>> tables;
+        tables.reserve(groups.size() * config.rounds);
+        for (std::uint32_t round = 0; round < config.rounds; ++round) {
+            for (const auto& group : groups) {
+                tables.push_back(rotated(group, round));
+            }
+        }
+        playBatch(tables);
+    } else {
+        for (std::uint32_t round = 0; round < config.rounds; ++round) {
+            // Neighbours in the standings share a table; a single leftover entrant sits out
+            std::vector<std::size_t> order = result.ratings.standings();
+            std::vector<std::vector<std::size_t>> tables;
+            for (std::size_t at = 0; at + 1 < order.size(); at += config.tableSize) {
+                std::size_t end = std::min(order.size(), at + config.tableSize);
+                tables.push_back(rotated(std::vector<std::size_t>(order.begin() + static_cast<std::ptrdiff_t>(at),
+                                                                  order.begin() + static_cast<std::ptrdiff_t>(end)),
+                                         round));
+            }
+            playBatch(tables);
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace coup
@@ -0,0 +1,366 @@
+//meirshuker159@gmail.com
+
+#include "Metrics.hpp"
+#include "Exceptions.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief One thread's counters, laid out like MetricsSnapshot
+ * @details Written by its thread only (or, for the shared overflow slot, by
+ * several, hence atomics), read by collectMetrics() at any time.
+ */
+struct alignas(64) ThreadMetrics {
+    std::array<std::atomic<std::uint64_t>, METRIC_EVENT_TYPES> events;
+    std::array<std::atomic<std::uint64_t>, METRIC_FAILURE_REASONS> validationFailures;
+    std::array<std::atomic<std::uint64_t>, METRIC_EVENT_TYPES> blocks;
+    std::atomic<std::uint64_t> forcedCoups;
+    std::atomic<std::uint64_t> eliminations;
+    std::atomic<std::uint64_t> treasuryExhausted;
+    std::array<std::atomic<std::uint64_t>, HdrBuckets::COUNT> turnNanos;
+    std::atomic<std::uint64_t> turns;
+    std::atomic<std::uint64_t> turnNanosSum;
+};
+
+constexpr std::size_t THREAD_SLOTS = 64; ///< Threads with a slot of their own; the rest share one
+
+/**
+ * @brief Every slot, plus the totals of exited threads
+ * @details Slots are static, so claiming one never allocates. The mutex only
+ * guards claiming, handing back and collecting, never a recording.
+ */
+struct MetricsRegistry {
+    std::mutex mutex;
+    ThreadMetrics slots[THREAD_SLOTS];
+    bool claimed[THREAD_SLOTS] = {};
+    ThreadMetrics shared; ///< Used by threads that found every slot taken
+    MetricsSnapshot retired; ///< Counts of exited threads
+};
+
+MetricsRegistry& registry() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+template <typename Visit>
+void forEachCounter(ThreadMetrics& slot, MetricsSnapshot& totals, Visit visit) {
+    for (std::size_t i = 0; i < METRIC_EVENT_TYPES; ++i) {
+        visit(slot.events[i], totals.events[i]);
+        visit(slot.blocks[i], totals.blocks[i]);
+    }
+    for (std::size_t i = 0; i < METRIC_FAILURE_REASONS; ++i) {
+        visit(slot.validationFailures[i], totals.validationFailures[i]);
+    }
+    visit(slot.forcedCoups, totals.forcedCoups);
+    visit(slot.eliminations, totals.eliminations);
+    visit(slot.treasuryExhausted, totals.treasuryExhausted);
+    for (std::size_t i = 0; i < HdrBuckets::COUNT; ++i) {
+        visit(slot.turnNanos[i], totals.turnNanos[i]);
+    }
+    visit(slot.turns, totals.turns);
+    visit(slot.turnNanosSum, totals.turnNanosSum);
+}
+
+void addInto(ThreadMetrics& slot, MetricsSnapshot& totals) {
+    forEachCounter(slot, totals, [](std::atomic<std::uint64_t>& counter, std::uint64_t& total) {
+        total += counter.load(std::memory_order_relaxed);
+    });
+}
+
+#ifdef COUP_METRICS
+
+/**
+ * @brief Hands a thread's slot back when the thread exits, keeping its counts
+ */
+struct SlotLease {
+    std::size_t slot = THREAD_SLOTS;
+
+    ~SlotLease() {
+        if (slot == THREAD_SLOTS) {
+            return;
+        }
+        MetricsRegistry& all = registry();
+        std::lock_guard<std::mutex> lock(all.mutex);
+        forEachCounter(all.slots[slot], all.retired, [](std::atomic<std::uint64_t>& counter, std::uint64_t& total) {
+            total += counter.exchange(0, std::memory_order_relaxed);
+        });
+        all.claimed[slot] = false;
+    }
+};
+
+thread_local ThreadMetrics* local = nullptr;
+thread_local SlotLease lease;
+
+ThreadMetrics& claimSlot() {
+    MetricsRegistry& all = registry();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    local = &all.shared;
+    for (std::size_t i = 0; i < THREAD_SLOTS; ++i) {
+        if (!all.claimed[i]) {
+            all.claimed[i] = true;
+            lease.slot = i;
+            local = &all.slots[i];
+            break;
+        }
+    }
+    return *local;
+}
+
+inline ThreadMetrics& threadMetrics() {
+    return local ? *local : claimSlot();
+}
+
+inline void bump(std::atomic<std::uint64_t>& counter, std::uint64_t amount = 1) {
+    counter.fetch_add(amount, std::memory_order_relaxed);
+}
+
+#endif
+
+/**
+ * @brief Writes a number of seconds without trailing zeros
+ */
+std::string seconds(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.9g", value);
+    return text;
+}
+
+void writeHeader(std::ostream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+}
+
+} // namespace
+
+double MetricsSnapshot::turnQuantile(double q) const {
+    if (turns == 0) {
+        return 0.0;
+    }
+    q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+    std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(turns - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < HdrBuckets::COUNT; ++i) {
+        seen += turnNanos[i];
+        if (seen >= rank) {
+            double middle = (static_cast<double>(HdrBuckets::lowerBound(i)) +
+                             static_cast<double>(HdrBuckets::upperBound(i) - 1)) / 2.0;
+            return middle / 1e9;
+        }
+    }
+    return static_cast<double>(HdrBuckets::lowerBound(HdrBuckets::COUNT - 1)) / 1e9;
+}
+
+void MetricsSnapshot::writePrometheus(std::ostream& out) const {
+    writeHeader(out, "coup_events_total", "counter", "Records emitted by game controllers, by type.");
+    for (std::size_t i = 0; i < METRIC_EVENT_TYPES; ++i) {
+        out << "coup_events_total{type=\"" << actionTypeName(static_cast<ActionType>(i)) << "\"} " << events[i]
+            << '\n';
+    }
+
+    writeHeader(out, "coup_validation_failures_total", "counter", "Action requests rejected by validation, by reason.");
+    for (std::size_t i = 1; i < METRIC_FAILURE_REASONS; ++i) {
+        out << "coup_validation_failures_total{reason=\"" << validationFailureName(static_cast<ValidationFailure>(i))
+            << "\"} " << validationFailures[i] << '\n';
+    }
+
+    writeHeader(out, "coup_blocks_total", "counter", "Blocked actions, by the action blocked.");
+    const ActionType blockable[] = {ActionType::Tax, ActionType::Bribe, ActionType::Arrest, ActionType::Sanction,
+                                    ActionType::Coup};
+    for (ActionType action : blockable) {
+        out << "coup_blocks_total{action=\"" << actionTypeName(action) << "\"} "
+            << blocks[static_cast<std::size_t>(action)] << '\n';
+    }
+
+    writeHeader(out, "coup_forced_coups_total", "counter", "Coups by players holding 10 or more coins.");
+    out << "coup_forced_coups_total " << forcedCoups << '\n';
+    writeHeader(out, "coup_eliminations_total", "counter", "Players eliminated.");
+    out << "coup_eliminations_total " << eliminations << '\n';
+    writeHeader(out, "coup_treasury_exhausted_total", "counter", "Times the treasury ran dry.");
+    out << "coup_treasury_exhausted_total " << treasuryExhausted << '\n';
+
+    writeHeader(out, "coup_turn_duration_seconds", "histogram", "Wall time a seat held the turn.");
+    const double bounds[] = {1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 0.1, 1.0, 10.0, 60.0};
+    std::size_t bucket = 0;
+    std::uint64_t cumulative = 0;
+    for (double bound : bounds) {
+        std::uint64_t limit = static_cast<std::uint64_t>(bound * 1e9);
+        while (bucket < HdrBuckets::COUNT && HdrBuckets::upperBound(bucket) - 1 <= limit) {
+            cumulative += turnNanos[bucket++];
+        }
+        out << "coup_turn_duration_seconds_bucket{le=\"" << seconds(bound) << "\"} " << cumulative << '\n';
+    }
+    out << "coup_turn_duration_seconds_bucket{le=\"+Inf\"} " << turns << '\n'
+        << "coup_turn_duration_seconds_sum " << seconds(static_cast<double>(turnNanosSum) / 1e9) << '\n'
+        << "coup_turn_duration_seconds_count " << turns << '\n';
+
+    writeHeader(out, "coup_turn_duration_quantile_seconds", "gauge",
+                "Turn duration quantiles estimated from the HDR histogram (6% resolution).");
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        out << "coup_turn_duration_quantile_seconds{quantile=\"" << q << "\"} " << seconds(turnQuantile(q)) << '\n';
+    }
+}
+
+MetricsSnapshot collectMetrics() {
+    MetricsRegistry& all = registry();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    MetricsSnapshot totals = all.retired;
+    for (std::size_t i = 0; i < THREAD_SLOTS; ++i) {
+        if (all.claimed[i]) {
+            addInto(all.slots[i], totals);
+        }
+    }
+    addInto(all.shared, totals);
+    return totals;
+}
+
+void writeMetricsFile(const std::string& path) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        collectMetrics().writePrometheus(out);
+        if (!out) {
+            throw GameException("Cannot write metrics to " + temporary);
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw GameException("Cannot replace " + path);
+    }
+}
+
+MetricsServer::MetricsServer(std::uint16_t port) : listener(-1), boundPort(0), stopping(false) {
+    listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw GameException("Cannot open a metrics socket");
+    }
+    int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, 16) != 0 ||
+        ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        ::close(listener);
+        throw GameException("Cannot listen for metrics on 127.0.0.1:" + std::to_string(port));
+    }
+    boundPort = ntohs(address.sin_port);
+    worker = std::thread([this]() { serve(); });
+}
+
+MetricsServer::~MetricsServer() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    ::close(listener);
+}
+
+/**
+ * @brief Answers one request per connection until stopped
+ * @details Polls with a short timeout so the destructor is never kept
+ * waiting; a client that stalls for a second is dropped.
+ */
+void MetricsServer::serve() {
+    while (!stopping) {
+        pollfd waiting{listener, POLLIN, 0};
+        if (::poll(&waiting, 1, 100) <= 0) {
+            continue;
+        }
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        timeval timeout{1, 0};
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            ssize_t received = ::recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                break;
+            }
+            request.append(buffer, static_cast<std::size_t>(received));
+        }
+        std::string status = "404 Not Found";
+        std::string body = "Not found\n";
+        if (request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET / ", 0) == 0) {
+            std::ostringstream text;
+            collectMetrics().writePrometheus(text);
+            status = "200 OK";
+            body = text.str();
+        }
+        std::string response = "HTTP/1.1 " + status +
+                               "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        for (std::size_t sent = 0; sent < response.size();) {
+            ssize_t written = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0) {
+                break;
+            }
+            sent += static_cast<std::size_t>(written);
+        }
+        ::close(client);
+    }
+}
+
+#ifdef COUP_METRICS
+
+namespace metrics {
+
+void countEvent(ActionType type) {
+    bump(threadMetrics().events[static_cast<std::size_t>(type)]);
+}
+
+void countValidationFailure(ValidationFailure reason) {
+    bump(threadMetrics().validationFailures[static_cast<std::size_t>(reason)]);
+}
+
+void countBlock(ActionType blocked) {
+    bump(threadMetrics().blocks[static_cast<std::size_t>(blocked)]);
+}
+
+void countForcedCoup() {
+    bump(threadMetrics().forcedCoups);
+}
+
+void countElimination() {
+    bump(threadMetrics().eliminations);
+}
+
+void countTreasuryExhausted() {
+    bump(threadMetrics().treasuryExhausted);
+}
+
+void recordTurn(std::uint64_t nanoseconds) {
+    ThreadMetrics& mine = threadMetrics();
+    bump(mine.turnNanos[HdrBuckets::index(nanoseconds)]);
+    bump(mine.turns);
+    bump(mine.turnNanosSum, nanoseconds);
+}
+
+std::uint64_t clockNanos() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+} // namespace metrics
+
+#endif
+
+} // namespace coup
@@ -0,0 +1,302 @@
+//meirshuker159@gmail.com
+
+#include "Network.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COUP_HAVE_AVX2_KERNEL 1
+#endif
+
+namespace coup {
+
+namespace {
+
+constexpr char MAGIC[8] = {'C', 'O', 'U', 'P', 'M', 'L', 'P', '1'};
+
+/**
+ * @brief Floats per SIMD register; rows are padded to a multiple of it
+ */
+constexpr std::size_t LANES = 8;
+
+std::size_t padded(std::size_t size) {
+    return (size + LANES - 1) / LANES * LANES;
+}
+
+/**
+ * @brief One dense layer: out[b][o] = bias[o] + sum_i in[b][i] * weights[o][i]
+ * @param in batch rows of stride padded(inputs), padding zeroed
+ * @param out batch rows of stride padded(outputs); padding is zeroed too
+ */
+void denseScalar(const float* weights, const float* bias, const float* in, float* out, std::size_t batch,
+                 std::size_t inputs, std::size_t outputs, bool relu) {
+    std::size_t inStride = padded(inputs);
+    std::size_t outStride = padded(outputs);
+    for (std::size_t b = 0; b < batch; ++b) {
+        const float* x = in + b * inStride;
+        float* y = out + b * outStride;
+        for (std::size_t o = 0; o < outputs; ++o) {
+            const float* w = weights + o * inStride;
+            float sum = 0.0f;
+            for (std::size_t i = 0; i < inStride; ++i) {
+                sum += w[i] * x[i];
+            }
+            sum += bias[o];
+            y[o] = relu ? std::max(sum, 0.0f) : sum;
+        }
+        std::fill(y + outputs, y + outStride, 0.0f);
+    }
+}
+
+#ifdef COUP_HAVE_AVX2_KERNEL
+
+__attribute__((target("avx2,fma"))) float horizontalSum(__m256 v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum);
+}
+
+/**
+ * @brief denseScalar() with 8-wide FMAs, four batch rows sharing each weight load
+ */
+__attribute__((target("avx2,fma"))) void denseAvx2(const float* weights, const float* bias, const float* in,
+                                                   float* out, std::size_t batch, std::size_t inputs,
+                                                   std::size_t outputs, bool relu) {
+    std::size_t inStride = padded(inputs);
+    std::size_t outStride = padded(outputs);
+    std::size_t b = 0;
+    for (; b + 4 <= batch; b += 4) {
+        const float* x = in + b * inStride;
+        for (std::size_t o = 0; o < outputs; ++o) {
+            const float* w = weights + o * inStride;
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            __m256 acc2 = _mm256_setzero_ps();
+            __m256 acc3 = _mm256_setzero_ps();
+            for (std::size_t i = 0; i < inStride; i += LANES) {
+                __m256 wv = _mm256_loadu_ps(w + i);
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), wv, acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + inStride + i), wv, acc1);
+                acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(x + 2 * inStride + i), wv, acc2);
+                acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(x + 3 * inStride + i), wv, acc3);
+            }
+            float sums[4] = {horizontalSum(acc0), horizontalSum(acc1), horizontalSum(acc2), horizontalSum(acc3)};
+            for (std::size_t k = 0; k < 4; ++k) {
+                float sum = sums[k] + bias[o];
+                out[(b + k) * outStride + o] = relu ? std::max(sum, 0.0f) : sum;
+            }
+        }
+    }
+    for (; b < batch; ++b) {
+        const float* x = in + b * inStride;
+        for (std::size_t o = 0; o < outputs; ++o) {
+            const float* w = weights + o * inStride;
+            __m256 acc = _mm256_setzero_ps();
+            for (std::size_t i = 0; i < inStride; i += LANES) {
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(w + i), acc);
+            }
+            float sum = horizontalSum(acc) + bias[o];
+            out[b * outStride + o] = relu ? std::max(sum, 0.0f) : sum;
+        }
+    }
+    for (b = 0; b < batch; ++b) {
+        std::fill(out + b * outStride + outputs, out + (b + 1) * outStride, 0.0f);
+    }
+}
+
+#endif
+
+template <typename T>
+void readValue(std::istream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+} // namespace
+
+PolicyValueNet::PolicyValueNet(const std::vector<std::size_t>& sizes, std::uint32_t seed) : sizes(sizes) {
+    allocate();
+    std::mt19937 rng(seed);
+    for (std::size_t layer = 0; layer + 1 < sizes.size(); ++layer) {
+        float limit = std::sqrt(6.0f / static_cast<float>(sizes[layer]));
+        std::uniform_real_distribution<float> weight(-limit, limit);
+        for (std::size_t o = 0; o < sizes[layer + 1]; ++o) {
+            for (std::size_t i = 0; i < sizes[layer]; ++i) {
+                weights[layer][o * padded(sizes[layer]) + i] = weight(rng);
+            }
+        }
+    }
+}
+
+void PolicyValueNet::allocate() {
+    if (sizes.size() < 2 || std::find(sizes.begin(), sizes.end(), 0) != sizes.end()) {
+        throw GameException("A network needs an input size and at least one layer, all non-zero");
+    }
+    if (sizes.back() < 2) {
+        throw GameException("A network needs at least one policy output and the value output");
+    }
+    weights.clear();
+    biases.clear();
+    for (std::size_t layer = 0; layer + 1 < sizes.size(); ++layer) {
+        weights.emplace_back(sizes[layer + 1] * padded(sizes[layer]), 0.0f);
+        biases.emplace_back(sizes[layer + 1], 0.0f);
+    }
+    simd = simdSupported();
+}
+
+PolicyValueNet PolicyValueNet::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw GameException("Cannot open network " + path);
+    }
+    char magic[8] = {};
+    in.read(magic, sizeof(magic));
+    std::uint32_t layers = 0;
+    readValue(in, layers);
+    if (!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || layers == 0 || layers > 64) {
+        throw GameException("Not a network file: " + path);
+    }
+    PolicyValueNet net;
+    for (std::uint32_t i = 0; i <= layers; ++i) {
+        std::uint32_t size = 0;
+        readValue(in, size);
+        if (size > (1u << 16)) {
+            throw GameException("Network layer too large in " + path);
+        }
+        net.sizes.push_back(size);
+    }
+    if (!in) {
+        throw GameException("Truncated network file: " + path);
+    }
+    net.allocate();
+    for (std::size_t layer = 0; layer < layers; ++layer) {
+        std::size_t inputs = net.sizes[layer];
+        for (std::size_t o = 0; o < net.sizes[layer + 1]; ++o) {
+            in.read(reinterpret_cast<char*>(&net.weights[layer][o * padded(inputs)]),
+                    static_cast<std::streamsize>(inputs * sizeof(float)));
+        }
+        in.read(reinterpret_cast<char*>(net.biases[layer].data()),
+                static_cast<std::streamsize>(net.biases[layer].size() * sizeof(float)));
+    }
+    if (!in || in.peek() != std::char_traits<char>::eof()) {
+        throw GameException("Network file has the wrong size: " + path);
+    }
+    return net;
+}
+
+std::shared_ptr<const PolicyValueNet> PolicyValueNet::shared(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const PolicyValueNet>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = cache.find(path);
+    if (found != cache.end()) {
+        return found->second;
+    }
+    auto net = std::make_shared<const PolicyValueNet>(load(path));
+    cache.emplace(path, net);
+    return net;
+}
+
+void PolicyValueNet::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(MAGIC, sizeof(MAGIC));
+    std::uint32_t layers = static_cast<std::uint32_t>(sizes.size() - 1);
+    out.write(reinterpret_cast<const char*>(&layers), sizeof(layers));
+    for (std::size_t size : sizes) {
+        std::uint32_t value = static_cast<std::uint32_t>(size);
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    for (std::size_t layer = 0; layer < weights.size(); ++layer) {
+        std::size_t inputs = sizes[layer];
+        for (std::size_t o = 0; o < sizes[layer + 1]; ++o) {
+            out.write(reinterpret_cast<const char*>(&weights[layer][o * padded(inputs)]),
+                      static_cast<std::streamsize>(inputs * sizeof(float)));
+        }
+        out.write(reinterpret_cast<const char*>(biases[layer].data()),
+                  static_cast<std::streamsize>(biases[layer].size() * sizeof(float)));
+    }
+    if (!out) {
+        throw GameException("Cannot write network " + path);
+    }
+}
+
+void PolicyValueNet::evaluate(const float* inputs, std::size_t batch, float* policy, float* value) const {
+    // Scratch space per thread: evaluations allocate nothing once warmed up
+    thread_local std::vector<float> current;
+    thread_local std::vector<float> next;
+    std::size_t widest = padded(*std::max_element(sizes.begin(), sizes.end()));
+    current.resize(batch * widest);
+    next.resize(batch * widest);
+
+    std::size_t inStride = padded(sizes.front());
+    for (std::size_t b = 0; b < batch; ++b) {
+        std::copy(inputs + b * sizes.front(), inputs + (b + 1) * sizes.front(), current.begin() + b * inStride);
+        std::fill(current.begin() + b * inStride + sizes.front(), current.begin() + (b + 1) * inStride, 0.0f);
+    }
+    for (std::size_t layer = 0; layer < weights.size(); ++layer) {
+        bool relu = layer + 1 < weights.size();
+#ifdef COUP_HAVE_AVX2_KERNEL
+        if (simd) {
+            denseAvx2(weights[layer].data(), biases[layer].data(), current.data(), next.data(), batch, sizes[layer],
+                      sizes[layer + 1], relu);
+        } else
+#endif
+        {
+            denseScalar(weights[layer].data(), biases[layer].data(), current.data(), next.data(), batch,
+                        sizes[layer], sizes[layer + 1], relu);
+        }
+        current.swap(next);
+    }
+
+    std::size_t outStride = padded(sizes.back());
+    std::size_t logits = policyOutputs();
+    for (std::size_t b = 0; b < batch; ++b) {
+        const float* row = current.data() + b * outStride;
+        if (policy) {
+            std::copy(row, row + logits, policy + b * logits);
+        }
+        if (value) {
+            value[b] = std::tanh(row[logits]);
+        }
+    }
+}
+
+void PolicyValueNet::setSimd(bool enabled) {
+    simd = enabled && simdSupported();
+}
+
+bool PolicyValueNet::simdSupported() {
+#ifdef COUP_HAVE_AVX2_KERNEL
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+void maskedSoftmax(const float* logits, const std::uint8_t* legal, std::size_t count, float* out) {
+    float highest = -INFINITY;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (legal[i]) {
+            highest = std::max(highest, logits[i]);
+        }
+    }
+    float total = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = legal[i] ? std::exp(logits[i] - highest) : 0.0f;
+        total += out[i];
+    }
+    if (total > 0.0f) {
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] /= total;
+        }
+    }
+}
+
+} // namespace coup
@@ -2,6 +2,7 @@
 #include "Player.hpp"
 #include "Game.hpp"
 #include "Exceptions.hpp"
+#include "Trace.hpp"
 #include <iostream>
 
 namespace coup {
@@ -27,6 +28,7 @@ Player::Player(std::shared_ptr<Game> game, const std::string& name)
  * Cannot be used while sanctioned. Consumes one action and may end turn.
  */
 void Player::gather() {
+    TraceSpan span("Player::gather", "action");
     validate_action();
     if (sanctioned) {
         throw IllegalMoveException("Player is under sanctions");
@@ -42,8 +44,10 @@ void Player::gather() {
     game_ptr->remove_from_treasury(1);
     add_coins(1);
     
-    std::cout << "[ACTION] " << name << " (" << role() << ") gathered 1 coin - now has " 
-              << coins << " coins (Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+    if (log_enabled()) {
+        std::cout << "[ACTION] " << name << " (" << role() << ") gathered 1 coin - now has " 
+                  << coins << " coins (Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+    }
     
 
     
@@ -63,6 +67,7 @@ void Player::gather() {
  * Cannot be used while sanctioned. Consumes one action and may end turn.
  */
 void Player::tax() {
+    TraceSpan span("Player::tax", "action");
     validate_action();
     if (sanctioned) {
         throw IllegalMoveException("Player is under sanctions");
@@ -73,15 +78,18 @@ void Player::tax() {
         throw GameException("Game no longer exists");
     }
     
-    // Governor gets 3 coins, other roles get 2
-    int tax_amount = (role() == "Governor") ? 3 : 2;
+    // Governor gets 3 coins, other roles get 2 (unless the game's rules say otherwise)
+    const RuleSet& rules = game_ptr->get_rules();
+    int tax_amount = (role() == "Governor") ? rules.governorTax : rules.taxAmount;
     
     // Remove coins from treasury and give to player
     game_ptr->remove_from_treasury(tax_amount);
     add_coins(tax_amount);
     
-    std::cout << "[ACTION] " << name << " (" << role() << ") taxed " << tax_amount << " coins - now has " 
-              << coins << " coins (Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+    if (log_enabled()) {
+        std::cout << "[ACTION] " << name << " (" << role() << ") taxed " << tax_amount << " coins - now has " 
+                  << coins << " coins (Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+    }
     
 
     
@@ -101,6 +109,7 @@ void Player::tax() {
  * The coins are returned to the treasury. Can be blocked by Judge role.
  */
 void Player::bribe() {
+    TraceSpan span("Player::bribe", "action");
     validate_action();
     validate_coins(4);
 
@@ -110,8 +119,10 @@ void Player::bribe() {
         throw GameException("Game no longer exists");
     }
     
-    std::cout << "[ACTION] " << name << " (" << role() << ") used bribe (paid 4 coins) - now has " 
-              << (coins - 4) << " coins and gets 2 extra actions" << std::endl;
+    if (log_enabled()) {
+        std::cout << "[ACTION] " << name << " (" << role() << ") used bribe (paid 4 coins) - now has " 
+                  << (coins - 4) << " coins and gets 2 extra actions" << std::endl;
+    }
     
     remove_coins(4);
     game_ptr->add_to_treasury(4);  // Return coins to treasury
@@ -139,6 +150,7 @@ void Player::bribe() {
  * of the same player and individual arrest blocking.
  */
 void Player::arrest(Player& target) {
+    TraceSpan span("Player::arrest", "action");
     validate_action();
     validate_target(target);
     
@@ -163,8 +175,10 @@ void Player::arrest(Player& target) {
     
     // General arrest immunity - can be arrested but no coin transfer
     if (target.role() == "General") {
-        std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
-                  << " (General) - General immunity: no coins transferred" << std::endl;
+        if (log_enabled()) {
+            std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
+                      << " (General) - General immunity: no coins transferred" << std::endl;
+        }
     }
     // Merchant special case: pays 2 coins to the treasury, if he only has 1 coin he pays 1 and if he has 0 he pays 0
     else if (target.role() == "Merchant") {
@@ -172,24 +186,32 @@ void Player::arrest(Player& target) {
             int coinsToTreasury = std::min(target.get_coins(), 2); // Pay max 2 coins or whatever they have
             target.remove_coins(coinsToTreasury);
             game_ptr->add_to_treasury(coinsToTreasury);
-            std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
-                      << " (Merchant) - Merchant paid " << coinsToTreasury << " coins to treasury (now has " 
-                      << target.get_coins() << " coins, Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+            if (log_enabled()) {
+                std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
+                          << " (Merchant) - Merchant paid " << coinsToTreasury << " coins to treasury (now has " 
+                          << target.get_coins() << " coins, Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+            }
         } else {
-            std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
-                      << " (Merchant) - but Merchant had no coins to pay" << std::endl;
+            if (log_enabled()) {
+                std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
+                          << " (Merchant) - but Merchant had no coins to pay" << std::endl;
+            }
         }
     } else {
         // Normal arrest: transfer 1 coin from target to arrester
         if (target.get_coins() > 0) {
             target.remove_coins(1);
             add_coins(1);
-            std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
-                      << " (" << target.role() << ") - stole 1 coin (" << name << ": " << coins 
-                      << ", " << target.get_name() << ": " << target.get_coins() << ")" << std::endl;
+            if (log_enabled()) {
+                std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
+                          << " (" << target.role() << ") - stole 1 coin (" << name << ": " << coins 
+                          << ", " << target.get_name() << ": " << target.get_coins() << ")" << std::endl;
+            }
         } else {
-            std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
-                      << " (" << target.role() << ") - but target had no coins to steal" << std::endl;
+            if (log_enabled()) {
+                std::cout << "[ACTION] " << name << " (" << role() << ") arrested " << target.get_name() 
+                          << " (" << target.role() << ") - but target had no coins to steal" << std::endl;
+            }
         }
     }
     
@@ -214,6 +236,7 @@ void Player::arrest(Player& target) {
  * Sanctioned players cannot gather or tax on their next turn.
  */
 void Player::sanction(Player& target) {
+    TraceSpan span("Player::sanction", "action");
     validate_action();
     validate_target(target);
     
@@ -227,7 +250,9 @@ void Player::sanction(Player& target) {
     if (target.role() == "Judge") {
         cost = 4;
         validate_coins(4);
-        std::cout << "[ACTION] " << name << " sanctioning Judge costs 4 coins instead of 3" << std::endl;
+        if (log_enabled()) {
+            std::cout << "[ACTION] " << name << " sanctioning Judge costs 4 coins instead of 3" << std::endl;
+        }
     } else {
         validate_coins(3);
     }
@@ -246,18 +271,24 @@ void Player::sanction(Player& target) {
         if (game_ptr->get_treasury() >= 1) {
             game_ptr->remove_from_treasury(1);
             target.add_coins(1);
-            std::cout << "[ACTION] " << name << " (" << role() << ") sanctioned " << target.get_name() 
-                      << " (Baron) - paid " << cost << " coins to treasury, Baron got 1 compensation coin (" << name << ": " 
-                      << coins << ", " << target.get_name() << ": " << target.get_coins() << ", Treasury: " 
-                      << game_ptr->get_treasury() << ")" << std::endl;
+            if (log_enabled()) {
+                std::cout << "[ACTION] " << name << " (" << role() << ") sanctioned " << target.get_name() 
+                          << " (Baron) - paid " << cost << " coins to treasury, Baron got 1 compensation coin (" << name << ": " 
+                          << coins << ", " << target.get_name() << ": " << target.get_coins() << ", Treasury: " 
+                          << game_ptr->get_treasury() << ")" << std::endl;
+            }
         } else {
-            std::cout << "[ACTION] " << name << " (" << role() << ") sanctioned " << target.get_name() 
-                      << " (Baron) - paid " << cost << " coins to treasury, but no compensation available" << std::endl;
+            if (log_enabled()) {
+                std::cout << "[ACTION] " << name << " (" << role() << ") sanctioned " << target.get_name() 
+                          << " (Baron) - paid " << cost << " coins to treasury, but no compensation available" << std::endl;
+            }
         }
     } else {
-        std::cout << "[ACTION] " << name << " (" << role() << ") sanctioned " << target.get_name() 
-                  << " (" << target.role() << ") - paid " << cost << " coins (" << name << ": " 
-                  << coins << ", Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+        if (log_enabled()) {
+            std::cout << "[ACTION] " << name << " (" << role() << ") sanctioned " << target.get_name() 
+                      << " (" << target.role() << ") - paid " << cost << " coins (" << name << ": " 
+                      << coins << ", Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+        }
     }
     
     target.set_sanctioned(true);
@@ -282,6 +313,7 @@ void Player::sanction(Player& target) {
  * The coins are returned to the treasury.
  */
 void Player::coup(Player& target) {
+    TraceSpan span("Player::coup", "action");
     // Validate that the player can perform this action
     validate_action();
     validate_target(target);
@@ -301,9 +333,11 @@ void Player::coup(Player& target) {
     }
     
     // Log the coup action with detailed information
-    std::cout << "[ACTION] " << name << " (" << role() << ") performed coup on " << target.get_name() 
-              << " (" << target.role() << ") - paid 7 coins to treasury, target eliminated (" << name << " now has " 
-              << (coins - 7) << " coins, Treasury: " << (game_ptr->get_treasury() + 7) << ")" << std::endl;
+    if (log_enabled()) {
+        std::cout << "[ACTION] " << name << " (" << role() << ") performed coup on " << target.get_name() 
+                  << " (" << target.role() << ") - paid 7 coins to treasury, target eliminated (" << name << " now has " 
+                  << (coins - 7) << " coins, Treasury: " << (game_ptr->get_treasury() + 7) << ")" << std::endl;
+    }
     
     // Execute payment: player -> treasury
     remove_coins(7);
@@ -412,4 +446,27 @@ void Player::validate_coins(int required) const {
     }
 }
 
+PlayerState Player::capture_state() const {
+    PlayerState state;
+    state.coins = coins;
+    state.active = active;
+    state.sanctioned = sanctioned;
+    state.arrest_blocked = arrest_blocked;
+    state.last_arrested_player = last_arrested_player;
+    return state;
+}
+
+void Player::restore_state(const PlayerState& state) {
+    coins = state.coins;
+    active = state.active;
+    sanctioned = state.sanctioned;
+    arrest_blocked = state.arrest_blocked;
+    last_arrested_player = state.last_arrested_player;
+}
+
+bool Player::log_enabled() const {
+    auto game_ptr = game.lock();
+    return game_ptr && game_ptr->is_verbose();
+}
+
 } // namespace coup 
\ No newline at end of file
@@ -0,0 +1,454 @@
+//meirshuker159@gmail.com
+
+#include "PolicyTable.hpp"
+#include "Bot.hpp"
+#include "Exceptions.hpp"
+#include "Player.hpp"
+#include "Tournament.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace coup {
+
+namespace {
+
+constexpr char MAGIC[8] = {'C', 'O', 'U', 'P', 'L', 'U', 'T', '1'};
+constexpr std::size_t HEADER_BYTES = sizeof(MAGIC) + 2 * sizeof(std::uint32_t);
+
+/**
+ * @brief Role indices as in roleName()
+ */
+enum RoleId : std::size_t { GOVERNOR, SPY, BARON, GENERAL, JUDGE, MERCHANT };
+
+/**
+ * @brief Action classes, the column order of a row
+ */
+enum ClassId : std::size_t { GATHER, TAX, BRIBE, ARREST, SANCTION, COUP, INVEST };
+
+constexpr std::size_t coinBucket(int coins) {
+    return coins <= 2 ? 0 : coins <= 4 ? 1 : coins <= 6 ? 2 : coins <= 9 ? 3 : 4;
+}
+
+constexpr std::size_t treasuryBucket(int treasury) {
+    return treasury < 10 ? 0 : treasury < 25 ? 1 : treasury < 40 ? 2 : 3;
+}
+
+constexpr std::size_t packActionKey(std::size_t coins, std::size_t role, std::size_t richest, std::size_t poorest,
+                                    std::size_t treasury) {
+    return (((coins * ROLE_COUNT + role) * PolicyTable::COIN_BUCKETS + richest) * PolicyTable::COIN_BUCKETS + poorest) *
+               PolicyTable::TREASURY_BUCKETS +
+           treasury;
+}
+
+constexpr std::size_t packBlockKey(std::size_t coins, std::size_t role, std::size_t pending) {
+    return (coins * ROLE_COUNT + role) * PolicyTable::BLOCKABLE + pending;
+}
+
+/**
+ * @brief The built-in heuristic: coup when possible, invest as a Baron, tax
+ * (more as a Governor), pressure the richest opponent, block what the role can
+ */
+constexpr PolicyTable::Data heuristicTable() {
+    PolicyTable::Data data{};
+    for (std::size_t coins = 0; coins < PolicyTable::COIN_LEVELS; ++coins) {
+        for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+            for (std::size_t richest = 0; richest < PolicyTable::COIN_BUCKETS; ++richest) {
+                for (std::size_t poorest = 0; poorest < PolicyTable::COIN_BUCKETS; ++poorest) {
+                    for (std::size_t treasury = 0; treasury < PolicyTable::TREASURY_BUCKETS; ++treasury) {
+                        std::size_t base = packActionKey(coins, role, richest, poorest, treasury) * PolicyTable::ROW;
+                        if (coins >= 10) {
+                            data.actions[base + COUP] = 255;
+                            continue;
+                        }
+                        int income = treasury == 0 ? 2 : 1;  // A nearly empty treasury may refuse
+                        data.actions[base + GATHER] = static_cast<std::uint8_t>(20 / income);
+                        data.actions[base + TAX] = static_cast<std::uint8_t>((role == GOVERNOR ? 120 : 60) / income);
+                        data.actions[base + BRIBE] = coins >= 4 && coins < 7 ? 8 : 0;
+                        data.actions[base + ARREST] = richest >= 1 ? 30 : 5;
+                        data.actions[base + SANCTION] = coins >= 3 && richest >= 2 ? 25 : 0;
+                        data.actions[base + COUP] = coins >= 7 ? 200 : 0;
+                        data.actions[base + INVEST] = role == BARON && coins >= 3 ? 150 : 0;
+                    }
+                }
+            }
+            data.blocks[packBlockKey(coins, role, 0)] = role == GOVERNOR ? 230 : 0;
+            data.blocks[packBlockKey(coins, role, 1)] = role == JUDGE ? 200 : 0;
+            data.blocks[packBlockKey(coins, role, 2)] = role == GENERAL && coins >= 5 ? 255 : 0;
+        }
+    }
+    return data;
+}
+
+constexpr PolicyTable::Data HEURISTIC = heuristicTable();
+
+/**
+ * @brief Index of a blockable action in the block entries
+ * @return 0 to BLOCKABLE - 1, or BLOCKABLE
+ */
+std::size_t blockableIndex(ActionType action) {
+    switch (action) {
+        case ActionType::Tax: return 0;
+        case ActionType::Bribe: return 1;
+        case ActionType::Coup: return 2;
+        default: return PolicyTable::BLOCKABLE;
+    }
+}
+
+/**
+ * @brief Draws an index in proportion to weights
+ */
+std::size_t draw(const std::uint32_t* weights, std::size_t count, std::uint32_t total, std::mt19937& rng) {
+    std::uint32_t pick = std::uniform_int_distribution<std::uint32_t>(0, total - 1)(rng);
+    std::size_t index = 0;
+    while (pick >= weights[index]) {
+        pick -= weights[index++];
+    }
+    return std::min(index, count - 1);
+}
+
+} // namespace
+
+PolicyTable::PolicyTable(const Data& data) : data(&data) {}
+
+PolicyTable::~PolicyTable() {
+    if (mapping) {
+        munmap(mapping, mappedSize);
+    }
+}
+
+std::shared_ptr<const PolicyTable> PolicyTable::builtin() {
+    static const auto table = std::make_shared<const PolicyTable>(HEURISTIC);
+    return table;
+}
+
+std::shared_ptr<const PolicyTable> PolicyTable::map(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const PolicyTable>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = cache.find(path);
+    if (found != cache.end()) {
+        return found->second;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw GameException("Cannot open policy table " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) != HEADER_BYTES + sizeof(Data)) {
+        close(fd);
+        throw GameException("Policy table has the wrong size: " + path);
+    }
+    void* base = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw GameException("Cannot map policy table " + path);
+    }
+    std::shared_ptr<PolicyTable> table(new PolicyTable());
+    table->mapping = base;
+    table->mappedSize = static_cast<std::size_t>(info.st_size);
+    const char* bytes = static_cast<const char*>(base);
+    std::uint32_t dims[2];
+    std::memcpy(dims, bytes + sizeof(MAGIC), sizeof(dims));
+    if (std::memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0 || dims[0] != ACTION_KEYS || dims[1] != BLOCK_KEYS) {
+        throw GameException("Not a policy table of this layout: " + path);  // The destructor unmaps it
+    }
+    table->data = reinterpret_cast<const Data*>(bytes + HEADER_BYTES);
+    cache.emplace(path, table);
+    return table;
+}
+
+std::shared_ptr<const PolicyTable> PolicyTable::copy(const Data& data) {
+    std::shared_ptr<PolicyTable> table(new PolicyTable());
+    table->owned = std::make_unique<Data>(data);
+    table->data = table->owned.get();
+    return table;
+}
+
+std::size_t PolicyTable::actionClass(ActionType action) {
+    switch (action) {
+        case ActionType::Gather: return GATHER;
+        case ActionType::Tax: return TAX;
+        case ActionType::Bribe: return BRIBE;
+        case ActionType::Arrest: return ARREST;
+        case ActionType::Sanction: return SANCTION;
+        case ActionType::Coup: return COUP;
+        case ActionType::Invest: return INVEST;
+        default: return CLASSES;
+    }
+}
+
+ActionType PolicyTable::classAction(std::size_t actionClass) {
+    static constexpr ActionType actions[CLASSES] = {ActionType::Gather, ActionType::Tax, ActionType::Bribe,
+                                                    ActionType::Arrest, ActionType::Sanction, ActionType::Coup,
+                                                    ActionType::Invest};
+    return actions[std::min(actionClass, CLASSES - 1)];
+}
+
+std::size_t PolicyTable::actionKey(const GameController& controller, std::uint8_t seat) {
+    const auto& players = controller.get_game()->all_players();
+    const Player& self = *players[seat];
+    int richest = -1;
+    int poorest = -1;
+    for (std::size_t other = 0; other < players.size(); ++other) {
+        if (other == seat || !players[other]->is_active()) continue;
+        int coins = players[other]->get_coins();
+        richest = std::max(richest, coins);
+        poorest = poorest < 0 ? coins : std::min(poorest, coins);
+    }
+    std::size_t role = std::min(roleIndex(self.role()), ROLE_COUNT - 1);
+    return packActionKey(static_cast<std::size_t>(std::min(self.get_coins(), 10)), role,
+                         coinBucket(std::max(richest, 0)), coinBucket(std::max(poorest, 0)),
+                         treasuryBucket(controller.get_game()->get_treasury()));
+}
+
+std::size_t PolicyTable::blockKey(const GameController& controller, std::uint8_t seat) {
+    std::size_t pending = blockableIndex(controller.pendingActionType());
+    auto self = controller.playerAt(seat);
+    if (pending == BLOCKABLE || !self) {
+        return BLOCK_KEYS;
+    }
+    std::size_t role = std::min(roleIndex(self->role()), ROLE_COUNT - 1);
+    return packBlockKey(static_cast<std::size_t>(std::min(self->get_coins(), 10)), role, pending);
+}
+
+RecordedMove PolicyTable::blockMove(const GameController& controller, std::uint8_t seat, std::mt19937& rng) const {
+    std::size_t key = blockKey(controller, seat);
+    if (key < BLOCK_KEYS && std::uniform_int_distribution<int>(0, 254)(rng) < blockChance(key)) {
+        return RecordedMove{RecordedMove::Kind::Block, ActionType::Gather, seat};
+    }
+    return RecordedMove{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT};
+}
+
+RecordedMove PolicyTable::move(const GameController& controller, std::mt19937& rng) const {
+    if (controller.phase() == GamePhase::BlockPending) {
+        for (std::size_t i = 0; i < controller.pendingBlockerCount(); ++i) {
+            RecordedMove answer = blockMove(controller, controller.pendingBlocker(i), rng);
+            if (answer.kind == RecordedMove::Kind::Block) {
+                return answer;
+            }
+        }
+        return RecordedMove{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT};
+    }
+
+    std::array<Move, MAX_MOVES> moves;
+    std::size_t count = controller.legalMoves(moves);
+    const auto& players = controller.get_game()->all_players();
+    // The legal move of each class against the richest target it may hit
+    std::array<Move, CLASSES> best;
+    std::array<int, CLASSES> bestCoins;
+    bestCoins.fill(-1);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t actionClass = PolicyTable::actionClass(moves[i].action);
+        if (actionClass == CLASSES) continue;
+        int coins = moves[i].target < players.size() ? players[moves[i].target]->get_coins() : 0;
+        if (coins > bestCoins[actionClass]) {
+            bestCoins[actionClass] = coins;
+            best[actionClass] = moves[i];
+        }
+    }
+
+    std::uint8_t seat = controller.seatOf(controller.get_game()->get_current_player().get());
+    const std::uint8_t* weights = row(actionKey(controller, seat));
+    std::array<std::uint32_t, CLASSES> legal{};
+    std::uint32_t total = 0;
+    std::uint32_t available = 0;
+    for (std::size_t c = 0; c < CLASSES; ++c) {
+        if (bestCoins[c] >= 0) {
+            legal[c] = weights[c];
+            total += weights[c];
+            available++;
+        }
+    }
+    if (available == 0) {
+        return RecordedMove{RecordedMove::Kind::Action, ActionType::EndTurn, NO_SEAT};
+    }
+    if (total == 0) {
+        // The table never plays anything legal here: any legal class will do
+        for (std::size_t c = 0; c < CLASSES; ++c) {
+            legal[c] = bestCoins[c] >= 0 ? 1 : 0;
+        }
+        total = available;
+    }
+    const Move& chosen = best[draw(legal.data(), CLASSES, total, rng)];
+    return RecordedMove{RecordedMove::Kind::Action, chosen.action, chosen.target};
+}
+
+void PolicyTable::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(MAGIC, sizeof(MAGIC));
+    std::uint32_t dims[2] = {static_cast<std::uint32_t>(ACTION_KEYS), static_cast<std::uint32_t>(BLOCK_KEYS)};
+    out.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+    out.write(reinterpret_cast<const char*>(data), sizeof(Data));
+    if (!out) {
+        throw GameException("Cannot write policy table " + path);
+    }
+}
+
+void PolicyTable::writeHeader(const std::string& path, const std::string& name) const {
+    std::ofstream out(path, std::ios::trunc);
+    auto writeBytes = [&out](const std::uint8_t* bytes, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            out << (i % 24 == 0 ? "\n     " : "") << ' ' << static_cast<int>(bytes[i]) << (i + 1 < count ? "," : "");
+        }
+    };
+    out << "// Policy table written by coup-sim --distill; do not edit\n\n"
+        << "#pragma once\n#include \"PolicyTable.hpp\"\n\nnamespace coup {\n\n"
+        << "inline constexpr PolicyTable::Data " << name << " = {\n    {{";
+    writeBytes(data->actions.data(), data->actions.size());
+    out << "}},\n    {{";
+    writeBytes(data->blocks.data(), data->blocks.size());
+    out << "}}};\n\n} // namespace coup\n";
+    if (!out) {
+        throw GameException("Cannot write " + path);
+    }
+}
+
+namespace {
+
+/**
+ * @brief A thread's tallies of teacher decisions
+ */
+struct DistillCounts {
+    std::vector<std::uint32_t> actions; ///< Per action row and class
+    std::vector<std::uint32_t> asked; ///< Per block entry: times asked
+    std::vector<std::uint32_t> blocked; ///< Per block entry: times blocked
+    std::uint64_t decisions = 0; ///< Decisions counted
+
+    DistillCounts()
+        : actions(PolicyTable::ACTION_KEYS * PolicyTable::CLASSES, 0), asked(PolicyTable::BLOCK_KEYS, 0),
+          blocked(PolicyTable::BLOCK_KEYS, 0) {}
+};
+
+/**
+ * @brief Plays one teacher game, counting its decisions
+ * @param index Game number; with the seed it fixes the deal and the bots' seeds
+ */
+void playDistillGame(const DistillConfig& config, std::uint64_t index, DistillCounts& counts) {
+    std::seed_seq seq{config.seed, static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32)};
+    std::mt19937 rng(seq);
+    std::uniform_int_distribution<int> tableSize(config.minPlayers, config.maxPlayers);
+    std::uniform_int_distribution<std::size_t> deal(0, ROLE_COUNT - 1);
+    std::size_t players = static_cast<std::size_t>(tableSize(rng));
+
+    GameRecord record;
+    record.rules = config.rules;
+    std::vector<std::unique_ptr<Bot>> bots;
+    std::vector<Bot*> seats;
+    for (std::size_t seat = 0; seat < players; ++seat) {
+        record.seats.push_back(SeatRecord{"P" + std::to_string(seat + 1), roleName(deal(rng))});
+        bots.push_back(createBot(config.teacher, rng()));
+        seats.push_back(bots.back().get());
+    }
+    auto count = [&counts](const GameController& controller, std::uint8_t seat, const RecordedMove& move) {
+        if (move.kind == RecordedMove::Kind::Action) {
+            std::size_t actionClass = PolicyTable::actionClass(move.action);
+            if (actionClass < PolicyTable::CLASSES) {
+                counts.actions[PolicyTable::actionKey(controller, seat) * PolicyTable::CLASSES + actionClass]++;
+                counts.decisions++;
+            }
+            return;
+        }
+        std::size_t key = PolicyTable::blockKey(controller, seat);
+        if (key < PolicyTable::BLOCK_KEYS) {
+            counts.asked[key]++;
+            counts.blocked[key] += move.kind == RecordedMove::Kind::Block ? 1 : 0;
+            counts.decisions++;
+        }
+    };
+    playBotGame(record, seats, config.stepLimit, nullptr, count);
+}
+
+} // namespace
+
+DistillResult distillPolicy(const DistillConfig& config) {
+    if (config.minPlayers < 2 || config.maxPlayers > MAX_SEATS || config.minPlayers > config.maxPlayers) {
+        throw GameException("Player counts must be between 2 and " + std::to_string(MAX_SEATS));
+    }
+    checkMatchBot(config.teacher);
+
+    DistillResult result;
+    result.threads = workerCount(config.threads, config.games);
+    std::vector<DistillCounts> counts(result.threads);
+    std::atomic<std::uint64_t> nextGame(0);
+    std::mutex failureMutex;
+    std::string failure;
+    auto worker = [&](unsigned slot) {
+        try {
+            for (;;) {
+                std::uint64_t index = nextGame.fetch_add(1, std::memory_order_relaxed);
+                if (index >= config.games) {
+                    break;
+                }
+                playDistillGame(config, index, counts[slot]);
+            }
+        } catch (const std::exception& e) {
+            nextGame.store(config.games, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (failure.empty()) {
+                failure = e.what();
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    runOnThreads(result.threads, worker);
+    if (!failure.empty()) {
+        throw GameException("Distillation failed: " + failure);
+    }
+
+    DistillCounts& total = counts[0];
+    for (unsigned slot = 1; slot < result.threads; ++slot) {
+        for (std::size_t i = 0; i < total.actions.size(); ++i) total.actions[i] += counts[slot].actions[i];
+        for (std::size_t i = 0; i < total.asked.size(); ++i) total.asked[i] += counts[slot].asked[i];
+        for (std::size_t i = 0; i < total.blocked.size(); ++i) total.blocked[i] += counts[slot].blocked[i];
+        total.decisions += counts[slot].decisions;
+    }
+    result.decisions = total.decisions;
+
+    PolicyTable::Data data = HEURISTIC;
+    for (std::size_t key = 0; key < PolicyTable::ACTION_KEYS; ++key) {
+        const std::uint32_t* seen = &total.actions[key * PolicyTable::CLASSES];
+        std::uint8_t* weights = &data.actions[key * PolicyTable::ROW];
+        double decisions = 0.0;
+        double heuristic = 0.0;
+        for (std::size_t c = 0; c < PolicyTable::CLASSES; ++c) {
+            decisions += seen[c];
+            heuristic += weights[c];
+        }
+        if (decisions == 0.0 || heuristic == 0.0) continue;
+        result.actionRows++;
+        std::array<double, PolicyTable::CLASSES> blended;
+        double highest = 0.0;
+        for (std::size_t c = 0; c < PolicyTable::CLASSES; ++c) {
+            blended[c] = (seen[c] + config.prior * weights[c] / heuristic) / (decisions + config.prior);
+            highest = std::max(highest, blended[c]);
+        }
+        // Only ratios matter: scale the most likely class to 255 for resolution
+        for (std::size_t c = 0; c < PolicyTable::CLASSES; ++c) {
+            weights[c] = static_cast<std::uint8_t>(std::lround(255.0 * blended[c] / highest));
+        }
+    }
+    for (std::size_t key = 0; key < PolicyTable::BLOCK_KEYS; ++key) {
+        if (total.asked[key] == 0) continue;
+        result.blockEntries++;
+        double chance = (total.blocked[key] + config.prior * data.blocks[key] / 255.0) / (total.asked[key] + config.prior);
+        data.blocks[key] = static_cast<std::uint8_t>(std::lround(255.0 * chance));
+    }
+    result.table = PolicyTable::copy(data);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace coup
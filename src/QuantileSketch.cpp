@@ -0,0 +1,169 @@
+//meirshuker159@gmail.com
+
+#include "QuantileSketch.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace coup {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+/**
+ * @brief Arcsine scale function: maps a quantile to a centroid index scale
+ */
+double scale(double q) {
+    return static_cast<double>(QuantileSketch::COMPRESSION) / (2.0 * PI) * std::asin(2.0 * q - 1.0);
+}
+
+/**
+ * @brief Inverse of scale(), clamped to [0, 1]
+ */
+double inverseScale(double k) {
+    double limit = static_cast<double>(QuantileSketch::COMPRESSION) / 4.0;
+    if (k >= limit) return 1.0;
+    if (k <= -limit) return 0.0;
+    return (std::sin(k * 2.0 * PI / static_cast<double>(QuantileSketch::COMPRESSION)) + 1.0) / 2.0;
+}
+
+} // namespace
+
+QuantileSketch::QuantileSketch()
+    : centroids(), merged(0), buffered(0), totalWeight(0.0), bufferWeight(0.0), minimum(0.0), maximum(0.0) {}
+
+void QuantileSketch::add(double value, double weight) {
+    if (std::isnan(value) || !(weight > 0.0)) {
+        return;
+    }
+    if (count() == 0.0) {
+        minimum = value;
+        maximum = value;
+    } else {
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+    }
+    push(value, weight);
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.count() == 0.0 || &other == this) {
+        return;
+    }
+    if (count() == 0.0) {
+        minimum = other.minimum;
+        maximum = other.maximum;
+    } else {
+        minimum = std::min(minimum, other.minimum);
+        maximum = std::max(maximum, other.maximum);
+    }
+    std::size_t entries = other.merged + other.buffered;
+    for (std::size_t i = 0; i < entries; ++i) {
+        push(other.centroids[i].mean, other.centroids[i].weight);
+    }
+}
+
+void QuantileSketch::clear() {
+    merged = 0;
+    buffered = 0;
+    totalWeight = 0.0;
+    bufferWeight = 0.0;
+    minimum = 0.0;
+    maximum = 0.0;
+}
+
+void QuantileSketch::push(double mean, double weight) const {
+    if (buffered == BUFFER) {
+        compress();
+    }
+    centroids[merged + buffered] = Centroid{mean, weight};
+    buffered++;
+    bufferWeight += weight;
+}
+
+/**
+ * @brief One pass of the merging t-digest over the sorted entries
+ * @details Neighbours are combined while the combined centroid stays within
+ * one unit of the scale function, which bounds the result to about
+ * COMPRESSION/2 centroids whatever the input; output is written in place
+ * because it never overtakes the read position.
+ */
+void QuantileSketch::compress() const {
+    if (buffered == 0) {
+        return;
+    }
+    std::size_t entries = merged + buffered;
+    std::sort(centroids.begin(), centroids.begin() + entries,
+              [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+    double total = totalWeight + bufferWeight;
+
+    std::size_t out = 0;
+    Centroid current = centroids[0];
+    double before = 0.0;  // Weight of the centroids already written
+    double limit = total * inverseScale(scale(0.0) + 1.0);
+    for (std::size_t i = 1; i < entries; ++i) {
+        const Centroid next = centroids[i];
+        if (before + current.weight + next.weight <= limit) {
+            current.mean += (next.mean - current.mean) * next.weight / (current.weight + next.weight);
+            current.weight += next.weight;
+        } else {
+            centroids[out++] = current;
+            before += current.weight;
+            limit = total * inverseScale(scale(before / total) + 1.0);
+            current = next;
+        }
+    }
+    centroids[out++] = current;
+
+    merged = out;
+    buffered = 0;
+    totalWeight = total;
+    bufferWeight = 0.0;
+}
+
+std::size_t QuantileSketch::centroidCount() const {
+    compress();
+    return merged;
+}
+
+/**
+ * @brief Interpolates between centroid means, treating each centroid's
+ * weight as spread evenly around its mean
+ * @details The ends interpolate towards the exact minimum and maximum, so
+ * the extreme quantiles never leave the observed range.
+ */
+double QuantileSketch::quantile(double q) const {
+    compress();
+    if (merged == 0) {
+        return 0.0;
+    }
+    q = std::min(std::max(q, 0.0), 1.0);
+    if (merged == 1 || q == 0.0 || q == 1.0) {
+        if (q == 0.0) return minimum;
+        if (q == 1.0) return maximum;
+        return centroids[0].mean;
+    }
+    double index = q * totalWeight;
+    const Centroid& first = centroids[0];
+    if (index < first.weight / 2.0) {
+        return minimum + (first.mean - minimum) * index / (first.weight / 2.0);
+    }
+    double cumulative = first.weight / 2.0;  // Weight up to the current centroid's mean
+    for (std::size_t i = 0; i + 1 < merged; ++i) {
+        const Centroid& left = centroids[i];
+        const Centroid& right = centroids[i + 1];
+        double gap = (left.weight + right.weight) / 2.0;
+        if (index < cumulative + gap) {
+            return left.mean + (right.mean - left.mean) * (index - cumulative) / gap;
+        }
+        cumulative += gap;
+    }
+    const Centroid& last = centroids[merged - 1];
+    double tail = totalWeight - cumulative;
+    if (tail <= 0.0) {
+        return maximum;
+    }
+    return last.mean + (maximum - last.mean) * std::min(1.0, (index - cumulative) / tail);
+}
+
+} // namespace coup
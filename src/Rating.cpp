@@ -0,0 +1,143 @@
+//meirshuker159@gmail.com
+
+#include "Rating.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace coup {
+
+namespace {
+
+const double BETA = 25.0 / 6.0; ///< Performance noise of one game
+const double TAU = 25.0 / 300.0; ///< Skill drift per game, so sigma never freezes
+const double KAPPA = 0.0001; ///< Lower bound of the variance shrink factor
+
+} // namespace
+
+std::size_t RatingTable::add(const std::string& name) {
+    entries.push_back(Entry{name, Rating()});
+    return entries.size() - 1;
+}
+
+/**
+ * @brief Weng-Lin Plackett-Luce update plus pairwise Elo
+ * @details The Plackett-Luce model sees a finishing order as picking the
+ * winner among everyone, then the runner-up among the rest, and so on; each
+ * player's mu moves by how much better or worse it did than predicted at
+ * every step it took part in, and its variance shrinks by how informative
+ * those steps were. Tied players share their step.
+ */
+void RatingTable::update(const std::vector<std::size_t>& players, const std::vector<std::uint32_t>& ranks) {
+    std::size_t n = players.size();
+    if (n < 2 || ranks.size() != n) {
+        throw GameException("A rated game needs two or more players with one rank each");
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        if (players[i] >= entries.size() ||
+            std::find(players.begin() + static_cast<std::ptrdiff_t>(i) + 1, players.end(), players[i]) != players.end()) {
+            throw GameException("Unknown or repeated player in rated game");
+        }
+    }
+
+    std::vector<double> variance(n);
+    double c2 = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        double sigma = entries[players[i]].rating.sigma;
+        variance[i] = sigma * sigma + TAU * TAU;
+        c2 += variance[i] + BETA * BETA;
+    }
+    double c = std::sqrt(c2);
+
+    std::vector<double> strength(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        strength[i] = std::exp(entries[players[i]].rating.mu / c);
+    }
+    // remaining[q]: total strength of everyone not ahead of q; tied[q]: players sharing q's place
+    std::vector<double> remaining(n, 0.0);
+    std::vector<double> tied(n, 0.0);
+    for (std::size_t q = 0; q < n; ++q) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (ranks[i] >= ranks[q]) remaining[q] += strength[i];
+            if (ranks[i] == ranks[q]) tied[q] += 1.0;
+        }
+    }
+
+    std::vector<Rating> updated(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        double omega = 0.0;
+        double delta = 0.0;
+        for (std::size_t q = 0; q < n; ++q) {
+            if (ranks[q] > ranks[i]) continue;
+            double share = strength[i] / remaining[q];
+            omega += ((q == i ? 1.0 : 0.0) - share) / tied[q];
+            delta += share * (1.0 - share) / tied[q];
+        }
+        Rating rating = entries[players[i]].rating;
+        rating.mu += variance[i] / c * omega;
+        double shrink = std::max(1.0 - std::sqrt(variance[i]) / c * variance[i] / c2 * delta, KAPPA);
+        rating.sigma = std::sqrt(variance[i] * shrink);
+
+        // Elo: every pair is a game of its own, scaled so one game moves at most K
+        double change = 0.0;
+        for (std::size_t j = 0; j < n; ++j) {
+            if (j == i) continue;
+            double expected = 1.0 / (1.0 + std::pow(10.0, (entries[players[j]].rating.elo - rating.elo) / 400.0));
+            double score = ranks[i] < ranks[j] ? 1.0 : (ranks[i] == ranks[j] ? 0.5 : 0.0);
+            change += score - expected;
+        }
+        rating.elo += ELO_K * change / static_cast<double>(n - 1);
+
+        rating.games++;
+        bool alone = std::count(ranks.begin(), ranks.end(), ranks[i]) == 1;
+        if (alone && ranks[i] == *std::min_element(ranks.begin(), ranks.end())) {
+            rating.wins++;
+        }
+        updated[i] = rating;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        entries[players[i]].rating = updated[i];
+    }
+}
+
+std::vector<std::size_t> RatingTable::standings() const {
+    std::vector<std::size_t> order(entries.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+        return entries[a].rating.conservative() > entries[b].rating.conservative();
+    });
+    return order;
+}
+
+void RatingTable::writeStandings(std::ostream& out) const {
+    char line[160];
+    std::snprintf(line, sizeof(line), "%4s  %-20s %7s %6s %7s %7s %7s %6s\n", "#", "Bot", "mu", "sigma", "mu-3s",
+                  "Elo", "games", "wins");
+    out << line;
+    std::size_t place = 1;
+    for (std::size_t index : standings()) {
+        const Rating& r = entries[index].rating;
+        std::snprintf(line, sizeof(line), "%4zu  %-20s %7.2f %6.2f %7.2f %7.1f %7llu %5.1f%%\n", place++,
+                      entries[index].name.c_str(), r.mu, r.sigma, r.conservative(), r.elo,
+                      static_cast<unsigned long long>(r.games),
+                      r.games ? 100.0 * static_cast<double>(r.wins) / static_cast<double>(r.games) : 0.0);
+        out << line;
+    }
+}
+
+void RatingTable::writeCsv(std::ostream& out) const {
+    out << "rank,name,mu,sigma,conservative,elo,games,wins\n";
+    std::size_t place = 1;
+    char line[160];
+    for (std::size_t index : standings()) {
+        const Rating& r = entries[index].rating;
+        std::snprintf(line, sizeof(line), "%.6f,%.6f,%.6f,%.6f,%llu,%llu\n", r.mu, r.sigma, r.conservative(), r.elo,
+                      static_cast<unsigned long long>(r.games), static_cast<unsigned long long>(r.wins));
+        out << place++ << ',' << entries[index].name << ',' << line;
+    }
+}
+
+} // namespace coup
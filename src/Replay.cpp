@@ -0,0 +1,62 @@
+//meirshuker159@gmail.com
+
+#include "Replay.hpp"
+#include <algorithm>
+
+namespace coup {
+
+/**
+ * @brief Plays the whole record once, collecting keyframes and events
+ * @details Records are replayed silently (no console logging or metrics) and every move
+ * must be accepted by the engine; a move the engine rejects means the record
+ * does not belong to this rule set and loading fails.
+ */
+Replay::Replay(const GameRecord& record, std::size_t keyframeInterval)
+    : record(record), game(record.createGame()), replayController(game),
+      interval(std::max<std::size_t>(keyframeInterval, 1)), keyframes(), events(), eventEnd(),
+      current(0), seekCost(0), capturing(true) {
+    game->set_verbose(false);
+    replayController.setMetered(false);  // Replays show games already counted when they were played
+    replayController.setEventSink([this](const ActionRecord& event) {
+        if (capturing) {
+            events.push_back(event);
+            events.back().seq = static_cast<std::uint32_t>(events.size() - 1);
+        }
+    });
+    replayController.startGame();
+
+    keyframes.reserve(length() / interval + 1);
+    eventEnd.reserve(length() + 1);
+    keyframes.push_back(replayController.saveState());
+    eventEnd.push_back(events.size());
+    for (std::size_t i = 0; i < length(); ++i) {
+        GameRecord::play(replayController, this->record.moves[i]);
+        eventEnd.push_back(events.size());
+        if ((i + 1) % interval == 0) {
+            keyframes.push_back(replayController.saveState());
+        }
+    }
+    capturing = false;
+    current = length();
+}
+
+/**
+ * @brief Reaches a position from the closest usable starting point
+ * @details Continuing forward is used when it is no longer than the replay
+ * from the keyframe would be; otherwise the keyframe is restored first.
+ */
+void Replay::seek(std::size_t position) {
+    position = std::min(position, length());
+    std::size_t keyframe = position / interval;
+    std::size_t start = keyframe * interval;
+    if (position < current || current < start) {
+        replayController.restoreState(keyframes[keyframe]);
+        current = start;
+    }
+    seekCost = position - current;
+    for (; current < position; ++current) {
+        GameRecord::play(replayController, record.moves[current]);
+    }
+}
+
+} // namespace coup
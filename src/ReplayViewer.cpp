@@ -0,0 +1,220 @@
+//meirshuker159@gmail.com
+
+#include "ReplayViewer.hpp"
+#include "Assets.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace coup {
+
+/**
+ * @brief Opens the window and positions the replay at move 0
+ * @details Keyframe ticks are built once; they never change for a record.
+ */
+ReplayViewer::ReplayViewer(Replay& replay, const std::string& title)
+    : replay(replay), formatter(1), snapshot(), playerTexts(), historyTexts(), keyframeTicks(sf::Lines),
+      dirty(true), dragging(false) {
+    window.create(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Coup Replay - " + title);
+    window.setFramerateLimit(60);
+    if (!loadAssets()) {
+        throw std::runtime_error("Failed to load required assets");
+    }
+    for (std::size_t seat = 0; seat < replay.seats().size(); ++seat) {
+        formatter.setSeatName(static_cast<std::uint8_t>(seat), replay.seats()[seat].name);
+    }
+
+    std::size_t length = std::max<std::size_t>(replay.length(), 1);
+    for (std::size_t k = 0; k < replay.keyframeCount(); ++k) {
+        float x = TIMELINE_X + static_cast<float>(k * replay.keyframeInterval()) * TIMELINE_WIDTH / length;
+        keyframeTicks.append(sf::Vertex(sf::Vector2f(x, TIMELINE_Y - 6), sf::Color(120, 120, 160)));
+        keyframeTicks.append(sf::Vertex(sf::Vector2f(x, TIMELINE_Y), sf::Color(120, 120, 160)));
+    }
+    seek(0);
+}
+
+/**
+ * @brief Loads the font from the embedded asset bundle and sets up the texts
+ */
+bool ReplayViewer::loadAssets() {
+    const EmbeddedAsset* fontAsset = findAsset("DejaVuSans.ttf");
+    if (!fontAsset || !font.loadFromMemory(fontAsset->data, fontAsset->size)) {
+        std::cerr << "Failed to load the embedded font" << std::endl;
+        return false;
+    }
+
+    titleText.setFont(font);
+    titleText.setCharacterSize(26);
+    titleText.setFillColor(sf::Color::White);
+    titleText.setPosition(350, 10);
+
+    treasuryText.setFont(font);
+    treasuryText.setCharacterSize(24);
+    treasuryText.setFillColor(sf::Color::Yellow);
+    treasuryText.setPosition(10, 10);
+
+    messageText.setFont(font);
+    messageText.setCharacterSize(18);
+    messageText.setFillColor(sf::Color(255, 220, 120));
+    messageText.setPosition(10, 660);
+
+    playerTexts.assign(MAX_SEATS, sf::Text());
+    for (std::size_t i = 0; i < playerTexts.size(); ++i) {
+        playerTexts[i].setFont(font);
+        playerTexts[i].setCharacterSize(20);
+        playerTexts[i].setPosition(10, 60 + i * 30.f);
+    }
+
+    historyTexts.assign(HISTORY_VISIBLE_LINES, sf::Text());
+    for (std::size_t i = 0; i < historyTexts.size(); ++i) {
+        historyTexts[i].setFont(font);
+        historyTexts[i].setCharacterSize(14);
+        historyTexts[i].setFillColor(sf::Color(220, 220, 220));
+        historyTexts[i].setPosition(HISTORY_X + 5, HISTORY_Y + i * HISTORY_LINE_HEIGHT);
+    }
+    return true;
+}
+
+void ReplayViewer::run() {
+    while (window.isOpen()) {
+        handleEvents();
+        render();
+    }
+}
+
+void ReplayViewer::handleEvents() {
+    sf::Event event;
+    while (window.pollEvent(event)) {
+        if (event.type == sf::Event::Closed) {
+            window.close();
+        } else if (event.type == sf::Event::KeyPressed) {
+            std::size_t position = replay.position();
+            switch (event.key.code) {
+                case sf::Keyboard::Escape: window.close(); break;
+                case sf::Keyboard::Left: seek(position > 0 ? position - 1 : 0); break;
+                case sf::Keyboard::Right: seek(position + 1); break;
+                case sf::Keyboard::PageUp: seek(position > 10 ? position - 10 : 0); break;
+                case sf::Keyboard::PageDown: seek(position + 10); break;
+                case sf::Keyboard::Home: seek(0); break;
+                case sf::Keyboard::End: seek(replay.length()); break;
+                default: break;
+            }
+        } else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+            sf::FloatRect bar(TIMELINE_X, TIMELINE_Y - 8, TIMELINE_WIDTH, TIMELINE_HEIGHT + 16);
+            if (bar.contains(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y))) {
+                dragging = true;
+                seekToTimeline(event.mouseButton.x);
+            }
+        } else if (event.type == sf::Event::MouseButtonReleased) {
+            dragging = false;
+        } else if (event.type == sf::Event::MouseMoved && dragging) {
+            seekToTimeline(event.mouseMove.x);
+        }
+    }
+}
+
+void ReplayViewer::seekToTimeline(int x) {
+    float fraction = static_cast<float>(x - TIMELINE_X) / TIMELINE_WIDTH;
+    fraction = std::clamp(fraction, 0.0f, 1.0f);
+    seek(static_cast<std::size_t>(fraction * replay.length() + 0.5f));
+}
+
+void ReplayViewer::seek(std::size_t position) {
+    position = std::min(position, replay.length());
+    if (position == replay.position() && !dirty) {
+        return;
+    }
+    replay.seek(position);
+    dirty = true;
+}
+
+/**
+ * @brief Rebuilds the texts for the current position
+ * @details The replay is for reviewers, so every role and coin count is shown.
+ */
+void ReplayViewer::refresh() {
+    replay.controller().fillSnapshot(snapshot);
+
+    titleText.setString("Move " + std::to_string(replay.position()) + " / " + std::to_string(replay.length()) +
+                        "   (replayed " + std::to_string(replay.lastSeekCost()) + ")");
+    treasuryText.setString("Treasury: " + std::to_string(snapshot.treasury));
+    messageText.setString(snapshot.message);
+
+    for (std::size_t i = 0; i < playerTexts.size(); ++i) {
+        if (i >= snapshot.playerCount) {
+            playerTexts[i].setString("");
+            continue;
+        }
+        const PlayerView& player = snapshot.players[i];
+        std::string info = std::string(player.name) + " [" + player.role + "] (" +
+                           std::to_string(player.coins) + " coins)";
+        if (player.sanctioned) info += " [SANCTIONED]";
+        if (player.arrestBlocked) info += " [ARREST BLOCKED]";
+        if (!player.active) {
+            info = std::string(player.name) + " [" + player.role + "] [ELIMINATED]";
+            playerTexts[i].setFillColor(sf::Color(100, 100, 100));
+        } else if (i == snapshot.currentSeat || i == snapshot.winnerSeat) {
+            playerTexts[i].setFillColor(sf::Color::Yellow);
+        } else {
+            playerTexts[i].setFillColor(sf::Color::White);
+        }
+        playerTexts[i].setString(info);
+    }
+
+    // Newest events at the bottom, ending at the current position
+    std::size_t count = replay.eventCount();
+    std::size_t shown = std::min(count, historyTexts.size());
+    for (std::size_t i = 0; i < historyTexts.size(); ++i) {
+        historyTexts[i].setString(i < shown ? formatter.format(replay.event(count - shown + i)) : "");
+    }
+    dirty = false;
+}
+
+void ReplayViewer::render() {
+    if (dirty) {
+        refresh();
+    }
+    window.clear(sf::Color(50, 50, 50));
+    window.draw(titleText);
+    window.draw(treasuryText);
+    window.draw(messageText);
+    for (const auto& text : playerTexts) {
+        window.draw(text);
+    }
+
+    sf::RectangleShape panel(sf::Vector2f(WINDOW_WIDTH - HISTORY_X - 10, HISTORY_VISIBLE_LINES * HISTORY_LINE_HEIGHT));
+    panel.setPosition(HISTORY_X, HISTORY_Y);
+    panel.setFillColor(sf::Color(35, 35, 35));
+    panel.setOutlineThickness(1.f);
+    panel.setOutlineColor(sf::Color(90, 90, 90));
+    window.draw(panel);
+    for (const auto& text : historyTexts) {
+        window.draw(text);
+    }
+
+    renderTimeline();
+    window.display();
+}
+
+void ReplayViewer::renderTimeline() {
+    sf::RectangleShape track(sf::Vector2f(TIMELINE_WIDTH, TIMELINE_HEIGHT));
+    track.setPosition(TIMELINE_X, TIMELINE_Y);
+    track.setFillColor(sf::Color(35, 35, 35));
+    track.setOutlineThickness(1.f);
+    track.setOutlineColor(sf::Color(90, 90, 90));
+    window.draw(track);
+
+    float fraction = replay.length() > 0 ? static_cast<float>(replay.position()) / replay.length() : 1.0f;
+    sf::RectangleShape played(sf::Vector2f(TIMELINE_WIDTH * fraction, TIMELINE_HEIGHT));
+    played.setPosition(TIMELINE_X, TIMELINE_Y);
+    played.setFillColor(sf::Color(60, 110, 160));
+    window.draw(played);
+    window.draw(keyframeTicks);
+
+    sf::RectangleShape handle(sf::Vector2f(6, TIMELINE_HEIGHT + 12));
+    handle.setPosition(TIMELINE_X + TIMELINE_WIDTH * fraction - 3, TIMELINE_Y - 6);
+    handle.setFillColor(sf::Color::White);
+    window.draw(handle);
+}
+
+} // namespace coup
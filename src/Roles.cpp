@@ -4,10 +4,29 @@
 #include <algorithm>
 #include "Exceptions.hpp"
 #include "Game.hpp"
+#include "Trace.hpp"
+#include <cctype>
 #include <iostream>
 
 namespace coup {
 
+namespace {
+
+/**
+ * @brief Compares an action name with a lowercase one, ignoring case, without copying it
+ */
+bool isAction(const std::string& action, const char* lower) {
+    std::size_t i = 0;
+    for (; lower[i] != '\0'; ++i) {
+        if (i >= action.size() || std::tolower(static_cast<unsigned char>(action[i])) != lower[i]) {
+            return false;
+        }
+    }
+    return i == action.size();
+}
+
+} // namespace
+
 // ================================
 // GOVERNOR ROLE IMPLEMENTATION
 // ================================
@@ -41,9 +60,7 @@ void Governor::tax() {
  * the treasury from excessive taxation by opponents.
  */
 bool Governor::can_block(const std::string& action) const {
-    std::string act = action;
-    std::transform(act.begin(), act.end(), act.begin(), ::tolower);
-    return act == "tax";
+    return isAction(action, "tax");
 }
 
 // ================================
@@ -73,6 +90,7 @@ Spy::Spy(std::shared_ptr<Game> game, const std::string& name)
  * This provides crucial information for strategic decision-making.
  */
 void Spy::investigate(Player& target) {
+    TraceSpan span("Spy::investigate", "action");
     // Standard action validation (turn, active status, game state)
     validate_action();
     validate_target(target);
@@ -83,10 +101,12 @@ void Spy::investigate(Player& target) {
     }
     
     // Log the investigation results for all players to see
-    std::cout << "[SPY] " << get_name() << " investigated " << target.get_name() << " (" << target.role() 
-              << ") - discovered: " << target.get_coins() << " coins, " 
-              << (target.is_sanctioned() ? "sanctioned" : "not sanctioned") << ", "
-              << std::endl;
+    if (log_enabled()) {
+        std::cout << "[SPY] " << get_name() << " investigated " << target.get_name() << " (" << target.role() 
+                  << ") - discovered: " << target.get_coins() << " coins, " 
+                  << (target.is_sanctioned() ? "sanctioned" : "not sanctioned") << ", "
+                  << std::endl;
+    }
     
     // Note: Spy can see target's coins and role - GUI will handle detailed display
     // This is a non-turn-ending action - spy retains their remaining actions
@@ -103,6 +123,7 @@ void Spy::investigate(Player& target) {
  * other actions after blocking. This is a powerful defensive/disruptive ability.
  */
 void Spy::block_arrest_ability(Player& target) {
+    TraceSpan span("Spy::block_arrest_ability", "action");
     // Standard action validation (turn, active status, game state)
     validate_action();
     validate_target(target);
@@ -116,8 +137,10 @@ void Spy::block_arrest_ability(Player& target) {
     target.set_arrest_blocked(true);  // Block target's arrest ability for this turn
     
     // Log the blocking action
-    std::cout << "[SPY] " << get_name() << " blocked " << target.get_name() << " (" << target.role() 
-              << ")'s arrest ability for this turn" << std::endl;
+    if (log_enabled()) {
+        std::cout << "[SPY] " << get_name() << " blocked " << target.get_name() << " (" << target.role() 
+                  << ")'s arrest ability for this turn" << std::endl;
+    }
     
     // This is a non-turn-ending action - spy retains their remaining actions
     // NO next_turn() call - Spy can continue with other actions
@@ -160,6 +183,7 @@ void Baron::sanction(Player& target) {
  * Net effect is +3 coins for the Baron, making it an efficient economic action.
  */
 void Baron::invest() {
+    TraceSpan span("Baron::invest", "action");
     // Standard action validation (turn, active status, game state)
     validate_action();
     
@@ -178,8 +202,10 @@ void Baron::invest() {
     }
     
     // Log the investment action before execution
-    std::cout << "[BARON] " << get_name() << " invested 3 coins to get 6 coins from treasury (net +3) - now has " 
-              << (get_coins() + 3) << " coins (Treasury: " << (game_ptr->get_treasury() - 3) << ")" << std::endl;
+    if (log_enabled()) {
+        std::cout << "[BARON] " << get_name() << " invested 3 coins to get 6 coins from treasury (net +3) - now has " 
+                  << (get_coins() + 3) << " coins (Treasury: " << (game_ptr->get_treasury() - 3) << ")" << std::endl;
+    }
     
     // Execute the investment transaction
     remove_coins(3);                        // Baron pays 3 coins
@@ -217,9 +243,7 @@ General::General(std::shared_ptr<Game> game, const std::string& name)
  * Requires at least 5 coins to activate the block.
  */
 bool General::can_block(const std::string& action) const {
-    std::string act = action;
-    std::transform(act.begin(), act.end(), act.begin(), ::tolower);
-    return act == "coup" && get_coins() >= 5;
+    return isAction(action, "coup") && get_coins() >= 5;
 }
 
 // ================================
@@ -245,9 +269,7 @@ Judge::Judge(std::shared_ptr<Game> game, const std::string& name)
  * and limits turn extension strategies.
  */
 bool Judge::can_block(const std::string& action) const {
-    std::string act = action;
-    std::transform(act.begin(), act.end(), act.begin(), ::tolower);
-    return act == "bribe";
+    return isAction(action, "bribe");
 }
 
 // ================================
@@ -286,18 +308,25 @@ void Merchant::gather() {
  * The rich get richer mechanic rewards successful economic play.
  */
 void Merchant::on_turn_start() {
+    auto game_ptr = get_game().lock();
+    if (!game_ptr) {
+        return;
+    }
+    const RuleSet& rules = game_ptr->get_rules();
     // Check if Merchant qualifies for bonus income (wealth threshold)
-    if (get_coins() >= 3) {
-        // Get valid game reference and check treasury availability
-        auto game_ptr = get_game().lock();
-        if (game_ptr && game_ptr->get_treasury() >= 1) {
+    if (get_coins() >= rules.merchantThreshold && rules.merchantBonus > 0) {
+        // Check treasury availability
+        if (game_ptr->get_treasury() >= rules.merchantBonus) {
             // Execute bonus income transaction
-            game_ptr->remove_from_treasury(1);
-            add_coins(1);
+            game_ptr->remove_from_treasury(rules.merchantBonus);
+            add_coins(rules.merchantBonus);
             
             // Log the bonus income for tracking
-            std::cout << "[MERCHANT BONUS] " << get_name() << " received bonus coin at turn start (had 3+ coins) - now has " 
-                      << get_coins() << " coins (Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+            if (log_enabled()) {
+                std::cout << "[MERCHANT BONUS] " << get_name() << " received " << rules.merchantBonus
+                          << " bonus coin(s) at turn start (had " << rules.merchantThreshold << "+ coins) - now has " 
+                          << get_coins() << " coins (Treasury: " << game_ptr->get_treasury() << ")" << std::endl;
+            }
         }
     }
 }
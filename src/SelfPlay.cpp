@@ -0,0 +1,143 @@
+//meirshuker159@gmail.com
+
+#include "SelfPlay.hpp"
+#include "Bot.hpp"
+#include "Dataset.hpp"
+#include "Exceptions.hpp"
+#include "Features.hpp"
+#include "GameRecord.hpp"
+#include "SimStats.hpp"
+#include "Tournament.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <random>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief Plays one self-play game into a writer
+ * @param index Game number; with the seed it fixes the deal and the bots' seeds
+ * @return True if the game was cut off at the step limit
+ */
+bool playSelfPlayGame(const SelfPlayConfig& config, std::uint64_t index, ChunkWriter& writer, std::uint64_t& rows) {
+    std::seed_seq seq{config.seed, static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32)};
+    std::mt19937 rng(seq);
+    std::uniform_int_distribution<int> tableSize(config.minPlayers, config.maxPlayers);
+    std::uniform_int_distribution<std::size_t> deal(0, ROLE_COUNT - 1);
+    std::size_t players = static_cast<std::size_t>(tableSize(rng));
+
+    GameRecord record;
+    record.rules = config.rules;
+    std::vector<std::unique_ptr<Bot>> bots;
+    std::vector<Bot*> seats;
+    for (std::size_t seat = 0; seat < players; ++seat) {
+        record.seats.push_back(SeatRecord{"P" + std::to_string(seat + 1), roleName(deal(rng))});
+        bots.push_back(createBot(config.bot, rng()));
+        seats.push_back(bots.back().get());
+    }
+
+    TrainingRow row;
+    row.players = static_cast<std::uint8_t>(players);
+    row.game = static_cast<std::uint32_t>(index);
+    auto recordDecision = [&](const GameController& controller, std::uint8_t seat, const RecordedMove& move) {
+        encodeFeatures(controller, seat, row.features.data());
+        legalMask(controller, seat, row.legal.data());
+        row.action = static_cast<std::uint8_t>(moveSlot(move, seat, players));
+        row.seat = seat;
+        writer.add(row);
+        rows++;
+    };
+
+    std::vector<std::uint32_t> eliminations;
+    std::uint8_t winner = playBotGame(record, seats, config.stepLimit, &eliminations, recordDecision);
+    std::vector<std::int8_t> outcomes(players, -1);
+    for (std::size_t seat = 0; seat < players; ++seat) {
+        if (seat == winner) {
+            outcomes[seat] = 1;
+        } else if (winner == NO_SEAT && eliminations[seat] == 0) {
+            outcomes[seat] = 0;  // Still in when the game was cut off
+        }
+    }
+    writer.finishGame(outcomes, finishingPlaces(eliminations));
+    return winner == NO_SEAT;
+}
+
+} // namespace
+
+SelfPlayResult runSelfPlay(const SelfPlayConfig& config) {
+    if (config.minPlayers < 2 || config.maxPlayers > MAX_SEATS || config.minPlayers > config.maxPlayers) {
+        throw GameException("Player counts must be between 2 and " + std::to_string(MAX_SEATS));
+    }
+    checkMatchBot(config.bot);
+    std::error_code error;
+    std::filesystem::create_directories(config.directory, error);
+    if (!std::filesystem::is_directory(config.directory)) {
+        throw GameException("Cannot create directory " + config.directory);
+    }
+
+    SelfPlayResult result;
+    result.threads = workerCount(config.threads, config.games);
+
+    std::atomic<std::uint32_t> nextChunk(0);
+    std::atomic<std::uint64_t> nextGame(0);
+    std::vector<ChunkWriter> writers;
+    writers.reserve(result.threads);
+    for (unsigned i = 0; i < result.threads; ++i) {
+        writers.emplace_back(config.directory, config.chunkRows, nextChunk);
+    }
+    std::vector<std::uint64_t> rows(result.threads, 0);
+    std::vector<std::uint64_t> truncated(result.threads, 0);
+    std::mutex failureMutex;
+    std::string failure;
+
+    auto worker = [&](unsigned slot) {
+        // Counted locally so the threads share no cache lines while playing
+        std::uint64_t played = 0;
+        std::uint64_t cutOff = 0;
+        try {
+            for (;;) {
+                std::uint64_t index = nextGame.fetch_add(1, std::memory_order_relaxed);
+                if (index >= config.games) {
+                    break;
+                }
+                cutOff += playSelfPlayGame(config, index, writers[slot], played) ? 1 : 0;
+            }
+            writers[slot].flush();
+            rows[slot] = played;
+            truncated[slot] = cutOff;
+        } catch (const std::exception& e) {
+            // Stop the other threads too; the first failure is reported
+            nextGame.store(config.games, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (failure.empty()) {
+                failure = e.what();
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    runOnThreads(result.threads, worker);
+    if (!failure.empty()) {
+        throw GameException("Self-play failed: " + failure);
+    }
+
+    std::vector<std::pair<std::uint32_t, std::size_t>> chunks;
+    for (unsigned slot = 0; slot < result.threads; ++slot) {
+        chunks.insert(chunks.end(), writers[slot].chunks().begin(), writers[slot].chunks().end());
+        result.rows += rows[slot];
+        result.truncated += truncated[slot];
+    }
+    result.games = config.games;
+    result.chunks = chunks.size();
+    writeManifest(config.directory, chunks, result.games);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace coup
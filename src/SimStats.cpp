@@ -0,0 +1,521 @@
+//meirshuker159@gmail.com
+
+#include "SimStats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace coup {
+
+namespace {
+
+const char* const ROLE_NAMES[ROLE_COUNT] = {"Governor", "Spy", "Baron", "General", "Judge", "Merchant"};
+
+/**
+ * @brief Formats a double with fixed precision for the exports
+ */
+std::string number(double value, int precision = 6) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+    return buffer;
+}
+
+/**
+ * @brief Writes one CSV row
+ */
+void csvRow(std::ostream& out, const std::string& metric, const std::string& key, const std::string& players,
+            std::uint64_t count, std::uint64_t total, const Interval& interval) {
+    out << metric << ',' << key << ',' << players << ',' << count << ',' << total << ','
+        << number(interval.estimate) << ',' << number(interval.low) << ',' << number(interval.high) << '\n';
+}
+
+/**
+ * @brief Writes the p50/p90/p99 rows of a sketch
+ */
+void csvQuantiles(std::ostream& out, const std::string& metric, const QuantileSketch& sketch) {
+    static const double QUANTILES[] = {0.5, 0.9, 0.99};
+    static const char* const KEYS[] = {"p50", "p90", "p99"};
+    std::uint64_t samples = static_cast<std::uint64_t>(sketch.count());
+    for (std::size_t i = 0; i < 3; ++i) {
+        out << metric << ',' << KEYS[i] << ",all," << samples << ',' << samples << ','
+            << number(sketch.quantile(QUANTILES[i])) << ",,\n";
+    }
+}
+
+/**
+ * @brief Writes the quantile fields of a sketch into an open JSON object
+ */
+void jsonQuantiles(std::ostream& out, const QuantileSketch& sketch) {
+    out << "\"p50\":" << number(sketch.quantile(0.5)) << ",\"p90\":" << number(sketch.quantile(0.9))
+        << ",\"p99\":" << number(sketch.quantile(0.99));
+}
+
+/**
+ * @brief Writes a JSON object for a proportion
+ */
+void jsonRate(std::ostream& out, std::uint64_t count, std::uint64_t total, const Interval& interval) {
+    out << "{\"count\":" << count << ",\"total\":" << total << ",\"rate\":" << number(interval.estimate)
+        << ",\"ci\":[" << number(interval.low) << ',' << number(interval.high) << "]}";
+}
+
+} // namespace
+
+const char* roleName(std::size_t index) {
+    return index < ROLE_COUNT ? ROLE_NAMES[index] : "?";
+}
+
+std::size_t roleIndex(const std::string& role) {
+    for (std::size_t i = 0; i < ROLE_COUNT; ++i) {
+        if (role == ROLE_NAMES[i]) {
+            return i;
+        }
+    }
+    return ROLE_COUNT;
+}
+
+void SimCounters::recordEvent(const ActionRecord& record) {
+    std::size_t type = static_cast<std::size_t>(record.type);
+    if (record.type == ActionType::Block) {
+        if (record.detail < MOVE_TYPES) {
+            blocks[record.detail]++;
+        }
+        return;
+    }
+    if (type >= MOVE_TYPES) {
+        return;  // TurnStart, GameStart and GameOver are counted by the caller
+    }
+    actions[type]++;
+    if (record.type == ActionType::Coup) {
+        coups++;
+        // actorCoins is after paying 7; a coup is mandatory from 10 coins
+        if (record.actorCoins + 7 >= 10) {
+            forcedCoups++;
+        }
+        eliminationCoins.add(record.targetCoins);
+    }
+}
+
+void SimCounters::recordGame(const std::vector<std::size_t>& roles, std::uint8_t winner, std::uint64_t turns) {
+    std::size_t players = std::min(roles.size(), MAX_SEATS);
+    games++;
+    gamesByPlayers[players]++;
+    for (std::size_t seat = 0; seat < players; ++seat) {
+        seatGames[players][seat]++;
+        if (roles[seat] < ROLE_COUNT) {
+            roleGames[players][roles[seat]]++;
+        }
+    }
+    if (winner >= players) {
+        truncated++;
+        return;
+    }
+    seatWins[players][winner]++;
+    if (roles[winner] < ROLE_COUNT) {
+        roleWins[players][roles[winner]]++;
+    }
+    turnsMin = games - truncated == 1 ? turns : std::min(turnsMin, turns);
+    turnsMax = std::max(turnsMax, turns);
+    turnsSum += turns;
+    turnsSumSquares += turns * turns;
+    turnQuantiles.add(static_cast<double>(turns));
+}
+
+void SimCounters::merge(const SimCounters& other) {
+    if (other.games - other.truncated > 0) {
+        bool empty = games - truncated == 0;
+        turnsMin = empty ? other.turnsMin : std::min(turnsMin, other.turnsMin);
+        turnsMax = std::max(turnsMax, other.turnsMax);
+    }
+    games += other.games;
+    truncated += other.truncated;
+    for (std::size_t players = 0; players <= MAX_SEATS; ++players) {
+        gamesByPlayers[players] += other.gamesByPlayers[players];
+        for (std::size_t seat = 0; seat < MAX_SEATS; ++seat) {
+            seatGames[players][seat] += other.seatGames[players][seat];
+            seatWins[players][seat] += other.seatWins[players][seat];
+        }
+        for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+            roleGames[players][role] += other.roleGames[players][role];
+            roleWins[players][role] += other.roleWins[players][role];
+        }
+    }
+    turnsSum += other.turnsSum;
+    turnsSumSquares += other.turnsSumSquares;
+    turnQuantiles.merge(other.turnQuantiles);
+    eliminationCoins.merge(other.eliminationCoins);
+    for (std::size_t type = 0; type < MOVE_TYPES; ++type) {
+        actions[type] += other.actions[type];
+        blocks[type] += other.blocks[type];
+    }
+    coups += other.coups;
+    forcedCoups += other.forcedCoups;
+}
+
+void PairedCounters::recordPair(const std::vector<std::size_t>& roles, const std::array<std::uint8_t, 2>& winners,
+                                const std::array<std::uint64_t, 2>& turns) {
+    std::size_t players = std::min(roles.size(), MAX_SEATS);
+    games++;
+    std::array<std::size_t, 2> winningRole = {ROLE_COUNT, ROLE_COUNT};
+    for (std::size_t variant = 0; variant < 2; ++variant) {
+        if (winners[variant] < players) {
+            winningRole[variant] = roles[winners[variant]];
+        } else {
+            truncated[variant]++;
+        }
+    }
+    std::array<bool, ROLE_COUNT> dealt = {};
+    for (std::size_t seat = 0; seat < players; ++seat) {
+        if (roles[seat] < ROLE_COUNT) {
+            dealt[roles[seat]] = true;
+        }
+    }
+    for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+        if (!dealt[role]) continue;
+        roleGames[role]++;
+        bool wonBaseline = winningRole[0] == role;
+        bool wonVariant = winningRole[1] == role;
+        roleWins[0][role] += wonBaseline ? 1 : 0;
+        roleWins[1][role] += wonVariant ? 1 : 0;
+        roleSplits[role] += wonBaseline != wonVariant ? 1 : 0;
+    }
+    if (winners[0] < players && winners[1] < players) {
+        finishedPairs++;
+        for (std::size_t variant = 0; variant < 2; ++variant) {
+            turnsSum[variant] += turns[variant];
+            turnsSumSquares[variant] += turns[variant] * turns[variant];
+        }
+        std::uint64_t diff = turns[0] > turns[1] ? turns[0] - turns[1] : turns[1] - turns[0];
+        turnsDiffSquares += diff * diff;
+    }
+}
+
+void PairedCounters::merge(const PairedCounters& other) {
+    games += other.games;
+    for (std::size_t variant = 0; variant < 2; ++variant) {
+        truncated[variant] += other.truncated[variant];
+        turnsSum[variant] += other.turnsSum[variant];
+        turnsSumSquares[variant] += other.turnsSumSquares[variant];
+        for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+            roleWins[variant][role] += other.roleWins[variant][role];
+        }
+    }
+    for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+        roleGames[role] += other.roleGames[role];
+        roleSplits[role] += other.roleSplits[role];
+    }
+    finishedPairs += other.finishedPairs;
+    turnsDiffSquares += other.turnsDiffSquares;
+}
+
+Interval wilsonInterval(std::uint64_t successes, std::uint64_t trials, double z) {
+    if (trials == 0) {
+        return Interval{0.0, 0.0, 1.0};
+    }
+    double n = static_cast<double>(trials);
+    double p = static_cast<double>(successes) / n;
+    double z2 = z * z;
+    double denominator = 1.0 + z2 / n;
+    double center = (p + z2 / (2.0 * n)) / denominator;
+    double margin = z * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / denominator;
+    return Interval{p, std::max(0.0, center - margin), std::min(1.0, center + margin)};
+}
+
+Interval meanInterval(double sum, double sumSquares, std::uint64_t count, double z) {
+    if (count == 0) {
+        return Interval{};
+    }
+    double n = static_cast<double>(count);
+    double mean = sum / n;
+    double variance = count > 1 ? std::max(0.0, (sumSquares - sum * mean) / (n - 1.0)) : 0.0;
+    double margin = z * std::sqrt(variance / n);
+    return Interval{mean, mean - margin, mean + margin};
+}
+
+SimStats::SimStats(const SimCounters& counters, unsigned threads, double seconds)
+    : totals(counters), threadCount(threads), elapsed(seconds) {}
+
+SimStats::Tally SimStats::roleTally(std::size_t role, std::size_t players) const {
+    Tally tally;
+    for (std::size_t count = 0; count <= MAX_SEATS && role < ROLE_COUNT; ++count) {
+        if (players == 0 || players == count) {
+            tally.wins += totals.roleWins[count][role];
+            tally.games += totals.roleGames[count][role];
+        }
+    }
+    return tally;
+}
+
+SimStats::Tally SimStats::seatTally(std::size_t seat, std::size_t players) const {
+    Tally tally;
+    for (std::size_t count = 0; count <= MAX_SEATS && seat < MAX_SEATS; ++count) {
+        if (players == 0 || players == count) {
+            tally.wins += totals.seatWins[count][seat];
+            tally.games += totals.seatGames[count][seat];
+        }
+    }
+    return tally;
+}
+
+Interval SimStats::roleWinRate(std::size_t role, std::size_t players) const {
+    Tally tally = roleTally(role, players);
+    return wilsonInterval(tally.wins, tally.games);
+}
+
+Interval SimStats::seatWinRate(std::size_t seat, std::size_t players) const {
+    Tally tally = seatTally(seat, players);
+    return wilsonInterval(tally.wins, tally.games);
+}
+
+Interval SimStats::gameLength() const {
+    return meanInterval(static_cast<double>(totals.turnsSum), static_cast<double>(totals.turnsSumSquares),
+                        totals.games - totals.truncated);
+}
+
+Interval SimStats::blockRate(ActionType action) const {
+    std::size_t type = static_cast<std::size_t>(action);
+    if (type >= MOVE_TYPES) {
+        return wilsonInterval(0, 0);
+    }
+    return wilsonInterval(totals.blocks[type], totals.actions[type] + totals.blocks[type]);
+}
+
+Interval SimStats::forcedCoupRate() const {
+    return wilsonInterval(totals.forcedCoups, totals.coups);
+}
+
+void SimStats::writeCsv(std::ostream& out) const {
+    out << "metric,key,players,count,total,value,ci_low,ci_high\n";
+    std::uint64_t finished = totals.games - totals.truncated;
+    csvRow(out, "game_length", "turns", "all", finished, totals.games, gameLength());
+    csvQuantiles(out, "game_length_quantile", totals.turnQuantiles);
+    csvRow(out, "truncated", "games", "all", totals.truncated, totals.games,
+           wilsonInterval(totals.truncated, totals.games));
+    for (std::size_t players = 0; players <= MAX_SEATS; ++players) {
+        if (players > 0 && totals.gamesByPlayers[players] == 0) {
+            continue;
+        }
+        std::string label = players == 0 ? "all" : std::to_string(players);
+        for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+            Tally tally = roleTally(role, players);
+            csvRow(out, "role_win", roleName(role), label, tally.wins, tally.games, roleWinRate(role, players));
+        }
+        std::size_t seats = players == 0 ? MAX_SEATS : players;
+        for (std::size_t seat = 0; seat < seats; ++seat) {
+            Tally tally = seatTally(seat, players);
+            csvRow(out, "seat_win", std::to_string(seat + 1), label, tally.wins, tally.games,
+                   seatWinRate(seat, players));
+        }
+    }
+    std::uint64_t allActions = 0;
+    for (std::uint64_t count : totals.actions) {
+        allActions += count;
+    }
+    for (std::size_t type = 0; type < MOVE_TYPES; ++type) {
+        const char* name = actionTypeName(static_cast<ActionType>(type));
+        csvRow(out, "action", name, "all", totals.actions[type], allActions,
+               wilsonInterval(totals.actions[type], allActions));
+        csvRow(out, "blocked", name, "all", totals.blocks[type], totals.actions[type] + totals.blocks[type],
+               blockRate(static_cast<ActionType>(type)));
+    }
+    csvRow(out, "forced_coup", "coups", "all", totals.forcedCoups, totals.coups, forcedCoupRate());
+    csvQuantiles(out, "elimination_coins_quantile", totals.eliminationCoins);
+}
+
+void SimStats::writeJson(std::ostream& out) const {
+    Interval length = gameLength();
+    out << "{\"games\":" << totals.games << ",\"truncated\":" << totals.truncated
+        << ",\"threads\":" << threadCount << ",\"seconds\":" << number(elapsed)
+        << ",\"game_length\":{\"finished\":" << (totals.games - totals.truncated)
+        << ",\"mean\":" << number(length.estimate) << ",\"ci\":[" << number(length.low) << ','
+        << number(length.high) << "],\"min\":" << totals.turnsMin << ",\"max\":" << totals.turnsMax << ',';
+    jsonQuantiles(out, totals.turnQuantiles);
+    out << '}';
+
+    out << ",\"roles\":{";
+    for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+        out << (role ? "," : "") << '"' << roleName(role) << "\":{\"all\":";
+        Tally tally = roleTally(role, 0);
+        jsonRate(out, tally.wins, tally.games, roleWinRate(role));
+        for (std::size_t players = 2; players <= MAX_SEATS; ++players) {
+            if (totals.gamesByPlayers[players] == 0) continue;
+            out << ",\"" << players << "\":";
+            jsonRate(out, totals.roleWins[players][role], totals.roleGames[players][role],
+                     roleWinRate(role, players));
+        }
+        out << '}';
+    }
+    out << '}';
+
+    out << ",\"seats\":{";
+    bool first = true;
+    for (std::size_t players = 2; players <= MAX_SEATS; ++players) {
+        if (totals.gamesByPlayers[players] == 0) continue;
+        out << (first ? "" : ",") << '"' << players << "\":[";
+        first = false;
+        for (std::size_t seat = 0; seat < players; ++seat) {
+            out << (seat ? "," : "");
+            jsonRate(out, totals.seatWins[players][seat], totals.seatGames[players][seat],
+                     seatWinRate(seat, players));
+        }
+        out << ']';
+    }
+    out << '}';
+
+    out << ",\"actions\":{";
+    for (std::size_t type = 0; type < MOVE_TYPES; ++type) {
+        out << (type ? "," : "") << '"' << actionTypeName(static_cast<ActionType>(type))
+            << "\":{\"performed\":" << totals.actions[type] << ",\"blocked\":";
+        jsonRate(out, totals.blocks[type], totals.actions[type] + totals.blocks[type],
+                 blockRate(static_cast<ActionType>(type)));
+        out << '}';
+    }
+    out << "},\"forced_coups\":";
+    jsonRate(out, totals.forcedCoups, totals.coups, forcedCoupRate());
+    out << ",\"elimination_coins\":{\"count\":" << static_cast<std::uint64_t>(totals.eliminationCoins.count())
+        << ',';
+    jsonQuantiles(out, totals.eliminationCoins);
+    out << ",\"max\":" << number(totals.eliminationCoins.max()) << "}}\n";
+}
+
+void SimStats::writeSummary(std::ostream& out) const {
+    char line[128];
+    std::uint64_t finished = totals.games - totals.truncated;
+    std::snprintf(line, sizeof(line), "%llu games (%llu truncated) on %u threads in %.2f s, %.0f games/s\n",
+                  static_cast<unsigned long long>(totals.games), static_cast<unsigned long long>(totals.truncated),
+                  threadCount, elapsed, elapsed > 0.0 ? static_cast<double>(totals.games) / elapsed : 0.0);
+    out << line;
+    Interval length = gameLength();
+    std::snprintf(line, sizeof(line), "Game length: %.1f turns [%.1f, %.1f], min %llu, max %llu\n",
+                  length.estimate, length.low, length.high, static_cast<unsigned long long>(totals.turnsMin),
+                  static_cast<unsigned long long>(finished ? totals.turnsMax : 0));
+    out << line;
+    std::snprintf(line, sizeof(line), "             p50 %.0f, p90 %.0f, p99 %.0f turns\n",
+                  gameLengthQuantile(0.5), gameLengthQuantile(0.9), gameLengthQuantile(0.99));
+    out << line;
+
+    out << "\nWin rate by role (95% CI)\n";
+    for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+        Interval rate = roleWinRate(role);
+        std::snprintf(line, sizeof(line), "  %-9s %6.2f%%  [%6.2f%%, %6.2f%%]\n", roleName(role),
+                      rate.estimate * 100.0, rate.low * 100.0, rate.high * 100.0);
+        out << line;
+    }
+
+    out << "\nWin rate by seat and player count\n";
+    for (std::size_t players = 2; players <= MAX_SEATS; ++players) {
+        if (totals.gamesByPlayers[players] == 0) continue;
+        std::snprintf(line, sizeof(line), "  %zu players:", players);
+        out << line;
+        for (std::size_t seat = 0; seat < players; ++seat) {
+            std::snprintf(line, sizeof(line), " %5.1f%%", seatWinRate(seat, players).estimate * 100.0);
+            out << line;
+        }
+        out << '\n';
+    }
+
+    out << "\nActions (performed / blocked)\n";
+    for (std::size_t type = 0; type < MOVE_TYPES; ++type) {
+        std::snprintf(line, sizeof(line), "  %-12s %10llu / %llu\n", actionTypeName(static_cast<ActionType>(type)),
+                      static_cast<unsigned long long>(totals.actions[type]),
+                      static_cast<unsigned long long>(totals.blocks[type]));
+        out << line;
+    }
+    Interval forced = forcedCoupRate();
+    std::snprintf(line, sizeof(line), "Forced coups: %llu of %llu (%.1f%%)\n",
+                  static_cast<unsigned long long>(totals.forcedCoups), static_cast<unsigned long long>(totals.coups),
+                  forced.estimate * 100.0);
+    out << '\n' << line;
+    std::snprintf(line, sizeof(line), "Coins when couped: p50 %.0f, p90 %.0f, p99 %.0f\n",
+                  eliminationCoinsQuantile(0.5), eliminationCoinsQuantile(0.9), eliminationCoinsQuantile(0.99));
+    out << line;
+}
+
+RuleComparison::RuleComparison(const PairedCounters& counters, unsigned threads, double seconds)
+    : totals(counters), threadCount(threads), elapsed(seconds) {}
+
+Interval RuleComparison::roleWinRate(std::size_t variant, std::size_t role) const {
+    return wilsonInterval(totals.roleWins[variant][role], totals.roleGames[role]);
+}
+
+/**
+ * @brief Per-game differences are -1, 0 or +1, so the squared differences
+ * sum to the number of split pairs
+ */
+PairedDelta RuleComparison::roleWinDelta(std::size_t role) const {
+    std::uint64_t games = totals.roleGames[role];
+    double diff = static_cast<double>(totals.roleWins[1][role]) - static_cast<double>(totals.roleWins[0][role]);
+    PairedDelta delta;
+    delta.paired = meanInterval(diff, static_cast<double>(totals.roleSplits[role]), games);
+    // Independent samples: the variances of the two proportions add up
+    Interval baseline = meanInterval(static_cast<double>(totals.roleWins[0][role]),
+                                     static_cast<double>(totals.roleWins[0][role]), games);
+    Interval variant = meanInterval(static_cast<double>(totals.roleWins[1][role]),
+                                    static_cast<double>(totals.roleWins[1][role]), games);
+    double margin = std::hypot(baseline.high - baseline.estimate, variant.high - variant.estimate);
+    delta.unpaired = Interval{delta.paired.estimate, delta.paired.estimate - margin, delta.paired.estimate + margin};
+    return delta;
+}
+
+PairedDelta RuleComparison::gameLengthDelta() const {
+    std::uint64_t pairs = totals.finishedPairs;
+    double diff = static_cast<double>(totals.turnsSum[1]) - static_cast<double>(totals.turnsSum[0]);
+    PairedDelta delta;
+    delta.paired = meanInterval(diff, static_cast<double>(totals.turnsDiffSquares), pairs);
+    Interval baseline = meanInterval(static_cast<double>(totals.turnsSum[0]),
+                                     static_cast<double>(totals.turnsSumSquares[0]), pairs);
+    Interval variant = meanInterval(static_cast<double>(totals.turnsSum[1]),
+                                    static_cast<double>(totals.turnsSumSquares[1]), pairs);
+    double margin = std::hypot(baseline.high - baseline.estimate, variant.high - variant.estimate);
+    delta.unpaired = Interval{delta.paired.estimate, delta.paired.estimate - margin, delta.paired.estimate + margin};
+    return delta;
+}
+
+void RuleComparison::writeCsv(std::ostream& out) const {
+    out << "metric,key,count,baseline,variant,delta,paired_low,paired_high,unpaired_low,unpaired_high\n";
+    auto row = [&out](const std::string& metric, const std::string& key, std::uint64_t count, double baseline,
+                      double variant, const PairedDelta& delta) {
+        out << metric << ',' << key << ',' << count << ',' << number(baseline) << ',' << number(variant) << ','
+            << number(delta.paired.estimate) << ',' << number(delta.paired.low) << ',' << number(delta.paired.high)
+            << ',' << number(delta.unpaired.low) << ',' << number(delta.unpaired.high) << '\n';
+    };
+    for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+        row("role_win_rate", ROLE_NAMES[role], totals.roleGames[role], roleWinRate(0, role).estimate,
+            roleWinRate(1, role).estimate, roleWinDelta(role));
+    }
+    double pairs = std::max<double>(1.0, static_cast<double>(totals.finishedPairs));
+    row("game_length", "mean", totals.finishedPairs, static_cast<double>(totals.turnsSum[0]) / pairs,
+        static_cast<double>(totals.turnsSum[1]) / pairs, gameLengthDelta());
+}
+
+void RuleComparison::writeSummary(std::ostream& out) const {
+    char line[160];
+    std::snprintf(line, sizeof(line), "%llu game pairs (%llu / %llu truncated) on %u threads in %.2f s\n",
+                  static_cast<unsigned long long>(totals.games), static_cast<unsigned long long>(totals.truncated[0]),
+                  static_cast<unsigned long long>(totals.truncated[1]), threadCount, elapsed);
+    out << line;
+    // Squared width ratio: how many more games independent seeds would need
+    auto saving = [](const PairedDelta& delta) {
+        double paired = delta.paired.high - delta.paired.low;
+        double unpaired = delta.unpaired.high - delta.unpaired.low;
+        return paired > 0.0 ? (unpaired / paired) * (unpaired / paired) : 0.0;
+    };
+
+    out << "\nWin rate by role: baseline -> variant, change (95% CI paired | unpaired)\n";
+    for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+        PairedDelta delta = roleWinDelta(role);
+        std::snprintf(line, sizeof(line),
+                      "  %-9s %6.2f%% -> %6.2f%%  %+6.2f%%  [%+6.2f%%, %+6.2f%%] | [%+6.2f%%, %+6.2f%%]  x%.1f\n",
+                      roleName(role), roleWinRate(0, role).estimate * 100.0, roleWinRate(1, role).estimate * 100.0,
+                      delta.paired.estimate * 100.0, delta.paired.low * 100.0, delta.paired.high * 100.0,
+                      delta.unpaired.low * 100.0, delta.unpaired.high * 100.0, saving(delta));
+        out << line;
+    }
+    PairedDelta length = gameLengthDelta();
+    std::snprintf(line, sizeof(line), "\nGame length change: %+.1f turns [%+.1f, %+.1f] | [%+.1f, %+.1f]  x%.1f\n",
+                  length.paired.estimate, length.paired.low, length.paired.high, length.unpaired.low,
+                  length.unpaired.high, saving(length));
+    out << line;
+    out << "(xN: an unpaired run would need about N times as many games for the same interval)\n";
+}
+
+} // namespace coup
@@ -0,0 +1,186 @@
+//meirshuker159@gmail.com
+
+#include "Simulation.hpp"
+#include "Bot.hpp"
+#include "Exceptions.hpp"
+#include "GameController.hpp"
+#include "GameRecord.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief Games a thread claims at a time
+ * @details Large enough that the shared counter is touched rarely, small
+ * enough that threads finish at about the same time.
+ */
+constexpr std::uint64_t CHUNK = 16;
+
+/**
+ * @brief Plays one game with random moves
+ * @param counters Receives the game's events, or nullptr to count nothing
+ * @param roles Receives the role index of each seat
+ * @param turns Receives the number of turns played
+ * @return Winning seat, NO_SEAT if the step limit was reached
+ */
+std::uint8_t playRandomGame(const SimConfig& config, const RuleSet& rules, std::uint64_t index,
+                            SimCounters* counters, std::vector<std::size_t>& roles, std::uint64_t& turns) {
+    std::seed_seq seq{config.seed, static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32)};
+    std::mt19937 rng(seq);
+
+    std::uniform_int_distribution<int> tableSize(config.minPlayers, config.maxPlayers);
+    int players = tableSize(rng);
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    game->set_rules(rules);
+    roles.clear();
+    for (int seat = 0; seat < players; ++seat) {
+        auto player = game->create_random_player("P" + std::to_string(seat + 1), rng);
+        roles.push_back(roleIndex(player->role()));
+        game->add_player(player);
+    }
+
+    GameController controller(game);
+    turns = 0;
+    controller.setEventSink([counters, &turns](const ActionRecord& event) {
+        if (event.type == ActionType::TurnStart) {
+            turns++;
+        }
+        if (counters) {
+            counters->recordEvent(event);
+        }
+    });
+    controller.startGame();
+
+    for (std::uint32_t step = 0; step < config.stepLimit && controller.phase() != GamePhase::GameOver; ++step) {
+        try {
+            GameRecord::play(controller, randomMove(controller, rng));
+        } catch (const std::exception&) {
+            // Rejected moves change nothing; the next random choice will differ
+        }
+    }
+    return controller.phase() == GamePhase::GameOver ? controller.winner() : NO_SEAT;
+}
+
+/**
+ * @brief Checks the table sizes and works out the thread count
+ * @throws GameException if the table sizes are out of range
+ */
+unsigned threadsFor(const SimConfig& config) {
+    if (config.minPlayers < 2 || config.maxPlayers > MAX_SEATS || config.minPlayers > config.maxPlayers) {
+        throw GameException("Player counts must be between 2 and " + std::to_string(MAX_SEATS));
+    }
+    return workerCount(config.threads, config.games);
+}
+
+/**
+ * @brief Plays config.games games, one slot of counters per thread
+ * @param slots One aligned slot per thread: no slot shares a cache line with another
+ * @param play Called as play(index, slot) for every game
+ * @return Wall time in seconds
+ */
+template <typename Counters, typename Play>
+double runChunked(const SimConfig& config, std::vector<Counters>& slots, Play play) {
+    std::atomic<std::uint64_t> next(0);
+    auto worker = [&config, &next, &play](Counters& counters) {
+        for (;;) {
+            std::uint64_t first = next.fetch_add(CHUNK, std::memory_order_relaxed);
+            if (first >= config.games) {
+                return;
+            }
+            std::uint64_t last = std::min(first + CHUNK, config.games);
+            for (std::uint64_t index = first; index < last; ++index) {
+                play(index, counters);
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    runOnThreads(static_cast<unsigned>(slots.size()), [&worker, &slots](unsigned slot) { worker(slots[slot]); });
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+void simulateGame(const SimConfig& config, std::uint64_t index, SimCounters& counters) {
+    TraceSpan span("simulateGame", "sim");
+    std::vector<std::size_t> roles;
+    std::uint64_t turns = 0;
+    std::uint8_t winner = playRandomGame(config, config.rules, index, &counters, roles, turns);
+    counters.recordGame(roles, winner, turns);
+}
+
+SimStats runSimulation(const SimConfig& config) {
+    unsigned threads = threadsFor(config);
+    std::vector<SimCounters> slots(threads);
+    double seconds = runChunked(config, slots, [&config](std::uint64_t index, SimCounters& counters) {
+        simulateGame(config, index, counters);
+    });
+
+    SimCounters totals;
+    for (const SimCounters& slot : slots) {
+        totals.merge(slot);
+    }
+    return SimStats(totals, threads, seconds);
+}
+
+RuleComparison compareRules(const SimConfig& config, const RuleSet& variant) {
+    unsigned threads = threadsFor(config);
+    std::vector<PairedCounters> slots(threads);
+    double seconds = runChunked(config, slots, [&config, &variant](std::uint64_t index, PairedCounters& counters) {
+        std::vector<std::size_t> roles;
+        std::array<std::uint8_t, 2> winners;
+        std::array<std::uint64_t, 2> turns;
+        winners[0] = playRandomGame(config, config.rules, index, nullptr, roles, turns[0]);
+        winners[1] = playRandomGame(config, variant, index, nullptr, roles, turns[1]);
+        counters.recordPair(roles, winners, turns);
+    });
+
+    PairedCounters totals;
+    for (const PairedCounters& slot : slots) {
+        totals.merge(slot);
+    }
+    return RuleComparison(totals, threads, seconds);
+}
+
+RuleSet parseRules(const std::string& spec, RuleSet rules) {
+    std::size_t start = 0;
+    while (start < spec.size()) {
+        std::size_t end = spec.find(',', start);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        std::string item = spec.substr(start, end - start);
+        std::size_t equals = item.find('=');
+        std::string key = item.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : item.substr(equals + 1);
+        if (value.empty() || value.size() > 3 || value.find_first_not_of("0123456789") != std::string::npos) {
+            throw GameException("Bad rule value in '" + item + "'");
+        }
+        int number = std::stoi(value);
+        if (key == "tax") {
+            rules.taxAmount = number;
+        } else if (key == "governor-tax") {
+            rules.governorTax = number;
+        } else if (key == "merchant-threshold") {
+            rules.merchantThreshold = number;
+        } else if (key == "merchant-bonus") {
+            rules.merchantBonus = number;
+        } else {
+            throw GameException("Unknown rule '" + key + "'");
+        }
+        start = end + 1;
+    }
+    return rules;
+}
+
+} // namespace coup
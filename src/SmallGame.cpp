@@ -0,0 +1,436 @@
+//meirshuker159@gmail.com
+
+#include "SmallGame.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <string>
+
+namespace coup {
+
+namespace {
+
+constexpr std::uint8_t NO_ACTION = 0xFF;
+constexpr std::size_t LOG_BITS = 8;
+constexpr std::size_t OUTCOME_BITS = 3;
+
+/**
+ * @brief Role indices as in roleName()
+ */
+enum RoleId : std::uint8_t { GOVERNOR, SPY, BARON, GENERAL, JUDGE, MERCHANT };
+
+bool isAlive(const SmallState& state, std::size_t seat) {
+    return (state.alive >> seat) & 1u;
+}
+
+/**
+ * @brief Seat 'offset' places after 'seat'
+ */
+std::uint8_t seatAfter(const SmallState& state, std::uint8_t seat, std::size_t offset) {
+    return static_cast<std::uint8_t>((seat + offset) % state.players);
+}
+
+/**
+ * @brief Seat of 'seat' counted from 'viewer' (0 for the viewer itself)
+ */
+std::uint64_t relative(const SmallState& state, std::uint8_t seat, std::uint8_t viewer) {
+    return static_cast<std::uint64_t>((seat + state.players - viewer) % state.players);
+}
+
+/**
+ * @brief Coin bucket with a boundary at every threshold of the rules (3, 5, 7, 10)
+ */
+std::uint64_t coinBucket(std::uint8_t coins) {
+    if (coins == 0) return 0;
+    if (coins <= 2) return 1;
+    if (coins <= 4) return 2;
+    if (coins <= 6) return 3;
+    if (coins <= 9) return 4;
+    return 5;
+}
+
+bool isTargeted(SmallAction action) {
+    return action >= SmallAction::Arrest1 && action <= SmallAction::Coup2;
+}
+
+/**
+ * @brief Offset of a targeted action's target from the actor (1 or 2)
+ */
+std::size_t targetOffset(SmallAction action) {
+    return (static_cast<std::size_t>(action) - static_cast<std::size_t>(SmallAction::Arrest1)) % 2 + 1;
+}
+
+/**
+ * @brief Seats asked to block, a bit per seat after the actor
+ */
+std::uint64_t askedAfterActor(const SmallState& state) {
+    std::uint64_t bits = 0;
+    for (std::size_t offset = 1; offset < state.players; ++offset) {
+        bits |= static_cast<std::uint64_t>((state.asked >> seatAfter(state, state.current, offset)) & 1u) << (offset - 1);
+    }
+    return bits;
+}
+
+/**
+ * @brief Packs the public log and the turn in progress into a key
+ * @param extra Up to 9 bits for the top of the key
+ */
+SmallKey packKey(const SmallState& state, std::uint64_t extra) {
+    SmallKey key;
+    key.low = state.log[0];
+    key.high = state.log[1];  // 48 bits of log at most (SMALL_MAX_HORIZON turns)
+    key.rest = state.outcomes;  // 43 bits at most
+    key.rest |= static_cast<std::uint64_t>(state.turn) << 43;
+    key.rest |= static_cast<std::uint64_t>(state.pending == NO_ACTION ? 15 : state.pending) << 47;
+    key.rest |= static_cast<std::uint64_t>(state.blocker == NO_SEAT ? 3 : state.blocker) << 51;
+    key.rest |= askedAfterActor(state) << 53;
+    key.rest |= extra << 55;
+    return key;
+}
+
+} // namespace
+
+const char* smallActionName(SmallAction action) {
+    switch (action) {
+        case SmallAction::Gather: return "Gather";
+        case SmallAction::Tax: return "Tax";
+        case SmallAction::Invest: return "Invest";
+        case SmallAction::Arrest1: return "Arrest+1";
+        case SmallAction::Arrest2: return "Arrest+2";
+        case SmallAction::Sanction1: return "Sanction+1";
+        case SmallAction::Sanction2: return "Sanction+2";
+        case SmallAction::Coup1: return "Coup+1";
+        case SmallAction::Coup2: return "Coup+2";
+        case SmallAction::Skip: return "Skip";
+        case SmallAction::Block: return "Block";
+        case SmallAction::Pass: return "Pass";
+    }
+    return "?";
+}
+
+SmallGame::SmallGame(const SmallConfig& config) : settings(config) {
+    if (config.players < 2 || config.players > SMALL_MAX_PLAYERS) {
+        throw GameException("Small games seat 2 or 3 players");
+    }
+    if (config.horizon < 1 || config.horizon > SMALL_MAX_HORIZON) {
+        throw GameException("Small game horizon must be 1 to " + std::to_string(SMALL_MAX_HORIZON) + " turns");
+    }
+}
+
+std::size_t SmallGame::dealCount() const {
+    std::size_t deals = 1;
+    for (std::size_t seat = 0; seat < settings.players; ++seat) {
+        deals *= ROLE_COUNT;
+    }
+    return deals;
+}
+
+SmallState SmallGame::deal(std::size_t index) const {
+    SmallState state;
+    state.players = settings.players;
+    state.alive = static_cast<std::uint8_t>((1u << settings.players) - 1);
+    for (std::size_t seat = 0; seat < settings.players; ++seat) {
+        state.roles[seat] = static_cast<std::uint8_t>(index % ROLE_COUNT);
+        state.coins[seat] = settings.startCoins;
+        index /= ROLE_COUNT;
+    }
+    if (state.roles[0] == MERCHANT && state.coins[0] >= settings.rules.merchantThreshold) {
+        state.coins[0] = static_cast<std::uint8_t>(state.coins[0] + settings.rules.merchantBonus);
+        state.outcomes |= std::uint64_t(1) << (SMALL_MAX_HORIZON * OUTCOME_BITS);
+    }
+    return state;
+}
+
+bool SmallGame::isTerminal(const SmallState& state) const {
+    return state.turn >= settings.horizon || (state.alive & (state.alive - 1)) == 0;
+}
+
+void SmallGame::utilities(const SmallState& state, float* out) const {
+    float total = 0.0f;
+    for (std::size_t seat = 0; seat < state.players; ++seat) {
+        out[seat] = isAlive(state, seat) ? static_cast<float>(state.coins[seat]) + 1.0f : 0.0f;
+        total += out[seat];
+    }
+    bool alone = (state.alive & (state.alive - 1)) == 0;
+    for (std::size_t seat = 0; seat < state.players; ++seat) {
+        out[seat] = alone ? (isAlive(state, seat) ? 1.0f : 0.0f) : out[seat] / total;
+    }
+}
+
+std::uint8_t SmallGame::actingSeat(const SmallState& state) const {
+    return state.pending == NO_ACTION ? state.current : state.blocker;
+}
+
+SmallActionMask SmallGame::legalActions(const SmallState& state) const {
+    auto bit = [](SmallAction action) { return static_cast<SmallActionMask>(1u << static_cast<unsigned>(action)); };
+    if (state.pending != NO_ACTION) {
+        return bit(SmallAction::Block) | bit(SmallAction::Pass);
+    }
+    std::uint8_t actor = state.current;
+    std::uint8_t coins = state.coins[actor];
+    bool sanctioned = (state.sanctioned >> actor) & 1u;
+    SmallActionMask legal = 0;
+    for (std::size_t offset = 1; offset < state.players; ++offset) {
+        std::uint8_t target = seatAfter(state, actor, offset);
+        if (!isAlive(state, target)) continue;
+        SmallAction coup = offset == 1 ? SmallAction::Coup1 : SmallAction::Coup2;
+        if (coins >= 7) legal |= bit(coup);
+    }
+    if (coins >= 10) {
+        return legal;  // Forced coup
+    }
+    if (!sanctioned) {
+        legal |= bit(SmallAction::Gather) | bit(SmallAction::Tax);
+    }
+    if (state.roles[actor] == BARON && coins >= 3) {
+        legal |= bit(SmallAction::Invest);
+    }
+    for (std::size_t offset = 1; offset < state.players; ++offset) {
+        std::uint8_t target = seatAfter(state, actor, offset);
+        if (!isAlive(state, target)) continue;
+        if (target != state.lastArrested) {
+            legal |= bit(offset == 1 ? SmallAction::Arrest1 : SmallAction::Arrest2);
+        }
+        if (coins >= 3) {
+            legal |= bit(offset == 1 ? SmallAction::Sanction1 : SmallAction::Sanction2);
+        }
+    }
+    return legal ? legal : bit(SmallAction::Skip);
+}
+
+std::uint8_t SmallGame::nextBlocker(const SmallState& state, std::uint8_t after) const {
+    SmallAction action = static_cast<SmallAction>(state.pending);
+    for (std::size_t offset = 1; offset < state.players; ++offset) {
+        std::uint8_t seat = seatAfter(state, after, offset);
+        if (seat == state.current) {
+            break;  // Everyone after the actor has been asked
+        }
+        if (!isAlive(state, seat)) continue;
+        bool can = action == SmallAction::Tax ? state.roles[seat] == GOVERNOR
+                                              : state.roles[seat] == GENERAL && state.coins[seat] >= 5;
+        if (can) {
+            return seat;
+        }
+    }
+    return NO_SEAT;
+}
+
+SmallState SmallGame::apply(const SmallState& state, SmallAction action) const {
+    SmallState next = state;
+    if (state.pending != NO_ACTION) {
+        SmallAction pending = static_cast<SmallAction>(state.pending);
+        next.asked = static_cast<std::uint8_t>(next.asked | (1u << state.blocker));
+        if (action == SmallAction::Block) {
+            if (pending != SmallAction::Tax) {
+                next.coins[state.current] = static_cast<std::uint8_t>(next.coins[state.current] - 7);
+                next.coins[state.blocker] = static_cast<std::uint8_t>(next.coins[state.blocker] - 5);
+            }
+            endTurn(next, pending, state.blocker, 0);
+            return next;
+        }
+        next.blocker = nextBlocker(state, state.blocker);
+        if (next.blocker == NO_SEAT) {
+            endTurn(next, pending, NO_SEAT, perform(next, pending));
+        }
+        return next;
+    }
+
+    if (action == SmallAction::Tax || action == SmallAction::Coup1 || action == SmallAction::Coup2) {
+        next.pending = static_cast<std::uint8_t>(action);
+        next.blocker = nextBlocker(next, state.current);
+        if (next.blocker != NO_SEAT) {
+            return next;
+        }
+        next.pending = NO_ACTION;
+    }
+    endTurn(next, action, NO_SEAT, perform(next, action));
+    return next;
+}
+
+std::uint8_t SmallGame::perform(SmallState& state, SmallAction action) const {
+    std::uint8_t actor = state.current;
+    std::uint8_t& coins = state.coins[actor];
+    std::uint8_t target = isTargeted(action) ? seatAfter(state, actor, targetOffset(action)) : NO_SEAT;
+    std::uint8_t before = coins;
+    std::uint8_t targetBefore = target == NO_SEAT ? 0 : state.coins[target];
+    switch (action) {
+        case SmallAction::Gather:
+            coins++;
+            break;
+        case SmallAction::Tax:
+            coins = static_cast<std::uint8_t>(
+                coins + (state.roles[actor] == GOVERNOR ? settings.rules.governorTax : settings.rules.taxAmount));
+            break;
+        case SmallAction::Invest:
+            coins = static_cast<std::uint8_t>(coins + 3);
+            break;
+        case SmallAction::Arrest1:
+        case SmallAction::Arrest2:
+            if (state.roles[target] == MERCHANT) {
+                state.coins[target] = static_cast<std::uint8_t>(state.coins[target] - std::min<int>(state.coins[target], 2));
+            } else if (state.roles[target] != GENERAL && state.coins[target] > 0) {
+                state.coins[target]--;
+                coins++;
+            }
+            state.lastArrested = target;
+            break;
+        case SmallAction::Sanction1:
+        case SmallAction::Sanction2:
+            coins = static_cast<std::uint8_t>(coins - 3);
+            state.sanctioned = static_cast<std::uint8_t>(state.sanctioned | (1u << target));
+            if (state.roles[target] == BARON) {
+                state.coins[target]++;
+            }
+            break;
+        case SmallAction::Coup1:
+        case SmallAction::Coup2:
+            coins = static_cast<std::uint8_t>(coins - 7);
+            state.alive = static_cast<std::uint8_t>(state.alive & ~(1u << target));
+            state.coins[target] = 0;
+            break;
+        default:
+            break;
+    }
+
+    // What the coins show beyond the action itself: a Governor's tax, an
+    // arrest a General shrugs off or a Merchant pays to the treasury, a
+    // sanctioned Baron's refund
+    if (action == SmallAction::Tax) {
+        return coins - before == settings.rules.governorTax && settings.rules.governorTax != settings.rules.taxAmount;
+    }
+    if (action == SmallAction::Arrest1 || action == SmallAction::Arrest2) {
+        if (coins != before) return 0;
+        return state.coins[target] == targetBefore ? 1 : 2;
+    }
+    if (action == SmallAction::Sanction1 || action == SmallAction::Sanction2) {
+        return state.coins[target] != targetBefore;
+    }
+    return 0;
+}
+
+void SmallGame::endTurn(SmallState& state, SmallAction action, std::uint8_t blockedBy, std::uint8_t observed) const {
+    std::uint64_t entry = static_cast<std::uint64_t>(action) | (blockedBy == NO_SEAT ? 0 : (blockedBy + 1u)) << 4 |
+                          askedAfterActor(state) << 6;
+    std::size_t position = state.turn * LOG_BITS;
+    if (position < 64) {
+        state.log[0] |= entry << position;
+        if (position + LOG_BITS > 64) {
+            state.log[1] |= entry >> (64 - position);
+        }
+    } else {
+        state.log[1] |= entry << (position - 64);
+    }
+    std::size_t outcome = state.turn * OUTCOME_BITS;
+    state.outcomes |= static_cast<std::uint64_t>(observed) << outcome;
+
+    // A sanction lasts until the end of the sanctioned player's turn
+    state.sanctioned = static_cast<std::uint8_t>(state.sanctioned & ~(1u << state.current));
+    state.pending = NO_ACTION;
+    state.blocker = NO_SEAT;
+    state.asked = 0;
+    state.turn++;
+    if (isTerminal(state)) {
+        return;
+    }
+    do {
+        state.current = seatAfter(state, state.current, 1);
+    } while (!isAlive(state, state.current));
+    std::uint8_t& coins = state.coins[state.current];
+    if (state.roles[state.current] == MERCHANT && coins >= settings.rules.merchantThreshold) {
+        coins = static_cast<std::uint8_t>(coins + settings.rules.merchantBonus);
+        state.outcomes |= std::uint64_t(4) << outcome;
+    }
+}
+
+std::uint64_t SmallGame::abstractKey(const SmallState& state, std::uint8_t seat) const {
+    std::uint64_t key = seat;
+    key |= static_cast<std::uint64_t>(state.roles[seat]) << 2;
+    key |= static_cast<std::uint64_t>(state.players) << 5;
+    key |= static_cast<std::uint64_t>(state.pending == NO_ACTION ? 15 : state.pending) << 7;
+    key |= relative(state, state.current, seat) << 11;
+    key |= static_cast<std::uint64_t>(settings.horizon - std::min(state.turn, settings.horizon)) << 13;
+    key |= (state.lastArrested == NO_SEAT ? 3 : relative(state, state.lastArrested, seat)) << 18;
+    for (std::uint8_t other = 0; other < state.players; ++other) {
+        std::uint64_t coins = settings.bucketCoins ? coinBucket(state.coins[other]) : std::min<std::uint64_t>(state.coins[other], 15);
+        std::uint64_t field = coins | (static_cast<std::uint64_t>(isAlive(state, other)) << 4) |
+                              (static_cast<std::uint64_t>((state.sanctioned >> other) & 1u) << 5);
+        key |= field << (20 + 6 * relative(state, other, seat));
+    }
+    return key;
+}
+
+SmallKey SmallGame::infoKey(const SmallState& state, std::uint8_t seat) const {
+    return packKey(state, seat | static_cast<std::uint64_t>(state.roles[seat]) << 2);
+}
+
+SmallKey SmallGame::historyKey(const SmallState& state) const {
+    std::uint64_t roles = 0;
+    for (std::size_t seat = 0; seat < state.players; ++seat) {
+        roles |= static_cast<std::uint64_t>(state.roles[seat]) << (3 * seat);
+    }
+    return packKey(state, roles);
+}
+
+void UniformPolicy::probabilities(const SmallGame&, const SmallState&, SmallActionMask legal,
+                                  std::array<float, SMALL_ACTIONS>& out) const {
+    float share = 1.0f / static_cast<float>(__builtin_popcount(legal));
+    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+        out[a] = (legal >> a) & 1u ? share : 0.0f;
+    }
+}
+
+void GreedyPolicy::probabilities(const SmallGame&, const SmallState&, SmallActionMask legal,
+                                 std::array<float, SMALL_ACTIONS>& out) const {
+    out.fill(0.0f);
+    auto has = [legal](SmallAction action) { return (legal >> static_cast<unsigned>(action)) & 1u; };
+    // In order of preference; the first group with a legal action is played
+    const std::vector<std::vector<SmallAction>> preferences = {
+        {SmallAction::Coup1, SmallAction::Coup2}, {SmallAction::Pass}, {SmallAction::Invest}, {SmallAction::Tax},
+        {SmallAction::Gather}, {SmallAction::Arrest1, SmallAction::Arrest2},
+        {SmallAction::Sanction1, SmallAction::Sanction2}, {SmallAction::Skip}};
+    for (const auto& group : preferences) {
+        std::size_t count = static_cast<std::size_t>(std::count_if(group.begin(), group.end(), has));
+        if (count == 0) continue;
+        for (SmallAction action : group) {
+            out[static_cast<std::size_t>(action)] = has(action) ? 1.0f / static_cast<float>(count) : 0.0f;
+        }
+        return;
+    }
+}
+
+namespace {
+
+void accumulate(const SmallGame& game, const SmallState& state, double weight,
+                const std::vector<const SmallPolicy*>& seats, std::vector<double>& totals) {
+    if (game.isTerminal(state)) {
+        std::array<float, SMALL_MAX_PLAYERS> scores;
+        game.utilities(state, scores.data());
+        for (std::size_t seat = 0; seat < state.players; ++seat) {
+            totals[seat] += weight * scores[seat];
+        }
+        return;
+    }
+    SmallActionMask legal = game.legalActions(state);
+    std::array<float, SMALL_ACTIONS> probabilities;
+    seats[game.actingSeat(state)]->probabilities(game, state, legal, probabilities);
+    for (std::size_t a = 0; a < SMALL_ACTIONS; ++a) {
+        if ((legal >> a) & 1u && probabilities[a] > 0.0f) {
+            accumulate(game, game.apply(state, static_cast<SmallAction>(a)), weight * probabilities[a], seats, totals);
+        }
+    }
+}
+
+} // namespace
+
+std::vector<double> expectedUtilities(const SmallGame& game, const std::vector<const SmallPolicy*>& seats) {
+    if (seats.size() != game.config().players) {
+        throw GameException("Need one policy per seat");
+    }
+    std::vector<double> totals(seats.size(), 0.0);
+    double weight = 1.0 / static_cast<double>(game.dealCount());
+    for (std::size_t deal = 0; deal < game.dealCount(); ++deal) {
+        accumulate(game, game.deal(deal), weight, seats, totals);
+    }
+    return totals;
+}
+
+} // namespace coup
@@ -0,0 +1,198 @@
+//meirshuker159@gmail.com
+
+#include "SpectatorWall.hpp"
+#include "Assets.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace coup {
+
+/**
+ * @brief Lays out the grid and prepares the atlas
+ * @details The grid is as square as possible: ceil(sqrt(n)) columns. Every
+ * tile starts dirty so the first frame draws the whole wall.
+ */
+SpectatorWall::SpectatorWall(TableFeed& feed)
+    : feed(feed), states(feed.tableCount()), texts(feed.tableCount()), columns(1), tileWidth(0), tileHeight(0),
+      geometry(sf::Quads) {
+    window.create(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Coup Spectator Wall");
+    window.setFramerateLimit(60);
+    if (!loadAssets()) {
+        throw std::runtime_error("Failed to load required assets");
+    }
+    if (!atlas.create(WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        throw std::runtime_error("Failed to create the wall texture");
+    }
+    atlas.clear(sf::Color(20, 20, 20));
+    atlasSprite.setTexture(atlas.getTexture());
+
+    std::size_t tableCount = std::max<std::size_t>(states.size(), 1);
+    columns = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(tableCount))));
+    std::size_t rows = (tableCount + columns - 1) / columns;
+    tileWidth = static_cast<float>(WINDOW_WIDTH) / static_cast<float>(columns);
+    tileHeight = static_cast<float>(WINDOW_HEIGHT) / static_cast<float>(rows);
+
+    unsigned textSize = static_cast<unsigned>(std::clamp(tileHeight / 9.0f, 10.0f, 16.0f));
+    for (std::size_t i = 0; i < texts.size(); ++i) {
+        float x = static_cast<float>(i % columns) * tileWidth + TILE_PADDING * 2;
+        float y = static_cast<float>(i / columns) * tileHeight + TILE_PADDING * 2;
+        for (sf::Text* text : {&texts[i].header, &texts[i].seats, &texts[i].lastAction}) {
+            text->setFont(font);
+            text->setCharacterSize(textSize);
+            text->setFillColor(sf::Color::White);
+        }
+        texts[i].header.setStyle(sf::Text::Bold);
+        texts[i].header.setPosition(x, y);
+        texts[i].seats.setPosition(x, y + textSize * 1.5f);
+        texts[i].lastAction.setPosition(x, y + tileHeight - TILE_PADDING * 4 - textSize * 1.5f);
+        texts[i].seats.setFillColor(sf::Color(200, 200, 200));
+        texts[i].lastAction.setFillColor(sf::Color(255, 220, 120));
+    }
+    redrawList.reserve(states.size());
+}
+
+/**
+ * @brief Loads the tile font from the embedded asset bundle
+ */
+bool SpectatorWall::loadAssets() {
+    const EmbeddedAsset* fontAsset = findAsset("DejaVuSans.ttf");
+    if (!fontAsset || !font.loadFromMemory(fontAsset->data, fontAsset->size)) {
+        std::cerr << "Failed to load the embedded font" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void SpectatorWall::run() {
+    while (window.isOpen()) {
+        handleEvents();
+        drainFeed();
+        render();
+    }
+}
+
+void SpectatorWall::handleEvents() {
+    sf::Event event;
+    while (window.pollEvent(event)) {
+        if (event.type == sf::Event::Closed ||
+            (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)) {
+            window.close();
+        }
+    }
+}
+
+void SpectatorWall::drainFeed() {
+    ActionRecord record;
+    for (std::size_t table = 0; table < states.size(); ++table) {
+        while (feed.poll(table, record)) {
+            states[table].apply(record);
+        }
+    }
+}
+
+void SpectatorWall::render() {
+    redrawDirtyTiles();
+    window.clear(sf::Color(20, 20, 20));
+    window.draw(atlasSprite);
+    window.display();
+}
+
+/**
+ * @brief Brings the atlas up to date with the dirty tiles
+ * @details Geometry for all dirty tiles goes out in one draw call, followed
+ * by their cached texts. Clean tiles are not touched at all.
+ */
+void SpectatorWall::redrawDirtyTiles() {
+    redrawList.clear();
+    geometry.clear();
+    for (std::size_t tile = 0; tile < states.size(); ++tile) {
+        if (!states[tile].dirty) continue;
+        states[tile].dirty = false;
+        redrawList.push_back(tile);
+        appendTileGeometry(tile);
+        updateTileTexts(tile);
+    }
+    if (redrawList.empty()) {
+        return;
+    }
+    atlas.draw(geometry);
+    for (std::size_t tile : redrawList) {
+        atlas.draw(texts[tile].header);
+        atlas.draw(texts[tile].seats);
+        atlas.draw(texts[tile].lastAction);
+    }
+    atlas.display();
+}
+
+/**
+ * @brief Adds the background and per-seat coin bars of a tile
+ * @details Bar height is proportional to coins (10 coins, the mandatory coup
+ * threshold, fills the bar). The seat to act is yellow, eliminated seats grey.
+ */
+void SpectatorWall::appendTileGeometry(std::size_t tile) {
+    const TableState& state = states[tile];
+    float x = static_cast<float>(tile % columns) * tileWidth;
+    float y = static_cast<float>(tile / columns) * tileHeight;
+    bool finished = state.winnerSeat != NO_SEAT;
+
+    // Border then body; the body fully covers the previous image of the tile
+    appendQuad(x, y, tileWidth, tileHeight, sf::Color(20, 20, 20));
+    appendQuad(x + TILE_PADDING, y + TILE_PADDING, tileWidth - 2 * TILE_PADDING, tileHeight - 2 * TILE_PADDING,
+               finished ? sf::Color(110, 90, 20) : sf::Color(60, 60, 60));
+    appendQuad(x + TILE_PADDING * 2, y + TILE_PADDING * 2, tileWidth - 4 * TILE_PADDING,
+               tileHeight - 4 * TILE_PADDING, sf::Color(35, 35, 45));
+
+    // Coin bars occupy the middle half of the tile
+    float barAreaTop = y + tileHeight * 0.35f;
+    float barAreaHeight = tileHeight * 0.35f;
+    float slotWidth = (tileWidth - 6 * TILE_PADDING) / static_cast<float>(MAX_SEATS);
+    for (std::uint8_t seat = 0; seat < state.playerCount; ++seat) {
+        float fill = std::min(static_cast<float>(state.coins[seat]) / 10.0f, 1.0f);
+        float slotX = x + TILE_PADDING * 3 + seat * slotWidth;
+        sf::Color color = !state.active[seat] ? sf::Color(90, 90, 90)
+                        : seat == state.currentSeat ? sf::Color(230, 200, 40)
+                        : sf::Color(60, 160, 80);
+        appendQuad(slotX, barAreaTop, slotWidth - TILE_PADDING, barAreaHeight, sf::Color(25, 25, 30));
+        float barHeight = std::max(barAreaHeight * fill, 2.0f);
+        appendQuad(slotX, barAreaTop + barAreaHeight - barHeight, slotWidth - TILE_PADDING, barHeight, color);
+    }
+}
+
+void SpectatorWall::updateTileTexts(std::size_t tile) {
+    const TableState& state = states[tile];
+    texts[tile].header.setString("Table " + std::to_string(tile + 1) + "  T:" + std::to_string(state.treasury) +
+                                 "  game " + std::to_string(state.gamesPlayed));
+
+    std::string seats;
+    for (std::uint8_t seat = 0; seat < state.playerCount; ++seat) {
+        seats += feed.seatName(tile, seat) + ":" + (state.active[seat] ? std::to_string(state.coins[seat]) : "x") + " ";
+    }
+    texts[tile].seats.setString(seats);
+
+    std::string last;
+    if (state.winnerSeat != NO_SEAT) {
+        last = feed.seatName(tile, state.winnerSeat) + " wins!";
+    } else if (state.hasLastAction) {
+        const ActionRecord& action = state.lastAction;
+        last = feed.seatName(tile, action.actor) + " " + actionTypeName(action.type);
+        if (action.type == ActionType::Block) {
+            last += " " + std::string(actionTypeName(static_cast<ActionType>(action.detail)));
+        }
+        if (action.target != NO_SEAT) {
+            last += " -> " + feed.seatName(tile, action.target);
+        }
+    }
+    texts[tile].lastAction.setString(last);
+}
+
+void SpectatorWall::appendQuad(float x, float y, float width, float height, const sf::Color& color) {
+    geometry.append(sf::Vertex(sf::Vector2f(x, y), color));
+    geometry.append(sf::Vertex(sf::Vector2f(x + width, y), color));
+    geometry.append(sf::Vertex(sf::Vector2f(x + width, y + height), color));
+    geometry.append(sf::Vertex(sf::Vector2f(x, y + height), color));
+}
+
+} // namespace coup
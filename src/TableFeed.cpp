@@ -0,0 +1,234 @@
+//meirshuker159@gmail.com
+
+#include "TableFeed.hpp"
+#include "Bot.hpp"
+#include "Replay.hpp"
+#include <algorithm>
+#include <exception>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief Gets a randomized delay around interval so tables do not tick in lockstep
+ */
+std::chrono::milliseconds jittered(std::chrono::milliseconds interval, std::mt19937& rng) {
+    std::uniform_int_distribution<long long> spread(interval.count() / 2, interval.count() * 3 / 2);
+    return std::chrono::milliseconds(spread(rng));
+}
+
+} // namespace
+
+/**
+ * @brief Folds one event into the table state
+ * @details GameStart resets the table; every other record refreshes the coins
+ * of its actor and target and the treasury it carries.
+ */
+void TableState::apply(const ActionRecord& record) {
+    dirty = true;
+    treasury = record.treasury;
+    switch (record.type) {
+        case ActionType::GameStart:
+            playerCount = std::min<std::uint8_t>(record.detail, static_cast<std::uint8_t>(MAX_SEATS));
+            coins.fill(0);
+            active.fill(false);
+            std::fill(active.begin(), active.begin() + playerCount, true);
+            currentSeat = NO_SEAT;
+            winnerSeat = NO_SEAT;
+            hasLastAction = false;
+            gamesPlayed++;
+            return;
+        case ActionType::TurnStart:
+            currentSeat = record.actor;
+            break;
+        case ActionType::GameOver:
+            winnerSeat = record.actor;
+            currentSeat = NO_SEAT;
+            break;
+        default:
+            lastAction = record;
+            hasLastAction = true;
+            break;
+    }
+    if (record.actor < MAX_SEATS) {
+        coins[record.actor] = record.actorCoins;
+    }
+    if (record.target < MAX_SEATS) {
+        coins[record.target] = record.targetCoins;
+        if (record.type == ActionType::Coup) {
+            active[record.target] = false;
+        }
+    }
+}
+
+/**
+ * @brief Seats a game at every table and starts the worker
+ * @details Tables start at staggered times so the first frames already show
+ * varied boards instead of every table moving at once.
+ */
+LiveTables::LiveTables(std::size_t tableCount, std::chrono::milliseconds stepInterval, std::uint32_t seed)
+    : tables(), stepInterval(stepInterval), restartDelay(stepInterval * 20), rng(seed), running(true),
+      wakeMutex(), wake(), worker() {
+    auto now = Clock::now();
+    for (std::size_t i = 0; i < tableCount; ++i) {
+        tables.push_back(std::make_unique<Table>());
+        newGame(*tables.back());
+        tables.back()->nextStep = now + jitter(stepInterval);
+    }
+    worker = std::thread(&LiveTables::run, this);
+}
+
+LiveTables::~LiveTables() {
+    running.store(false);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wake.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+std::string LiveTables::seatName(std::size_t, std::uint8_t seat) const {
+    return "P" + std::to_string(seat + 1);
+}
+
+bool LiveTables::poll(std::size_t table, ActionRecord& record) {
+    return table < tables.size() && tables[table]->events.tryPop(record);
+}
+
+void LiveTables::run() {
+    while (running.load()) {
+        auto now = Clock::now();
+        auto wakeAt = now + stepInterval;
+        for (auto& table : tables) {
+            if (!flush(*table)) {
+                continue;  // Consumer is behind; hold this table until it catches up
+            }
+            if (table->nextStep <= now) {
+                step(*table);
+                flush(*table);
+                bool over = table->controller->phase() == GamePhase::GameOver;
+                table->nextStep = now + (over ? Clock::duration(restartDelay) : jitter(stepInterval));
+            }
+            wakeAt = std::min(wakeAt, table->nextStep);
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait_until(lock, wakeAt, [this] { return !running.load(); });
+    }
+}
+
+void LiveTables::newGame(Table& table) {
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    table.controller = std::make_unique<GameController>(game);
+    table.controller->setEventSink([&table](const ActionRecord& record) { table.pending.push_back(record); });
+    table.steps = 0;
+
+    std::uniform_int_distribution<int> seats(2, static_cast<int>(MAX_SEATS));
+    int playerCount = seats(rng);
+    for (int seat = 0; seat < playerCount; ++seat) {
+        table.controller->addPlayer(seatName(0, static_cast<std::uint8_t>(seat)));
+    }
+    // A full table starts itself when the last player joins
+    if (table.controller->phase() == GamePhase::Setup) {
+        table.controller->startGame();
+    }
+}
+
+/**
+ * @brief Makes one random decision (see randomMove)
+ */
+void LiveTables::step(Table& table) {
+    GameController& controller = *table.controller;
+    if (controller.phase() == GamePhase::GameOver || table.steps >= MAX_GAME_STEPS) {
+        newGame(table);
+        return;
+    }
+    table.steps++;
+    try {
+        GameRecord::play(controller, randomMove(controller, rng));
+    } catch (const std::exception& e) {
+        controller.reportError(e.what());
+    }
+}
+
+bool LiveTables::flush(Table& table) {
+    std::size_t pushed = 0;
+    while (pushed < table.pending.size() && table.events.tryPush(table.pending[pushed])) {
+        pushed++;
+    }
+    table.pending.erase(table.pending.begin(), table.pending.begin() + pushed);
+    return table.pending.empty();
+}
+
+LiveTables::Clock::duration LiveTables::jitter(std::chrono::milliseconds interval) {
+    return jittered(interval, rng);
+}
+
+/**
+ * @brief Replays every record once, keeping its events split by move
+ * @details Forward seeks of one move continue from the current state, so
+ * walking a record costs one pass through the engine.
+ */
+ReplayTables::ReplayTables(const std::vector<GameRecord>& records, std::chrono::milliseconds stepInterval,
+                           std::uint32_t seed)
+    : tables(), stepInterval(stepInterval), restartDelay(stepInterval * 20), rng(seed) {
+    auto now = Clock::now();
+    tables.reserve(records.size());
+    for (const GameRecord& record : records) {
+        Replay replay(record);
+        Table table;
+        table.seats = record.seats;
+        for (std::size_t position = 0; position <= replay.length(); ++position) {
+            replay.seek(position);
+            table.moveEnd.push_back(replay.eventCount());
+        }
+        for (std::size_t i = 0; i < replay.eventCount(); ++i) {
+            table.events.push_back(replay.event(i));
+        }
+        table.nextStep = now + jittered(stepInterval, rng);
+        tables.push_back(std::move(table));
+    }
+}
+
+std::string ReplayTables::seatName(std::size_t table, std::uint8_t seat) const {
+    if (table < tables.size() && seat < tables[table].seats.size()) {
+        return tables[table].seats[seat].name;
+    }
+    return "P" + std::to_string(seat + 1);
+}
+
+/**
+ * @brief Hands out the next released event, releasing the next move when it is due
+ * @details The events before the first move (GameStart, TurnStart) are
+ * released from the start. After the last move the table waits restartDelay
+ * and plays the game again from its first event.
+ */
+bool ReplayTables::poll(std::size_t index, ActionRecord& record) {
+    if (index >= tables.size()) {
+        return false;
+    }
+    Table& table = tables[index];
+    std::size_t length = table.moveEnd.size() - 1;
+    // A blockable action emits nothing until it is blocked or passed, so release moves until one has events
+    while (table.next >= table.moveEnd[table.moves]) {
+        auto now = Clock::now();
+        if (now < table.nextStep) {
+            return false;
+        }
+        if (table.moves < length) {
+            table.moves++;
+            table.nextStep = now + (table.moves == length ? restartDelay : jittered(stepInterval, rng));
+        } else {
+            table.moves = 0;
+            table.next = 0;
+            table.nextStep = now + jittered(stepInterval, rng);
+        }
+    }
+    record = table.events[table.next++];
+    return true;
+}
+
+} // namespace coup
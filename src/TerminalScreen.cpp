@@ -0,0 +1,184 @@
+//meirshuker159@gmail.com
+
+#include "TerminalScreen.hpp"
+#include <algorithm>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief SGR sequence selecting a style; every sequence starts with a reset
+ */
+const char* styleSequence(CellStyle style) {
+    switch (style) {
+        case CellStyle::Normal: return "\x1b[0m";
+        case CellStyle::Bold: return "\x1b[0;1m";
+        case CellStyle::Dim: return "\x1b[0;2m";
+        case CellStyle::Highlight: return "\x1b[0;1;33m";
+        case CellStyle::Title: return "\x1b[0;1;36m";
+        case CellStyle::Error: return "\x1b[0;1;31m";
+        case CellStyle::Good: return "\x1b[0;32m";
+        case CellStyle::Inverse: return "\x1b[0;7m";
+    }
+    return "\x1b[0m";
+}
+
+} // namespace
+
+TerminalScreen::TerminalScreen(int rows, int cols)
+    : rowCount(0), colCount(0), front(), back(), fullRedraw(true) {
+    resize(rows, cols);
+}
+
+void TerminalScreen::resize(int rows, int cols) {
+    rowCount = std::max(rows, 1);
+    colCount = std::max(cols, 1);
+    std::size_t cells = static_cast<std::size_t>(rowCount) * static_cast<std::size_t>(colCount);
+    front.assign(cells, Cell());
+    back.assign(cells, Cell());
+    fullRedraw = true;
+}
+
+void TerminalScreen::clear() {
+    std::fill(back.begin(), back.end(), Cell());
+}
+
+void TerminalScreen::put(int row, int col, const std::string& text, CellStyle style) {
+    if (row < 0 || row >= rowCount) {
+        return;
+    }
+    std::size_t base = static_cast<std::size_t>(row) * static_cast<std::size_t>(colCount);
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        int x = col + static_cast<int>(i);
+        if (x < 0) continue;
+        if (x >= colCount) break;
+        char ch = text[i];
+        if (ch < 32 || ch > 126) {
+            ch = '?';
+        }
+        back[base + static_cast<std::size_t>(x)] = Cell{ch, style};
+    }
+}
+
+void TerminalScreen::fill(int row, int col, int height, int width, CellStyle style) {
+    std::string blank(static_cast<std::size_t>(std::max(width, 0)), ' ');
+    for (int y = row; y < row + height; ++y) {
+        put(y, col, blank, style);
+    }
+}
+
+char TerminalScreen::at(int row, int col) const {
+    if (row < 0 || row >= rowCount || col < 0 || col >= colCount) {
+        return ' ';
+    }
+    return back[static_cast<std::size_t>(row) * static_cast<std::size_t>(colCount) + static_cast<std::size_t>(col)].ch;
+}
+
+/**
+ * @brief Emits, per row, one cursor move and the span between the first and
+ * last changed cell
+ * @details Rewriting the few unchanged cells inside a span is cheaper than a
+ * cursor move for each changed run. Style changes are only emitted where the
+ * style differs from the previous cell written.
+ */
+std::string TerminalScreen::flush() {
+    std::string out;
+    if (fullRedraw) {
+        out += "\x1b[0m\x1b[2J";
+    }
+    bool styled = false;
+    CellStyle current = CellStyle::Normal;
+    for (int row = 0; row < rowCount; ++row) {
+        std::size_t base = static_cast<std::size_t>(row) * static_cast<std::size_t>(colCount);
+        int first = -1;
+        int last = -1;
+        for (int col = 0; col < colCount; ++col) {
+            std::size_t index = base + static_cast<std::size_t>(col);
+            // After a clear the terminal is blank, so only non-blank cells need writing
+            bool changed = fullRedraw ? back[index] != Cell() : back[index] != front[index];
+            if (changed) {
+                if (first < 0) first = col;
+                last = col;
+            }
+        }
+        if (first < 0) {
+            continue;
+        }
+        out += "\x1b[" + std::to_string(row + 1) + ";" + std::to_string(first + 1) + "H";
+        for (int col = first; col <= last; ++col) {
+            const Cell& cell = back[base + static_cast<std::size_t>(col)];
+            if (!styled || cell.style != current) {
+                out += styleSequence(cell.style);
+                current = cell.style;
+                styled = true;
+            }
+            out += cell.ch;
+        }
+    }
+    if (styled && current != CellStyle::Normal) {
+        out += "\x1b[0m";
+    }
+    front = back;
+    fullRedraw = false;
+    return out;
+}
+
+void decodeTerminalKeys(const std::string& bytes, std::vector<TerminalKey>& keys) {
+    using Kind = TerminalKey::Kind;
+    std::size_t i = 0;
+    while (i < bytes.size()) {
+        unsigned char ch = static_cast<unsigned char>(bytes[i]);
+        if (ch == 0x1b) {
+            if (i + 1 >= bytes.size()) {
+                keys.push_back(TerminalKey{Kind::Escape, 0});
+                ++i;
+                continue;
+            }
+            if (bytes[i + 1] != '[' && bytes[i + 1] != 'O') {
+                keys.push_back(TerminalKey{Kind::Escape, 0});
+                ++i;
+                continue;
+            }
+            // CSI/SS3 sequence: parameters, then a final byte in '@'..'~'
+            std::size_t end = i + 2;
+            while (end < bytes.size() && (bytes[end] < '@' || bytes[end] > '~')) {
+                ++end;
+            }
+            if (end >= bytes.size()) {
+                return;  // Truncated sequence
+            }
+            std::string params = bytes.substr(i + 2, end - i - 2);
+            char final = bytes[end];
+            if (final == 'A') {
+                keys.push_back(TerminalKey{Kind::Up, 0});
+            } else if (final == 'B') {
+                keys.push_back(TerminalKey{Kind::Down, 0});
+            } else if (final == '~' && params == "5") {
+                keys.push_back(TerminalKey{Kind::PageUp, 0});
+            } else if (final == '~' && params == "6") {
+                keys.push_back(TerminalKey{Kind::PageDown, 0});
+            }
+            i = end + 1;
+            continue;
+        }
+        if (ch == '\r' || ch == '\n') {
+            keys.push_back(TerminalKey{Kind::Enter, 0});
+            // Treat CR LF as one Enter
+            if (ch == '\r' && i + 1 < bytes.size() && bytes[i + 1] == '\n') {
+                ++i;
+            }
+        } else if (ch == 0x7f || ch == 0x08) {
+            keys.push_back(TerminalKey{Kind::Backspace, 0});
+        } else if (ch == '\t') {
+            keys.push_back(TerminalKey{Kind::Tab, 0});
+        } else if (ch == 0x03 || ch == 0x04) {
+            keys.push_back(TerminalKey{Kind::Interrupt, 0});
+        } else if (ch >= 32 && ch < 127) {
+            keys.push_back(TerminalKey{Kind::Char, static_cast<char>(ch)});
+        }
+        ++i;
+    }
+}
+
+} // namespace coup
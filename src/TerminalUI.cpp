@@ -0,0 +1,565 @@
+//meirshuker159@gmail.com
+
+#include "TerminalUI.hpp"
+#include "ActionValidator.hpp"
+#include "Exceptions.hpp"
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief Turns console logging off before the game is handed to the engine
+ * @details Log lines written to stdout or stderr would scroll the screen.
+ */
+std::shared_ptr<Game> silenced(std::shared_ptr<Game> game) {
+    game->set_verbose(false);
+    return game;
+}
+
+/**
+ * @brief Writes all of a buffer to a file descriptor
+ */
+void writeAll(int fd, const std::string& data) {
+    std::size_t done = 0;
+    while (done < data.size()) {
+        ssize_t written = ::write(fd, data.data() + done, data.size() - done);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        done += static_cast<std::size_t>(written);
+    }
+}
+
+/**
+ * @brief Puts the terminal in raw mode on the alternate screen for its lifetime
+ */
+class TerminalSession {
+public:
+    TerminalSession() : saved() {
+        if (!::isatty(STDIN_FILENO) || !::isatty(STDOUT_FILENO)) {
+            throw GameException("coup-tui must be run in a terminal");
+        }
+        ::tcgetattr(STDIN_FILENO, &saved);
+        termios raw = saved;
+        raw.c_iflag &= static_cast<tcflag_t>(~(BRKINT | ICRNL | INPCK | ISTRIP | IXON));
+        raw.c_oflag &= static_cast<tcflag_t>(~OPOST);
+        raw.c_lflag &= static_cast<tcflag_t>(~(ECHO | ICANON | IEXTEN | ISIG));
+        raw.c_cflag |= CS8;
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        ::tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+        // Alternate screen, hidden cursor
+        writeAll(STDOUT_FILENO, "\x1b[?1049h\x1b[?25l");
+    }
+
+    ~TerminalSession() {
+        writeAll(STDOUT_FILENO, "\x1b[0m\x1b[?25h\x1b[?1049l");
+        ::tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved);
+    }
+
+    TerminalSession(const TerminalSession&) = delete;
+    TerminalSession& operator=(const TerminalSession&) = delete;
+
+    /**
+     * @brief Gets the terminal size, falling back to 24x80
+     */
+    static void size(int& rows, int& cols) {
+        winsize ws{};
+        if (::ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+            rows = ws.ws_row;
+            cols = ws.ws_col;
+        } else {
+            rows = 24;
+            cols = 80;
+        }
+    }
+
+private:
+    termios saved; ///< Settings restored on exit
+};
+
+/**
+ * @brief Cuts text to a width, marking the cut with '~'
+ */
+std::string fit(const std::string& text, int width) {
+    if (width <= 0) return "";
+    if (static_cast<int>(text.size()) <= width) return text;
+    return text.substr(0, static_cast<std::size_t>(width - 1)) + "~";
+}
+
+} // namespace
+
+TerminalUI::TerminalUI(std::shared_ptr<Game> game) :
+    engine(silenced(game), "coup_game.rec"),
+    view(&engine.snapshot()),
+    screen(MIN_ROWS, MIN_COLS),
+    quit(false),
+    actionNames(),
+    currentInput(""),
+    isSelectingTarget(false),
+    pendingAction(ActionType::Gather),
+    message(""),
+    messageTime(),
+    actionHistory(ActionHistory::DEFAULT_CAPACITY, "coup_history.log"),
+    historyScroll(0),
+    namedSeats(0),
+    lastVersion(0),
+    lastMessageCount(0),
+    lastEliminationCount(0),
+    lastBotThinking(false),
+    eliminatedPlayerName(""),
+    eliminationTime(),
+    showEliminationPopup(false),
+    winnerName("") {
+    createMenu();
+}
+
+/**
+ * @brief Waits for input with a short timeout so engine updates still show
+ * @details A frame is built only when something changed, and flush() sends
+ * only the changed cells, so an idle game produces no output at all.
+ */
+void TerminalUI::run() {
+    TerminalSession session;
+    int rows = 0;
+    int cols = 0;
+    TerminalSession::size(rows, cols);
+    screen.resize(rows, cols);
+    bool dirty = true;
+    std::vector<TerminalKey> keys;
+    char buffer[256];
+
+    while (!quit) {
+        dirty = update() || dirty;
+        TerminalSession::size(rows, cols);
+        if (rows != screen.rows() || cols != screen.cols()) {
+            screen.resize(rows, cols);
+            dirty = true;
+        }
+        if (dirty) {
+            render();
+            writeAll(STDOUT_FILENO, screen.flush());
+            dirty = false;
+        }
+
+        pollfd input{STDIN_FILENO, POLLIN, 0};
+        if (::poll(&input, 1, 50) <= 0) {
+            continue;
+        }
+        ssize_t count = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (count == 0 || (count < 0 && errno != EINTR && errno != EAGAIN)) {
+            break;  // Terminal went away (e.g. the SSH session closed)
+        }
+        keys.clear();
+        decodeTerminalKeys(std::string(buffer, count > 0 ? static_cast<std::size_t>(count) : 0), keys);
+        for (const TerminalKey& key : keys) {
+            handleKey(key);
+        }
+        dirty = !keys.empty();
+    }
+}
+
+bool TerminalUI::update() {
+    view = &engine.snapshot();
+    bool changed = drainEngineEvents();
+
+    if (view->version != lastVersion) {
+        lastVersion = view->version;
+        createMenu();
+        if (view->phase != GamePhase::Playing) {
+            isSelectingTarget = false;
+        }
+        changed = true;
+    }
+    if (view->botThinking != lastBotThinking) {
+        lastBotThinking = view->botThinking;
+        changed = true;
+    }
+    if (view->messageCount != lastMessageCount) {
+        lastMessageCount = view->messageCount;
+        showMessage(view->message);
+        changed = true;
+    }
+    if (view->eliminationCount != lastEliminationCount && view->eliminatedSeat < view->playerCount) {
+        lastEliminationCount = view->eliminationCount;
+        eliminatedPlayerName = view->players[view->eliminatedSeat].name;
+        showEliminationPopup = true;
+        eliminationTime = Clock::now();
+        changed = true;
+    }
+    if (view->phase == GamePhase::GameOver && winnerName.empty() && view->winnerSeat < view->playerCount) {
+        winnerName = view->players[view->winnerSeat].name;
+        changed = true;
+    }
+    return expireTimers() || changed;
+}
+
+bool TerminalUI::drainEngineEvents() {
+    while (namedSeats < view->playerCount) {
+        actionHistory.setSeatName(namedSeats, view->players[namedSeats].name);
+        namedSeats++;
+    }
+    bool any = false;
+    ActionRecord record;
+    while (engine.pollEvent(record)) {
+        actionHistory.push(record);
+        if (historyScroll > 0) {
+            scrollHistory(1);
+        }
+        any = true;
+    }
+    return any;
+}
+
+void TerminalUI::showMessage(const std::string& text) {
+    message = text;
+    messageTime = Clock::now();
+}
+
+bool TerminalUI::expireTimers() {
+    Clock::time_point now = Clock::now();
+    std::chrono::seconds timeout(MESSAGE_SECONDS);
+    bool changed = false;
+    if (!message.empty() && now - messageTime >= timeout) {
+        message.clear();
+        changed = true;
+    }
+    if (showEliminationPopup && now - eliminationTime >= timeout) {
+        showEliminationPopup = false;
+        changed = true;
+    }
+    return changed;
+}
+
+/**
+ * @brief Builds the same per-role action list as the GUI's buttons
+ */
+void TerminalUI::createMenu() {
+    const PlayerView* currentPlayer = view->currentSeat < view->playerCount ? &view->players[view->currentSeat] : nullptr;
+    if (currentPlayer && std::string(currentPlayer->role) == "Spy") {
+        actionNames = {"Gather", "Tax", "Bribe", "Arrest", "Sanction", "Coup", "Investigate", "Block Arrest", "End Turn"};
+    } else if (currentPlayer && std::string(currentPlayer->role) == "Baron") {
+        actionNames = {"Gather", "Tax", "Bribe", "Arrest", "Sanction", "Coup", "Invest", "End Turn"};
+    } else {
+        actionNames = {"Gather", "Tax", "Bribe", "Arrest", "Sanction", "Coup", "End Turn"};
+    }
+}
+
+void TerminalUI::handleKey(const TerminalKey& key) {
+    using Kind = TerminalKey::Kind;
+    if (key.kind == Kind::Interrupt) {
+        quit = true;
+        return;
+    }
+    if (isSetupPhase()) {
+        handleSetupKey(key);
+        return;
+    }
+    if (view->phase == GamePhase::GameOver) {
+        if (key.kind == Kind::Escape || key.kind == Kind::Enter || (key.kind == Kind::Char && key.ch == 'q')) {
+            quit = true;
+        }
+        return;
+    }
+    switch (key.kind) {
+        case Kind::PageUp: scrollHistory(static_cast<int>(historyLines())); return;
+        case Kind::PageDown: scrollHistory(-static_cast<int>(historyLines())); return;
+        case Kind::Up: scrollHistory(1); return;
+        case Kind::Down: scrollHistory(-1); return;
+        case Kind::Escape: isSelectingTarget = false; return;
+        default: break;
+    }
+    if (key.kind != Kind::Char) {
+        return;
+    }
+    if (key.ch == 'q') {
+        quit = true;
+    } else if (key.ch == 'c' && view->phase == GamePhase::BlockPending && !humanBlockers().empty()) {
+        engine.pass();  // The engine waits for any bot that may still block
+    } else if (key.ch >= '1' && key.ch <= '9') {
+        handleChoice(key.ch - '0');
+    }
+}
+
+void TerminalUI::handleSetupKey(const TerminalKey& key) {
+    using Kind = TerminalKey::Kind;
+    if (key.kind == Kind::Escape) {
+        quit = true;
+    } else if (key.kind == Kind::Tab) {
+        engine.addBot("Bot " + std::to_string(view->playerCount + 1));
+    } else if (key.kind == Kind::Backspace && !currentInput.empty()) {
+        currentInput.pop_back();
+    } else if (key.kind == Kind::Enter) {
+        if (currentInput.empty()) {
+            engine.startGame();
+        } else {
+            // Name validation and the 6-player auto start happen in the engine
+            engine.addPlayer(currentInput);
+            currentInput.clear();
+        }
+    } else if (key.kind == Kind::Char && currentInput.size() < 31) {
+        currentInput += key.ch;
+    }
+}
+
+/**
+ * @brief Maps a digit to a blocker, a target or an action, in that priority
+ * @details Mirrors GUI::handleClick: during a block phase only block decisions
+ * are accepted, and nothing is accepted on a bot's turn.
+ */
+void TerminalUI::handleChoice(int choice) {
+    std::size_t index = static_cast<std::size_t>(choice - 1);
+    if (view->phase == GamePhase::BlockPending) {
+        std::vector<std::uint8_t> blockers = humanBlockers();
+        if (index < blockers.size()) {
+            engine.block(blockers[index]);
+        }
+        return;
+    }
+    if (view->phase != GamePhase::Playing) return;
+    if (view->currentSeat >= view->playerCount) return;
+    if (view->isBot(view->currentSeat)) return;  // Bots play their own turns
+
+    if (isSelectingTarget) {
+        isSelectingTarget = false;
+        if (index < view->playerCount) {
+            // The engine validates the target and starts a block phase if needed
+            engine.action(pendingAction, static_cast<std::uint8_t>(index));
+        }
+        return;
+    }
+
+    if (index >= actionNames.size()) {
+        return;
+    }
+    const std::string& action = actionNames[index];
+    ActionType type;
+    if (!parseActionType(action, type)) {
+        return;
+    }
+    if (!ActionValidator::requiresTarget(action)) {
+        engine.action(type);
+        return;
+    }
+    if (!view->isAvailable(type)) {
+        showMessage("Action not available");
+        return;
+    }
+    isSelectingTarget = true;
+    pendingAction = type;
+}
+
+std::vector<std::uint8_t> TerminalUI::humanBlockers() const {
+    std::vector<std::uint8_t> result;
+    for (std::size_t i = 0; i < view->blockerCount; ++i) {
+        if (!view->isBot(view->blockers[i])) {
+            result.push_back(view->blockers[i]);
+        }
+    }
+    return result;
+}
+
+std::size_t TerminalUI::historyLines() const {
+    // Panel runs from row 3 down to above the message line
+    int lines = screen.rows() - 9;
+    return lines > 0 ? static_cast<std::size_t>(lines) : 1;
+}
+
+void TerminalUI::scrollHistory(int lines) {
+    std::size_t visible = historyLines();
+    std::size_t maxScroll = actionHistory.size() > visible ? actionHistory.size() - visible : 0;
+    if (lines < 0) {
+        std::size_t back = static_cast<std::size_t>(-lines);
+        historyScroll = historyScroll > back ? historyScroll - back : 0;
+    } else {
+        historyScroll = std::min(historyScroll + static_cast<std::size_t>(lines), maxScroll);
+    }
+}
+
+/**
+ * @brief Layout: status line on top, players and block decisions on the
+ * left, history on the right, message, menu and key help at the bottom
+ */
+void TerminalUI::render() {
+    screen.clear();
+    if (screen.rows() < MIN_ROWS || screen.cols() < MIN_COLS) {
+        screen.put(0, 0, fit("Terminal too small: need " + std::to_string(MIN_COLS) + "x" +
+                             std::to_string(MIN_ROWS), screen.cols()), CellStyle::Error);
+        return;
+    }
+    screen.put(0, 1, "COUP", CellStyle::Title);
+    if (isSetupPhase()) {
+        renderSetup();
+    } else {
+        screen.put(0, 8, "Treasury: " + std::to_string(view->treasury) + " coins", CellStyle::Highlight);
+        const PlayerView* currentPlayer = view->currentSeat < view->playerCount ? &view->players[view->currentSeat] : nullptr;
+        if (currentPlayer) {
+            std::string turn = "Current Turn: " + std::string(currentPlayer->name);
+            if (view->isBot(view->currentSeat)) {
+                // A bot's role stays hidden like every other player's
+                turn += std::string(" [BOT]") + (view->botThinking ? " thinking..." : "");
+            } else {
+                turn += " [" + std::string(currentPlayer->role) + "] (" + std::to_string(currentPlayer->coins) + " coins)";
+            }
+            screen.put(0, 30, fit(turn, screen.cols() - 31), CellStyle::Bold);
+        }
+        screen.put(1, 0, std::string(static_cast<std::size_t>(screen.cols()), '-'), CellStyle::Dim);
+        renderPlayers();
+        if (view->phase == GamePhase::BlockPending) {
+            renderBlockPhase(static_cast<int>(MAX_SEATS) + 3);
+        }
+        renderHistory();
+        renderMenu();
+    }
+    if (!message.empty()) {
+        screen.put(screen.rows() - 6, 1, fit(message, screen.cols() - 2), CellStyle::Error);
+    }
+    renderPopups();
+}
+
+void TerminalUI::renderSetup() {
+    int count = view->playerCount;
+    for (int i = 0; i < count; ++i) {
+        screen.put(2 + i, 1, std::to_string(i + 1) + ". " + view->players[i].name +
+                   (view->isBot(static_cast<std::uint8_t>(i)) ? " [BOT]" : ""));
+    }
+    std::string prompt;
+    if (count == 0) {
+        prompt = "Enter player name (press Enter to add, Tab adds a bot):";
+    } else if (count < 2) {
+        prompt = "Need at least " + std::to_string(2 - count) + " more players to start. Enter player name:";
+    } else {
+        prompt = "Press Enter on an empty name to start, or enter more names (max 6)";
+    }
+    int row = screen.rows() / 2;
+    screen.put(row - 1, 4, fit(prompt, screen.cols() - 5));
+    screen.fill(row, 4, 1, 34, CellStyle::Inverse);
+    screen.put(row, 5, currentInput + "_", CellStyle::Inverse);
+    screen.put(screen.rows() - 1, 1, "Enter: add / start   Tab: add bot   Esc: quit", CellStyle::Dim);
+}
+
+void TerminalUI::renderPlayers() {
+    for (std::size_t i = 0; i < view->playerCount; ++i) {
+        const PlayerView& player = view->players[i];
+        std::uint8_t seat = static_cast<std::uint8_t>(i);
+        std::string info = "[" + std::to_string(i + 1) + "] " + player.name;
+        CellStyle style = i == view->currentSeat ? CellStyle::Highlight : CellStyle::Normal;
+        if (!player.active) {
+            info += " [ELIMINATED]";
+            style = CellStyle::Dim;
+        } else {
+            if (view->isBot(seat)) {
+                info += " [BOT]";
+            }
+            if (i == view->currentSeat && !view->isBot(seat)) {
+                info += " [" + std::string(player.role) + "] (" + std::to_string(player.coins) + " coins)";
+            } else {
+                info += " [Hidden]";
+            }
+            if (player.sanctioned) {
+                info += " [SANCTIONED]";
+            }
+            if (player.arrestBlocked) {
+                info += " [ARREST BLOCKED]";
+            }
+        }
+        screen.put(2 + static_cast<int>(i), 1, fit(info, screen.cols() / 2 - 2), style);
+    }
+}
+
+void TerminalUI::renderBlockPhase(int row) {
+    int width = screen.cols() / 2 - 2;
+    std::string actor = view->pendingActor < view->playerCount ? view->players[view->pendingActor].name : "?";
+    screen.put(row++, 1, fit("Block " + actor + "'s " + actionTypeName(view->pendingAction) + "?", width),
+               CellStyle::Bold);
+    // Only humans are listed; bots send their block decisions themselves
+    std::vector<std::uint8_t> blockers = humanBlockers();
+    for (std::size_t i = 0; i < blockers.size(); ++i) {
+        screen.put(row++, 3, fit("[" + std::to_string(i + 1) + "] Block: " + view->players[blockers[i]].name, width - 2),
+                   CellStyle::Error);
+    }
+    if (!blockers.empty()) {
+        screen.put(row++, 3, "[c] Continue", CellStyle::Good);
+    }
+    if (view->botThinking) {
+        screen.put(row, 1, fit("Bots are deciding whether to block...", width), CellStyle::Dim);
+    }
+}
+
+void TerminalUI::renderHistory() {
+    int left = screen.cols() / 2;
+    int width = screen.cols() - left - 1;
+    std::string title = "Action History (" + std::to_string(actionHistory.totalRecorded()) + ")";
+    if (historyScroll > 0) {
+        title += " -" + std::to_string(historyScroll);
+    }
+    screen.put(2, left, fit(title, width), CellStyle::Title);
+
+    std::size_t visible = historyLines();
+    std::size_t available = actionHistory.size() > historyScroll ? actionHistory.size() - historyScroll : 0;
+    std::size_t shown = std::min(available, visible);
+    for (std::size_t i = 0; i < shown; ++i) {
+        // Oldest visible line at the top, newest at the bottom
+        std::size_t fromNewest = historyScroll + (shown - 1 - i);
+        screen.put(3 + static_cast<int>(i), left,
+                   fit(actionHistory.format(actionHistory.fromNewest(fromNewest)), width));
+    }
+}
+
+void TerminalUI::renderMenu() {
+    int row = screen.rows() - 4;
+    screen.put(row - 1, 0, std::string(static_cast<std::size_t>(screen.cols()), '-'), CellStyle::Dim);
+    bool botTurn = view->currentSeat < view->playerCount && view->isBot(view->currentSeat);
+    int col = 1;
+    for (std::size_t i = 0; i < actionNames.size(); ++i) {
+        std::string label = "[" + std::to_string(i + 1) + "] " + actionNames[i];
+        ActionType type;
+        bool available = view->phase == GamePhase::Playing && !botTurn &&
+                         parseActionType(actionNames[i], type) && view->isAvailable(type);
+        if (col + static_cast<int>(label.size()) >= screen.cols()) {
+            row++;
+            col = 1;
+        }
+        screen.put(row, col, label, available ? CellStyle::Normal : CellStyle::Dim);
+        col += static_cast<int>(label.size()) + 2;
+    }
+
+    std::string help;
+    if (isSelectingTarget) {
+        help = pendingAction == ActionType::Investigate ? "Select a player to investigate (1-6, Esc cancels)"
+             : pendingAction == ActionType::BlockArrest ? "Select a player to block their arrest ability (1-6, Esc cancels)"
+             : "Select a target player (1-6, Esc cancels)";
+        screen.put(screen.rows() - 1, 1, fit(help, screen.cols() - 2), CellStyle::Highlight);
+    } else {
+        help = "1-9: choose   PgUp/PgDn: history   q: quit";
+        screen.put(screen.rows() - 1, 1, fit(help, screen.cols() - 2), CellStyle::Dim);
+    }
+}
+
+void TerminalUI::renderPopups() {
+    int width = 40;
+    int left = (screen.cols() - width) / 2;
+    if (!winnerName.empty()) {
+        int top = screen.rows() / 2 - 3;
+        screen.fill(top, left, 6, width, CellStyle::Inverse);
+        screen.put(top + 1, left + 2, "GAME OVER!", CellStyle::Inverse);
+        screen.put(top + 3, left + 2, fit("Winner: " + winnerName, width - 4), CellStyle::Inverse);
+        screen.put(top + 4, left + 2, "Press q to quit", CellStyle::Inverse);
+    } else if (showEliminationPopup) {
+        int top = 4;
+        screen.fill(top, left, 4, width, CellStyle::Inverse);
+        screen.put(top + 1, left + 2, "ELIMINATED!", CellStyle::Inverse);
+        screen.put(top + 2, left + 2, fit(eliminatedPlayerName + " has been eliminated!", width - 4),
+                   CellStyle::Inverse);
+    }
+}
+
+} // namespace coup
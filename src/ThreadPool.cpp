@@ -0,0 +1,98 @@
+//meirshuker159@gmail.com
+
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <exception>
+#include <mutex>
+
+namespace coup {
+
+ThreadPool::ThreadPool(std::size_t threads) : workers(), jobs(), mutex(), available(), stopping(false) {
+    if (threads == 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        threads = std::max(hardware, 2u) - 1;
+    }
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    available.notify_one();
+}
+
+void ThreadPool::run() {
+    trace::setThreadName("pool");
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        try {
+            job();
+        } catch (...) {
+            // A failed job must not take the worker down with it
+        }
+    }
+}
+
+unsigned workerCount(unsigned requested, std::uint64_t work) {
+    unsigned threads = requested == 0 ? std::max(1u, std::thread::hardware_concurrency()) : requested;
+    return static_cast<unsigned>(std::min<std::uint64_t>(threads, std::max<std::uint64_t>(1, work)));
+}
+
+void runOnThreads(unsigned threads, const std::function<void(unsigned)>& body) {
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+    auto guarded = [&body, &failureMutex, &failure](unsigned slot) {
+        try {
+            body(slot);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads > 0 ? threads - 1 : 0);
+    for (unsigned slot = 1; slot < threads; ++slot) {
+        workers.emplace_back([&guarded, slot]() {
+            trace::setThreadName("worker");
+            guarded(slot);
+        });
+    }
+    guarded(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+} // namespace coup
@@ -0,0 +1,256 @@
+//meirshuker159@gmail.com
+
+#include "Tournament.hpp"
+#include "Exceptions.hpp"
+#include "GameController.hpp"
+#include "GameRecord.hpp"
+#include "SimStats.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace coup {
+
+namespace {
+
+/**
+ * @brief Expected score of a player that is elo stronger
+ */
+double expectedScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+/**
+ * @brief Elo difference that gives an expected score
+ */
+double eloFromScore(double score) {
+    if (score <= 0.0) return -1000.0;
+    if (score >= 1.0) return 1000.0;
+    return std::max(-1000.0, std::min(1000.0, -400.0 * std::log10(1.0 / score - 1.0)));
+}
+
+/**
+ * @brief Checks whether a move is one the current player may make right now
+ */
+bool isLegalAction(const GameController& controller, const RecordedMove& move) {
+    if (move.kind != RecordedMove::Kind::Action) {
+        return false;
+    }
+    std::array<Move, MAX_MOVES> moves;
+    std::size_t count = controller.legalMoves(moves);
+    return std::any_of(moves.begin(), moves.begin() + count, [&move](const Move& legal) {
+        return legal.action == move.action && legal.target == move.seat;
+    });
+}
+
+/**
+ * @brief Win/draw/loss counts of one thread, padded against false sharing
+ */
+struct alignas(64) MatchCounts {
+    std::uint64_t wins = 0;
+    std::uint64_t draws = 0;
+    std::uint64_t losses = 0;
+};
+
+} // namespace
+
+std::uint8_t playBotGame(const GameRecord& deal, const std::vector<Bot*>& players, std::uint32_t stepLimit,
+                         std::vector<std::uint32_t>* eliminations, const DecisionHook& onDecision) {
+    if (players.size() != deal.seats.size()) {
+        throw GameException("Every seat needs a bot");
+    }
+    auto game = deal.createGame();
+    game->set_verbose(false);
+    GameController controller(game);
+    if (eliminations) {
+        eliminations->assign(players.size(), 0);
+        std::uint32_t out = 0;
+        // Coups are the only way out of the game
+        controller.setEventSink([eliminations, &out](const ActionRecord& event) {
+            if (event.type == ActionType::Coup && event.target < eliminations->size()) {
+                (*eliminations)[event.target] = ++out;
+            }
+        });
+    }
+    controller.startGame();
+    // No deadline: capped bots stop on their playout limit instead
+    const Bot::Clock::time_point deadline = Bot::Clock::time_point::max();
+
+    for (std::uint32_t step = 0; step < stepLimit && controller.phase() != GamePhase::GameOver; ++step) {
+        RecordedMove move{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT};
+        if (controller.phase() == GamePhase::BlockPending) {
+            for (std::size_t i = 0; i < controller.pendingBlockerCount(); ++i) {
+                std::uint8_t seat = controller.pendingBlocker(i);
+                RecordedMove answer = players[seat]->decide(BotPosition::capture(controller, seat), deadline);
+                if (onDecision) {
+                    onDecision(controller, seat, answer);
+                }
+                if (answer.kind == RecordedMove::Kind::Block) {
+                    move = RecordedMove{RecordedMove::Kind::Block, ActionType::Gather, seat};
+                    break;
+                }
+            }
+        } else {
+            std::uint8_t seat = controller.seatOf(controller.get_game()->get_current_player().get());
+            move = players[seat]->decide(BotPosition::capture(controller, seat), deadline);
+            if (onDecision && isLegalAction(controller, move)) {
+                onDecision(controller, seat, move);
+            }
+        }
+        try {
+            GameRecord::play(controller, move);
+        } catch (const std::exception&) {
+            // A rejected move leaves the position unchanged; the step still counts
+        }
+    }
+    return controller.phase() == GamePhase::GameOver ? controller.winner() : NO_SEAT;
+}
+
+std::vector<std::uint32_t> finishingPlaces(const std::vector<std::uint32_t>& eliminations) {
+    // A seat's place is the number of seats that lasted longer
+    std::vector<std::uint32_t> places;
+    for (std::uint32_t out : eliminations) {
+        std::uint32_t place = 0;
+        for (std::uint32_t other : eliminations) {
+            place += out != 0 && (other == 0 || other > out) ? 1 : 0;
+        }
+        places.push_back(place);
+    }
+    return places;
+}
+
+void checkMatchBot(const std::string& type) {
+    createBot(type, 0);  // Throws for unknown types
+    if (type == "montecarlo") {
+        // Decisions have no deadline here, so an uncapped search would never return
+        throw GameException("Match bots must be capped, e.g. montecarlo:32");
+    }
+}
+
+const char* sprtDecisionName(SprtDecision decision) {
+    switch (decision) {
+        case SprtDecision::Continue: return "continue";
+        case SprtDecision::AcceptH0: return "H0";
+        case SprtDecision::AcceptH1: return "H1";
+    }
+    return "?";
+}
+
+SprtTest::SprtTest(double elo0, double elo1, double alpha, double beta)
+    : score0(expectedScore(elo0)), score1(expectedScore(elo1)), lower(0.0), upper(0.0),
+      winCount(0), drawCount(0), lossCount(0) {
+    if (!(alpha > 0.0 && alpha < 0.5) || !(beta > 0.0 && beta < 0.5)) {
+        throw GameException("SPRT alpha and beta must be between 0 and 0.5");
+    }
+    if (!(std::fabs(elo1 - elo0) > 0.0) || std::fabs(elo0) > 1000.0 || std::fabs(elo1) > 1000.0) {
+        throw GameException("SPRT elo0 and elo1 must differ and lie within +-1000");
+    }
+    lower = std::log(beta / (1.0 - alpha));
+    upper = std::log((1.0 - beta) / alpha);
+}
+
+void SprtTest::add(std::uint64_t wins, std::uint64_t draws, std::uint64_t losses) {
+    winCount += wins;
+    drawCount += draws;
+    lossCount += losses;
+}
+
+double SprtTest::llr() const {
+    double won = static_cast<double>(winCount) + static_cast<double>(drawCount) / 2.0;
+    double lost = static_cast<double>(lossCount) + static_cast<double>(drawCount) / 2.0;
+    return won * std::log(score1 / score0) + lost * std::log((1.0 - score1) / (1.0 - score0));
+}
+
+SprtDecision SprtTest::decision() const {
+    double ratio = llr();
+    if (ratio >= upper) return SprtDecision::AcceptH1;
+    if (ratio <= lower) return SprtDecision::AcceptH0;
+    return SprtDecision::Continue;
+}
+
+double SprtTest::eloEstimate(double& low, double& high) const {
+    std::uint64_t n = games();
+    if (n == 0) {
+        low = -1000.0;
+        high = 1000.0;
+        return 0.0;
+    }
+    double count = static_cast<double>(n);
+    double score = (static_cast<double>(winCount) + static_cast<double>(drawCount) / 2.0) / count;
+    double squares = (static_cast<double>(winCount) + static_cast<double>(drawCount) / 4.0) / count;
+    double margin = 1.96 * std::sqrt(std::max(0.0, squares - score * score) / count);
+    low = eloFromScore(score - margin);
+    high = eloFromScore(score + margin);
+    return eloFromScore(score);
+}
+
+void playMatchPair(const TournamentConfig& config, std::uint64_t index,
+                   std::uint64_t& wins, std::uint64_t& draws, std::uint64_t& losses) {
+    std::seed_seq seq{config.seed, static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32)};
+    std::mt19937 rng(seq);
+    std::uniform_int_distribution<std::size_t> deal(0, ROLE_COUNT - 1);
+    GameRecord record;
+    record.rules = config.rules;
+    for (int seat = 0; seat < 2; ++seat) {
+        record.seats.push_back(SeatRecord{"P" + std::to_string(seat + 1), roleName(deal(rng))});
+    }
+    std::uint32_t candidateSeed = rng();
+    std::uint32_t baselineSeed = rng();
+
+    for (std::uint8_t candidateSeat = 0; candidateSeat < 2; ++candidateSeat) {
+        // Fresh bots per game, seeded the same in both games of the pair
+        auto candidate = createBot(config.candidate, candidateSeed);
+        auto baseline = createBot(config.baseline, baselineSeed);
+        std::vector<Bot*> players = {candidate.get(), baseline.get()};
+        if (candidateSeat == 1) {
+            std::swap(players[0], players[1]);
+        }
+        std::uint8_t winner = playBotGame(record, players, config.stepLimit);
+        if (winner == NO_SEAT) {
+            draws++;
+        } else if (winner == candidateSeat) {
+            wins++;
+        } else {
+            losses++;
+        }
+    }
+}
+
+TournamentResult runTournament(const TournamentConfig& config) {
+    TournamentResult result{SprtTest(config.elo0, config.elo1, config.alpha, config.beta)};
+    checkMatchBot(config.candidate);  // Before any thread starts
+    checkMatchBot(config.baseline);
+    std::uint64_t batchPairs = std::max<std::uint32_t>(1, config.batchPairs);
+    std::uint64_t maxPairs = (config.maxGames + 1) / 2;
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t nextPair = 0;
+    while (nextPair < maxPairs && result.decision == SprtDecision::Continue) {
+        std::uint64_t batchEnd = std::min(nextPair + batchPairs, maxPairs);
+        std::atomic<std::uint64_t> next(nextPair);
+        std::vector<MatchCounts> counts(workerCount(config.threads, batchEnd - nextPair));
+        auto worker = [&config, &next, batchEnd](MatchCounts& mine) {
+            for (std::uint64_t pair = next.fetch_add(1, std::memory_order_relaxed); pair < batchEnd;
+                 pair = next.fetch_add(1, std::memory_order_relaxed)) {
+                playMatchPair(config, pair, mine.wins, mine.draws, mine.losses);
+            }
+        };
+        runOnThreads(static_cast<unsigned>(counts.size()), [&worker, &counts](unsigned slot) { worker(counts[slot]); });
+
+        for (const MatchCounts& mine : counts) {
+            result.sprt.add(mine.wins, mine.draws, mine.losses);
+        }
+        result.batches++;
+        result.decision = result.sprt.decision();
+        nextPair = batchEnd;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace coup
@@ -0,0 +1,274 @@
+//meirshuker159@gmail.com
+
+#include "Trace.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <vector>
+
+namespace coup {
+
+namespace trace {
+
+std::atomic<bool> recording{false};
+thread_local unsigned quietDepth = 0;
+
+} // namespace trace
+
+namespace {
+
+constexpr std::size_t SLOT_MASK = TRACE_SPANS_PER_THREAD - 1;
+static_assert((TRACE_SPANS_PER_THREAD & SLOT_MASK) == 0, "spans per thread must be a power of two");
+
+/**
+ * @brief One span in a ring buffer
+ * @details sequence is 2n+1 while span n is being written and 2n+2 once it
+ * is complete. Every field is atomic so a dump reading a slot the owner is
+ * rewriting is a detected retry, not a data race.
+ */
+struct TraceSlot {
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<const char*> category{nullptr};
+    std::atomic<std::uint64_t> start{0};
+    std::atomic<std::uint64_t> end{0};
+    std::atomic<std::uint32_t> thread{0};
+};
+
+/**
+ * @brief A thread's ring of spans
+ * @details Written by the thread holding it only; the thread id is stored
+ * per span because a buffer is handed to a new thread when its owner exits.
+ */
+struct TraceBuffer {
+    std::atomic<std::uint64_t> written{0}; ///< Spans ever written
+    std::uint32_t thread = 0; ///< Id of the thread holding the buffer
+    std::array<TraceSlot, TRACE_SPANS_PER_THREAD> slots;
+};
+
+/**
+ * @brief Every buffer, free or held, and the thread names
+ * @details The mutex guards claiming and handing back buffers, naming
+ * threads and dumping, never a recording.
+ */
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    std::vector<TraceBuffer*> idle; ///< Buffers of exited threads
+    std::vector<std::string> names; ///< Thread names, indexed by thread id - 1
+    std::atomic<std::uint64_t> startedNanos{0}; ///< Spans starting earlier are not dumped
+};
+
+TraceRegistry& registry() {
+    static TraceRegistry instance;
+    return instance;
+}
+
+/**
+ * @brief The calling thread's name and buffer
+ */
+struct ThreadTrace {
+    char name[32] = {};
+    TraceBuffer* buffer = nullptr;
+
+    ~ThreadTrace() {
+        if (!buffer) {
+            return;
+        }
+        TraceRegistry& all = registry();
+        std::lock_guard<std::mutex> lock(all.mutex);
+        all.idle.push_back(buffer);
+    }
+};
+
+thread_local ThreadTrace local;
+
+TraceBuffer& claimBuffer() {
+    TraceRegistry& all = registry();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    if (all.idle.empty()) {
+        all.buffers.push_back(std::make_unique<TraceBuffer>());
+        local.buffer = all.buffers.back().get();
+    } else {
+        local.buffer = all.idle.back();
+        all.idle.pop_back();
+    }
+    all.names.emplace_back(local.name[0] ? local.name : "thread " + std::to_string(all.names.size() + 1));
+    local.buffer->thread = static_cast<std::uint32_t>(all.names.size());
+    return *local.buffer;
+}
+
+/**
+ * @brief A span copied out of a ring buffer
+ */
+struct SpanCopy {
+    const char* name;
+    const char* category;
+    std::uint64_t start;
+    std::uint64_t end;
+    std::uint32_t thread;
+};
+
+/**
+ * @brief Copies the complete spans of a buffer that started at or after since
+ */
+void copySpans(const TraceBuffer& buffer, std::uint64_t since, std::vector<SpanCopy>& spans) {
+    std::uint64_t end = buffer.written.load(std::memory_order_acquire);
+    std::uint64_t begin = end > TRACE_SPANS_PER_THREAD ? end - TRACE_SPANS_PER_THREAD : 0;
+    for (std::uint64_t n = begin; n < end; ++n) {
+        const TraceSlot& slot = buffer.slots[n & SLOT_MASK];
+        std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * n + 2) {
+            continue;  // Overwritten since written was read
+        }
+        SpanCopy span{slot.name.load(std::memory_order_relaxed), slot.category.load(std::memory_order_relaxed),
+                      slot.start.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed),
+                      slot.thread.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence || span.start < since) {
+            continue;
+        }
+        spans.push_back(span);
+    }
+}
+
+/**
+ * @brief Writes a string as a JSON string literal
+ */
+void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (; *text; ++text) {
+        unsigned char c = static_cast<unsigned char>(*text);
+        if (c == '"' || c == '\\') {
+            out << '\\' << *text;
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        } else {
+            out << *text;
+        }
+    }
+    out << '"';
+}
+
+/**
+ * @brief Writes nanoseconds as microseconds with three decimals
+ */
+void writeMicros(std::ostream& out, std::uint64_t nanos) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%llu.%03llu", static_cast<unsigned long long>(nanos / 1000),
+                  static_cast<unsigned long long>(nanos % 1000));
+    out << text;
+}
+
+} // namespace
+
+void startTracing() {
+    registry().startedNanos.store(trace::clockNanos(), std::memory_order_relaxed);
+    trace::recording.store(true, std::memory_order_relaxed);
+}
+
+void stopTracing() {
+    trace::recording.store(false, std::memory_order_relaxed);
+}
+
+std::size_t writeTraceJson(std::ostream& out) {
+    TraceRegistry& all = registry();
+    std::uint64_t since = all.startedNanos.load(std::memory_order_relaxed);
+    std::vector<SpanCopy> spans;
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(all.mutex);
+        for (const auto& buffer : all.buffers) {
+            copySpans(*buffer, since, spans);
+        }
+        names = all.names;
+    }
+    // Parents before their children: by start, the longer span first on a tie
+    std::sort(spans.begin(), spans.end(), [](const SpanCopy& a, const SpanCopy& b) {
+        return a.start != b.start ? a.start < b.start : a.end > b.end;
+    });
+
+    long pid = static_cast<long>(::getpid());
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":\"coup\"}}";
+    std::vector<bool> seen(names.size() + 1, false);
+    for (const SpanCopy& span : spans) {
+        seen[span.thread] = true;
+    }
+    for (std::size_t thread = 1; thread < seen.size(); ++thread) {
+        if (!seen[thread]) {
+            continue;
+        }
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << thread
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, names[thread - 1].c_str());
+        out << "}}";
+    }
+    for (const SpanCopy& span : spans) {
+        out << ",\n{\"name\":";
+        writeJsonString(out, span.name);
+        out << ",\"cat\":";
+        writeJsonString(out, span.category);
+        out << ",\"ph\":\"X\",\"ts\":";
+        writeMicros(out, span.start - since);
+        out << ",\"dur\":";
+        writeMicros(out, span.end - span.start);
+        out << ",\"pid\":" << pid << ",\"tid\":" << span.thread << "}";
+    }
+    out << "\n]}\n";
+    return spans.size();
+}
+
+std::size_t writeTraceFile(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    std::size_t spans = writeTraceJson(out);
+    out.flush();
+    if (!out) {
+        throw GameException("Cannot write trace to " + path);
+    }
+    return spans;
+}
+
+namespace trace {
+
+void setThreadName(const char* name) {
+    std::strncpy(local.name, name, sizeof(local.name) - 1);
+    if (local.buffer) {
+        TraceRegistry& all = registry();
+        std::lock_guard<std::mutex> lock(all.mutex);
+        all.names[local.buffer->thread - 1] = local.name;
+    }
+}
+
+std::uint64_t clockNanos() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void record(const char* name, const char* category, std::uint64_t startNanos, std::uint64_t endNanos) {
+    TraceBuffer& buffer = local.buffer ? *local.buffer : claimBuffer();
+    std::uint64_t n = buffer.written.load(std::memory_order_relaxed);
+    TraceSlot& slot = buffer.slots[n & SLOT_MASK];
+    slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.start.store(startNanos, std::memory_order_relaxed);
+    slot.end.store(endNanos, std::memory_order_relaxed);
+    slot.thread.store(buffer.thread, std::memory_order_relaxed);
+    slot.sequence.store(2 * n + 2, std::memory_order_release);
+    buffer.written.store(n + 1, std::memory_order_release);
+}
+
+} // namespace trace
+
+} // namespace coup
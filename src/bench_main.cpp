@@ -0,0 +1,217 @@
+//meirshuker159@gmail.com
+
+
+#include "ActionHistory.hpp"
+#include "ActionValidator.hpp"
+#include "AllocTracker.hpp"
+#include "Bench.hpp"
+#include "Exceptions.hpp"
+#include "Game.hpp"
+#include "Roles.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Every allocation in this binary is counted, so a benchmark reports its allocations per call
+COUP_INSTALL_ALLOCATION_HOOK();
+
+namespace {
+
+/**
+ * @brief A started six-player table, one of each role, and states to start a benchmark from
+ */
+struct Table {
+    enum Seat : std::size_t { GOVERNOR, SPY, BARON, GENERAL, JUDGE, MERCHANT };
+
+    std::shared_ptr<coup::Game> game;
+    std::vector<std::shared_ptr<coup::Player>> players;
+
+    Table() : game(std::make_shared<coup::Game>()) {
+        game->set_verbose(false);
+        players = {std::make_shared<coup::Governor>(game, "Governor"), std::make_shared<coup::Spy>(game, "Spy"),
+                   std::make_shared<coup::Baron>(game, "Baron"), std::make_shared<coup::General>(game, "General"),
+                   std::make_shared<coup::Judge>(game, "Judge"), std::make_shared<coup::Merchant>(game, "Merchant")};
+        for (const auto& player : players) {
+            game->add_player(player);
+        }
+        game->start_game();
+    }
+
+    /**
+     * @brief Gets the opening state with another seat to move and a few coins everywhere
+     * @param seat Seat to move
+     * @param coins Coins of the seat to move; the others hold 2
+     */
+    coup::GameState turnOf(std::size_t seat, int coins) const {
+        coup::GameState state = game->capture_state();
+        state.current_turn = seat;
+        for (std::size_t i = 0; i < state.players.size(); ++i) {
+            state.players[i].coins = i == seat ? coins : 2;
+        }
+        return state;
+    }
+
+    /**
+     * @brief Makes a case that restores state before every call of op
+     */
+    template <typename Op>
+    coup::BenchCase fromState(const std::string& name, coup::GameState state, Op op) {
+        auto shared = std::make_shared<coup::GameState>(std::move(state));
+        std::shared_ptr<coup::Game> target = game;
+        return coup::BenchCase{name, [target, shared]() { target->restore_state(*shared); }, op, nullptr};
+    }
+};
+
+/**
+ * @brief Lists the benchmarks: player actions, turn changes, lookups and validation
+ */
+std::vector<coup::BenchCase> engineBenchmarks(Table& table) {
+    using Seat = Table::Seat;
+    auto& p = table.players;
+    coup::Player& governor = *p[Seat::GOVERNOR];
+    coup::Player& spy = *p[Seat::SPY];
+    auto& baron = static_cast<coup::Baron&>(*p[Seat::BARON]);
+    auto& spyRole = static_cast<coup::Spy&>(spy);
+    coup::Game& game = *table.game;
+
+    std::vector<coup::BenchCase> cases;
+    cases.push_back(table.fromState("Player::gather", table.turnOf(Seat::GOVERNOR, 0), [&]() { governor.gather(); }));
+    cases.push_back(table.fromState("Player::tax", table.turnOf(Seat::GOVERNOR, 0), [&]() { governor.tax(); }));
+    cases.push_back(table.fromState("Player::bribe", table.turnOf(Seat::GOVERNOR, 4), [&]() { governor.bribe(); }));
+    cases.push_back(table.fromState("Player::arrest", table.turnOf(Seat::GOVERNOR, 0),
+                                    [&]() { governor.arrest(spy); }));
+    cases.push_back(table.fromState("Player::sanction", table.turnOf(Seat::GOVERNOR, 3),
+                                    [&]() { governor.sanction(spy); }));
+    cases.push_back(table.fromState("Player::coup", table.turnOf(Seat::GOVERNOR, 7), [&]() { governor.coup(spy); }));
+    cases.push_back(table.fromState("Baron::invest", table.turnOf(Seat::BARON, 3), [&]() { baron.invest(); }));
+    cases.push_back(table.fromState("Spy::investigate", table.turnOf(Seat::SPY, 0),
+                                    [&]() { spyRole.investigate(governor); }));
+    cases.push_back(table.fromState("Game::next_turn", table.turnOf(Seat::GOVERNOR, 0), [&]() { game.next_turn(); }));
+
+    // Lookups and validation do not change the game; they run in a position where everything is legal
+    coup::GameState armed = table.turnOf(Seat::GOVERNOR, 7);
+    auto ready = [&table, armed]() { table.game->restore_state(armed); };
+    const std::string last = "Merchant";
+    cases.push_back({"Game::get_player_by_name", nullptr, [&game, last]() { game.get_player_by_name(last); }, ready});
+    std::shared_ptr<coup::Player> actor = p[Seat::GOVERNOR];
+    std::shared_ptr<coup::Player> target = p[Seat::SPY];
+    const std::string tax = coup::actionTypeName(coup::ActionType::Tax);
+    const std::string coup = coup::actionTypeName(coup::ActionType::Coup);
+    const std::string sanction = coup::actionTypeName(coup::ActionType::Sanction);
+    // An unknown name would time the reject path instead of the calls named here
+    if (!coup::ActionValidator::requiresTarget(coup) || coup::ActionValidator::getActionCost(sanction, actor) != 3) {
+        throw coup::GameException("ActionValidator benchmarks do not name real actions");
+    }
+    cases.push_back({"ActionValidator::isActionAvailable", nullptr,
+                     [actor, tax]() { coup::ActionValidator::isActionAvailable(tax, actor); }, ready});
+    cases.push_back({"ActionValidator::isActionAvailableForButton", nullptr,
+                     [actor, tax]() { coup::ActionValidator::isActionAvailableForButton(tax, actor); }, ready});
+    cases.push_back({"ActionValidator::validateActionExecution", nullptr,
+                     [actor, target, coup]() { coup::ActionValidator::validateActionExecution(coup, actor, target); },
+                     ready});
+    cases.push_back({"ActionValidator::getActionCost", nullptr,
+                     [actor, sanction]() { coup::ActionValidator::getActionCost(sanction, actor); }, ready});
+    cases.push_back({"ActionValidator::requiresTarget", nullptr,
+                     [sanction]() { coup::ActionValidator::requiresTarget(sanction); }, ready});
+    cases.push_back({"ActionValidator::getValidationResult", nullptr,
+                     [actor, target, coup]() { coup::ActionValidator::getValidationResult(coup, actor, target); },
+                     ready});
+    return cases;
+}
+
+void printUsage() {
+    std::cerr << "Usage: coup-bench [--filter TEXT] [--min-time SECONDS] [--warmup SECONDS] [--repetitions N]\n"
+              << "                  [--json FILE] [--check BASELINE] [--tolerance FRACTION]\n";
+}
+
+} // namespace
+
+/**
+ * @brief Entry point of the engine microbenchmarks (coup-bench)
+ * @return 0 on success, 1 on bad arguments or errors
+ * @details Times every player action, turn change, player lookup and
+ * ActionValidator entry point on a six-player table, prints ns, heap
+ * allocations and instructions per call, and optionally writes them as
+ * JSON for tracking over time. With --check it compares the results with a
+ * stored baseline and fails if any case regressed beyond its noise.
+ */
+int main(int argc, char* argv[]) {
+    coup::BenchConfig config;
+    config.allocations = []() { return coup::allocationTotals().allocations; };
+    std::string jsonPath;
+    std::string baselinePath;
+    double tolerance = 0.25;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--filter") {
+            config.filter = value;
+        } else if (arg == "--min-time") {
+            config.minSeconds = std::strtod(value, nullptr);
+        } else if (arg == "--warmup") {
+            config.warmupSeconds = std::strtod(value, nullptr);
+        } else if (arg == "--repetitions") {
+            config.repetitions = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--json") {
+            jsonPath = value;
+        } else if (arg == "--check") {
+            baselinePath = value;
+        } else if (arg == "--tolerance") {
+            tolerance = std::strtod(value, nullptr);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    try {
+        // Read the baseline first, so a bad path fails before the long run
+        std::vector<coup::BenchResult> baseline;
+        if (!baselinePath.empty()) {
+            std::ifstream in(baselinePath);
+            if (!in) {
+                throw coup::GameException("Cannot open baseline " + baselinePath);
+            }
+            baseline = coup::readBenchJson(in);
+        }
+        Table table;
+        std::vector<coup::BenchResult> results = coup::runBenchmarks(engineBenchmarks(table), config);
+        coup::writeBenchTable(std::cout, results);
+        if (!coup::InstructionCounter().available()) {
+            std::cout << "(instruction counts unavailable: perf_event_open was refused)\n";
+        }
+        if (!jsonPath.empty()) {
+            std::ofstream out(jsonPath, std::ios::trunc);
+            coup::writeBenchJson(out, results);
+            if (!out) {
+                std::cerr << "Error: cannot write " << jsonPath << std::endl;
+                return 1;
+            }
+        }
+        if (!baselinePath.empty()) {
+            std::vector<coup::BenchVerdict> verdicts = coup::compareBenchmarks(baseline, results, tolerance);
+            std::cout << "\nAgainst " << baselinePath << " (tolerance " << tolerance * 100.0
+                      << "% beyond the 95% intervals)\n";
+            coup::writeBenchVerdicts(std::cout, verdicts);
+            std::size_t regressed = 0;
+            for (const coup::BenchVerdict& verdict : verdicts) {
+                regressed += verdict.regressed ? 1 : 0;
+            }
+            if (regressed > 0) {
+                std::cerr << regressed << " benchmark(s) regressed" << std::endl;
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -5,7 +5,17 @@
 #include "Player.hpp"
 #include "Roles.hpp"
 #include "GUI.hpp"
+#include "GameRecord.hpp"
+#include "Replay.hpp"
+#include "ReplayViewer.hpp"
+#include "SpectatorWall.hpp"
+#include "TableFeed.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <vector>
 #include <iostream>
 
 using coup::GUI;
@@ -13,13 +23,46 @@ using coup::Game;
 
 /**
  * @brief Main entry point for the Coup card game
+ * @param argc Argument count
+ * @param argv Arguments; "--wall [N]" opens the spectator wall with N
+ * self-playing tables (default 16, at most 64), "--wall FILE..." opens it
+ * on recorded games (up to 64 .rec files, one table each, played back in
+ * a loop), "--replay FILE" opens a
+ * recorded game (e.g. coup_game.rec) in the replay viewer; without
+ * arguments a playable game starts
  * @return 0 on successful execution, 1 on error
  * @details Creates a new game instance and launches the GUI.
  * All exceptions are caught and reported to stderr.
  * The GUI handles player setup, game logic, and display.
  */
-int main() {
+int main(int argc, char* argv[]) {
     try {
+        if (argc > 1 && std::strcmp(argv[1], "--wall") == 0) {
+            char* end = nullptr;
+            long tables = argc > 2 ? std::strtol(argv[2], &end, 10) : 16;
+            if (argc > 2 && *end != '\0') {
+                std::vector<coup::GameRecord> records;
+                for (int i = 2; i < argc && records.size() < 64; ++i) {
+                    records.push_back(coup::GameRecord::load(argv[i]));
+                }
+                coup::ReplayTables feed(records, std::chrono::milliseconds(400));
+                coup::SpectatorWall wall(feed);
+                wall.run();
+                return 0;
+            }
+            tables = std::clamp(tables, 1L, 64L);
+            coup::LiveTables feed(static_cast<std::size_t>(tables), std::chrono::milliseconds(400));
+            coup::SpectatorWall wall(feed);
+            wall.run();
+            return 0;
+        }
+        if (argc > 2 && std::strcmp(argv[1], "--replay") == 0) {
+            coup::Replay replay(coup::GameRecord::load(argv[2]));
+            coup::ReplayViewer viewer(replay, argv[2]);
+            viewer.run();
+            return 0;
+        }
+
         // Create game instance
         auto game = std::make_shared<coup::Game>();
         
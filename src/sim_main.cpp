@@ -0,0 +1,494 @@
+//meirshuker159@gmail.com
+
+
+#include "Cfr.hpp"
+#include "Exploitability.hpp"
+#include "League.hpp"
+#include "Metrics.hpp"
+#include "PolicyTable.hpp"
+#include "SelfPlay.hpp"
+#include "Simulation.hpp"
+#include "Tournament.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: coup-sim [--games N] [--threads N] [--seed N] [--players MIN[-MAX]]\n"
+              << "                [--limit STEPS] [--rules RULES] [--csv FILE] [--json FILE]\n"
+              << "       coup-sim --compare RULES [--games N] [--rules RULES] ... [--csv FILE]\n"
+              << "       coup-sim --match CANDIDATE BASELINE [--threads N] [--seed N] [--limit STEPS]\n"
+              << "                [--elo0 E] [--elo1 E] [--alpha P] [--beta P] [--batch PAIRS]\n"
+              << "                [--max-games N]\n"
+              << "       coup-sim --league BOT,BOT,... [--format roundrobin|swiss] [--table N]\n"
+              << "                [--rounds N] [--threads N] [--seed N] [--limit STEPS] [--csv FILE]\n"
+              << "       coup-sim --selfplay DIR [--games N] [--bot TYPE] [--chunk ROWS] [--players MIN[-MAX]]\n"
+              << "                [--threads N] [--seed N] [--limit STEPS] [--rules RULES]\n"
+              << "       coup-sim --cfr FILE [--players N] [--horizon TURNS] [--iterations N] [--coins N]\n"
+              << "                [--exact-coins] [--threads N] [--rules RULES]\n"
+              << "       coup-sim --exploit uniform|greedy|FILE [--players N] [--horizon TURNS] [--coins N]\n"
+              << "                [--exact-coins] [--threads N] [--rules RULES]\n"
+              << "       coup-sim --distill FILE[.hpp] [--teacher BOT] [--games N] [--players MIN[-MAX]]\n"
+              << "                [--threads N] [--seed N] [--limit STEPS] [--rules RULES]\n"
+              << "Any mode: [--metrics FILE] [--metrics-port PORT] (Prometheus text, see README)\n"
+              << "          [--trace FILE] (Chrome trace JSON of the last spans of each thread)\n"
+              << "RULES: comma-separated tax=N, governor-tax=N, merchant-threshold=N, merchant-bonus=N\n";
+}
+
+/**
+ * @brief Writes the metrics file when the run ends, whichever way main returns
+ */
+struct MetricsFileOnExit {
+    std::string path; ///< File to write, empty for none
+
+    ~MetricsFileOnExit() {
+        if (path.empty()) {
+            return;
+        }
+        try {
+            coup::writeMetricsFile(path);
+            std::cout << "Wrote " << path << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    }
+};
+
+/**
+ * @brief Writes the trace file when the run ends, whichever way main returns
+ */
+struct TraceFileOnExit {
+    std::string path; ///< File to write, empty for none
+
+    ~TraceFileOnExit() {
+        if (path.empty()) {
+            return;
+        }
+        coup::stopTracing();
+        try {
+            std::size_t spans = coup::writeTraceFile(path);
+            std::cout << "Wrote " << spans << " spans to " << path << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    }
+};
+
+/**
+ * @brief Plays an SPRT-stopped match and prints the verdict
+ */
+int runMatch(const coup::TournamentConfig& config) {
+    coup::TournamentResult result = coup::runTournament(config);
+    const coup::SprtTest& sprt = result.sprt;
+    double low = 0.0;
+    double high = 0.0;
+    double elo = sprt.eloEstimate(low, high);
+    std::cout << config.candidate << " vs " << config.baseline << ": "
+              << sprt.wins() << " W / " << sprt.draws() << " D / " << sprt.losses() << " L in "
+              << sprt.games() << " games, " << result.batches << " batches, " << result.seconds << " s\n"
+              << "Elo " << elo << " [" << low << ", " << high << "]\n"
+              << "LLR " << sprt.llr() << " (" << sprt.lowerBound() << ", " << sprt.upperBound() << ") "
+              << "for H0 elo " << config.elo0 << " vs H1 elo " << config.elo1 << "\n"
+              << "Decision: ";
+    switch (result.decision) {
+        case coup::SprtDecision::AcceptH1: std::cout << "H1 accepted (candidate is stronger)\n"; break;
+        case coup::SprtDecision::AcceptH0: std::cout << "H0 accepted (no improvement)\n"; break;
+        case coup::SprtDecision::Continue: std::cout << "undecided after --max-games\n"; break;
+    }
+    return 0;
+}
+
+/**
+ * @brief Solves a small game with CFR+, saves the strategy and reports how it scores
+ */
+int runCfr(const coup::SmallConfig& config, std::size_t iterations, unsigned threads, const std::string& path) {
+    coup::SmallGame game(config);
+    auto start = std::chrono::steady_clock::now();
+    coup::CfrSolver solver(game, threads);
+    solver.iterate(iterations);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    coup::CfrStrategy strategy = solver.averageStrategy();
+    strategy.save(path);
+    std::cout << solver.infoSets() << " information sets, " << solver.iterations() << " iterations in "
+              << seconds << " s\nWrote " << path << "\n";
+
+    // Expected score of each seat playing the strategy against uniform and greedy opponents
+    coup::UniformPolicy uniform;
+    coup::GreedyPolicy greedy;
+    const coup::SmallPolicy* opponents[] = {&uniform, &greedy};
+    const char* names[] = {"uniform", "greedy"};
+    for (std::size_t o = 0; o < 2; ++o) {
+        std::cout << "vs " << names[o] << ":";
+        for (std::size_t seat = 0; seat < config.players; ++seat) {
+            std::vector<const coup::SmallPolicy*> seats(config.players, opponents[o]);
+            seats[seat] = &strategy;
+            std::cout << " seat " << seat << " " << coup::expectedUtilities(game, seats)[seat];
+        }
+        std::cout << " (fair share " << 1.0 / config.players << ")\n";
+    }
+    return 0;
+}
+
+/**
+ * @brief Reports how much a best response gains against a small-game policy in every seat
+ * @param policy "uniform", "greedy" or a strategy file, which brings its own game
+ */
+int runExploit(coup::SmallConfig config, const std::string& policy, unsigned threads) {
+    coup::UniformPolicy uniform;
+    coup::GreedyPolicy greedy;
+    std::unique_ptr<coup::CfrStrategy> strategy;
+    const coup::SmallPolicy* played = &uniform;
+    if (policy == "greedy") {
+        played = &greedy;
+    } else if (policy != "uniform") {
+        strategy = std::make_unique<coup::CfrStrategy>(coup::CfrStrategy::load(policy));
+        config = strategy->config();
+        played = strategy.get();
+    }
+    coup::SmallGame game(config);
+    coup::ExploitabilityReport report =
+        coup::exploitability(game, std::vector<const coup::SmallPolicy*>(config.players, played), threads);
+    std::cout << policy << " in a " << static_cast<int>(config.players) << "-player, "
+              << static_cast<int>(config.horizon) << "-turn game: " << report.infoSets << " information sets in "
+              << report.seconds << " s\n";
+    for (std::size_t seat = 0; seat < config.players; ++seat) {
+        std::cout << "seat " << seat << ": policy " << report.policyValues[seat] << ", best response "
+                  << report.bestResponseValues[seat] << "\n";
+    }
+    std::cout << "NashConv " << report.nashConv << ", exploitability " << report.exploitability << "\n";
+    return 0;
+}
+
+/**
+ * @brief Plays games with every move drawn by a function, on the calling thread
+ * @return Moves per second
+ */
+template <typename Draw>
+double playoutSpeed(const coup::RuleSet& rules, std::size_t games, Draw draw) {
+    std::mt19937 rng(1);
+    std::uint64_t moves = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t g = 0; g < games; ++g) {
+        coup::GameRecord record;
+        record.rules = rules;
+        for (std::size_t seat = 0; seat < 4; ++seat) {
+            const char* role = coup::roleName((g + seat) % coup::ROLE_COUNT);
+            record.seats.push_back(coup::SeatRecord{"P" + std::to_string(seat + 1), role});
+        }
+        auto game = record.createGame();
+        game->set_verbose(false);
+        coup::GameController controller(game);
+        controller.startGame();
+        try {
+            for (std::uint32_t step = 0; step < 2000 && controller.phase() != coup::GamePhase::GameOver; ++step) {
+                coup::GameRecord::play(controller, draw(controller, rng));
+                moves++;
+            }
+        } catch (const std::exception&) {
+            // A rejected move ends the game; the moves made still count
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(moves) / std::max(seconds, 1e-9);
+}
+
+/**
+ * @brief Distills a bot into a policy table, writes it and reports its speed
+ * @param path Output; a .hpp path gets a header to compile in, anything else the blob
+ */
+int runDistill(const coup::DistillConfig& config, const std::string& path) {
+    coup::DistillResult result = coup::distillPolicy(config);
+    const coup::PolicyTable& table = *result.table;
+    if (path.size() > 4 && path.compare(path.size() - 4, 4, ".hpp") == 0) {
+        table.writeHeader(path, "DISTILLED_POLICY");
+    } else {
+        table.save(path);
+    }
+    std::cout << result.decisions << " " << config.teacher << " decisions, " << result.actionRows << " of "
+              << coup::PolicyTable::ACTION_KEYS << " action rows and " << result.blockEntries << " of "
+              << coup::PolicyTable::BLOCK_KEYS << " block entries seen, on " << result.threads << " threads in "
+              << result.seconds << " s\nWrote " << path << "\n";
+
+    // Raw lookups, then whole games, where the engine dominates
+    std::mt19937 rng(1);
+    std::vector<std::uint32_t> keys(1 << 16);
+    for (auto& key : keys) {
+        key = static_cast<std::uint32_t>(rng() % coup::PolicyTable::ACTION_KEYS);
+    }
+    std::uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    const std::size_t rounds = 200;
+    for (std::size_t r = 0; r < rounds; ++r) {
+        for (std::uint32_t key : keys) {
+            checksum += table.row(key)[r % coup::PolicyTable::ROW];
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Lookups: " << static_cast<double>(rounds * keys.size()) / std::max(seconds, 1e-9) / 1e6
+              << " M/s (checksum " << checksum << ")\n";
+    auto tableMove = [&table](const coup::GameController& controller, std::mt19937& gen) {
+        return table.move(controller, gen);
+    };
+    double tableSpeed = playoutSpeed(config.rules, 50, tableMove);
+    double randomSpeed = playoutSpeed(config.rules, 50, coup::randomMove);
+    std::cout << "Playouts on one thread: table " << tableSpeed / 1e3 << " k moves/s, random "
+              << randomSpeed / 1e3 << " k moves/s\n";
+    return 0;
+}
+
+/**
+ * @brief Writes an export through a callback, reporting failures
+ */
+template <typename Write>
+bool exportTo(const std::string& path, Write write) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (out) {
+        write(out);
+    }
+    if (!out) {
+        std::cerr << "Error: cannot write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Entry point of the batch simulator (coup-sim)
+ * @return 0 on success, 1 on bad arguments or errors
+ * @details Plays random games on all hardware threads, prints a summary and
+ * optionally exports the full statistics as CSV and/or JSON. With --match it
+ * instead plays two bots heads-up until a sequential test decides which is
+ * stronger; with --compare it plays every game under two rule sets on the
+ * same seeds and reports the differences; with --league it rates a bot
+ * population over many free-for-all games; with --selfplay it records every
+ * decision of bot self-play as a training dataset; with --cfr it solves a
+ * small abstraction of the game with CFR+, with --exploit it measures
+ * how far a policy of that game is from an equilibrium, and with --distill
+ * it compiles a bot's decisions into a lookup-table rollout policy.
+ */
+int main(int argc, char* argv[]) {
+    coup::SimConfig config;
+    std::string csvPath;
+    std::string jsonPath;
+    coup::TournamentConfig match;
+    bool matchMode = false;
+    std::string baselineRules;
+    std::string variantRules;
+    coup::LeagueConfig league;
+    coup::SelfPlayConfig selfPlay;
+    bool selfPlayMode = false;
+    coup::SmallConfig small;
+    std::string cfrPath;
+    std::string exploitPolicy;
+    std::size_t cfrIterations = 200;
+    coup::DistillConfig distill;
+    std::string distillPath;
+    MetricsFileOnExit metricsFile;
+    long metricsPort = -1;
+    TraceFileOnExit traceFile;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--match" && i + 2 < argc) {
+            matchMode = true;
+            match.candidate = argv[++i];
+            match.baseline = argv[++i];
+            continue;
+        }
+        if (arg == "--exact-coins") {
+            small.bucketCoins = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--games") {
+            config.games = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--threads") {
+            config.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--seed") {
+            config.seed = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--limit") {
+            config.stepLimit = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--players") {
+            char* end = nullptr;
+            long low = std::strtol(value, &end, 10);
+            long high = *end == '-' ? std::strtol(end + 1, nullptr, 10) : low;
+            config.minPlayers = static_cast<std::uint8_t>(std::max(0L, std::min(low, 255L)));
+            config.maxPlayers = static_cast<std::uint8_t>(std::max(0L, std::min(high, 255L)));
+        } else if (arg == "--rules") {
+            baselineRules = value;
+        } else if (arg == "--compare") {
+            variantRules = value;
+        } else if (arg == "--league") {
+            std::string list = value;
+            for (std::size_t start = 0; start <= list.size();) {
+                std::size_t end = std::min(list.find(',', start), list.size());
+                league.bots.push_back(list.substr(start, end - start));
+                start = end + 1;
+            }
+        } else if (arg == "--format") {
+            if (std::strcmp(value, "swiss") == 0) {
+                league.format = coup::LeagueFormat::Swiss;
+            } else if (std::strcmp(value, "roundrobin") == 0) {
+                league.format = coup::LeagueFormat::RoundRobin;
+            } else {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--table") {
+            league.tableSize = static_cast<std::uint8_t>(std::min(std::strtoul(value, nullptr, 10), 255UL));
+        } else if (arg == "--rounds") {
+            league.rounds = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--selfplay") {
+            selfPlayMode = true;
+            selfPlay.directory = value;
+        } else if (arg == "--bot") {
+            selfPlay.bot = value;
+        } else if (arg == "--chunk") {
+            selfPlay.chunkRows = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--cfr") {
+            cfrPath = value;
+        } else if (arg == "--exploit") {
+            exploitPolicy = value;
+        } else if (arg == "--distill") {
+            distillPath = value;
+        } else if (arg == "--teacher") {
+            distill.teacher = value;
+        } else if (arg == "--horizon") {
+            small.horizon = static_cast<std::uint8_t>(std::min(std::strtoul(value, nullptr, 10), 255UL));
+        } else if (arg == "--iterations") {
+            cfrIterations = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--coins") {
+            small.startCoins = static_cast<std::uint8_t>(std::min(std::strtoul(value, nullptr, 10), 255UL));
+        } else if (arg == "--elo0") {
+            match.elo0 = std::strtod(value, nullptr);
+        } else if (arg == "--elo1") {
+            match.elo1 = std::strtod(value, nullptr);
+        } else if (arg == "--alpha") {
+            match.alpha = std::strtod(value, nullptr);
+        } else if (arg == "--beta") {
+            match.beta = std::strtod(value, nullptr);
+        } else if (arg == "--batch") {
+            match.batchPairs = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--max-games") {
+            match.maxGames = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--csv") {
+            csvPath = value;
+        } else if (arg == "--json") {
+            jsonPath = value;
+        } else if (arg == "--metrics") {
+            metricsFile.path = value;
+        } else if (arg == "--trace") {
+            traceFile.path = value;
+        } else if (arg == "--metrics-port") {
+            metricsPort = std::strtol(value, nullptr, 10);
+            if (metricsPort < 0 || metricsPort > 65535) {
+                printUsage();
+                return 1;
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::unique_ptr<coup::MetricsServer> metricsServer;
+    try {
+        if (!traceFile.path.empty()) {
+            coup::trace::setThreadName("main");
+            coup::startTracing();
+        }
+        if (metricsPort >= 0) {
+            metricsServer = std::make_unique<coup::MetricsServer>(static_cast<std::uint16_t>(metricsPort));
+            std::cerr << "Serving metrics on http://127.0.0.1:" << metricsServer->port() << "/metrics" << std::endl;
+        }
+        config.rules = coup::parseRules(baselineRules, coup::RuleSet());
+        if (!variantRules.empty()) {
+            coup::RuleComparison comparison = coup::compareRules(config, coup::parseRules(variantRules, config.rules));
+            comparison.writeSummary(std::cout);
+            if (!csvPath.empty()) {
+                return exportTo(csvPath, [&comparison](std::ostream& out) { comparison.writeCsv(out); }) ? 0 : 1;
+            }
+            return 0;
+        }
+        small.players = config.minPlayers;
+        small.rules = config.rules;
+        if (!cfrPath.empty()) {
+            return runCfr(small, cfrIterations, config.threads, cfrPath);
+        }
+        if (!exploitPolicy.empty()) {
+            return runExploit(small, exploitPolicy, config.threads);
+        }
+        if (!distillPath.empty()) {
+            distill.games = config.games;
+            distill.threads = config.threads;
+            distill.seed = config.seed;
+            distill.minPlayers = config.minPlayers;
+            distill.maxPlayers = config.maxPlayers;
+            distill.stepLimit = config.stepLimit;
+            distill.rules = config.rules;
+            return runDistill(distill, distillPath);
+        }
+        if (selfPlayMode) {
+            selfPlay.games = config.games;
+            selfPlay.threads = config.threads;
+            selfPlay.seed = config.seed;
+            selfPlay.minPlayers = config.minPlayers;
+            selfPlay.maxPlayers = config.maxPlayers;
+            selfPlay.stepLimit = config.stepLimit;
+            selfPlay.rules = config.rules;
+            coup::SelfPlayResult result = coup::runSelfPlay(selfPlay);
+            std::cout << result.games << " games (" << result.truncated << " cut off), " << result.rows
+                      << " rows in " << result.chunks << " chunks on " << result.threads << " threads in "
+                      << result.seconds << " s\n"
+                      << "Wrote " << selfPlay.directory << "/manifest.json\n";
+            return 0;
+        }
+        if (!league.bots.empty()) {
+            league.rules = config.rules;
+            league.threads = config.threads;
+            league.seed = config.seed;
+            league.stepLimit = config.stepLimit;
+            coup::LeagueResult result = coup::runLeague(league);
+            std::cout << result.games << " games (" << result.truncated << " cut off) on " << result.threads
+                      << " threads in " << result.seconds << " s\n\n";
+            result.ratings.writeStandings(std::cout);
+            if (!csvPath.empty()) {
+                return exportTo(csvPath, [&result](std::ostream& out) { result.ratings.writeCsv(out); }) ? 0 : 1;
+            }
+            return 0;
+        }
+        if (matchMode) {
+            match.rules = config.rules;
+            match.threads = config.threads;
+            match.seed = config.seed;
+            match.stepLimit = config.stepLimit;
+            return runMatch(match);
+        }
+        coup::SimStats stats = coup::runSimulation(config);
+        stats.writeSummary(std::cout);
+        bool ok = true;
+        if (!csvPath.empty()) {
+            ok = exportTo(csvPath, [&stats](std::ostream& out) { stats.writeCsv(out); }) && ok;
+        }
+        if (!jsonPath.empty()) {
+            ok = exportTo(jsonPath, [&stats](std::ostream& out) { stats.writeJson(out); }) && ok;
+        }
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
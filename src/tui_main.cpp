@@ -0,0 +1,26 @@
+//meirshuker159@gmail.com
+
+
+#include "Game.hpp"
+#include "TerminalUI.hpp"
+#include <iostream>
+#include <memory>
+
+/**
+ * @brief Entry point of the terminal frontend (coup-tui)
+ * @return 0 on successful execution, 1 on error
+ * @details Links only the engine, so it starts without a display, GL
+ * context or font and can be played over SSH. The terminal is restored
+ * before any error is reported to stderr.
+ */
+int main() {
+    try {
+        auto game = std::make_shared<coup::Game>();
+        coup::TerminalUI ui(game);
+        ui.run();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -6,7 +6,58 @@
 #include "Roles.hpp"
 #include "Exceptions.hpp"
 #include "ActionValidator.hpp"
+#include "Bot.hpp"
+#include "ActionHistory.hpp"
+#include "AllocTracker.hpp"
+#include "Assets.hpp"
+#include "Bench.hpp"
+#include "BeliefTracker.hpp"
+#include "Cfr.hpp"
+#include "Concurrent.hpp"
+#include "Dataset.hpp"
+#include "EngineThread.hpp"
+#include "EvalQueue.hpp"
+#include "Exploitability.hpp"
+#include "Features.hpp"
+#include "FrameProfiler.hpp"
+#include "GameController.hpp"
+#include "GameRecord.hpp"
+#include "League.hpp"
+#include "Metrics.hpp"
+#include "Network.hpp"
+#include "PolicyTable.hpp"
+#include "QuantileSketch.hpp"
+#include "Rating.hpp"
+#include "Replay.hpp"
+#include "SelfPlay.hpp"
+#include "SmallGame.hpp"
+#include "Simulation.hpp"
+#include "TableFeed.hpp"
+#include "TerminalScreen.hpp"
+#include "ThreadPool.hpp"
+#include "Tournament.hpp"
+#include "Trace.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
 #include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Count every allocation, so tests can hold the engine to a zero-allocation contract
+COUP_INSTALL_ALLOCATION_HOOK();
 
 using namespace coup;
 
@@ -491,6 +542,33 @@ TEST_CASE("Mandatory coup rule") {
     ActionValidator::validateActionExecution("End Turn", governor);
 }
 
+TEST_CASE("ActionValidator - exception type follows the failure reason") {
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    auto spy = std::make_shared<Spy>(game, "Spy");
+    auto governor = std::make_shared<Governor>(game, "Governor");
+    game->add_player(spy);
+    game->add_player(governor);
+    game->start_game();
+
+    CHECK_THROWS_AS(ActionValidator::validateActionExecution(ActionType::Gather, governor.get()), NotYourTurnException);
+    CHECK_THROWS_AS(ActionValidator::validateActionExecution(ActionType::Bribe, spy.get()), NotEnoughCoinsException);
+    CHECK_THROWS_AS(ActionValidator::validateActionExecution(ActionType::Arrest, spy.get()), IllegalTargetException);
+    CHECK_THROWS_AS(ActionValidator::validateActionExecution(ActionType::Arrest, spy.get(), spy.get()),
+                    IllegalTargetException);
+    spy->add_coins(3);
+    CHECK_THROWS_AS(ActionValidator::validateActionExecution(ActionType::Invest, spy.get()), IllegalMoveException);
+
+    // Messages mentioning "turn" or "coins" no longer pick the type
+    spy->block_arrest_ability(*governor);
+    spy->gather();
+    CHECK_THROWS_WITH_AS(ActionValidator::validateActionExecution(ActionType::Arrest, governor.get(), spy.get()),
+                         "Your arrest ability is blocked this turn", IllegalMoveException);
+    governor->add_coins(10);
+    CHECK_THROWS_WITH_AS(ActionValidator::validateActionExecution(ActionType::Gather, governor.get()),
+                         "Must perform coup when having 10 or more coins", IllegalMoveException);
+}
+
 TEST_CASE("Complex game scenario") {
     auto game = std::make_shared<Game>();
     auto governor = std::make_shared<Governor>(game, "Governor");
@@ -605,4 +683,2119 @@ TEST_CASE("Edge cases and error handling") {
     auto baron3 = std::make_shared<Baron>(game3, "Baron");
     game3->add_player(baron3);
     CHECK_THROWS_AS(governor3->arrest(*spy3), IllegalTargetException); // Spy is inactive
-} 
\ No newline at end of file
+} 
+TEST_CASE("ActionHistory - bounded ring buffer") {
+    ActionHistory history(4);
+    CHECK(history.capacity() == 4);
+    CHECK(history.size() == 0);
+
+    for (int i = 0; i < 10; ++i) {
+        ActionRecord record;
+        record.type = ActionType::Gather;
+        record.actor = 0;
+        record.actorCoins = static_cast<std::uint8_t>(i);
+        history.push(record);
+    }
+
+    // Memory stays at capacity; only the newest records are retained
+    CHECK(history.size() == 4);
+    CHECK(history.totalRecorded() == 10);
+    CHECK(history.fromNewest(0).seq == 9);
+    CHECK(history.fromNewest(0).actorCoins == 9);
+    CHECK(history.fromNewest(3).seq == 6);
+
+    history.clear();
+    CHECK(history.size() == 0);
+    CHECK(history.totalRecorded() == 10);
+}
+
+TEST_CASE("ActionHistory - record formatting") {
+    ActionHistory history(8);
+    history.setSeatName(0, "Alice");
+    history.setSeatName(1, "Bob");
+
+    ActionRecord arrest;
+    arrest.type = ActionType::Arrest;
+    arrest.actor = 0;
+    arrest.target = 1;
+    arrest.treasury = 50;
+    history.push(arrest);
+    CHECK(history.format(history.fromNewest(0)) == "#0 Alice arrested Bob [T:50]");
+
+    ActionRecord block;
+    block.type = ActionType::Block;
+    block.actor = 1;
+    block.target = 0;
+    block.detail = static_cast<std::uint8_t>(ActionType::Tax);
+    block.treasury = 48;
+    history.push(block);
+    CHECK(history.format(history.fromNewest(0)) == "#1 Bob blocked Tax by Alice [T:48]");
+
+    ActionType parsed;
+    CHECK(parseActionType("Block Arrest", parsed));
+    CHECK(parsed == ActionType::BlockArrest);
+    CHECK_FALSE(parseActionType("Dance", parsed));
+}
+
+TEST_CASE("GameController - setup and turn flow") {
+    auto game = std::make_shared<Game>();
+    GameController controller(game);
+    std::vector<ActionRecord> events;
+    controller.setEventSink([&events](const ActionRecord& record) { events.push_back(record); });
+
+    CHECK(controller.phase() == GamePhase::Setup);
+    CHECK_THROWS_AS(controller.addPlayer(""), GameException);
+    controller.addPlayer("Alice");
+    CHECK_THROWS_AS(controller.addPlayer("Alice"), GameException);
+    CHECK_THROWS_AS(controller.startGame(), GameException);
+    controller.addPlayer("Bob");
+    controller.startGame();
+    CHECK(controller.phase() == GamePhase::Playing);
+    REQUIRE(events.size() == 2);
+    CHECK(events[0].type == ActionType::GameStart);
+    CHECK(events[0].detail == 2);
+    CHECK(events[1].type == ActionType::TurnStart);
+    CHECK(events[1].actor == 0);
+
+    controller.requestAction(ActionType::Gather);
+    CHECK(controller.playerAt(0)->get_coins() == 1);
+    REQUIRE(events.size() == 4);
+    CHECK(events[2].type == ActionType::Gather);
+    CHECK(events[2].actorCoins == 1);
+    CHECK(events[2].treasury == 49);
+    CHECK(events[3].type == ActionType::TurnStart);
+    CHECK(events[3].actor == 1);
+
+    // Not enough coins: rejected before anything changes
+    CHECK_THROWS_AS(controller.requestAction(ActionType::Coup, 0), NotEnoughCoinsException);
+
+    GameSnapshot snapshot;
+    controller.fillSnapshot(snapshot);
+    CHECK(snapshot.phase == GamePhase::Playing);
+    CHECK(snapshot.playerCount == 2);
+    CHECK(snapshot.currentSeat == 1);
+    CHECK(snapshot.treasury == 49);
+    CHECK(std::string(snapshot.players[0].name) == "Alice");
+    CHECK(snapshot.players[0].coins == 1);
+    CHECK(snapshot.isAvailable(ActionType::Gather));
+    CHECK_FALSE(snapshot.isAvailable(ActionType::Coup));
+}
+
+TEST_CASE("GameController - block phase") {
+    auto game = std::make_shared<Game>();
+    auto merchant = std::make_shared<Merchant>(game, "Merchant");
+    auto governor = std::make_shared<Governor>(game, "Governor");
+    game->add_player(merchant);
+    game->add_player(governor);
+    GameController controller(game);
+    std::vector<ActionRecord> events;
+    controller.setEventSink([&events](const ActionRecord& record) { events.push_back(record); });
+    controller.startGame();
+
+    // Governor can block tax, so the action waits for a decision
+    controller.requestAction(ActionType::Tax);
+    CHECK(controller.phase() == GamePhase::BlockPending);
+    GameSnapshot snapshot;
+    controller.fillSnapshot(snapshot);
+    CHECK(snapshot.blockerCount == 1);
+    CHECK(snapshot.blockers[0] == 1);
+    CHECK(snapshot.pendingActor == 0);
+    CHECK_THROWS_AS(controller.requestAction(ActionType::Gather), GameException);
+    CHECK_THROWS_AS(controller.block(0), IllegalMoveException);
+
+    controller.block(1);
+    CHECK(controller.phase() == GamePhase::Playing);
+    CHECK(merchant->get_coins() == 0);
+    CHECK(game->turn() == "Governor");
+    CHECK(events[events.size() - 2].type == ActionType::Block);
+    CHECK(events[events.size() - 2].detail == static_cast<std::uint8_t>(ActionType::Tax));
+
+    // Merchant cannot block tax; passing lets the Governor's tax through
+    controller.requestAction(ActionType::Tax);
+    CHECK(controller.phase() == GamePhase::Playing);
+    CHECK(governor->get_coins() == 3);
+    controller.requestAction(ActionType::Tax);
+    CHECK(controller.phase() == GamePhase::BlockPending);
+    controller.pass();
+    CHECK(merchant->get_coins() == 2);
+}
+
+TEST_CASE("Concurrent - SPSC queue and triple buffer") {
+    SpscQueue<int, 4> queue;
+    int value = 0;
+    CHECK(queue.empty());
+    CHECK_FALSE(queue.tryPop(value));
+    for (int i = 0; i < 4; ++i) {
+        CHECK(queue.tryPush(i));
+    }
+    CHECK_FALSE(queue.tryPush(99));
+    CHECK(queue.tryPop(value));
+    CHECK(value == 0);
+    CHECK(queue.tryPush(4));
+
+    // Ordered hand-off between two threads
+    SpscQueue<int, 64> channel;
+    const int count = 20000;
+    std::thread producer([&channel]() {
+        for (int i = 0; i < count; ++i) {
+            while (!channel.tryPush(i)) std::this_thread::yield();
+        }
+    });
+    bool ordered = true;
+    for (int expected = 0; expected < count; ++expected) {
+        int got = -1;
+        while (!channel.tryPop(got)) std::this_thread::yield();
+        ordered = ordered && got == expected;
+    }
+    producer.join();
+    CHECK(ordered);
+
+    TripleBuffer<int> buffer;
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    buffer.writeBuffer() = 2;
+    buffer.publish();
+    CHECK(buffer.read() == 2);
+    CHECK(buffer.read() == 2);
+    buffer.writeBuffer() = 3;
+    buffer.publish();
+    CHECK(buffer.read() == 3);
+}
+
+TEST_CASE("ThreadPool - batch runs on a few threads") {
+    CHECK(workerCount(4, 100) == 4);
+    CHECK(workerCount(4, 2) == 2);
+    CHECK(workerCount(4, 0) == 1);
+    CHECK(workerCount(0, 1000) >= 1);
+
+    // Every slot runs once, slot 0 on the calling thread
+    std::vector<int> runs(4, 0);
+    std::thread::id callerSlot;
+    runOnThreads(4, [&runs, &callerSlot](unsigned slot) {
+        runs[slot]++;
+        if (slot == 0) {
+            callerSlot = std::this_thread::get_id();
+        }
+    });
+    CHECK(runs == std::vector<int>{1, 1, 1, 1});
+    CHECK(callerSlot == std::this_thread::get_id());
+
+    // A failing slot does not stop the others, and its exception reaches the caller
+    std::atomic<int> finished{0};
+    CHECK_THROWS_WITH_AS(runOnThreads(3, [&finished](unsigned slot) {
+        if (slot == 2) {
+            throw GameException("slot failed");
+        }
+        finished++;
+    }), "slot failed", GameException);
+    CHECK(finished == 2);
+}
+
+TEST_CASE("EngineThread - commands produce snapshots and events") {
+    auto game = std::make_shared<Game>();
+    EngineThread engine(game);
+    CHECK(engine.snapshot().phase == GamePhase::Setup);
+
+    engine.addPlayer("Alice");
+    engine.addPlayer("Bob");
+    engine.startGame();
+    engine.action(ActionType::Gather);
+
+    // Wait (bounded) for the engine thread to catch up
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (engine.snapshot().treasury != 49 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const GameSnapshot& snapshot = engine.snapshot();
+    CHECK(snapshot.phase == GamePhase::Playing);
+    CHECK(snapshot.playerCount == 2);
+    CHECK(snapshot.treasury == 49);
+    CHECK(snapshot.currentSeat == 1);
+    CHECK(snapshot.engineCommandCount == 4);
+
+    std::vector<ActionType> types;
+    ActionRecord record;
+    while (engine.pollEvent(record)) {
+        types.push_back(record.type);
+    }
+    REQUIRE(types.size() == 4);
+    CHECK(types[0] == ActionType::GameStart);
+    CHECK(types[1] == ActionType::TurnStart);
+    CHECK(types[2] == ActionType::Gather);
+    CHECK(types[3] == ActionType::TurnStart);
+
+    // Rule violations come back as a message instead of an exception
+    std::uint32_t messages = snapshot.messageCount;
+    engine.action(ActionType::Coup, 0);
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (engine.snapshot().messageCount == messages && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(engine.snapshot().messageCount == messages + 1);
+}
+
+TEST_CASE("GameController - legal moves and quiet games") {
+    auto game = std::make_shared<Game>();
+    auto governor = std::make_shared<Governor>(game, "Governor");
+    auto spy = std::make_shared<Spy>(game, "Spy");
+    game->add_player(governor);
+    game->add_player(spy);
+    GameController controller(game);
+
+    std::array<Move, MAX_MOVES> moves;
+    CHECK(controller.legalMoves(moves) == 0);
+    controller.startGame();
+    std::size_t count = controller.legalMoves(moves);
+    REQUIRE(count > 0);
+    bool hasGather = false;
+    bool hasCoup = false;
+    for (std::size_t i = 0; i < count; ++i) {
+        CHECK(ActionValidator::getValidationResult(actionTypeName(moves[i].action), governor,
+                                                   controller.playerAt(moves[i].target)).isValid);
+        hasGather = hasGather || moves[i].action == ActionType::Gather;
+        hasCoup = hasCoup || moves[i].action == ActionType::Coup;
+    }
+    CHECK(hasGather);
+    CHECK_FALSE(hasCoup);
+
+    // Mandatory coup leaves only Coup and End Turn
+    governor->add_coins(10);
+    count = controller.legalMoves(moves);
+    for (std::size_t i = 0; i < count; ++i) {
+        CHECK((moves[i].action == ActionType::Coup || moves[i].action == ActionType::EndTurn));
+    }
+
+    // A quiet game writes nothing to the console
+    std::ostringstream captured;
+    std::streambuf* original = std::cout.rdbuf(captured.rdbuf());
+    game->set_verbose(false);
+    controller.requestAction(ActionType::Coup, 1);
+    std::cout.rdbuf(original);
+    CHECK(captured.str().empty());
+    CHECK(controller.phase() == GamePhase::GameOver);
+    CHECK(controller.legalMoves(moves) == 0);
+}
+
+TEST_CASE("TableFeed - table state from events") {
+    TableState state;
+    ActionRecord record;
+    record.type = ActionType::GameStart;
+    record.detail = 3;
+    record.treasury = 50;
+    state.apply(record);
+    CHECK(state.playerCount == 3);
+    CHECK(state.active[2]);
+    CHECK_FALSE(state.active[3]);
+    CHECK(state.gamesPlayed == 1);
+    CHECK_FALSE(state.hasLastAction);
+
+    state.dirty = false;
+    record = ActionRecord();
+    record.type = ActionType::TurnStart;
+    record.actor = 1;
+    record.treasury = 50;
+    state.apply(record);
+    CHECK(state.dirty);
+    CHECK(state.currentSeat == 1);
+    CHECK_FALSE(state.hasLastAction);
+
+    record.type = ActionType::Coup;
+    record.actor = 1;
+    record.target = 2;
+    record.actorCoins = 3;
+    record.targetCoins = 4;
+    record.treasury = 43;
+    state.apply(record);
+    CHECK(state.coins[1] == 3);
+    CHECK(state.coins[2] == 4);
+    CHECK_FALSE(state.active[2]);
+    CHECK(state.treasury == 43);
+    CHECK(state.hasLastAction);
+    CHECK(state.lastAction.type == ActionType::Coup);
+
+    record = ActionRecord();
+    record.type = ActionType::GameOver;
+    record.actor = 1;
+    record.treasury = 43;
+    state.apply(record);
+    CHECK(state.winnerSeat == 1);
+    CHECK(state.currentSeat == NO_SEAT);
+}
+
+TEST_CASE("TableFeed - live tables stream complete games") {
+    const std::size_t tableCount = 4;
+    LiveTables feed(tableCount, std::chrono::milliseconds(1), 7);
+    CHECK(feed.tableCount() == tableCount);
+    CHECK(feed.seatName(0, 2) == "P3");
+
+    std::vector<TableState> states(tableCount);
+    std::vector<bool> finished(tableCount, false);
+    bool coinsConserved = true;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (std::count(finished.begin(), finished.end(), true) < static_cast<long>(tableCount) &&
+           std::chrono::steady_clock::now() < deadline) {
+        ActionRecord record;
+        for (std::size_t t = 0; t < tableCount; ++t) {
+            while (feed.poll(t, record)) {
+                states[t].apply(record);
+                if (record.type == ActionType::GameOver) {
+                    finished[t] = true;
+                }
+                if (record.type != ActionType::TurnStart) continue;
+                // Turn-start bonuses are settled by the TurnStart record, so the
+                // event stream accounts for every coin at each turn boundary
+                int total = states[t].treasury;
+                for (std::uint8_t seat = 0; seat < states[t].playerCount; ++seat) {
+                    total += states[t].coins[seat];
+                }
+                coinsConserved = coinsConserved && total == 50;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(coinsConserved);
+    for (std::size_t t = 0; t < tableCount; ++t) {
+        CHECK(finished[t]);
+        CHECK(states[t].gamesPlayed >= 1);
+        CHECK(states[t].playerCount >= 2);
+    }
+}
+
+// Plays a random game to the end and returns its record
+GameRecord play_random_game(std::uint32_t seed, std::size_t players) {
+    std::mt19937 rng(seed);
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    const char* roles[] = {"Governor", "Spy", "Baron", "General", "Judge", "Merchant"};
+    for (std::size_t i = 0; i < players; ++i) {
+        game->add_player(game->create_player("P" + std::to_string(i + 1), roles[rng() % 6]));
+    }
+    GameController controller(game);
+    controller.startGame();
+    GameRecord record;
+    record.captureSeats(*game);
+    std::array<Move, MAX_MOVES> moves;
+    while (controller.phase() != GamePhase::GameOver && record.moves.size() < 1000) {
+        RecordedMove move;
+        if (controller.phase() == GamePhase::BlockPending) {
+            std::size_t pick = rng() % (2 * controller.pendingBlockerCount());
+            if (pick < controller.pendingBlockerCount()) {
+                move = RecordedMove{RecordedMove::Kind::Block, ActionType::Gather, controller.pendingBlocker(pick)};
+            } else {
+                move = RecordedMove{RecordedMove::Kind::Pass, ActionType::Gather, NO_SEAT};
+            }
+        } else {
+            std::size_t count = controller.legalMoves(moves);
+            const Move& chosen = moves[rng() % count];
+            move = RecordedMove{RecordedMove::Kind::Action, chosen.action, chosen.target};
+        }
+        GameRecord::play(controller, move);
+        record.moves.push_back(move);
+    }
+    return record;
+}
+
+TEST_CASE("GameRecord - save and load") {
+    GameRecord record = play_random_game(11, 4);
+    REQUIRE(record.seats.size() == 4);
+    REQUIRE_FALSE(record.moves.empty());
+    record.seats[0].name = "Ann Lee";  // Names may contain spaces
+    record.save("test_game.rec");
+
+    GameRecord loaded = GameRecord::load("test_game.rec");
+    REQUIRE(loaded.seats.size() == record.seats.size());
+    CHECK(loaded.seats[0].name == "Ann Lee");
+    CHECK(loaded.seats[1].role == record.seats[1].role);
+    REQUIRE(loaded.moves.size() == record.moves.size());
+    bool same = true;
+    for (std::size_t i = 0; i < record.moves.size(); ++i) {
+        same = same && loaded.moves[i].kind == record.moves[i].kind &&
+               loaded.moves[i].action == record.moves[i].action && loaded.moves[i].seat == record.moves[i].seat;
+    }
+    CHECK(same);
+
+    {
+        std::ofstream broken("test_game.rec");
+        broken << "COUP-RECORD 1\nseats 2\nGovernor A\nSpy B\nmoves 1\nX 1\n";
+    }
+    CHECK_THROWS_AS(GameRecord::load("test_game.rec"), GameException);
+    // Move counts the file cannot back fail as malformed, not as allocation errors
+    for (const char* count : {"-1", "99999999999999"}) {
+        {
+            std::ofstream broken("test_game.rec");
+            broken << "COUP-RECORD 1\nseats 2\nGovernor A\nSpy B\nmoves " << count << "\nP\n";
+        }
+        CHECK_THROWS_AS(GameRecord::load("test_game.rec"), GameException);
+    }
+    std::remove("test_game.rec");
+    CHECK_THROWS_AS(GameRecord::load("test_game.rec"), GameException);
+}
+
+TEST_CASE("Replay - keyframe seeks match sequential play") {
+    GameRecord record = play_random_game(5, 5);
+    Replay replay(record, 8);
+    REQUIRE(replay.length() == record.moves.size());
+    CHECK(replay.keyframeCount() == replay.length() / 8 + 1);
+    CHECK(replay.position() == replay.length());
+    CHECK(replay.controller().phase() == GamePhase::GameOver);
+
+    // Reference: play the record from the start, one move at a time
+    auto game = record.createGame();
+    game->set_verbose(false);
+    GameController reference(game);
+    reference.startGame();
+    std::vector<GameSnapshot> expected(replay.length() + 1);
+    reference.fillSnapshot(expected[0]);
+    for (std::size_t i = 0; i < record.moves.size(); ++i) {
+        GameRecord::play(reference, record.moves[i]);
+        reference.fillSnapshot(expected[i + 1]);
+    }
+
+    std::mt19937 rng(3);
+    bool matches = true;
+    bool bounded = true;
+    for (int i = 0; i < 200; ++i) {
+        std::size_t target = rng() % (replay.length() + 1);
+        replay.seek(target);
+        bounded = bounded && replay.lastSeekCost() < replay.keyframeInterval();
+        GameSnapshot actual;
+        replay.controller().fillSnapshot(actual);
+        const GameSnapshot& want = expected[target];
+        matches = matches && actual.phase == want.phase && actual.treasury == want.treasury &&
+                  actual.currentSeat == want.currentSeat && actual.actionsRemaining == want.actionsRemaining &&
+                  actual.blockerCount == want.blockerCount;
+        for (std::size_t seat = 0; seat < want.playerCount; ++seat) {
+            matches = matches && actual.players[seat].coins == want.players[seat].coins &&
+                      actual.players[seat].active == want.players[seat].active &&
+                      actual.players[seat].sanctioned == want.players[seat].sanctioned;
+        }
+    }
+    CHECK(matches);
+    CHECK(bounded);
+
+    // Events up to a position need no replay at all
+    replay.seek(0);
+    REQUIRE(replay.eventCount() == 2);
+    CHECK(replay.event(0).type == ActionType::GameStart);
+    CHECK(replay.event(1).type == ActionType::TurnStart);
+    replay.seek(replay.length());
+    CHECK(replay.event(replay.eventCount() - 1).type == ActionType::GameOver);
+}
+
+TEST_CASE("TableFeed - replayed tables stream recorded games") {
+    std::vector<GameRecord> records = {play_random_game(11, 3), play_random_game(12, 5)};
+    ReplayTables feed(records, std::chrono::milliseconds(0), 3);
+    REQUIRE(feed.tableCount() == 2);
+    CHECK(feed.seatName(1, 4) == "P5");
+    CHECK(feed.seatName(1, 5) == "P6");  // Past the recorded seats
+
+    for (std::size_t t = 0; t < records.size(); ++t) {
+        Replay replay(records[t]);
+        std::vector<ActionRecord> streamed;
+        TableState state;
+        ActionRecord record;
+        while (state.gamesPlayed < 2 && feed.poll(t, record)) {
+            state.apply(record);
+            if (state.gamesPlayed < 2) {
+                streamed.push_back(record);
+            }
+        }
+        // One full game, event for event, then it starts over
+        REQUIRE(streamed.size() == replay.eventCount());
+        bool same = true;
+        for (std::size_t i = 0; i < streamed.size(); ++i) {
+            same = same && streamed[i].type == replay.event(i).type && streamed[i].actor == replay.event(i).actor &&
+                   streamed[i].target == replay.event(i).target && streamed[i].treasury == replay.event(i).treasury;
+        }
+        CHECK(same);
+        CHECK(state.gamesPlayed == 2);
+        CHECK(record.type == ActionType::GameStart);
+    }
+    CHECK_FALSE(feed.poll(2, *std::make_unique<ActionRecord>()));
+
+    // Moves are released over time, not all at once
+    ReplayTables paced(records, std::chrono::milliseconds(60000), 3);
+    ActionRecord record;
+    std::size_t early = 0;
+    while (paced.poll(0, record)) {
+        early++;
+    }
+    CHECK(early == 2);  // GameStart and the first TurnStart
+}
+
+TEST_CASE("EngineThread - records the game for replay") {
+    std::remove("test_engine.rec");
+    {
+        auto game = std::make_shared<Game>();
+        game->set_verbose(false);
+        EngineThread engine(game, "test_engine.rec");
+        engine.addPlayer("Alice");
+        engine.addPlayer("Bob");
+        engine.startGame();
+        engine.action(ActionType::Gather);
+        engine.action(ActionType::Coup, 0);  // Rejected, so not recorded
+        engine.action(ActionType::Gather);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (engine.snapshot().treasury != 48 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    GameRecord record = GameRecord::load("test_engine.rec");
+    REQUIRE(record.seats.size() == 2);
+    CHECK(record.seats[0].name == "Alice");
+    REQUIRE(record.moves.size() == 2);
+    CHECK(record.moves[0].action == ActionType::Gather);
+    Replay replay(record);
+    CHECK(replay.controller().get_game()->get_treasury() == 48);
+    std::remove("test_engine.rec");
+}
+
+TEST_CASE("Assets - font is compiled into the binary") {
+    const EmbeddedAsset* font = findAsset("DejaVuSans.ttf");
+    REQUIRE(font != nullptr);
+    REQUIRE(font->size > 4);
+    // TrueType files start with the sfnt version 0x00010000
+    CHECK(font->data[0] == 0x00);
+    CHECK(font->data[1] == 0x01);
+    CHECK(font->data[2] == 0x00);
+    CHECK(font->data[3] == 0x00);
+    CHECK(findAsset("missing.png") == nullptr);
+}
+
+TEST_CASE("FrameProfiler - rolling windows and percentiles") {
+    SampleWindow window;
+    CHECK(window.size() == 0);
+    CHECK(window.percentile(50) == 0.0f);
+
+    for (int i = 1; i <= 100; ++i) {
+        window.add(static_cast<float>(i));
+    }
+    CHECK(window.size() == 100);
+    CHECK(window.at(0) == 1.0f);
+    CHECK(window.latest() == 100.0f);
+    CHECK(window.percentile(50) == 50.0f);
+    CHECK(window.percentile(99) == 99.0f);
+    CHECK(window.percentile(100) == 100.0f);
+    CHECK(window.max() == 100.0f);
+
+    // Once full, the oldest samples fall out of the window
+    for (std::size_t i = 0; i < SampleWindow::CAPACITY; ++i) {
+        window.add(2.0f);
+    }
+    CHECK(window.size() == SampleWindow::CAPACITY);
+    CHECK(window.max() == 2.0f);
+    CHECK(window.percentile(99) == 2.0f);
+
+    FrameProfiler profiler;
+    profiler.beginFrame();
+    CHECK(profiler.samples(ProfileChannel::Frame).size() == 0);
+    {
+        FrameProfiler::Scope scope(profiler, ProfileChannel::Render);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    profiler.beginFrame();
+    CHECK(profiler.samples(ProfileChannel::Render).size() == 1);
+    CHECK(profiler.samples(ProfileChannel::Render).latest() >= 2.0f);
+    CHECK(profiler.samples(ProfileChannel::Frame).latest() >= profiler.samples(ProfileChannel::Render).latest());
+    profiler.reset();
+    CHECK(profiler.samples(ProfileChannel::Frame).size() == 0);
+}
+
+TEST_CASE("Bot - Monte Carlo and random bots choose legal moves") {
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    auto governor = std::make_shared<Governor>(game, "Alice");
+    auto spy = std::make_shared<Spy>(game, "Bob");
+    game->add_player(governor);
+    game->add_player(spy);
+    governor->add_coins(7);
+    spy->add_coins(7);
+    GameController controller(game);
+    controller.startGame();
+
+    // A coup wins on the spot; anything else gives Bob the chance to coup first
+    BotPosition position = BotPosition::capture(controller, 0);
+    MonteCarloBot bot(3, 300);
+    RecordedMove move = bot.decide(position, Bot::Clock::now() + std::chrono::seconds(10));
+    CHECK(bot.lastRollouts() == 300);
+    CHECK(move.kind == RecordedMove::Kind::Action);
+    CHECK(move.action == ActionType::Coup);
+    CHECK(move.seat == 1);
+    // The bot searched a copy; the live game is untouched
+    CHECK(governor->get_coins() == 7);
+    CHECK(spy->is_active());
+    CHECK(controller.phase() == GamePhase::Playing);
+
+    // A block decision is answered with a block by the bot's own seat or a pass
+    auto merchantGame = std::make_shared<Game>();
+    merchantGame->set_verbose(false);
+    merchantGame->add_player(std::make_shared<Merchant>(merchantGame, "Merchant"));
+    merchantGame->add_player(std::make_shared<Governor>(merchantGame, "Governor"));
+    GameController blockController(merchantGame);
+    blockController.startGame();
+    blockController.requestAction(ActionType::Tax);
+    REQUIRE(blockController.phase() == GamePhase::BlockPending);
+    BotPosition blockPosition = BotPosition::capture(blockController, 1);
+    RandomBot randomBot(9);
+    for (int i = 0; i < 10; ++i) {
+        RecordedMove answer = randomBot.decide(blockPosition, Bot::Clock::now());
+        bool valid = answer.kind == RecordedMove::Kind::Pass ||
+                     (answer.kind == RecordedMove::Kind::Block && answer.seat == 1);
+        CHECK(valid);
+    }
+    RecordedMove answer = bot.decide(blockPosition, Bot::Clock::now() + std::chrono::seconds(10));
+    CHECK((answer.kind == RecordedMove::Kind::Pass || answer.kind == RecordedMove::Kind::Block));
+    GameRecord::play(blockController, answer);
+    CHECK(blockController.phase() == GamePhase::Playing);
+
+    CHECK(createBot("random", 1)->name() == "random");
+    CHECK_THROWS_AS(createBot("oracle", 1), GameException);
+    CHECK(createBot("montecarlo:8", 1)->name() == "montecarlo");
+    CHECK_THROWS_AS(createBot("montecarlo:x", 1), GameException);
+    CHECK_THROWS_AS(createBot("montecarlo:0", 1), GameException);
+}
+
+TEST_CASE("EngineThread - bots play through the thread pool") {
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    {
+        EngineThread engine(game, "", std::chrono::milliseconds(2));
+        engine.addBot("Bot 1", "random");
+        engine.addBot("Bot 2");
+        engine.addBot("Bot 3", "random");
+        engine.startGame();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while (engine.snapshot().phase != GamePhase::GameOver && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        const GameSnapshot& snapshot = engine.snapshot();
+        CHECK(snapshot.phase == GamePhase::GameOver);
+        CHECK(snapshot.winnerSeat < 3);
+        CHECK(snapshot.botSeats == 0x07);
+        CHECK(snapshot.botDecisionCount > 0);
+        CHECK(snapshot.botDecisionP99Micros >= snapshot.botDecisionP50Micros);
+    }
+
+    // Humans cannot move for a bot, and a long search is cancelled on shutdown
+    auto mixed = std::make_shared<Game>();
+    mixed->set_verbose(false);
+    auto start = std::chrono::steady_clock::now();
+    {
+        EngineThread engine(mixed, "", std::chrono::seconds(30));
+        engine.addPlayer("Alice");
+        engine.addBot("Bot");
+        engine.startGame();
+        engine.action(ActionType::Gather);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!engine.snapshot().botThinking && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE(engine.snapshot().botThinking);
+        CHECK(engine.snapshot().currentSeat == 1);
+        CHECK(engine.snapshot().isBot(1));
+        CHECK_FALSE(engine.snapshot().isBot(0));
+
+        std::uint32_t messages = engine.snapshot().messageCount;
+        engine.action(ActionType::Tax);
+        deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (engine.snapshot().messageCount == messages && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(std::string(engine.snapshot().message) == "Waiting for Bot (bot)");
+    }
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+}
+
+TEST_CASE("TerminalScreen - only changed cells are redrawn") {
+    TerminalScreen screen(4, 20);
+    screen.put(0, 0, "Treasury: 50", CellStyle::Highlight);
+    screen.put(2, 18, "clipped");
+    CHECK(screen.at(2, 19) == 'l');
+    CHECK(screen.at(3, 25) == ' ');
+
+    std::string first = screen.flush();
+    CHECK(first.find("\x1b[2J") != std::string::npos);
+    CHECK(first.find("Treasury: 50") != std::string::npos);
+
+    // Redrawing the same frame sends nothing
+    screen.clear();
+    screen.put(0, 0, "Treasury: 50", CellStyle::Highlight);
+    screen.put(2, 18, "clipped");
+    CHECK(screen.flush().empty());
+
+    // A changed digit is one cursor move and the changed span only
+    screen.clear();
+    screen.put(0, 0, "Treasury: 49", CellStyle::Highlight);
+    screen.put(2, 18, "clipped");
+    std::string update = screen.flush();
+    CHECK(update.find("\x1b[1;11H") != std::string::npos);
+    CHECK(update.find("49") != std::string::npos);
+    CHECK(update.find("Treasury") == std::string::npos);
+    CHECK(update.find("\x1b[2J") == std::string::npos);
+
+    screen.resize(5, 20);
+    screen.put(0, 0, "Treasury: 49", CellStyle::Highlight);
+    CHECK(screen.flush().find("\x1b[2J") != std::string::npos);
+
+    std::vector<TerminalKey> keys;
+    decodeTerminalKeys("a\r\x1b[5~\x1b[B\x7f\t\x03\x1b", keys);
+    REQUIRE(keys.size() == 8);
+    CHECK(keys[0].kind == TerminalKey::Kind::Char);
+    CHECK(keys[0].ch == 'a');
+    CHECK(keys[1].kind == TerminalKey::Kind::Enter);
+    CHECK(keys[2].kind == TerminalKey::Kind::PageUp);
+    CHECK(keys[3].kind == TerminalKey::Kind::Down);
+    CHECK(keys[4].kind == TerminalKey::Kind::Backspace);
+    CHECK(keys[5].kind == TerminalKey::Kind::Tab);
+    CHECK(keys[6].kind == TerminalKey::Kind::Interrupt);
+    CHECK(keys[7].kind == TerminalKey::Kind::Escape);
+}
+
+TEST_CASE("SimStats - per-thread counters, intervals and exports") {
+    Interval half = wilsonInterval(50, 100);
+    CHECK(half.estimate == doctest::Approx(0.5));
+    CHECK(half.low == doctest::Approx(0.4038).epsilon(0.001));
+    CHECK(half.high == doctest::Approx(0.5962).epsilon(0.001));
+    Interval none = wilsonInterval(0, 20);
+    CHECK(none.low == 0.0);
+    CHECK(none.high > 0.0);
+    CHECK(wilsonInterval(0, 0).high == 1.0);
+    Interval mean = meanInterval(6.0, 14.0, 3);  // samples 1, 2, 3
+    CHECK(mean.estimate == doctest::Approx(2.0));
+    CHECK(mean.high - mean.estimate == doctest::Approx(1.96 / std::sqrt(3.0)));
+
+    SimConfig config;
+    config.games = 24;
+    config.seed = 7;
+    config.threads = 1;
+    SimStats single = runSimulation(config);
+    config.threads = 3;
+    SimStats multi = runSimulation(config);
+
+    const SimCounters& totals = multi.counters();
+    CHECK(totals.games == 24);
+    CHECK(multi.threads() == 3);
+    std::uint64_t wins = 0;
+    std::uint64_t seats = 0;
+    std::uint64_t dealt = 0;
+    for (std::size_t players = 0; players <= MAX_SEATS; ++players) {
+        for (std::size_t seat = 0; seat < MAX_SEATS; ++seat) {
+            wins += totals.seatWins[players][seat];
+            seats += totals.seatGames[players][seat];
+        }
+        for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+            dealt += totals.roleGames[players][role];
+        }
+    }
+    CHECK(wins == totals.games - totals.truncated);
+    CHECK(dealt == seats);
+    CHECK(totals.actions[static_cast<std::size_t>(ActionType::Coup)] == totals.coups);
+    CHECK(totals.forcedCoups <= totals.coups);
+    CHECK(totals.turnQuantiles.count() == static_cast<double>(totals.games - totals.truncated));
+    CHECK(totals.eliminationCoins.count() == static_cast<double>(totals.coups));
+    CHECK(multi.gameLengthQuantile(0.5) <= multi.gameLengthQuantile(0.99));
+    CHECK(roleIndex(roleName(3)) == 3);
+    CHECK(roleIndex("Jester") == ROLE_COUNT);
+
+    // Games are seeded by index, so the thread count does not change the totals
+    std::ostringstream singleCsv;
+    std::ostringstream multiCsv;
+    single.writeCsv(singleCsv);
+    multi.writeCsv(multiCsv);
+    CHECK(singleCsv.str() == multiCsv.str());
+    CHECK(singleCsv.str().rfind("metric,key,players,count,total,value,ci_low,ci_high\n", 0) == 0);
+    CHECK(singleCsv.str().find("role_win,Governor,all,") != std::string::npos);
+
+    std::ostringstream json;
+    multi.writeJson(json);
+    CHECK(json.str().rfind("{\"games\":24,", 0) == 0);
+    CHECK(json.str().find("\"forced_coups\":{") != std::string::npos);
+
+    config.minPlayers = 1;
+    CHECK_THROWS_AS(runSimulation(config), GameException);
+}
+
+TEST_CASE("QuantileSketch - bounded memory and mergeable") {
+    QuantileSketch empty;
+    CHECK(empty.count() == 0.0);
+    CHECK(empty.quantile(0.5) == 0.0);
+
+    // Four interleaved streams of 0..99999, as four threads would see them
+    std::array<QuantileSketch, 4> parts;
+    QuantileSketch whole;
+    for (int i = 0; i < 100000; ++i) {
+        int value = (i * 7919) % 100000;
+        parts[static_cast<std::size_t>(i % 4)].add(value);
+        whole.add(value);
+    }
+    QuantileSketch merged;
+    for (const auto& part : parts) {
+        merged.merge(part);
+    }
+    for (const QuantileSketch* sketch : {&whole, &merged}) {
+        CHECK(sketch->count() == 100000.0);
+        CHECK(sketch->min() == 0.0);
+        CHECK(sketch->max() == 99999.0);
+        CHECK(sketch->quantile(0.0) == 0.0);
+        CHECK(sketch->quantile(1.0) == 99999.0);
+        CHECK(sketch->quantile(0.5) == doctest::Approx(50000.0).epsilon(0.01));
+        CHECK(sketch->quantile(0.99) == doctest::Approx(99000.0).epsilon(0.005));
+        CHECK(sketch->quantile(0.01) == doctest::Approx(1000.0).epsilon(0.1));
+        CHECK(sketch->centroidCount() <= QuantileSketch::CAPACITY);
+    }
+
+    QuantileSketch small;
+    for (int value : {5, 1, 4, 2, 3}) {
+        small.add(value);
+    }
+    CHECK(small.quantile(0.5) == doctest::Approx(3.0));
+    small.clear();
+    CHECK(small.count() == 0.0);
+}
+
+TEST_CASE("Tournament - SPRT stops bot matches early") {
+    SprtTest sprt(0.0, 50.0, 0.05, 0.05);
+    CHECK(sprt.lowerBound() == doctest::Approx(std::log(0.05 / 0.95)));
+    CHECK(sprt.upperBound() == doctest::Approx(std::log(0.95 / 0.05)));
+    CHECK(sprt.llr() == 0.0);
+    CHECK(sprt.decision() == SprtDecision::Continue);
+
+    // Draws count half each way, so they move the ratio like one win and one loss
+    SprtTest drawn;
+    drawn.add(0, 2, 0);
+    SprtTest split;
+    split.add(1, 0, 1);
+    CHECK(drawn.llr() == doctest::Approx(split.llr()));
+
+    SprtTest strong;
+    strong.add(70, 0, 30);
+    CHECK(strong.decision() == SprtDecision::AcceptH1);
+    double low = 0.0;
+    double high = 0.0;
+    CHECK(strong.eloEstimate(low, high) == doctest::Approx(147.2).epsilon(0.01));
+    CHECK(low < 147.0);
+    CHECK(high > 147.3);
+    SprtTest even;
+    even.add(250, 0, 250);
+    CHECK(even.decision() == SprtDecision::AcceptH0);
+    CHECK(even.eloEstimate(low, high) == doctest::Approx(0.0));
+
+    CHECK_THROWS_AS(SprtTest(0.0, 0.0), GameException);
+    CHECK_THROWS_AS(SprtTest(0.0, 50.0, 0.0, 0.05), GameException);
+    CHECK_THROWS_AS(SprtTest(0.0, 50.0, 0.05, 0.7), GameException);
+
+    TournamentConfig config;
+    config.candidate = "random";
+    config.baseline = "random";
+    config.batchPairs = 4;
+    config.maxGames = 16;
+    std::uint64_t wins = 0;
+    std::uint64_t draws = 0;
+    std::uint64_t losses = 0;
+    playMatchPair(config, 3, wins, draws, losses);
+    CHECK(wins + draws + losses == 2);
+
+    // Same configuration, different thread counts: identical results
+    config.threads = 1;
+    TournamentResult one = runTournament(config);
+    config.threads = 3;
+    TournamentResult three = runTournament(config);
+    CHECK(one.sprt.games() == 16);
+    CHECK(one.batches == 2);
+    CHECK(one.sprt.wins() == three.sprt.wins());
+    CHECK(one.sprt.losses() == three.sprt.losses());
+    CHECK(one.decision == three.decision);
+
+    config.baseline = "montecarlo";
+    CHECK_THROWS_AS(runTournament(config), GameException);
+    config.baseline = "oracle";
+    CHECK_THROWS_AS(runTournament(config), GameException);
+}
+
+TEST_CASE("RuleSet - rule variants compared on common seeds") {
+    RuleSet variant;
+    variant.governorTax = 2;
+    variant.merchantThreshold = 4;
+    variant.merchantBonus = 2;
+    auto game = std::make_shared<Game>();
+    game->set_rules(variant);
+    auto governor = std::make_shared<Governor>(game, "Governor");
+    auto merchant = std::make_shared<Merchant>(game, "Merchant");
+    game->add_player(governor);
+    game->add_player(merchant);
+    game->start_game();
+    CHECK_THROWS_AS(game->set_rules(RuleSet()), GameException);
+    governor->tax();
+    CHECK(governor->get_coins() == 2);
+    merchant->add_coins(3);
+    merchant->on_turn_start();
+    CHECK(merchant->get_coins() == 3);  // Below the raised threshold
+    merchant->add_coins(1);
+    merchant->on_turn_start();
+    CHECK(merchant->get_coins() == 6);
+    RuleSet negative;
+    negative.taxAmount = -1;
+    CHECK_THROWS_AS(std::make_shared<Game>()->set_rules(negative), GameException);
+
+    // Seeded dealing repeats; rules survive records and bot positions
+    std::mt19937 first(3);
+    std::mt19937 second(3);
+    auto dealer = std::make_shared<Game>();
+    for (int i = 0; i < 8; ++i) {
+        CHECK(dealer->create_random_player("A", first)->role() == dealer->create_random_player("B", second)->role());
+    }
+    GameRecord record;
+    record.captureSeats(*game);
+    CHECK(record.rules == variant);
+    record.save("test_rules.rec");
+    GameRecord loaded = GameRecord::load("test_rules.rec");
+    std::remove("test_rules.rec");
+    CHECK(loaded.rules == variant);
+    CHECK(loaded.createGame()->get_rules() == variant);
+    GameController controller(loaded.createGame());
+    controller.startGame();
+    std::mt19937 rng(1);
+    CHECK(BotPosition::capture(controller, 0).instantiate(rng)->get_game()->get_rules() == variant);
+
+    CHECK(parseRules("governor-tax=2,merchant-threshold=4,merchant-bonus=2", RuleSet()) == variant);
+    CHECK(parseRules("", variant) == variant);
+    CHECK_THROWS_AS(parseRules("tax=x", RuleSet()), GameException);
+    CHECK_THROWS_AS(parseRules("bribe=5", RuleSet()), GameException);
+
+    // Same rules on both sides: every pair is identical, so the paired interval is empty
+    SimConfig config;
+    config.games = 6;
+    config.threads = 2;
+    RuleComparison same = compareRules(config, config.rules);
+    CHECK(same.counters().games == 6);
+    for (std::size_t role = 0; role < ROLE_COUNT; ++role) {
+        CHECK(same.counters().roleSplits[role] == 0);
+        PairedDelta delta = same.roleWinDelta(role);
+        CHECK(delta.paired.estimate == 0.0);
+        CHECK(delta.paired.high - delta.paired.low == 0.0);
+        CHECK(delta.unpaired.high - delta.unpaired.low >= 0.0);
+    }
+    CHECK(same.gameLengthDelta().paired.estimate == 0.0);
+
+    RuleComparison changed = compareRules(config, variant);
+    std::ostringstream csv;
+    changed.writeCsv(csv);
+    CHECK(csv.str().find("role_win_rate,Governor,") != std::string::npos);
+    std::ostringstream summary;
+    changed.writeSummary(summary);
+    CHECK(summary.str().find("6 game pairs") != std::string::npos);
+}
+
+TEST_CASE("League - free-for-all ratings from parallel games") {
+    RatingTable table;
+    std::size_t first = table.add("A");
+    std::size_t second = table.add("B");
+    std::size_t third = table.add("C");
+    table.update({first, second, third}, {0, 1, 2});
+    CHECK(table.rating(first).mu > 25.0);
+    CHECK(table.rating(third).mu < 25.0);
+    CHECK(table.rating(first).mu > table.rating(second).mu);
+    CHECK(table.rating(second).mu > table.rating(third).mu);
+    CHECK(table.rating(first).sigma < 25.0 / 3.0);
+    CHECK(table.rating(first).elo + table.rating(second).elo + table.rating(third).elo == doctest::Approx(4500.0));
+    CHECK(table.rating(first).wins == 1);
+    CHECK(table.rating(second).games == 1);
+    CHECK(table.standings() == std::vector<std::size_t>{first, second, third});
+
+    // A shared place moves both players alike
+    RatingTable tied;
+    tied.add("A");
+    tied.add("B");
+    tied.update({0, 1}, {0, 0});
+    CHECK(tied.rating(0).mu == doctest::Approx(tied.rating(1).mu));
+    CHECK(tied.rating(0).elo == doctest::Approx(1500.0));
+    CHECK(tied.rating(0).wins == 0);
+    CHECK_THROWS_AS(tied.update({0, 0}, {0, 1}), GameException);
+    CHECK_THROWS_AS(tied.update({0, 5}, {0, 1}), GameException);
+    CHECK_THROWS_AS(tied.update({0, 1}, {0}), GameException);
+    std::ostringstream csv;
+    table.writeCsv(csv);
+    CHECK(csv.str().find("1,A,") != std::string::npos);
+
+    LeagueConfig config;
+    config.bots = {"random", "random", "random", "random"};
+    config.tableSize = 3;
+    config.rounds = 2;
+    config.threads = 1;
+    LeagueResult one = runLeague(config);
+    CHECK(one.games == 8);  // Four groups of three, twice
+    CHECK(one.ratings.name(1) == "random#2");
+    std::uint64_t games = 0;
+    for (std::size_t i = 0; i < one.ratings.size(); ++i) {
+        games += one.ratings.rating(i).games;
+    }
+    CHECK(games == 24);
+    config.threads = 2;
+    LeagueResult two = runLeague(config);
+    for (std::size_t i = 0; i < one.ratings.size(); ++i) {
+        CHECK(one.ratings.rating(i).mu == two.ratings.rating(i).mu);
+    }
+
+    // Swiss: five entrants at tables of two play two games a round, one sits out
+    config.format = LeagueFormat::Swiss;
+    config.bots.push_back("random");
+    config.tableSize = 2;
+    config.rounds = 3;
+    CHECK(runLeague(config).games == 6);
+
+    config.tableSize = 6;
+    CHECK_THROWS_AS(runLeague(config), GameException);
+    config.tableSize = 2;
+    config.bots.push_back("montecarlo");
+    CHECK_THROWS_AS(runLeague(config), GameException);
+}
+
+TEST_CASE("SelfPlay - features, move slots and NumPy chunks") {
+    auto game = std::make_shared<Game>();
+    game->add_player(std::make_shared<Merchant>(game, "Merchant"));
+    game->add_player(std::make_shared<Governor>(game, "Governor"));
+    game->add_player(std::make_shared<Spy>(game, "Spy"));
+    GameController controller(game);
+    controller.startGame();
+
+    // Seats are listed from the decider's point of view
+    std::array<float, FEATURE_COUNT> fromFirst;
+    std::array<float, FEATURE_COUNT> fromSecond;
+    encodeFeatures(controller, 0, fromFirst.data());
+    encodeFeatures(controller, 1, fromSecond.data());
+    std::size_t governor = 8 + roleIndex("Governor");
+    CHECK(fromSecond[GLOBAL_FEATURES + governor] == 1.0f);
+    // Other seats show the beliefs, never their hidden roles
+    CHECK(fromFirst[GLOBAL_FEATURES + SEAT_FEATURES + governor] == doctest::Approx(1.0 / 6.0));
+    CHECK(fromFirst[GLOBAL_FEATURES + 6] == 1.0f);  // Seat 0 is to move
+    CHECK(fromSecond[GLOBAL_FEATURES + 2 * SEAT_FEATURES + 6] == 1.0f);
+    CHECK(fromFirst[GLOBAL_FEATURES + 3 * SEAT_FEATURES] == 0.0f);  // No fourth seat
+    CHECK(featureName(GLOBAL_FEATURES + SEAT_FEATURES + 2) == "seat1.coins");
+
+    // The mask marks exactly the slots of the legal moves, and slots map back
+    std::array<Move, MAX_MOVES> moves;
+    std::size_t count = controller.legalMoves(moves);
+    std::array<std::uint8_t, MOVE_SLOTS> mask;
+    std::size_t legal = legalMask(controller, 0, mask.data());
+    std::size_t marked = 0;
+    for (std::uint8_t slot : mask) {
+        marked += slot;
+    }
+    CHECK(legal == marked);
+    CHECK(legal == count);
+    for (std::size_t i = 0; i < count; ++i) {
+        RecordedMove move{RecordedMove::Kind::Action, moves[i].action, moves[i].target};
+        std::size_t slot = moveSlot(move, 0, 3);
+        CHECK(mask[slot] == 1);
+        RecordedMove back = slotMove(slot, 0, 3);
+        CHECK(back.action == move.action);
+        CHECK(back.seat == move.seat);
+    }
+    CHECK(moveSlot(RecordedMove{RecordedMove::Kind::Action, ActionType::Coup, 2}, 1, 3) ==
+          static_cast<std::size_t>(ActionType::Coup) * (MAX_SEATS + 1) + 1);
+
+    // A block decision sees the pending action and who asked for it
+    controller.requestAction(ActionType::Tax);
+    REQUIRE(controller.phase() == GamePhase::BlockPending);
+    std::array<float, FEATURE_COUNT> blocker;
+    encodeFeatures(controller, 1, blocker.data());
+    CHECK(blocker[1] == 1.0f);
+    CHECK(blocker[5 + static_cast<std::size_t>(ActionType::Tax)] == 1.0f);
+    CHECK(blocker[5 + MOVE_TYPES + 2] == 1.0f);  // The actor sits two places on
+    CHECK(legalMask(controller, 1, mask.data()) == 2);
+    CHECK(mask[BLOCK_SLOT] == 1);
+    CHECK(mask[PASS_SLOT] == 1);
+
+    // .npy headers are padded so the data starts on a 64-byte boundary
+    std::array<std::uint8_t, 3> values = {1, 2, 3};
+    writeNpy("test_array.npy", "|u1", {3}, values.data(), values.size());
+    std::ifstream npy("test_array.npy", std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(npy)), std::istreambuf_iterator<char>());
+    npy.close();
+    std::remove("test_array.npy");
+    REQUIRE(bytes.size() % 64 == 3);
+    CHECK(bytes.compare(0, 6, "\x93NUMPY") == 0);
+    CHECK(bytes.find("'shape': (3,)") != std::string::npos);
+    CHECK(bytes[bytes.size() - 4] == '\n');
+    CHECK(bytes[bytes.size() - 3] == 1);
+
+    SelfPlayConfig config;
+    config.directory = "test_selfplay";
+    config.games = 12;
+    config.threads = 1;
+    config.minPlayers = 2;
+    config.maxPlayers = 4;
+    config.chunkRows = 40;
+    SelfPlayResult one = runSelfPlay(config);
+    CHECK(one.games == 12);
+    CHECK(one.rows > 0);
+    CHECK(one.chunks >= 2);
+    std::ifstream manifest("test_selfplay/manifest.json");
+    std::string text((std::istreambuf_iterator<char>(manifest)), std::istreambuf_iterator<char>());
+    CHECK(text.find("\"rows\": " + std::to_string(one.rows)) != std::string::npos);
+    CHECK(text.find("\"Coup+2\"") != std::string::npos);
+    std::uintmax_t actionBytes = std::filesystem::file_size("test_selfplay/chunk-000000.action.npy");
+    CHECK(actionBytes > 128);  // Padded header, then one byte per row
+
+    // Every finished game has one winning seat among its rows
+    std::ifstream outcomes("test_selfplay/chunk-000000.outcome.npy", std::ios::binary);
+    std::string column((std::istreambuf_iterator<char>(outcomes)), std::istreambuf_iterator<char>());
+    CHECK(column.find('\x01', 128) != std::string::npos);
+
+    config.threads = 2;
+    SelfPlayResult two = runSelfPlay(config);
+    CHECK(two.rows == one.rows);
+    std::filesystem::remove_all("test_selfplay");
+
+    // Rejected moves never reach the hook, so every label is legal in its row
+    GameRecord judges;
+    for (const char* role : {"Judge", "Judge", "Governor", "Judge"}) {
+        judges.seats.push_back(SeatRecord{std::string("P") + role, role});
+    }
+    bool labelsLegal = true;
+    for (std::uint32_t seed = 0; seed < 20; ++seed) {
+        std::vector<std::unique_ptr<Bot>> bots;
+        std::vector<Bot*> seats;
+        for (std::uint32_t seat = 0; seat < 4; ++seat) {
+            bots.push_back(std::make_unique<RandomBot>(seed * 4 + seat));
+            seats.push_back(bots.back().get());
+        }
+        playBotGame(judges, seats, 300, nullptr,
+                    [&](const GameController& position, std::uint8_t seat, const RecordedMove& move) {
+                        if (position.phase() == GamePhase::Playing) {
+                            legalMask(position, seat, mask.data());
+                            labelsLegal = labelsLegal && mask[moveSlot(move, seat, 4)] == 1;
+                        }
+                    });
+    }
+    CHECK(labelsLegal);
+
+    config.bot = "montecarlo";
+    CHECK_THROWS_AS(runSelfPlay(config), GameException);
+    config.bot = "random";
+    config.maxPlayers = 7;
+    CHECK_THROWS_AS(runSelfPlay(config), GameException);
+}
+
+TEST_CASE("Network - policy/value inference with SIMD and scalar kernels") {
+    PolicyValueNet net({FEATURE_COUNT, 64, 32, MOVE_SLOTS + 1}, 7);
+    CHECK(net.inputs() == FEATURE_COUNT);
+    CHECK(net.policyOutputs() == MOVE_SLOTS);
+
+    // Five rows: one block of four and a leftover row in the AVX2 kernel
+    constexpr std::size_t BATCH = 5;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<float> inputs(BATCH * FEATURE_COUNT);
+    for (float& input : inputs) {
+        input = value(rng);
+    }
+    std::vector<float> policy(BATCH * MOVE_SLOTS);
+    std::vector<float> values(BATCH);
+    net.evaluate(inputs.data(), BATCH, policy.data(), values.data());
+    net.setSimd(false);
+    CHECK_FALSE(net.simdEnabled());
+    std::vector<float> scalarPolicy(BATCH * MOVE_SLOTS);
+    std::vector<float> scalarValues(BATCH);
+    net.evaluate(inputs.data(), BATCH, scalarPolicy.data(), scalarValues.data());
+    for (std::size_t i = 0; i < policy.size(); ++i) {
+        CHECK(policy[i] == doctest::Approx(scalarPolicy[i]).epsilon(1e-4));
+    }
+    for (std::size_t b = 0; b < BATCH; ++b) {
+        CHECK(values[b] == doctest::Approx(scalarValues[b]).epsilon(1e-4));
+        CHECK(std::abs(values[b]) <= 1.0f);
+    }
+
+    // A row evaluates the same alone as in a batch
+    float single = 0.0f;
+    net.evaluate(inputs.data() + 4 * FEATURE_COUNT, 1, nullptr, &single);
+    CHECK(single == scalarValues[4]);
+
+    net.save("test_net.bin");
+    PolicyValueNet loaded = PolicyValueNet::load("test_net.bin");
+    CHECK(loaded.layerSizes() == net.layerSizes());
+    loaded.setSimd(false);
+    std::vector<float> loadedPolicy(BATCH * MOVE_SLOTS);
+    loaded.evaluate(inputs.data(), BATCH, loadedPolicy.data(), nullptr);
+    CHECK(loadedPolicy == scalarPolicy);
+
+    std::array<float, 4> logits = {1.0f, 5.0f, 2.0f, 0.0f};
+    std::array<std::uint8_t, 4> legal = {1, 0, 1, 1};
+    std::array<float, 4> probabilities;
+    maskedSoftmax(logits.data(), legal.data(), 4, probabilities.data());
+    CHECK(probabilities[1] == 0.0f);
+    CHECK(probabilities[0] + probabilities[2] + probabilities[3] == doctest::Approx(1.0f));
+    CHECK(probabilities[2] > probabilities[0]);
+
+    // The search bot uses the network for priors and leaf values
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    game->add_player(std::make_shared<Merchant>(game, "P1"));
+    game->add_player(std::make_shared<Governor>(game, "P2"));
+    game->add_player(std::make_shared<Baron>(game, "P3"));
+    GameController controller(game);
+    controller.startGame();
+    auto bot = createBot("netmc:24:test_net.bin", 1);
+    CHECK(bot->name() == "netmc");
+    RecordedMove move = bot->decide(BotPosition::capture(controller, 0), Bot::Clock::time_point::max());
+    CHECK(move.kind == RecordedMove::Kind::Action);
+    CHECK(static_cast<MonteCarloBot&>(*bot).lastRollouts() == 24);
+    CHECK_NOTHROW(GameRecord::play(controller, move));
+    CHECK_NOTHROW(checkMatchBot("netmc:24:test_net.bin"));
+
+    std::ofstream("test_net.bin", std::ios::binary | std::ios::app) << 'x';
+    CHECK_THROWS_AS(PolicyValueNet::load("test_net.bin"), GameException);
+    std::ofstream("test_net.bin", std::ios::binary | std::ios::trunc) << "COUPNET0";
+    CHECK_THROWS_AS(PolicyValueNet::load("test_net.bin"), GameException);
+    std::remove("test_net.bin");
+    CHECK_THROWS_AS(PolicyValueNet::load("test_net.bin"), GameException);
+    CHECK_THROWS_AS(createBot("netmc:24", 1), GameException);
+    auto small = std::make_shared<const PolicyValueNet>(std::vector<std::size_t>{4, 3}, 1);
+    CHECK_THROWS_AS(MonteCarloBot(1, 8, small), GameException);
+    CHECK_THROWS_AS(PolicyValueNet({FEATURE_COUNT, 0, 3}, 1), GameException);
+}
+
+TEST_CASE("EvalQueue - batched leaf evaluation from several searches") {
+    auto net = std::make_shared<const PolicyValueNet>(std::vector<std::size_t>{FEATURE_COUNT, 32, MOVE_SLOTS + 1}, 5);
+    constexpr std::size_t ROWS = 40;
+    std::vector<float> inputs(4 * ROWS * FEATURE_COUNT);
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> value(0.0f, 1.0f);
+    for (float& input : inputs) {
+        input = value(rng);
+    }
+    std::vector<float> expected(4 * ROWS);
+    net->evaluate(inputs.data(), 4 * ROWS, nullptr, expected.data());
+
+    // Four searches queue all their leaves before waiting for any
+    std::vector<float> results(4 * ROWS);
+    {
+        EvalQueue queue(net, 64);
+        std::vector<std::thread> searches;
+        for (std::size_t t = 0; t < 4; ++t) {
+            searches.emplace_back([&queue, &inputs, &results, t]() {
+                std::vector<EvalQueue::Slot> slots(ROWS);
+                for (std::size_t i = 0; i < ROWS; ++i) {
+                    queue.submit(inputs.data() + (t * ROWS + i) * FEATURE_COUNT, slots[i]);
+                }
+                for (std::size_t i = 0; i < ROWS; ++i) {
+                    queue.wait(slots[i]);
+                    results[t * ROWS + i] = slots[i].value;
+                }
+            });
+        }
+        for (auto& search : searches) {
+            search.join();
+        }
+        CHECK(queue.evaluations() == 4 * ROWS);
+        CHECK(queue.batches() >= 3);  // At most 64 rows a batch
+        CHECK(queue.batches() <= 4 * ROWS);
+    }
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        CHECK(results[i] == doctest::Approx(expected[i]).epsilon(1e-5));
+    }
+
+    // A lone search flushes its wave instead of waiting for a full batch
+    EvalQueue lone(net, 256, std::chrono::seconds(10));
+    EvalQueue::Slot slot;
+    lone.submit(inputs.data(), slot);
+    auto start = std::chrono::steady_clock::now();
+    lone.wait(slot);
+    CHECK(slot.isReady());
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+
+    // Searches with virtual loss stay reproducible however the batches fell
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    game->add_player(std::make_shared<Judge>(game, "P1"));
+    game->add_player(std::make_shared<Spy>(game, "P2"));
+    game->add_player(std::make_shared<General>(game, "P3"));
+    GameController controller(game);
+    controller.startGame();
+    BotPosition position = BotPosition::capture(controller, 0);
+    MonteCarloBot first(4, 100, net);
+    MonteCarloBot second(4, 100, net);
+    RecordedMove alone = first.decide(position, Bot::Clock::time_point::max());
+    RecordedMove together;
+    std::thread other([&]() { together = second.decide(position, Bot::Clock::time_point::max()); });
+    MonteCarloBot(8, 100, net).decide(position, Bot::Clock::time_point::max());
+    other.join();
+    CHECK(first.lastRollouts() == 100);
+    CHECK(alone.action == together.action);
+    CHECK(alone.seat == together.seat);
+}
+
+TEST_CASE("BeliefTracker - role beliefs from the event stream") {
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    game->add_player(std::make_shared<Governor>(game, "P1"));
+    game->add_player(std::make_shared<Merchant>(game, "P2"));
+    game->add_player(std::make_shared<Judge>(game, "P3"));
+    GameController controller(game);
+    BeliefTracker beliefs;
+    controller.setEventSink([&beliefs](const ActionRecord& record) { beliefs.observe(record); });
+    controller.startGame();
+    CHECK(beliefs.players() == 3);
+    CHECK(beliefs.probability(1, roleIndex("Spy")) == doctest::Approx(1.0 / 6.0));
+    CHECK(beliefs.knownRole(0) == ROLE_COUNT);
+
+    // The Governor collects 3; the Merchant's 2 rules the Governor out
+    controller.requestAction(ActionType::Tax);
+    CHECK(controller.phase() == GamePhase::Playing);
+    CHECK(beliefs.knownRole(0) == roleIndex("Governor"));
+    controller.requestAction(ActionType::Tax);
+    REQUIRE(controller.phase() == GamePhase::BlockPending);
+    controller.pass();
+    CHECK(beliefs.probability(1, roleIndex("Governor")) == 0.0f);
+    CHECK(beliefs.probability(1, roleIndex("Merchant")) == doctest::Approx(0.2));
+    CHECK(beliefs.knownRole(1) == ROLE_COUNT);
+
+    // Blocking a bribe reveals the Judge
+    controller.requestAction(ActionType::Gather);
+    controller.requestAction(ActionType::Gather);
+    controller.requestAction(ActionType::Gather);
+    controller.requestAction(ActionType::Gather);
+    controller.requestAction(ActionType::Bribe);
+    REQUIRE(controller.phase() == GamePhase::BlockPending);
+    controller.block(2);
+    CHECK(beliefs.knownRole(2) == roleIndex("Judge"));
+
+    std::mt19937 rng(1);
+    std::array<std::size_t, MAX_SEATS> roles{};
+    beliefs.sample(rng, roles);
+    CHECK(roles[0] == roleIndex("Governor"));
+    CHECK(roles[1] != roleIndex("Governor"));
+    CHECK(roles[2] == roleIndex("Judge"));
+    beliefs.reveal(1, roleIndex("Merchant"));
+    CHECK(beliefs.knownRole(1) == roleIndex("Merchant"));
+
+    // Over many random games the evidence never rules out a seat's true role
+    std::size_t revealed = 0;
+    for (std::uint32_t seed = 0; seed < 60; ++seed) {
+        std::mt19937 gameRng(seed);
+        auto random = std::make_shared<Game>();
+        random->set_verbose(false);
+        std::vector<std::size_t> truth;
+        for (int seat = 0; seat < 4; ++seat) {
+            auto player = random->create_random_player("P" + std::to_string(seat + 1), gameRng);
+            truth.push_back(roleIndex(player->role()));
+            random->add_player(player);
+        }
+        GameController table(random);
+        BeliefTracker tracker;
+        bool consistent = true;
+        table.setEventSink([&](const ActionRecord& record) {
+            tracker.observe(record);
+            for (std::uint8_t seat = 0; seat < truth.size(); ++seat) {
+                consistent = consistent && tracker.probability(seat, truth[seat]) > 0.0f;
+            }
+        });
+        table.startGame();
+        for (int step = 0; step < 400 && table.phase() != GamePhase::GameOver; ++step) {
+            try {
+                GameRecord::play(table, randomMove(table, gameRng));
+            } catch (const std::exception&) {
+            }
+        }
+        CHECK(consistent);
+        for (std::uint8_t seat = 0; seat < truth.size(); ++seat) {
+            if (tracker.knownRole(seat) < ROLE_COUNT) {
+                CHECK(tracker.knownRole(seat) == truth[seat]);
+                revealed++;
+            }
+        }
+    }
+    CHECK(revealed > 0);
+}
+
+TEST_CASE("BotPosition - hidden roles are dealt from the beliefs") {
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    game->add_player(std::make_shared<Governor>(game, "P1"));
+    game->add_player(std::make_shared<Merchant>(game, "P2"));
+    game->add_player(std::make_shared<Judge>(game, "P3"));
+    GameController controller(game);
+    controller.setMetered(false);  // Beliefs are kept either way
+    controller.startGame();
+    controller.requestAction(ActionType::Tax);  // Collecting 3 shows the Governor
+    REQUIRE(controller.phase() == GamePhase::Playing);
+    CHECK(controller.beliefs().knownRole(0) == roleIndex("Governor"));
+    CHECK(controller.beliefs().knownRole(2) == ROLE_COUNT);
+
+    // Only the deciding seat's own role is copied; the Merchant's is never known
+    BotPosition position = BotPosition::capture(controller, 2);
+    CHECK(position.seats[0].role.empty());
+    CHECK(position.seats[1].role.empty());
+    CHECK(position.seats[2].role == "Judge");
+    std::mt19937 rng(3);
+    std::array<bool, ROLE_COUNT> dealt = {};
+    bool consistent = true;
+    for (int deal = 0; deal < 60; ++deal) {
+        auto copy = position.instantiate(rng);
+        const auto& players = copy->get_game()->all_players();
+        consistent = consistent && players[0]->role() == "Governor" && players[2]->role() == "Judge" &&
+                     players[1]->get_coins() == game->all_players()[1]->get_coins();
+        dealt[roleIndex(players[1]->role())] = true;
+    }
+    CHECK(consistent);
+    CHECK(std::count(dealt.begin(), dealt.end(), true) > 2);
+
+    // Searches leave the live beliefs alone
+    auto search = position.instantiate(rng);
+    search->requestAction(ActionType::Tax);
+    CHECK(search->beliefs().knownRole(1) == ROLE_COUNT);
+    CHECK(controller.beliefs().knownRole(1) == ROLE_COUNT);
+
+    // With 3 coins a sanction fails against a hidden Judge, so it is never a candidate
+    auto judgeGame = std::make_shared<Game>();
+    judgeGame->set_verbose(false);
+    judgeGame->add_player(std::make_shared<Governor>(judgeGame, "P1"));
+    judgeGame->add_player(std::make_shared<Judge>(judgeGame, "P2"));
+    GameController judgeController(judgeGame);
+    judgeController.startGame();
+    auto sanctioner = judgeGame->all_players()[0];
+    sanctioner->add_coins(3);
+    sanctioner->set_sanctioned(true);
+    sanctioner->set_arrest_blocked(true);
+    ControllerState saved = judgeController.saveState();
+    bool accepted = true;
+    for (std::uint32_t seed = 0; seed < 10; ++seed) {
+        judgeController.restoreState(saved);
+        MonteCarloBot search(seed, 20);
+        RecordedMove move = search.decide(BotPosition::capture(judgeController, 0), Bot::Clock::time_point::max());
+        CHECK(move.action != ActionType::Sanction);
+        try {
+            GameRecord::play(judgeController, move);
+        } catch (const std::exception&) {
+            accepted = false;
+        }
+    }
+    CHECK(accepted);
+}
+
+TEST_CASE("Cfr - small game rules and CFR+ strategies") {
+    SmallConfig fourPlayers;
+    fourPlayers.players = 4;
+    CHECK_THROWS_AS(SmallGame{fourPlayers}, GameException);
+    SmallConfig config;
+    config.players = 2;
+    config.horizon = 4;
+    SmallGame game(config);
+    CHECK(game.dealCount() == 36);
+
+    // Seat 0 Governor, seat 1 General: the General blocks nothing with 3 coins
+    SmallState start = game.deal(0 + 6 * roleIndex("General"));
+    CHECK(game.actingSeat(start) == 0);
+    auto has = [](SmallActionMask legal, SmallAction action) { return (legal >> static_cast<unsigned>(action)) & 1u; };
+    SmallActionMask legal = game.legalActions(start);
+    CHECK(has(legal, SmallAction::Tax));
+    CHECK(has(legal, SmallAction::Sanction1));
+    CHECK_FALSE(has(legal, SmallAction::Arrest2));  // Only one opponent
+    CHECK_FALSE(has(legal, SmallAction::Invest));
+    SmallState taxed = game.apply(start, SmallAction::Tax);
+    CHECK(taxed.coins[0] == 6);
+    CHECK(game.actingSeat(taxed) == 1);
+
+    // The General's tax is blocked by the Governor, who is asked first
+    SmallState asked = game.apply(taxed, SmallAction::Tax);
+    CHECK(game.actingSeat(asked) == 0);
+    CHECK(game.legalActions(asked) == ((1u << static_cast<unsigned>(SmallAction::Block)) |
+                                       (1u << static_cast<unsigned>(SmallAction::Pass))));
+    CHECK(game.apply(asked, SmallAction::Block).coins[1] == 3);
+    CHECK(game.apply(asked, SmallAction::Pass).coins[1] == 5);
+    CHECK_FALSE(game.infoKey(asked, 0) == game.infoKey(taxed, 0));
+
+    // A sanctioned seat can neither gather nor tax on its next turn
+    SmallState sanctioned = game.apply(start, SmallAction::Sanction1);
+    CHECK_FALSE(has(game.legalActions(sanctioned), SmallAction::Gather));
+    SmallState arrested = game.apply(sanctioned, SmallAction::Arrest1);
+    CHECK(arrested.sanctioned == 0);
+    CHECK(arrested.coins[1] == 3);  // Nothing to take from a seat with no coins
+    CHECK(arrested.lastArrested == 0);
+    CHECK(game.isTerminal(game.apply(game.apply(game.apply(taxed, SmallAction::Gather), SmallAction::Gather),
+                                     SmallAction::Gather)));
+
+    // Scores always add up to 1
+    UniformPolicy uniform;
+    std::vector<double> fair = expectedUtilities(game, {&uniform, &uniform});
+    CHECK(fair[0] + fair[1] == doctest::Approx(1.0));
+
+    // The solved strategy beats uniform play from either seat
+    CfrSolver solver(game, 2);
+    CHECK(solver.infoSets() > 0);
+    solver.iterate(50);
+    CHECK(solver.iterations() == 50);
+    CfrStrategy strategy = solver.averageStrategy();
+    CHECK(strategy.size() == solver.infoSets());
+    double first = expectedUtilities(game, {&strategy, &uniform})[0];
+    double second = expectedUtilities(game, {&uniform, &strategy})[1];
+    CHECK(first > fair[0] + 0.05);
+    CHECK(second > fair[1] + 0.05);
+
+    // One thread gives the same strategy up to rounding
+    CfrSolver single(game, 1);
+    single.iterate(50);
+    CfrStrategy alone = single.averageStrategy();
+    CHECK(expectedUtilities(game, {&alone, &uniform})[0] == doctest::Approx(first).epsilon(1e-3));
+
+    // Save and load round trip
+    strategy.save("test_strategy.cfr");
+    CfrStrategy loaded = CfrStrategy::load("test_strategy.cfr");
+    CHECK(loaded.size() == strategy.size());
+    CHECK(loaded.config().horizon == 4);
+    CHECK(expectedUtilities(game, {&loaded, &uniform})[0] == doctest::Approx(first));
+    std::remove("test_strategy.cfr");
+    CHECK_THROWS_AS(CfrStrategy::load("missing.cfr"), GameException);
+
+    // Three players solve too
+    config.players = 3;
+    config.horizon = 2;
+    SmallGame three(config);
+    CfrSolver threeSolver(three);
+    threeSolver.iterate(10);
+    CfrStrategy threeStrategy = threeSolver.averageStrategy();
+    CHECK(expectedUtilities(three, {&threeStrategy, &uniform, &uniform})[0] >
+          expectedUtilities(three, {&uniform, &uniform, &uniform})[0]);
+}
+
+TEST_CASE("Exploitability - best responses to fixed small-game policies") {
+    SmallConfig config;
+    config.players = 2;
+    config.horizon = 4;
+    SmallGame game(config);
+    UniformPolicy uniform;
+    GreedyPolicy greedy;
+
+    // The reply's reported value is what it really scores when played out
+    BestResponse reply = bestResponse(game, {&uniform, &uniform}, 1, 2);
+    CHECK(reply.policy.seat() == 1);
+    CHECK(reply.policy.size() > 0);
+    CHECK(expectedUtilities(game, {&uniform, &reply.policy})[1] == doctest::Approx(reply.value));
+    CHECK(reply.value > expectedUtilities(game, {&uniform, &uniform})[1]);
+    CHECK_THROWS_AS(bestResponse(game, {&uniform, &uniform}, 2), GameException);
+    CHECK_THROWS_AS(bestResponse(game, {&uniform}, 0), GameException);
+
+    ExploitabilityReport random = exploitability(game, {&uniform, &uniform}, 1);
+    REQUIRE(random.bestResponseValues.size() == 2);
+    CHECK(random.bestResponseValues[1] == doctest::Approx(reply.value));
+    CHECK(random.policyValues[0] + random.policyValues[1] == doctest::Approx(1.0));
+    CHECK(random.nashConv > 0.1);
+    CHECK(random.exploitability == doctest::Approx(random.nashConv / 2));
+
+    // Greedy play is easy to punish too
+    ExploitabilityReport simple = exploitability(game, {&greedy, &greedy});
+    CHECK(simple.nashConv > 0.1);
+    CHECK(simple.bestResponseValues[1] > simple.policyValues[1]);
+
+    // CFR+ strategies are far harder to exploit, down to what the abstraction forgets
+    CfrSolver solver(game);
+    solver.iterate(30);
+    CfrStrategy strategy = solver.averageStrategy();
+    ExploitabilityReport solved = exploitability(game, {&strategy, &strategy}, 2);
+    CHECK(solved.exploitability < random.exploitability / 3);
+    CHECK(solved.exploitability >= 0.0);
+
+    // Three players
+    config.players = 3;
+    config.horizon = 3;
+    SmallGame three(config);
+    ExploitabilityReport triple = exploitability(three, {&uniform, &uniform, &uniform});
+    CHECK(triple.bestResponseValues.size() == 3);
+    for (std::size_t seat = 0; seat < 3; ++seat) {
+        CHECK(triple.bestResponseValues[seat] >= triple.policyValues[seat] - 1e-6);
+    }
+}
+
+TEST_CASE("PolicyTable - lookup-table rollout policies") {
+    auto builtin = PolicyTable::builtin();
+    CHECK(builtin == PolicyTable::builtin());
+    for (std::size_t c = 0; c < PolicyTable::CLASSES; ++c) {
+        CHECK(PolicyTable::actionClass(PolicyTable::classAction(c)) == c);
+    }
+    CHECK(PolicyTable::actionClass(ActionType::EndTurn) == PolicyTable::CLASSES);
+
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    game->add_player(std::make_shared<General>(game, "P1"));
+    game->add_player(std::make_shared<Governor>(game, "P2"));
+    game->add_player(std::make_shared<Baron>(game, "P3"));
+    GameController controller(game);
+    controller.startGame();
+
+    // Ten coins leave nothing but a coup
+    game->all_players()[0]->add_coins(10);
+    const std::uint8_t* forced = builtin->row(PolicyTable::actionKey(controller, 0));
+    CHECK(forced[PolicyTable::actionClass(ActionType::Coup)] == 255);
+    CHECK(forced[PolicyTable::actionClass(ActionType::Tax)] == 0);
+    std::mt19937 rng(3);
+    RecordedMove coup = builtin->move(controller, rng);
+    CHECK(coup.action == ActionType::Coup);
+    game->all_players()[0]->remove_coins(10);
+
+    // Drawn moves are always legal
+    for (int i = 0; i < 50; ++i) {
+        RecordedMove move = builtin->move(controller, rng);
+        REQUIRE(move.kind == RecordedMove::Kind::Action);
+        std::array<Move, MAX_MOVES> moves;
+        std::size_t count = controller.legalMoves(moves);
+        bool legal = false;
+        for (std::size_t m = 0; m < count; ++m) {
+            legal = legal || (moves[m].action == move.action && moves[m].target == move.seat);
+        }
+        CHECK(legal);
+    }
+
+    // A Governor nearly always blocks a tax; a General never does
+    controller.requestAction(ActionType::Tax);
+    REQUIRE(controller.phase() == GamePhase::BlockPending);
+    std::size_t governor = PolicyTable::blockKey(controller, 1);
+    std::size_t general = PolicyTable::blockKey(controller, 0);
+    REQUIRE(governor < PolicyTable::BLOCK_KEYS);
+    CHECK(builtin->blockChance(governor) == 230);
+    CHECK(builtin->blockChance(general) == 0);
+    CHECK(builtin->blockMove(controller, 0, rng).kind == RecordedMove::Kind::Pass);
+
+    // Blobs map back byte for byte, once per path
+    PolicyTable::Data data = builtin->bytes();
+    data.actions[0] = 7;
+    auto copy = PolicyTable::copy(data);
+    copy->save("test_table.lut");
+    auto mapped = PolicyTable::map("test_table.lut");
+    CHECK(mapped == PolicyTable::map("test_table.lut"));
+    CHECK(mapped->row(0)[0] == 7);
+    CHECK(std::memcmp(&mapped->bytes(), &data, sizeof(data)) == 0);
+    std::remove("test_table.lut");
+    std::ofstream("test_table_bad.lut", std::ios::binary) << "COUPLUT1";
+    CHECK_THROWS_AS(PolicyTable::map("test_table_bad.lut"), GameException);
+    std::remove("test_table_bad.lut");
+    CHECK_THROWS_AS(PolicyTable::map("test_table_bad.lut"), GameException);
+
+    // Bots
+    auto table = createBot("table", 1);
+    CHECK(table->name() == "table");
+    CHECK_NOTHROW(checkMatchBot("table"));
+    auto search = createBot("tablemc:8", 1);
+    CHECK(search->name() == "tablemc");
+    RecordedMove block = table->decide(BotPosition::capture(controller, 1), Bot::Clock::time_point::max());
+    CHECK(block.kind != RecordedMove::Kind::Action);
+    controller.pass();
+    REQUIRE(controller.phase() == GamePhase::Playing);
+    std::uint8_t seat = controller.seatOf(game->get_current_player().get());
+    RecordedMove move = search->decide(BotPosition::capture(controller, seat), Bot::Clock::time_point::max());
+    CHECK(static_cast<MonteCarloBot&>(*search).lastRollouts() > 0);
+    CHECK_NOTHROW(GameRecord::play(controller, move));
+    CHECK_THROWS_AS(createBot("tablemc:", 1), GameException);
+    CHECK_THROWS_AS(createBot("tablemc:0", 1), GameException);
+    CHECK_THROWS_AS(createBot("tablemc:8:", 1), GameException);
+    CHECK_THROWS_AS(createBot("table:missing.lut", 1), GameException);
+
+    // Distillation is the same on any number of threads
+    DistillConfig config;
+    config.teacher = "random";
+    config.games = 12;
+    config.maxPlayers = 4;
+    config.threads = 1;
+    DistillResult one = distillPolicy(config);
+    config.threads = 3;
+    DistillResult three = distillPolicy(config);
+    CHECK(one.decisions > 0);
+    CHECK(one.decisions == three.decisions);
+    CHECK(one.actionRows > 0);
+    CHECK(std::memcmp(&one.table->bytes(), &three.table->bytes(), sizeof(PolicyTable::Data)) == 0);
+    CHECK(std::memcmp(&one.table->bytes(), &builtin->bytes(), sizeof(PolicyTable::Data)) != 0);
+    config.teacher = "montecarlo";
+    CHECK_THROWS_AS(distillPolicy(config), GameException);
+}
+
+TEST_CASE("Bench - microbenchmark harness") {
+    // A fake allocation counter: reset and op both "allocate", only op's share is reported
+    std::uint64_t allocations = 0;
+    int state = 0;
+    BenchConfig config;
+    config.minSeconds = 0.001;
+    config.allocations = [&allocations]() { return allocations; };
+    bool setUp = false;
+    std::vector<BenchCase> cases = {
+        {"counter::add", [&]() { state = 0; allocations += 3; }, [&]() { state++; allocations++; },
+         [&]() { setUp = true; }},
+        {"other::skip", nullptr, []() {}, nullptr}};
+    config.filter = "counter";
+    std::vector<BenchResult> results = runBenchmarks(cases, config);
+    REQUIRE(results.size() == 1);
+    CHECK(setUp);
+    CHECK(results[0].name == "counter::add");
+    CHECK(results[0].iterations > 0);
+    CHECK(results[0].allocsPerOp == doctest::Approx(1.0));
+    CHECK(results[0].nsPerOp >= 0.0);
+    CHECK(state == 0);  // The last loop only ran reset
+
+    config.allocations = nullptr;
+    config.filter.clear();
+    results = runBenchmarks(cases, config);
+    REQUIRE(results.size() == 2);
+    CHECK(results[1].allocsPerOp < 0.0);
+    CHECK((results[1].instructionsPerOp < 0.0) == !InstructionCounter().available());
+
+    std::ostringstream json;
+    writeBenchJson(json, results);
+    CHECK(json.str().find("{\"name\":\"other::skip\",\"iterations\":") != std::string::npos);
+    CHECK(json.str().find("\"allocs\":null") != std::string::npos);
+    std::ostringstream table;
+    writeBenchTable(table, results);
+    CHECK(table.str().find("counter::add") != std::string::npos);
+
+    // Repetitions give an interval around the mean, and the JSON reads back
+    config.repetitions = 4;
+    config.warmupSeconds = 0.001;
+    results = runBenchmarks(cases, config);
+    REQUIRE(results.size() == 2);
+    CHECK(results[0].repetitions == 4);
+    CHECK(results[0].nsLow <= results[0].nsPerOp);
+    CHECK(results[0].nsHigh >= results[0].nsPerOp);
+    std::ostringstream written;
+    writeBenchJson(written, results);
+    std::istringstream read(written.str());
+    std::vector<BenchResult> loaded = readBenchJson(read);
+    REQUIRE(loaded.size() == 2);
+    CHECK(loaded[0].name == "counter::add");
+    CHECK(loaded[0].repetitions == 4);
+    CHECK(loaded[0].iterations == results[0].iterations);
+    CHECK(loaded[0].nsHigh == doctest::Approx(results[0].nsHigh).epsilon(1e-4));
+    CHECK(loaded[1].allocsPerOp < 0.0);
+    std::istringstream single("{\"benchmarks\":[{\"name\":\"a\",\"ns\":5,\"extra\":\"x\"}]}");
+    loaded = readBenchJson(single);
+    REQUIRE(loaded.size() == 1);
+    CHECK(loaded[0].nsLow == 5.0);
+    CHECK(loaded[0].nsHigh == 5.0);
+    std::istringstream broken("{\"benchmarks\":[{\"name\":\"a\",\"ns\":}]}");
+    CHECK_THROWS_AS(readBenchJson(broken), GameException);
+
+    // A regression needs the mean beyond the tolerance and intervals that do not overlap
+    auto make = [](const std::string& name, double ns, double low, double high, double allocs) {
+        BenchResult result;
+        result.name = name;
+        result.nsPerOp = ns;
+        result.nsLow = low;
+        result.nsHigh = high;
+        result.allocsPerOp = allocs;
+        return result;
+    };
+    std::vector<BenchResult> baseline = {make("slow", 100, 95, 105, 0), make("noisy", 100, 95, 105, 0),
+                                         make("alloc", 100, 95, 105, 1), make("tight", 100, 98, 102, 0)};
+    std::vector<BenchResult> current = {make("slow", 140, 135, 145, 0), make("noisy", 130, 100, 160, 0),
+                                        make("alloc", 100, 95, 105, 2), make("new", 10, 9, 11, 0),
+                                        make("tight", 130, 127, 133, 0)};
+    std::vector<BenchVerdict> verdicts = compareBenchmarks(baseline, current, 0.25);
+    REQUIRE(verdicts.size() == 5);
+    CHECK(verdicts[0].regressed);
+    CHECK(verdicts[0].reason == "time");
+    CHECK(verdicts[0].change == doctest::Approx(0.4));
+    CHECK_FALSE(verdicts[1].regressed);
+    CHECK(verdicts[2].regressed);
+    CHECK(verdicts[2].reason == "allocations");
+    CHECK_FALSE(verdicts[3].regressed);
+    CHECK(verdicts[3].baseline == nullptr);
+    CHECK(verdicts[4].regressed);  // 30% slower: caught without a margin on top of the noise
+    std::ostringstream report;
+    writeBenchVerdicts(report, verdicts);
+    CHECK(report.str().find("REGRESSED (time)") != std::string::npos);
+}
+
+TEST_CASE("AllocTracker - engine moves allocate nothing after setup") {
+    REQUIRE(allocationHookInstalled());
+
+    // Scopes count their own thread's traffic, nested scopes included
+    AllocationCounts before = allocationTotals();
+    std::atomic<int> stage{0};
+    std::uint64_t workerAllocations = 0;
+    std::thread worker([&stage, &workerAllocations]() {
+        AllocationScope own;
+        while (stage.load() == 0) {
+            std::this_thread::yield();
+        }
+        std::vector<int> elsewhere(100);
+        workerAllocations = own.counts().allocations;
+        stage.store(2);
+    });
+    AllocationCounts outerCounts;
+    AllocationCounts innerCounts;
+    {
+        AllocationScope outer;
+        auto first = std::make_unique<std::array<char, 64>>();
+        {
+            AllocationScope inner;
+            auto second = std::make_unique<int>(7);
+            second.reset();
+            innerCounts = inner.counts();
+        }
+        stage.store(1);
+        while (stage.load() != 2) {
+            std::this_thread::yield();
+        }
+        outerCounts = outer.counts();
+    }
+    worker.join();
+    CHECK(innerCounts.allocations == 1);
+    CHECK(innerCounts.deallocations == 1);
+    CHECK(innerCounts.bytes == sizeof(int));
+    CHECK(outerCounts.allocations == 2);
+    CHECK(outerCounts.bytes == 64 + sizeof(int));
+    CHECK(workerAllocations == 1);
+    CHECK(allocationTotals().allocations >= before.allocations + 3);
+
+    // Full games through the move API: setup may allocate, play may not
+    const char* roles[] = {"Governor", "Spy", "Baron", "General", "Judge", "Merchant"};
+    for (std::uint32_t seed = 1; seed <= 20; ++seed) {
+        std::mt19937 rng(seed);
+        auto game = std::make_shared<Game>();
+        game->set_verbose(false);
+        std::size_t players = 2 + seed % 5;
+        for (std::size_t i = 0; i < players; ++i) {
+            game->add_player(game->create_player("P" + std::to_string(i + 1), roles[rng() % 6]));
+        }
+        GameController controller(game);
+        std::uint64_t records = 0;
+        controller.setEventSink([&records](const ActionRecord&) { records++; });
+        controller.startGame();
+        std::array<Move, MAX_MOVES> moves;
+        std::uint32_t steps = 0;
+        AllocationCounts played;
+        {
+            AllocationScope scope;
+            while (controller.phase() != GamePhase::GameOver && steps++ < 3000) {
+                if (controller.phase() == GamePhase::BlockPending) {
+                    std::size_t pick = rng() % (2 * controller.pendingBlockerCount());
+                    if (pick < controller.pendingBlockerCount()) {
+                        controller.block(controller.pendingBlocker(pick));
+                    } else {
+                        controller.pass();
+                    }
+                } else {
+                    std::size_t count = controller.legalMoves(moves);
+                    const Move& move = moves[rng() % count];
+                    controller.requestAction(move.action, move.target);
+                }
+            }
+            played = scope.counts();
+        }
+        INFO("seed " << seed << ", " << steps << " steps");
+        CHECK(records > 0);
+        CHECK(played.allocations == 0);
+        CHECK(played.deallocations == 0);
+    }
+}
+
+TEST_CASE("Metrics - counters, HDR histogram and Prometheus export") {
+    // Every value lies in its bucket, and buckets are at most 1/16 of their values wide
+    bool inBucket = true;
+    bool narrow = true;
+    for (std::uint64_t value : {0ull, 1ull, 15ull, 16ull, 17ull, 31ull, 32ull, 1000ull, 999999ull, 123456789ull,
+                                (1ull << 39) + 12345}) {
+        std::size_t index = HdrBuckets::index(value);
+        inBucket = inBucket && HdrBuckets::lowerBound(index) <= value && value < HdrBuckets::upperBound(index);
+        std::uint64_t width = HdrBuckets::upperBound(index) - HdrBuckets::lowerBound(index);
+        narrow = narrow && (value < HdrBuckets::SUB_BUCKETS || width * HdrBuckets::SUB_BUCKETS <= value);
+    }
+    CHECK(inBucket);
+    CHECK(narrow);
+    CHECK(HdrBuckets::index(1ull << 50) == HdrBuckets::COUNT - 1);
+    for (std::size_t i = 0; i + 1 < HdrBuckets::COUNT; ++i) {
+        REQUIRE(HdrBuckets::upperBound(i) == HdrBuckets::lowerBound(i + 1));
+    }
+
+    MetricsSnapshot snapshot;
+    snapshot.turnNanos[HdrBuckets::index(1000)] = 90;
+    snapshot.turnNanos[HdrBuckets::index(2000000)] = 10;
+    snapshot.turns = 100;
+    CHECK(snapshot.turnQuantile(0.5) == doctest::Approx(1e-6).epsilon(0.07));
+    CHECK(snapshot.turnQuantile(0.95) == doctest::Approx(2e-3).epsilon(0.07));
+    CHECK(MetricsSnapshot().turnQuantile(0.5) == 0.0);
+
+    // A game through a metered controller, counted against its own event stream
+    MetricsSnapshot before = collectMetrics();
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    game->add_player(game->create_player("A", "General"));
+    game->add_player(game->create_player("B", "Governor"));
+    game->add_player(game->create_player("C", "Judge"));
+    GameController controller(game);
+    std::array<std::uint64_t, METRIC_EVENT_TYPES> emitted = {};
+    controller.setEventSink([&emitted](const ActionRecord& record) {
+        emitted[static_cast<std::size_t>(record.type)]++;
+    });
+    controller.startGame();
+    auto position = BotPosition::capture(controller, 0);
+    controller.requestAction(ActionType::Tax);  // The Governor may block it
+    REQUIRE(controller.phase() == GamePhase::BlockPending);
+    controller.block(1);
+    CHECK_THROWS_AS(controller.requestAction(ActionType::Coup, 0), NotEnoughCoinsException);
+    game->get_current_player()->add_coins(10);
+    controller.requestAction(ActionType::Coup, 2);  // Forced: 10 coins; only a General could block
+    if (controller.phase() == GamePhase::BlockPending) {
+        controller.pass();
+    }
+    std::mt19937 rng(5);
+    std::array<Move, MAX_MOVES> moves;
+    for (int step = 0; controller.phase() != GamePhase::GameOver && step < 2000; ++step) {
+        if (controller.phase() == GamePhase::BlockPending) {
+            controller.pass();
+        } else {
+            std::size_t count = controller.legalMoves(moves);
+            const Move& move = moves[rng() % count];
+            controller.requestAction(move.action, move.target);
+        }
+    }
+    REQUIRE(controller.phase() == GamePhase::GameOver);
+
+    // Search positions are not counted, rejected requests included
+    position.instantiate(rng)->requestAction(ActionType::Gather);
+    CHECK_THROWS_AS(position.instantiate(rng)->requestAction(ActionType::Coup, 1), NotEnoughCoinsException);
+    MetricsSnapshot after = collectMetrics();
+
+    if (METRICS_ENABLED) {
+        bool sameEvents = true;
+        for (std::size_t i = 0; i < METRIC_EVENT_TYPES; ++i) {
+            sameEvents = sameEvents && after.events[i] - before.events[i] == emitted[i];
+        }
+        CHECK(sameEvents);
+        CHECK(after.blocks[static_cast<std::size_t>(ActionType::Tax)] -
+                  before.blocks[static_cast<std::size_t>(ActionType::Tax)] == 1);
+        CHECK(after.validationFailures[static_cast<std::size_t>(ValidationFailure::NotEnoughCoins)] -
+                  before.validationFailures[static_cast<std::size_t>(ValidationFailure::NotEnoughCoins)] == 1);
+        CHECK(after.forcedCoups - before.forcedCoups >= 1);
+        CHECK(after.eliminations - before.eliminations == 2);
+        std::uint64_t turnStarts = emitted[static_cast<std::size_t>(ActionType::TurnStart)];
+        CHECK(after.turns - before.turns == turnStarts);
+    } else {
+        CHECK(after.turns == 0);
+        CHECK(after.events[static_cast<std::size_t>(ActionType::GameOver)] == 0);
+    }
+
+    // Prometheus text, written to a file and served over HTTP
+    std::ostringstream text;
+    after.writePrometheus(text);
+    CHECK(text.str().find("# TYPE coup_events_total counter\ncoup_events_total{type=\"Gather\"} ") !=
+          std::string::npos);
+    CHECK(text.str().find("coup_validation_failures_total{reason=\"not_enough_coins\"} ") != std::string::npos);
+    CHECK(text.str().find("coup_turn_duration_seconds_bucket{le=\"+Inf\"} " + std::to_string(after.turns) + "\n") !=
+          std::string::npos);
+    CHECK(text.str().find("coup_turn_duration_quantile_seconds{quantile=\"0.99\"} ") != std::string::npos);
+
+    writeMetricsFile("test_metrics.prom");
+    std::ifstream written("test_metrics.prom");
+    std::string firstLine;
+    std::getline(written, firstLine);
+    CHECK(firstLine == "# HELP coup_events_total Records emitted by game controllers, by type.");
+    written.close();
+    std::remove("test_metrics.prom");
+    CHECK_THROWS_AS(writeMetricsFile("no_such_directory/metrics.prom"), GameException);
+
+    MetricsServer server(0);
+    REQUIRE(server.port() != 0);
+    auto fetch = [&server](const std::string& path) {
+        int client = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(server.port());
+        std::string response;
+        if (::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+            ::send(client, request.data(), request.size(), 0);
+            char buffer[4096];
+            for (ssize_t got; (got = ::recv(client, buffer, sizeof(buffer), 0)) > 0;) {
+                response.append(buffer, static_cast<std::size_t>(got));
+            }
+        }
+        ::close(client);
+        return response;
+    };
+    std::string response = fetch("/metrics");
+    CHECK(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    CHECK(response.find("Content-Type: text/plain; version=0.0.4") != std::string::npos);
+    CHECK(response.find("coup_eliminations_total ") != std::string::npos);
+    CHECK(fetch("/other").rfind("HTTP/1.1 404", 0) == 0);
+}
+
+TEST_CASE("Trace - per-thread span buffers and Chrome trace export") {
+    auto count = [](const std::string& text, const std::string& needle) {
+        std::size_t found = 0;
+        for (std::size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) {
+            found++;
+        }
+        return found;
+    };
+
+    // A short game on this thread, a span on a thread that exits and one on the thread that takes its buffer
+    startTracing();
+    trace::setThreadName("test");
+    auto game = std::make_shared<Game>();
+    game->set_verbose(false);
+    auto governor = game->create_player("A", "Governor");
+    auto baron = game->create_player("B", "Baron");
+    game->add_player(governor);
+    game->add_player(baron);
+    game->start_game();
+    governor->tax();
+    baron->gather();
+    {
+        TraceQuiet quiet;
+        governor->gather();
+    }
+    std::thread([]() {
+        trace::setThreadName("worker \"one\"");
+        TraceSpan span("first", "test");
+    }).join();
+    std::thread([]() {
+        trace::setThreadName("worker two");
+        TraceSpan span("second", "test");
+    }).join();
+    stopTracing();
+    baron->gather();
+
+    std::ostringstream json;
+    std::size_t spans = writeTraceJson(json);
+    std::string text = json.str();
+    CHECK(text.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", 0) == 0);
+    CHECK(text.size() >= 4);
+    CHECK(text.compare(text.size() - 4, 4, "\n]}\n") == 0);
+    if (TRACE_ENABLED) {
+        CHECK(spans == 6);  // tax, gather, two next_turns, first, second
+        CHECK(count(text, "\"ph\":\"X\"") == spans);
+        CHECK(count(text, "\"name\":\"Player::tax\",\"cat\":\"action\"") == 1);
+        CHECK(count(text, "\"name\":\"Player::gather\"") == 1);
+        CHECK(count(text, "\"name\":\"Game::next_turn\",\"cat\":\"engine\"") == 2);
+        CHECK(text.find("\"args\":{\"name\":\"test\"}") != std::string::npos);
+        CHECK(text.find("\"args\":{\"name\":\"worker \\\"one\\\"\"}") != std::string::npos);
+        CHECK(text.find("\"args\":{\"name\":\"worker two\"}") != std::string::npos);
+    } else {
+        CHECK(spans == 0);
+    }
+
+    // A thread keeps its newest spans, and a dump taken while it writes only sees whole ones
+    startTracing();
+    std::atomic<bool> writing(true);
+    std::thread writer([&writing]() {
+        for (std::size_t i = 0; i < 3 * TRACE_SPANS_PER_THREAD; ++i) {
+            std::uint64_t start = trace::clockNanos();
+            trace::record("span", "test", start, start + 1000);
+        }
+        writing = false;
+    });
+    bool consistent = true;
+    while (writing) {
+        std::ostringstream partial;
+        std::size_t dumped = writeTraceJson(partial);
+        consistent = consistent && dumped <= TRACE_SPANS_PER_THREAD &&
+                     count(partial.str(), "\"dur\":1.000,") == dumped;
+    }
+    writer.join();
+    CHECK(consistent);
+    std::ostringstream full;
+    CHECK(writeTraceJson(full) == TRACE_SPANS_PER_THREAD);
+    stopTracing();
+
+    CHECK(writeTraceFile("test_trace.json") == TRACE_SPANS_PER_THREAD);
+    std::remove("test_trace.json");
+    CHECK_THROWS_AS(writeTraceFile("no_such_directory/trace.json"), GameException);
+}
@@ -0,0 +1,93 @@
+//meirshuker159@gmail.com
+
+/**
+ * @file embed_assets.cpp
+ * @brief Build tool that compiles asset files into a C++ source file
+ * @details Usage: embed_assets OUTPUT.cpp FILE...
+ *
+ * Writes one string literal per file plus the EMBEDDED_ASSETS table declared
+ * in Assets.hpp. String literals (rather than brace lists of numbers) keep
+ * the generated file small and quick to compile: printable characters are
+ * copied as-is and everything else becomes a three-digit octal escape.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string baseName(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+void writeLiteral(std::ostream& out, const std::vector<char>& bytes) {
+    const std::size_t bytesPerLine = 64;
+    out << "    \"";
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        if (i > 0 && i % bytesPerLine == 0) {
+            out << "\"\n    \"";
+        }
+        unsigned char c = static_cast<unsigned char>(bytes[i]);
+        // '?' is escaped too so no trigraph can form
+        if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\' && c != '?') {
+            out << static_cast<char>(c);
+        } else {
+            char escape[5];
+            std::snprintf(escape, sizeof(escape), "\\%03o", c);
+            out << escape;
+        }
+    }
+    out << "\"";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: embed_assets OUTPUT.cpp FILE..." << std::endl;
+        return 1;
+    }
+    std::ofstream out(argv[1], std::ios::out | std::ios::trunc);
+    if (!out) {
+        std::cerr << "embed_assets: cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    out << "// Generated by tools/embed_assets - do not edit\n\n";
+    out << "#include \"Assets.hpp\"\n\nnamespace coup {\n\nnamespace {\n\n";
+    std::vector<std::size_t> sizes;
+    for (int i = 2; i < argc; ++i) {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in) {
+            std::cerr << "embed_assets: cannot read " << argv[i] << std::endl;
+            return 1;
+        }
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        sizes.push_back(bytes.size());
+        out << "const char asset" << (i - 2) << "[] =\n";
+        writeLiteral(out, bytes);
+        out << ";\n\n";
+    }
+    out << "} // namespace\n\n";
+
+    out << "const EmbeddedAsset EMBEDDED_ASSETS[] = {\n";
+    for (int i = 2; i < argc; ++i) {
+        out << "    {\"" << baseName(argv[i]) << "\", reinterpret_cast<const unsigned char*>(asset" << (i - 2)
+            << "), " << sizes[i - 2] << "},\n";
+    }
+    // Keeps the array non-empty when no assets are listed
+    out << "    {\"\", nullptr, 0}\n};\n\n";
+    out << "const std::size_t EMBEDDED_ASSET_COUNT = " << (argc - 2) << ";\n\n";
+    out << "} // namespace coup\n";
+
+    if (!out) {
+        std::cerr << "embed_assets: failed writing " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}